@@ -1,9 +1,19 @@
 // Engine-agnostic placeholder types; rename avoids Win32 name clashes.
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DF_CORE_TYPES_SSE2 1
+#endif
 
 struct DFPoint {
     float x = 0;
@@ -21,17 +31,81 @@ struct DFRect {
     }
 };
 
+inline bool DFRectsOverlap(const DFRect& a, const DFRect& b)
+{
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+inline DFRect DFRectIntersection(const DFRect& a, const DFRect& b)
+{
+    const float x0 = std::max(a.x, b.x);
+    const float y0 = std::max(a.y, b.y);
+    const float x1 = std::min(a.x + a.width, b.x + b.width);
+    const float y1 = std::min(a.y + a.height, b.y + b.height);
+    return {x0, y0, std::max(0.0f, x1 - x0), std::max(0.0f, y1 - y0)};
+}
+
+inline DFRect DFRectUnion(const DFRect& a, const DFRect& b)
+{
+    const float x0 = std::min(a.x, b.x);
+    const float y0 = std::min(a.y, b.y);
+    const float x1 = std::max(a.x + a.width, b.x + b.width);
+    const float y1 = std::max(a.y + a.height, b.y + b.height);
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+inline DFRect DFPointsBounds(const DFPoint* points, size_t count)
+{
+    if (!points || count == 0) {
+        return {};
+    }
+    float x0 = points[0].x;
+    float y0 = points[0].y;
+    float x1 = x0;
+    float y1 = y0;
+    for (size_t i = 1; i < count; ++i) {
+        x0 = std::min(x0, points[i].x);
+        y0 = std::min(y0, points[i].y);
+        x1 = std::max(x1, points[i].x);
+        y1 = std::max(y1, points[i].y);
+    }
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
 class Event {
 public:
     enum class Type { Unknown, MouseDown, MouseUp, MouseMove, KeyDown, KeyUp, Close };
+    enum class Modifier : uint32_t { Shift = 1u << 0, Control = 1u << 1, Alt = 1u << 2 };
     explicit Event(Type t = Type::Unknown) : type(t) {}
     Type type = Type::Unknown;
     float x = 0.0f;
     float y = 0.0f;
     int key = 0;
+    uint32_t modifiers = 0; // Modifier bits held when the input was generated
+    // Stamped by DFStampInput where the platform delivers the input; 0 means
+    // synthetic. A coalesced move keeps the stamp of the oldest move it
+    // absorbed, so latency counts from the first input still waiting.
+    double time = 0.0;      // DFInputClockSeconds()
+    uint64_t sequence = 0;  // process-wide input order
     bool handled = false;
+
+    bool has(Modifier modifier) const { return (modifiers & static_cast<uint32_t>(modifier)) != 0; }
 };
 
+// Monotonic seconds; input stamps and present times must share this clock.
+inline double DFInputClockSeconds()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void DFStampInput(Event& event)
+{
+    static std::atomic<uint64_t> nextSequence{1};
+    event.time = DFInputClockSeconds();
+    event.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+}
+
 struct DFColor {
     float r = 1, g = 1, b = 1, a = 1;
 };
@@ -46,6 +120,54 @@ inline constexpr DFColor DFColorFromHex(uint32_t rgb, float alpha = 1.0f)
     };
 }
 
+// Straight (not premultiplied) RGBA8 with red in the low byte: the memory
+// order of DXGI_FORMAT_R8G8B8A8_UNORM on little-endian targets. Command
+// streams and vertices carry colors in this form.
+struct DFPackedColor {
+    uint32_t rgba = 0xFFFFFFFFu;
+
+    bool operator==(const DFPackedColor& other) const { return rgba == other.rgba; }
+    bool operator!=(const DFPackedColor& other) const { return rgba != other.rgba; }
+};
+
+// Clamps each channel to [0, 1] and rounds to the nearest byte; NaN packs to 0.
+inline DFPackedColor DFPackColor(const DFColor& color)
+{
+#if defined(DF_CORE_TYPES_SSE2)
+    const __m128 v = _mm_set_ps(color.a, color.b, color.g, color.r);
+    // maxps returns its second operand when either is NaN.
+    const __m128 unit = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    const __m128i ints = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(unit, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+    const __m128i words = _mm_packs_epi32(ints, ints);
+    return {static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_packus_epi16(words, words)))};
+#else
+    auto toByte = [](float v) {
+        const float unit = v > 0.0f ? (v < 1.0f ? v : 1.0f) : 0.0f;
+        return static_cast<uint32_t>(unit * 255.0f + 0.5f);
+    };
+    return {toByte(color.r) | (toByte(color.g) << 8) | (toByte(color.b) << 16) | (toByte(color.a) << 24)};
+#endif
+}
+
+inline constexpr DFColor DFUnpackColor(DFPackedColor packed)
+{
+    return DFColor{
+        static_cast<float>(packed.rgba & 0xFFu) / 255.0f,
+        static_cast<float>((packed.rgba >> 8) & 0xFFu) / 255.0f,
+        static_cast<float>((packed.rgba >> 16) & 0xFFu) / 255.0f,
+        static_cast<float>(packed.rgba >> 24) / 255.0f
+    };
+}
+
+// Backend-neutral vertex: position plus packed color, 12 bytes.
+struct DFVertex {
+    float x = 0.0f;
+    float y = 0.0f;
+    DFPackedColor color;
+};
+
+static_assert(sizeof(DFPackedColor) == 4 && sizeof(DFVertex) == 12, "packed formats must stay tight");
+
 struct DFSize {
     float width = 0;
     float height = 0;
@@ -103,20 +225,48 @@ inline int DFMaxCharsForWidth(float maxWidthPx, float scaleMul = 1.0f)
     return static_cast<int>(maxWidthPx / DFGlyphAdvancePx(scaleMul));
 }
 
-inline std::string DFClipTextToWidth(const std::string& text, float maxWidthPx, bool withEllipsis = true, float scaleMul = 1.0f)
+// Result of fitting text into a width: how many source characters to draw and
+// whether a "..." run follows them. The bitmap font has a fixed advance, so
+// this is closed-form and never allocates.
+struct DFTextFit {
+    size_t visibleChars = 0;
+    bool ellipsis = false;
+    float widthPx = 0.0f;
+};
+
+inline float DFMeasureTextWidth(std::string_view text, float scaleMul = 1.0f)
+{
+    return static_cast<float>(text.size()) * DFGlyphAdvancePx(scaleMul);
+}
+
+inline DFTextFit DFFitTextToWidth(std::string_view text, float maxWidthPx, bool withEllipsis = true, float scaleMul = 1.0f)
 {
+    DFTextFit fit;
     const int maxChars = DFMaxCharsForWidth(maxWidthPx, scaleMul);
     if (maxChars <= 0) {
-        return {};
+        return fit;
     }
     if (static_cast<int>(text.size()) <= maxChars) {
-        return text;
+        fit.visibleChars = text.size();
+    } else if (!withEllipsis || maxChars <= 6) {
+        // For very narrow slots, plain clipping is more readable than "X..."
+        fit.visibleChars = static_cast<size_t>(maxChars);
+    } else {
+        fit.visibleChars = static_cast<size_t>(maxChars - 3);
+        fit.ellipsis = true;
     }
-    // For very narrow slots, plain clipping is more readable than "X..."
-    if (!withEllipsis || maxChars <= 6) {
-        return text.substr(0, static_cast<size_t>(maxChars));
+    fit.widthPx = static_cast<float>(fit.visibleChars + (fit.ellipsis ? 3u : 0u)) * DFGlyphAdvancePx(scaleMul);
+    return fit;
+}
+
+inline std::string DFClipTextToWidth(const std::string& text, float maxWidthPx, bool withEllipsis = true, float scaleMul = 1.0f)
+{
+    const DFTextFit fit = DFFitTextToWidth(text, maxWidthPx, withEllipsis, scaleMul);
+    std::string clipped = text.substr(0, fit.visibleChars);
+    if (fit.ellipsis) {
+        clipped += "...";
     }
-    return text.substr(0, static_cast<size_t>(maxChars - 3)) + "...";
+    return clipped;
 }
 
 inline float DFTextBaselineYForRect(const DFRect& rect, float scaleMul = 1.0f)
@@ -220,7 +370,7 @@ inline const uint8_t* DFGlyph5x7(char c)
 }
 
 template <typename PixelDrawer>
-inline void DFDrawBitmapTextPixels(float x, float y, const std::string& text, PixelDrawer&& drawPixel, float scaleMul = 1.0f)
+inline void DFDrawBitmapTextPixels(float x, float y, std::string_view text, PixelDrawer&& drawPixel, float scaleMul = 1.0f)
 {
     const float s = std::clamp(scaleMul, 0.2f, 4.0f);
     const float px = DFTextPixelScale() * s;
@@ -241,16 +391,131 @@ inline void DFDrawBitmapTextPixels(float x, float y, const std::string& text, Pi
     }
 }
 
+struct DFGlyphRect {
+    uint8_t col = 0;
+    uint8_t row = 0;
+    uint8_t width = 0;
+    uint8_t height = 0;
+};
+
+// Prebuilt 5x7 glyph data for printable ASCII: a coverage mask per glyph plus a
+// greedy split of its lit cells into non-overlapping rectangles, so a glyph is
+// drawn as a few quads instead of one per lit pixel.
+class DFGlyphAtlas {
+public:
+    static constexpr int kGlyphWidth = 5;
+    static constexpr int kGlyphHeight = 7;
+    static constexpr int kFirstChar = 32;
+    static constexpr int kGlyphCount = 95;
+
+    static const DFGlyphAtlas& instance()
+    {
+        static const DFGlyphAtlas atlas;
+        return atlas;
+    }
+
+    // Characters outside printable ASCII share the '?' (unknown) glyph.
+    static int glyphIndex(char c)
+    {
+        int code = static_cast<unsigned char>(c);
+        if (code < kFirstChar || code >= kFirstChar + kGlyphCount) {
+            code = '?';
+        }
+        return code - kFirstChar;
+    }
+
+    const DFGlyphRect* rects(int glyph) const { return rects_ + rectStart_[glyph]; }
+    int rectCount(int glyph) const { return rectCount_[glyph]; }
+    // Row-major kGlyphWidth x kGlyphHeight mask, 0 or 255 per cell.
+    const uint8_t* mask(int glyph) const { return masks_[glyph]; }
+
+private:
+    DFGlyphAtlas()
+    {
+        int total = 0;
+        for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+            const uint8_t* bits = DFGlyph5x7(static_cast<char>(glyph + kFirstChar));
+            bool used[kGlyphHeight][kGlyphWidth] = {};
+            auto lit = [&](int col, int row) {
+                return (bits[row] & (1u << (kGlyphWidth - 1 - col))) != 0u;
+            };
+            rectStart_[glyph] = static_cast<uint16_t>(total);
+            for (int row = 0; row < kGlyphHeight; ++row) {
+                for (int col = 0; col < kGlyphWidth; ++col) {
+                    masks_[glyph][row * kGlyphWidth + col] = lit(col, row) ? 255u : 0u;
+                    if (!lit(col, row) || used[row][col]) {
+                        continue;
+                    }
+                    int width = 1;
+                    while (col + width < kGlyphWidth && lit(col + width, row) && !used[row][col + width]) {
+                        ++width;
+                    }
+                    int height = 1;
+                    for (bool grow = true; grow && row + height < kGlyphHeight;) {
+                        for (int c = col; c < col + width; ++c) {
+                            if (!lit(c, row + height) || used[row + height][c]) {
+                                grow = false;
+                                break;
+                            }
+                        }
+                        if (grow) {
+                            ++height;
+                        }
+                    }
+                    for (int r = row; r < row + height; ++r) {
+                        for (int c = col; c < col + width; ++c) {
+                            used[r][c] = true;
+                        }
+                    }
+                    rects_[total++] = DFGlyphRect{
+                        static_cast<uint8_t>(col),
+                        static_cast<uint8_t>(row),
+                        static_cast<uint8_t>(width),
+                        static_cast<uint8_t>(height)};
+                }
+            }
+            rectCount_[glyph] = static_cast<uint8_t>(total - rectStart_[glyph]);
+        }
+    }
+
+    DFGlyphRect rects_[kGlyphCount * kGlyphWidth * kGlyphHeight]{};
+    uint16_t rectStart_[kGlyphCount]{};
+    uint8_t rectCount_[kGlyphCount]{};
+    uint8_t masks_[kGlyphCount][kGlyphWidth * kGlyphHeight]{};
+};
+
 class Canvas;
 
 inline void DFDrawText(Canvas& canvas,
                        float x,
                        float y,
-                       const std::string& text,
+                       std::string_view text,
                        const DFColor& color,
                        float scaleMul = 1.0f,
                        bool smooth = false);
 
+inline void DFDrawGlyphRunRects(Canvas& canvas,
+                                float x,
+                                float y,
+                                std::string_view text,
+                                const DFColor& color,
+                                float scaleMul,
+                                bool smooth);
+
+class DisplayListCanvas;
+
+// Subsystem that issues a run of draws, for canvases that attribute cost.
+enum class DFCanvasScope : uint8_t {
+    Other,
+    DockRenderer,
+    DockSplitter,
+    WindowManager,
+    DragOverlay,
+    WidgetContent,
+    DebugOverlay,
+    Count
+};
+
 class Canvas {
 public:
     virtual ~Canvas() = default;
@@ -268,34 +533,260 @@ public:
         drawRectangle({rect.x + std::max(0.0f, rect.width - t), rect.y, t, rect.height}, color);
     }
     virtual void drawLine(const DFPoint&, const DFPoint&, const DFColor&, float /*thickness*/ = 1.0f) {}
+    // Filled convex polygon, points in either winding. The default covers each
+    // pixel row with one rectangle spanning the polygon across that row.
+    virtual void drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color)
+    {
+        const DFRect bounds = DFPointsBounds(points, count);
+        if (count < 3 || bounds.width <= 0.0f || bounds.height <= 0.0f || isClippedOut(bounds)) {
+            return;
+        }
+        const float bottom = bounds.y + bounds.height;
+        for (float y0 = bounds.y; y0 < bottom;) {
+            const float y1 = std::min(bottom, std::floor(y0) + 1.0f);
+            float xMin = bounds.x + bounds.width;
+            float xMax = bounds.x;
+            for (size_t i = 0; i < count; ++i) {
+                const DFPoint& a = points[i];
+                const DFPoint& b = points[(i + 1) % count];
+                float t0 = 0.0f;
+                float t1 = 1.0f;
+                if (a.y == b.y) {
+                    if (a.y < y0 || a.y > y1) {
+                        continue;
+                    }
+                } else {
+                    const float ta = (y0 - a.y) / (b.y - a.y);
+                    const float tb = (y1 - a.y) / (b.y - a.y);
+                    t0 = std::max(0.0f, std::min(ta, tb));
+                    t1 = std::min(1.0f, std::max(ta, tb));
+                    if (t0 > t1) {
+                        continue;
+                    }
+                }
+                const float xa = a.x + (b.x - a.x) * t0;
+                const float xb = a.x + (b.x - a.x) * t1;
+                xMin = std::min({xMin, xa, xb});
+                xMax = std::max({xMax, xa, xb});
+            }
+            if (xMax > xMin) {
+                drawRectangle({xMin, y0, xMax - xMin, y1 - y0}, color);
+            }
+            y0 = y1;
+        }
+    }
     virtual void drawText(float x, float y, const std::string& text, const DFColor& color)
     {
-        DFDrawText(*this, x, y, text, color, 1.0f, DFTextSmooth());
+        drawGlyphRun(x, y, text, color, 1.0f, DFTextSmooth());
+    }
+    // Whole-string bitmap text; the default emits the atlas rectangles per glyph.
+    virtual void drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul = 1.0f, bool smooth = false)
+    {
+        DFDrawGlyphRunRects(*this, x, y, text, color, scaleMul, smooth);
+    }
+
+    // Scissor for subsequent draws, used to repaint damaged regions only.
+    // Backends driving partial redraw must honour it; the base just tracks it
+    // so painters can skip content that cannot touch the clip.
+    virtual void setClipRect(const DFRect& rect)
+    {
+        clipRect_ = rect;
+        hasClip_ = true;
+    }
+    virtual void clearClipRect() { hasClip_ = false; }
+    bool hasClipRect() const { return hasClip_; }
+
+    // Retained backends can take a recorded list in one step when everything
+    // it draws lies within bounds; false means the caller replays it instead.
+    virtual bool appendRecorded(const DisplayListCanvas& /*list*/, const DFRect& /*bounds*/) { return false; }
+
+    // Draws until the matching popScope belong to scope; scopes nest and the
+    // innermost wins. Only instrumenting canvases act on them.
+    virtual void pushScope(DFCanvasScope /*scope*/) {}
+    virtual void popScope() {}
+    const DFRect& clipRect() const { return clipRect_; }
+
+    // True when nothing drawn inside bounds can reach the clip. Bounds are
+    // padded for antialiased edges and strokes that straddle them.
+    bool isClippedOut(const DFRect& bounds) const
+    {
+        if (!hasClip_) {
+            return false;
+        }
+        constexpr float kMargin = 2.0f;
+        const DFRect padded{bounds.x - kMargin, bounds.y - kMargin, bounds.width + kMargin * 2.0f, bounds.height + kMargin * 2.0f};
+        return !DFRectsOverlap(padded, clipRect_);
+    }
+
+    // Nested clip for widget content. The pushed rect is intersected with the
+    // active clip and handed to setClipRect, so backends scissor it; popClip
+    // restores the clip (or no clip) that was active before the matching push.
+    void pushClip(const DFRect& rect)
+    {
+        clipStack_.push_back({clipRect_, hasClip_});
+        setClipRect(hasClip_ ? DFRectIntersection(clipRect_, rect) : rect);
+    }
+    void popClip()
+    {
+        if (clipStack_.empty()) {
+            return;
+        }
+        const SavedClip saved = clipStack_.back();
+        clipStack_.pop_back();
+        if (saved.active) {
+            setClipRect(saved.rect);
+        } else {
+            clearClipRect();
+        }
     }
+    size_t clipDepth() const { return clipStack_.size(); }
+
+protected:
+    // CPU-side clipping for backends, applied before geometry is tessellated
+    // or queued. Plain rects are trimmed to the clip; false means nothing of
+    // the primitive can show.
+    bool cullRect(DFRect& rect) const
+    {
+        if (!hasClip_) {
+            return true;
+        }
+        rect = DFRectIntersection(rect, clipRect_);
+        return rect.width > 0.0f && rect.height > 0.0f;
+    }
+
+    // Trims the segment to the clip grown by the stroke, so the caps of the
+    // cut ends stay outside the clip (Liang-Barsky).
+    bool cullLine(DFPoint& a, DFPoint& b, float thickness) const
+    {
+        if (!hasClip_) {
+            return true;
+        }
+        const float pad = std::max(1.0f, thickness) + 2.0f;
+        const float minX = clipRect_.x - pad;
+        const float minY = clipRect_.y - pad;
+        const float maxX = clipRect_.x + clipRect_.width + pad;
+        const float maxY = clipRect_.y + clipRect_.height + pad;
+        const float dx = b.x - a.x;
+        const float dy = b.y - a.y;
+        const float p[4] = {-dx, dx, -dy, dy};
+        const float q[4] = {a.x - minX, maxX - a.x, a.y - minY, maxY - a.y};
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+        for (int i = 0; i < 4; ++i) {
+            if (p[i] == 0.0f) {
+                if (q[i] < 0.0f) {
+                    return false;
+                }
+                continue;
+            }
+            const float t = q[i] / p[i];
+            if (p[i] < 0.0f) {
+                t0 = std::max(t0, t);
+            } else {
+                t1 = std::min(t1, t);
+            }
+            if (t0 > t1) {
+                return false;
+            }
+        }
+        const DFPoint start = a;
+        if (t0 > 0.0f) {
+            a = {start.x + dx * t0, start.y + dy * t0};
+        }
+        if (t1 < 1.0f) {
+            b = {start.x + dx * t1, start.y + dy * t1};
+        }
+        return true;
+    }
+
+    void dropClipStack() { clipStack_.clear(); }
+
+    DFRect clipRect_{};
+    bool hasClip_ = false;
+
+private:
+    struct SavedClip {
+        DFRect rect;
+        bool active = false;
+    };
+    std::vector<SavedClip> clipStack_;
+};
+
+class DFCanvasScopeGuard {
+public:
+    DFCanvasScopeGuard(Canvas& canvas, DFCanvasScope scope) : canvas_(canvas) { canvas_.pushScope(scope); }
+    ~DFCanvasScopeGuard() { canvas_.popScope(); }
+    DFCanvasScopeGuard(const DFCanvasScopeGuard&) = delete;
+    DFCanvasScopeGuard& operator=(const DFCanvasScopeGuard&) = delete;
+
+private:
+    Canvas& canvas_;
 };
 
+inline void DFDrawGlyphRunRects(Canvas& canvas,
+                                float x,
+                                float y,
+                                std::string_view text,
+                                const DFColor& color,
+                                float scaleMul,
+                                bool smooth)
+{
+    const DFGlyphAtlas& atlas = DFGlyphAtlas::instance();
+    const float px = DFTextPixelScale() * std::clamp(scaleMul, 0.2f, 4.0f);
+    const float advance = DFGlyphAdvancePx(scaleMul);
+    if (canvas.isClippedOut({x, y, advance * static_cast<float>(text.size()), DFGlyphHeightPx(scaleMul)})) {
+        return;
+    }
+    // Soft mode: rounded runs reduce the blocky appearance.
+    const float radius = std::max(0.2f, px * 0.35f);
+    float cursorX = x;
+    for (char ch : text) {
+        const int glyph = DFGlyphAtlas::glyphIndex(ch);
+        const DFGlyphRect* rects = atlas.rects(glyph);
+        for (int i = 0; i < atlas.rectCount(glyph); ++i) {
+            const DFRect rect{
+                cursorX + rects[i].col * px,
+                y + rects[i].row * px,
+                rects[i].width * px,
+                rects[i].height * px};
+            if (smooth) {
+                canvas.drawRoundedRectangle(rect, radius, color);
+            } else {
+                canvas.drawRectangle(rect, color);
+            }
+        }
+        cursorX += advance;
+    }
+}
+
 inline void DFDrawText(Canvas& canvas,
                        float x,
                        float y,
-                       const std::string& text,
+                       std::string_view text,
                        const DFColor& color,
                        float scaleMul,
                        bool smooth)
 {
-    DFDrawBitmapTextPixels(
-        x,
-        y,
-        text,
-        [&](float px, float py, float w, float h) {
-            if (!smooth) {
-                canvas.drawRectangle({px, py, w, h}, color);
-                return;
-            }
-            // Soft mode: rounded glyph pixels reduce blocky appearance.
-            const float radius = std::max(0.2f, w * 0.35f);
-            canvas.drawRoundedRectangle({px, py, w, h}, radius, color);
-        },
-        scaleMul);
+    canvas.drawGlyphRun(x, y, text, color, scaleMul, smooth);
+}
+
+// Draws the fitted prefix and, when clipped, the ellipsis as a second run.
+inline void DFDrawTextFit(Canvas& canvas,
+                          float x,
+                          float y,
+                          std::string_view text,
+                          const DFTextFit& fit,
+                          const DFColor& color,
+                          float scaleMul = 1.0f,
+                          bool smooth = false)
+{
+    if (fit.visibleChars > 0) {
+        canvas.drawGlyphRun(x, y, text.substr(0, fit.visibleChars), color, scaleMul, smooth);
+    }
+    if (fit.ellipsis) {
+        const float ellipsisX = x + static_cast<float>(fit.visibleChars) * DFGlyphAdvancePx(scaleMul);
+        canvas.drawGlyphRun(ellipsisX, y, "...", color, scaleMul, smooth);
+    }
 }
 
 class Widget {
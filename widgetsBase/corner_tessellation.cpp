@@ -0,0 +1,98 @@
+#include "corner_tessellation.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr float kHalfPi = 1.57079632679489661923f;
+constexpr float kQuantum = 4.0f; // steps per pixel
+
+uint32_t QuantumSteps(float value)
+{
+    return static_cast<uint32_t>(std::clamp(std::floor(value * kQuantum), 0.0f, 32767.0f));
+}
+
+// Same densities the DX12 fans and arcs used: fills need fewer segments than
+// strokes, whose facets show along the thin edge.
+int SegmentsFor(float radius, bool ring)
+{
+    const int segments = ring ? std::max(8, static_cast<int>(std::ceil(radius)))
+                              : std::max(6, static_cast<int>(std::ceil(radius * 0.75f)));
+    return std::min(segments, DFCornerTessellation::kMaxSegments);
+}
+
+// Rotates the quarter arc (cos, sin) of [0, pi/2] into each corner, starting
+// at angle pi for the top-left corner and going clockwise on screen.
+void BuildCorners(const std::vector<DFPoint>& quarter, float radius, std::vector<DFPoint>& out)
+{
+    out.clear();
+    out.reserve(quarter.size() * 4);
+    for (const DFPoint& q : quarter) {
+        out.push_back({-q.x * radius, -q.y * radius});
+    }
+    for (const DFPoint& q : quarter) {
+        out.push_back({q.y * radius, -q.x * radius});
+    }
+    for (const DFPoint& q : quarter) {
+        out.push_back({q.x * radius, q.y * radius});
+    }
+    for (const DFPoint& q : quarter) {
+        out.push_back({-q.y * radius, q.x * radius});
+    }
+}
+
+DFCornerTable BuildTable(float radius, float thickness, bool ring)
+{
+    DFCornerTable table;
+    table.radius = radius;
+    table.segments = SegmentsFor(radius, ring);
+    std::vector<DFPoint> quarter(static_cast<size_t>(table.segments) + 1);
+    for (int i = 0; i <= table.segments; ++i) {
+        const float angle = kHalfPi * static_cast<float>(i) / static_cast<float>(table.segments);
+        quarter[static_cast<size_t>(i)] = {std::cos(angle), std::sin(angle)};
+    }
+    // Exact axis endpoints keep the straight edges straight.
+    quarter.front() = {1.0f, 0.0f};
+    quarter.back() = {0.0f, 1.0f};
+    if (ring) {
+        BuildCorners(quarter, radius + thickness * 0.5f, table.outer);
+        BuildCorners(quarter, std::max(0.0f, radius - thickness * 0.5f), table.inner);
+    } else {
+        BuildCorners(quarter, radius, table.outer);
+    }
+    return table;
+}
+
+} // namespace
+
+DFCornerTessellation& DFCornerTessellation::instance()
+{
+    static DFCornerTessellation tessellation;
+    return tessellation;
+}
+
+float DFCornerTessellation::Quantize(float value)
+{
+    return static_cast<float>(QuantumSteps(value)) / kQuantum;
+}
+
+const DFCornerTable& DFCornerTessellation::fill(float radius)
+{
+    const uint32_t key = QuantumSteps(radius);
+    auto it = tables_.find(key);
+    if (it == tables_.end()) {
+        it = tables_.emplace(key, BuildTable(Quantize(radius), 0.0f, false)).first;
+    }
+    return it->second;
+}
+
+const DFCornerTable& DFCornerTessellation::ring(float radius, float thickness)
+{
+    const uint32_t key = 0x80000000u | (QuantumSteps(thickness) << 15) | QuantumSteps(radius);
+    auto it = tables_.find(key);
+    if (it == tables_.end()) {
+        it = tables_.emplace(key, BuildTable(Quantize(radius), Quantize(thickness), true)).first;
+    }
+    return it->second;
+}
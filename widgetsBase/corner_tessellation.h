@@ -0,0 +1,62 @@
+#pragma once
+
+#include "core_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Precomputed rounded-rectangle corners for backends that tessellate them.
+// A table holds the four corner arcs in clockwise order (top-left, top-right,
+// bottom-right, bottom-left), segments + 1 offsets each, relative to the
+// corner's arc center. The first and last offset of an arc lie on the straight
+// edges, so walking all offsets traces the whole outline.
+struct DFCornerTable {
+    int segments = 0;
+    float radius = 0.0f;           // quantized; corner centers sit this far in
+    std::vector<DFPoint> outer;    // 4 * (segments + 1) offsets
+    std::vector<DFPoint> inner;    // rings only, same layout as outer
+
+    size_t pointCount() const { return outer.size(); }
+
+    // Writes pointCount() outline points of rect (the inner edge for rings).
+    void trace(const DFRect& rect, bool innerEdge, DFPoint* out) const
+    {
+        const std::vector<DFPoint>& offsets = innerEdge ? inner : outer;
+        const size_t perCorner = static_cast<size_t>(segments) + 1;
+        const DFPoint centers[4] = {
+            {rect.x + radius, rect.y + radius},
+            {rect.x + rect.width - radius, rect.y + radius},
+            {rect.x + rect.width - radius, rect.y + rect.height - radius},
+            {rect.x + radius, rect.y + rect.height - radius},
+        };
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            const DFPoint& center = centers[i / perCorner];
+            out[i] = {center.x + offsets[i].x, center.y + offsets[i].y};
+        }
+    }
+};
+
+// Tables are keyed by radius and stroke thickness rounded down to a quarter
+// pixel, built on first use and kept for the process. References stay valid.
+// Not synchronized: use it from the thread that renders.
+class DFCornerTessellation {
+public:
+    static constexpr int kMaxSegments = 64;
+
+    static DFCornerTessellation& instance();
+
+    // Filled corners of radius.
+    const DFCornerTable& fill(float radius);
+    // Stroke of thickness centered on radius: outer offsets at radius + t / 2,
+    // inner ones at radius - t / 2 (at least 0).
+    const DFCornerTable& ring(float radius, float thickness);
+
+    static float Quantize(float value);
+    size_t tableCount() const { return tables_.size(); }
+
+private:
+    DFCornerTessellation() = default;
+
+    std::unordered_map<uint32_t, DFCornerTable> tables_;
+};
@@ -0,0 +1,267 @@
+#include "counting_canvas.h"
+
+#include "corner_tessellation.h"
+#include "display_list_canvas.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace {
+
+using Counts = CountingCanvas::Counts;
+
+constexpr float kPi = 3.14159265358979323846f;
+
+Counts RectCost(const DFRect& rect)
+{
+    return {1, 6, 0, static_cast<double>(std::max(0.0f, rect.width) * std::max(0.0f, rect.height))};
+}
+
+float CornerRadius(const DFRect& rect, float radius)
+{
+    return std::clamp(radius, 0.0f, std::min(rect.width, rect.height) * 0.5f);
+}
+
+Counts RoundedCost(const DFRect& rect, float radius)
+{
+    const float r = CornerRadius(rect, radius);
+    if (r <= 0.01f) {
+        return RectCost(rect);
+    }
+    Counts cost = RectCost(rect);
+    cost.vertices = (DFCornerTessellation::instance().fill(r).pointCount() - 2) * 3;
+    cost.pixelArea -= static_cast<double>((4.0f - kPi) * r * r);
+    return cost;
+}
+
+Counts OutlineCost(const DFRect& rect, float radius, float thickness)
+{
+    const float r = CornerRadius(rect, radius);
+    const float t = std::max(0.5f, thickness);
+    const float perimeter = 2.0f * (rect.width + rect.height) - (8.0f - 2.0f * kPi) * r;
+    Counts cost{1, 24, 0, static_cast<double>(std::max(0.0f, perimeter) * t)};
+    if (r > 0.01f) {
+        cost.vertices = DFCornerTessellation::instance().ring(r, t).pointCount() * 6;
+    }
+    return cost;
+}
+
+Counts LineCost(const DFPoint& a, const DFPoint& b, float thickness)
+{
+    const float length = std::hypot(b.x - a.x, b.y - a.y);
+    return {1, 6, 0, static_cast<double>(length * std::max(1.0f, thickness))};
+}
+
+Counts PolygonCost(const DFPoint* points, size_t count)
+{
+    double twiceArea = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        const DFPoint& a = points[i];
+        const DFPoint& b = points[(i + 1) % count];
+        twiceArea += static_cast<double>(a.x) * b.y - static_cast<double>(b.x) * a.y;
+    }
+    return {1, (count - 2) * 3, 0, std::fabs(twiceArea) * 0.5};
+}
+
+// DX12Canvas draws text as one quad per glyph atlas rect.
+Counts GlyphCost(std::string_view text, float scaleMul)
+{
+    const DFGlyphAtlas& atlas = DFGlyphAtlas::instance();
+    const float px = DFTextPixelScale() * std::clamp(scaleMul, 0.2f, 4.0f);
+    Counts cost{1, 0, text.size(), 0.0};
+    for (char ch : text) {
+        const int glyph = DFGlyphAtlas::glyphIndex(ch);
+        const DFGlyphRect* rects = atlas.rects(glyph);
+        for (int i = 0; i < atlas.rectCount(glyph); ++i) {
+            cost.vertices += 6;
+            cost.pixelArea += static_cast<double>(rects[i].width * rects[i].height) * px * px;
+        }
+    }
+    return cost;
+}
+
+DFRect GlyphBounds(float x, float y, std::string_view text, float scaleMul)
+{
+    return {x, y, DFGlyphAdvancePx(scaleMul) * static_cast<float>(text.size()), DFGlyphHeightPx(scaleMul)};
+}
+
+} // namespace
+
+void CountingCanvas::drawRectangle(const DFRect& rect, const DFColor& color)
+{
+    DFRect clipped = rect;
+    if (rect.width > 0.0f && rect.height > 0.0f && cullRect(clipped)) {
+        count(RectCost(clipped));
+    }
+    target_.drawRectangle(rect, color);
+}
+
+void CountingCanvas::drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color)
+{
+    if (rect.width > 0.0f && rect.height > 0.0f && !isClippedOut(rect)) {
+        count(RoundedCost(rect, radius));
+    }
+    target_.drawRoundedRectangle(rect, radius, color);
+}
+
+void CountingCanvas::drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness)
+{
+    if (rect.width > 0.0f && rect.height > 0.0f && thickness > 0.0f && !isClippedOut(rect)) {
+        count(OutlineCost(rect, radius, thickness));
+    }
+    target_.drawRoundedRectangleOutline(rect, radius, color, thickness);
+}
+
+void CountingCanvas::drawLine(const DFPoint& from, const DFPoint& to, const DFColor& color, float thickness)
+{
+    DFPoint a = from;
+    DFPoint b = to;
+    if (cullLine(a, b, thickness)) {
+        count(LineCost(a, b, thickness));
+    }
+    target_.drawLine(from, to, color, thickness);
+}
+
+void CountingCanvas::drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color)
+{
+    if (count >= 3 && !isClippedOut(DFPointsBounds(points, count))) {
+        this->count(PolygonCost(points, count));
+    }
+    target_.drawConvexPolygon(points, count, color);
+}
+
+void CountingCanvas::drawText(float x, float y, const std::string& text, const DFColor& color)
+{
+    if (!text.empty() && !isClippedOut(GlyphBounds(x, y, text, 1.0f))) {
+        count(GlyphCost(text, 1.0f));
+    }
+    target_.drawText(x, y, text, color);
+}
+
+void CountingCanvas::drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul, bool smooth)
+{
+    if (!text.empty() && !isClippedOut(GlyphBounds(x, y, text, scaleMul))) {
+        count(GlyphCost(text, scaleMul));
+    }
+    target_.drawGlyphRun(x, y, text, color, scaleMul, smooth);
+}
+
+void CountingCanvas::setClipRect(const DFRect& rect)
+{
+    Canvas::setClipRect(rect);
+    target_.setClipRect(rect);
+}
+
+void CountingCanvas::clearClipRect()
+{
+    Canvas::clearClipRect();
+    target_.clearClipRect();
+}
+
+bool CountingCanvas::appendRecorded(const DisplayListCanvas& list, const DFRect& bounds)
+{
+    if (!target_.appendRecorded(list, bounds)) {
+        return false;
+    }
+    using Op = DisplayListCanvas::Op;
+    for (const DisplayListCanvas::Command& command : list.commands()) {
+        const DFRect rect{command.x, command.y, command.w, command.h};
+        switch (command.op) {
+        case Op::Rectangle:
+            count(RectCost(rect));
+            break;
+        case Op::RoundedRectangle:
+            count(RoundedCost(rect, command.radius));
+            break;
+        case Op::RoundedRectangleOutline:
+            count(OutlineCost(rect, command.radius, command.thickness));
+            break;
+        case Op::Line:
+            count(LineCost({command.x, command.y}, {command.w, command.h}, command.thickness));
+            break;
+        case Op::ConvexPolygon:
+            count(PolygonCost(list.pointsOf(command), command.textLength));
+            break;
+        case Op::Text:
+            count(GlyphCost(list.textOf(command), 1.0f));
+            break;
+        case Op::GlyphRun:
+            count(GlyphCost(list.textOf(command), command.radius));
+            break;
+        case Op::ClipRect:
+        case Op::ClearClip:
+        case Op::Count:
+            break;
+        }
+    }
+    return true;
+}
+
+void CountingCanvas::pushScope(DFCanvasScope scope)
+{
+    scopes_.push_back(scope);
+    target_.pushScope(scope);
+}
+
+void CountingCanvas::popScope()
+{
+    if (!scopes_.empty()) {
+        scopes_.pop_back();
+    }
+    target_.popScope();
+}
+
+void CountingCanvas::beginFrame()
+{
+    counts_.fill({});
+    scopes_.clear();
+}
+
+CountingCanvas::Counts CountingCanvas::total() const
+{
+    Counts sum;
+    for (const Counts& scope : counts_) {
+        sum.add(scope);
+    }
+    return sum;
+}
+
+void CountingCanvas::count(const Counts& cost)
+{
+    counts_[static_cast<size_t>(currentScope())].add(cost);
+}
+
+std::string CountingCanvas::json() const
+{
+    std::ostringstream out;
+    auto write = [&out](const Counts& counts) {
+        out << "{\"primitives\": " << counts.primitives << ", \"vertices\": " << counts.vertices
+            << ", \"pixels\": " << static_cast<uint64_t>(std::llround(std::max(0.0, counts.pixelArea)))
+            << ", \"text_chars\": " << counts.textChars << "}";
+    };
+    out << "{\"total\": ";
+    write(total());
+    out << ", \"scopes\": {";
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        out << (i > 0 ? ", " : "") << "\"" << ScopeName(static_cast<DFCanvasScope>(i)) << "\": ";
+        write(counts_[i]);
+    }
+    out << "}}";
+    return out.str();
+}
+
+const char* CountingCanvas::ScopeName(DFCanvasScope scope)
+{
+    switch (scope) {
+    case DFCanvasScope::Other: return "other";
+    case DFCanvasScope::DockRenderer: return "dock_renderer";
+    case DFCanvasScope::DockSplitter: return "dock_splitter";
+    case DFCanvasScope::WindowManager: return "window_manager";
+    case DFCanvasScope::DragOverlay: return "drag_overlay";
+    case DFCanvasScope::WidgetContent: return "widget_content";
+    case DFCanvasScope::DebugOverlay: return "debug_overlay";
+    case DFCanvasScope::Count: break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core_types.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Forwards every call to a target canvas while tallying what each subsystem
+// submits: primitives, estimated vertices, covered pixel area and text
+// characters. Counts go to the innermost DFCanvasScope pushed on this canvas.
+// Vertex estimates follow the DX12Canvas tessellation (two triangles per
+// quad, corner tables for rounded shapes, atlas rects for text), so they
+// predict the upload that MAX_VERTICES caps. Draws that miss the clip are not
+// counted.
+class CountingCanvas : public Canvas {
+public:
+    struct Counts {
+        uint64_t primitives = 0;
+        uint64_t vertices = 0;
+        uint64_t textChars = 0;
+        double pixelArea = 0.0;
+
+        void add(const Counts& other)
+        {
+            primitives += other.primitives;
+            vertices += other.vertices;
+            textChars += other.textChars;
+            pixelArea += other.pixelArea;
+        }
+    };
+
+    explicit CountingCanvas(Canvas& target) : target_(target) {}
+
+    void drawRectangle(const DFRect& rect, const DFColor& color) override;
+    void drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color) override;
+    void drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness = 1.0f) override;
+    void drawLine(const DFPoint& a, const DFPoint& b, const DFColor& color, float thickness = 1.0f) override;
+    void drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color) override;
+    void drawText(float x, float y, const std::string& text, const DFColor& color) override;
+    void drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul = 1.0f, bool smooth = false) override;
+    void setClipRect(const DFRect& rect) override;
+    void clearClipRect() override;
+    // Counts the list's commands when the target takes it in one step.
+    bool appendRecorded(const DisplayListCanvas& list, const DFRect& bounds) override;
+    void pushScope(DFCanvasScope scope) override;
+    void popScope() override;
+
+    // Clears the counts and any unbalanced scopes.
+    void beginFrame();
+    const Counts& counts(DFCanvasScope scope) const { return counts_[static_cast<size_t>(scope)]; }
+    Counts total() const;
+    DFCanvasScope currentScope() const { return scopes_.empty() ? DFCanvasScope::Other : scopes_.back(); }
+
+    // {"total": {...}, "scopes": {"dock_renderer": {...}, ...}} on one line.
+    std::string json() const;
+    static const char* ScopeName(DFCanvasScope scope);
+
+private:
+    void count(const Counts& cost);
+
+    Canvas& target_;
+    std::array<Counts, static_cast<size_t>(DFCanvasScope::Count)> counts_{};
+    std::vector<DFCanvasScope> scopes_;
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core_types.h"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+// Damaged screen rectangles accumulated between frames. Rects are snapped
+// outward to whole pixels with a 1px margin for antialiased edges. Overlapping
+// rects are merged, and when the set is full the pair that grows least is
+// merged, so a frame never needs more than kMaxRects scissored passes.
+class DFDamageRegion {
+public:
+    static constexpr size_t kMaxRects = 8;
+
+    void add(const DFRect& rect)
+    {
+        if (!(rect.width > 0.0f) || !(rect.height > 0.0f)) {
+            return;
+        }
+        DFRect pending = Snap(rect);
+        for (;;) {
+            absorbOverlaps(pending);
+            if (count_ < kMaxRects) {
+                break;
+            }
+            size_t best = 0;
+            float bestGrowth = std::numeric_limits<float>::max();
+            for (size_t i = 0; i < count_; ++i) {
+                const float growth = Area(DFRectUnion(rects_[i], pending)) - Area(rects_[i]) - Area(pending);
+                if (growth < bestGrowth) {
+                    bestGrowth = growth;
+                    best = i;
+                }
+            }
+            pending = DFRectUnion(rects_[best], pending);
+            rects_[best] = rects_[--count_];
+        }
+        rects_[count_++] = pending;
+    }
+
+    void add(const DFDamageRegion& other)
+    {
+        for (const DFRect& rect : other) {
+            add(rect);
+        }
+    }
+
+    void clear() { count_ = 0; }
+    bool empty() const { return count_ == 0; }
+    size_t size() const { return count_; }
+    const DFRect* begin() const { return rects_.data(); }
+    const DFRect* end() const { return rects_.data() + count_; }
+    const DFRect& operator[](size_t index) const { return rects_[index]; }
+
+    DFRect bounds() const
+    {
+        if (count_ == 0) {
+            return {};
+        }
+        DFRect out = rects_[0];
+        for (size_t i = 1; i < count_; ++i) {
+            out = DFRectUnion(out, rects_[i]);
+        }
+        return out;
+    }
+
+    // Sum of rect areas; rects never overlap, so this is the repainted area.
+    float area() const
+    {
+        float total = 0.0f;
+        for (size_t i = 0; i < count_; ++i) {
+            total += Area(rects_[i]);
+        }
+        return total;
+    }
+
+    bool intersects(const DFRect& rect) const
+    {
+        for (size_t i = 0; i < count_; ++i) {
+            if (DFRectsOverlap(rects_[i], rect)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static float Area(const DFRect& rect) { return rect.width * rect.height; }
+
+    static DFRect Snap(const DFRect& rect)
+    {
+        const float x0 = std::floor(rect.x) - 1.0f;
+        const float y0 = std::floor(rect.y) - 1.0f;
+        const float x1 = std::ceil(rect.x + rect.width) + 1.0f;
+        const float y1 = std::ceil(rect.y + rect.height) + 1.0f;
+        return {x0, y0, x1 - x0, y1 - y0};
+    }
+
+    // Folds every stored rect that overlaps pending into it; the union can
+    // reach rects the original did not, so scan again after each merge.
+    void absorbOverlaps(DFRect& pending)
+    {
+        for (size_t i = 0; i < count_;) {
+            if (DFRectsOverlap(rects_[i], pending)) {
+                pending = DFRectUnion(rects_[i], pending);
+                rects_[i] = rects_[--count_];
+                i = 0;
+                continue;
+            }
+            ++i;
+        }
+    }
+
+    std::array<DFRect, kMaxRects> rects_{};
+    size_t count_ = 0;
+};
@@ -0,0 +1,372 @@
+#include "display_list_canvas.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+static_assert(sizeof(DisplayListCanvas::Command) == 10 * 4, "Command must stay padding-free for hashing");
+
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+// Commands are hashed a 4-byte field at a time; every field is 4 bytes wide.
+uint64_t HashWords(uint64_t hash, const DisplayListCanvas::Command& command)
+{
+    uint32_t words[sizeof(DisplayListCanvas::Command) / 4];
+    std::memcpy(words, &command, sizeof(words));
+    for (uint32_t word : words) {
+        hash ^= word;
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+uint64_t HashPoints(uint64_t hash, const DFPoint* points, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t words[2];
+        std::memcpy(words, &points[i], sizeof(words));
+        hash = ((hash ^ words[0]) * kFnvPrime ^ words[1]) * kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace
+
+void DisplayListCanvas::drawRectangle(const DFRect& rect, const DFColor& color)
+{
+    DFRect clipped = rect;
+    if (!cullRect(clipped)) {
+        return;
+    }
+    Command command;
+    command.op = Op::Rectangle;
+    command.x = clipped.x;
+    command.y = clipped.y;
+    command.w = clipped.width;
+    command.h = clipped.height;
+    command.color = DFPackColor(color);
+    record(command);
+}
+
+void DisplayListCanvas::drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color)
+{
+    if (isClippedOut(rect)) {
+        return;
+    }
+    Command command;
+    command.op = Op::RoundedRectangle;
+    command.x = rect.x;
+    command.y = rect.y;
+    command.w = rect.width;
+    command.h = rect.height;
+    command.radius = radius;
+    command.color = DFPackColor(color);
+    record(command);
+}
+
+void DisplayListCanvas::drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness)
+{
+    if (isClippedOut(rect)) {
+        return;
+    }
+    Command command;
+    command.op = Op::RoundedRectangleOutline;
+    command.x = rect.x;
+    command.y = rect.y;
+    command.w = rect.width;
+    command.h = rect.height;
+    command.radius = radius;
+    command.thickness = thickness;
+    command.color = DFPackColor(color);
+    record(command);
+}
+
+void DisplayListCanvas::drawLine(const DFPoint& from, const DFPoint& to, const DFColor& color, float thickness)
+{
+    DFPoint a = from;
+    DFPoint b = to;
+    if (!cullLine(a, b, thickness)) {
+        return;
+    }
+    Command command;
+    command.op = Op::Line;
+    command.x = a.x;
+    command.y = a.y;
+    command.w = b.x;
+    command.h = b.y;
+    command.thickness = thickness;
+    command.color = DFPackColor(color);
+    record(command);
+}
+
+void DisplayListCanvas::drawText(float x, float y, const std::string& text, const DFColor& color)
+{
+    if (text.empty()) {
+        return;
+    }
+    Command command;
+    command.op = Op::Text;
+    command.x = x;
+    command.y = y;
+    command.color = DFPackColor(color);
+    recordText(command, text);
+}
+
+void DisplayListCanvas::drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul, bool smooth)
+{
+    if (text.empty()) {
+        return;
+    }
+    Command command;
+    command.op = Op::GlyphRun;
+    command.x = x;
+    command.y = y;
+    command.radius = scaleMul;
+    command.thickness = smooth ? 1.0f : 0.0f;
+    command.color = DFPackColor(color);
+    recordText(command, text);
+}
+
+void DisplayListCanvas::drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color)
+{
+    const DFRect bounds = DFPointsBounds(points, count);
+    if (count < 3 || isClippedOut(bounds)) {
+        return;
+    }
+    Command command;
+    command.op = Op::ConvexPolygon;
+    command.x = bounds.x;
+    command.y = bounds.y;
+    command.w = bounds.width;
+    command.h = bounds.height;
+    command.color = DFPackColor(color);
+    command.textOffset = static_cast<uint32_t>(points_.size());
+    command.textLength = static_cast<uint32_t>(count);
+    points_.insert(points_.end(), points, points + count);
+    hash_ = HashPoints(hash_, points, count);
+    record(command);
+}
+
+void DisplayListCanvas::setClipRect(const DFRect& rect)
+{
+    Canvas::setClipRect(rect);
+    Command command;
+    command.op = Op::ClipRect;
+    command.x = rect.x;
+    command.y = rect.y;
+    command.w = rect.width;
+    command.h = rect.height;
+    record(command);
+}
+
+void DisplayListCanvas::clearClipRect()
+{
+    Canvas::clearClipRect();
+    Command command;
+    command.op = Op::ClearClip;
+    record(command);
+}
+
+bool DisplayListCanvas::appendRecorded(const DisplayListCanvas& list, const DFRect& bounds)
+{
+    if (list.count(Op::ClipRect) > 0 || list.count(Op::ClearClip) > 0) {
+        return false;
+    }
+    if (hasClipRect()) {
+        constexpr float kMargin = 2.0f;
+        const DFRect& clip = clipRect();
+        if (bounds.x - kMargin < clip.x || bounds.y - kMargin < clip.y ||
+            bounds.x + bounds.width + kMargin > clip.x + clip.width ||
+            bounds.y + bounds.height + kMargin > clip.y + clip.height) {
+            return false;
+        }
+    }
+    const uint32_t textBase = static_cast<uint32_t>(text_.size());
+    const uint32_t pointBase = static_cast<uint32_t>(points_.size());
+    commands_.reserve(commands_.size() + list.commands_.size());
+    for (Command command : list.commands_) {
+        if (command.op == Op::Text || command.op == Op::GlyphRun) {
+            hash_ = HashBytes(hash_, list.text_.data() + command.textOffset, command.textLength);
+            command.textOffset += textBase;
+        } else if (command.op == Op::ConvexPolygon) {
+            hash_ = HashPoints(hash_, list.points_.data() + command.textOffset, command.textLength);
+            command.textOffset += pointBase;
+        }
+        record(command);
+    }
+    text_.insert(text_.end(), list.text_.begin(), list.text_.end());
+    points_.insert(points_.end(), list.points_.begin(), list.points_.end());
+    return true;
+}
+
+void DisplayListCanvas::recordText(Command& command, std::string_view text)
+{
+    command.textLength = static_cast<uint32_t>(text.size());
+    if (isClippedOut(Bounds(command))) {
+        return;
+    }
+    command.textOffset = static_cast<uint32_t>(text_.size());
+    text_.insert(text_.end(), text.begin(), text.end());
+    // Text is hashed by content; the arena offset alone says nothing about it.
+    hash_ = HashBytes(hash_, text.data(), text.size());
+    record(command);
+}
+
+void DisplayListCanvas::record(const Command& command)
+{
+    hash_ = HashWords(hash_, command);
+    commands_.push_back(command);
+    ++counts_[static_cast<size_t>(command.op)];
+}
+
+void DisplayListCanvas::reset()
+{
+    commands_.clear();
+    text_.clear();
+    points_.clear();
+    counts_.fill(0);
+    hash_ = kHashSeed;
+    Canvas::clearClipRect();
+    dropClipStack();
+}
+
+std::string_view DisplayListCanvas::textOf(const Command& command) const
+{
+    if (command.op != Op::Text && command.op != Op::GlyphRun) {
+        return {};
+    }
+    return std::string_view(text_.data() + command.textOffset, command.textLength);
+}
+
+const DFPoint* DisplayListCanvas::pointsOf(const Command& command) const
+{
+    return command.op == Op::ConvexPolygon ? points_.data() + command.textOffset : nullptr;
+}
+
+DFRect DisplayListCanvas::Bounds(const Command& command)
+{
+    switch (command.op) {
+    case Op::ConvexPolygon:
+    case Op::Rectangle:
+    case Op::RoundedRectangle:
+    case Op::RoundedRectangleOutline:
+        return {command.x, command.y, command.w, command.h};
+    case Op::Line: {
+        const float pad = std::max(1.0f, command.thickness);
+        const float x0 = std::min(command.x, command.w) - pad;
+        const float y0 = std::min(command.y, command.h) - pad;
+        return {x0, y0, std::max(command.x, command.w) + pad - x0, std::max(command.y, command.h) + pad - y0};
+    }
+    case Op::Text:
+    case Op::GlyphRun: {
+        const float scale = (command.op == Op::GlyphRun) ? command.radius : 1.0f;
+        return {
+            command.x,
+            command.y,
+            DFGlyphAdvancePx(scale) * static_cast<float>(command.textLength),
+            DFGlyphHeightPx(scale)
+        };
+    }
+    case Op::ClipRect:
+    case Op::ClearClip:
+    case Op::Count:
+        break;
+    }
+    return {};
+}
+
+void DisplayListCanvas::replay(Canvas& target) const
+{
+    std::string scratch;
+    for (const Command& command : commands_) {
+        replayCommand(target, command, scratch);
+    }
+}
+
+void DisplayListCanvas::replay(Canvas& target, const DFRect& clip) const
+{
+    std::string scratch;
+    target.setClipRect(clip);
+    for (const Command& command : commands_) {
+        if (command.op == Op::ClipRect) {
+            target.setClipRect(DFRectIntersection(clip, {command.x, command.y, command.w, command.h}));
+        } else if (command.op == Op::ClearClip) {
+            target.setClipRect(clip);
+        } else if (!target.isClippedOut(Bounds(command))) {
+            replayCommand(target, command, scratch);
+        }
+    }
+    target.clearClipRect();
+}
+
+void DisplayListCanvas::replayCommand(Canvas& target, const Command& command, std::string& scratch) const
+{
+    const DFColor color = DFUnpackColor(command.color);
+    switch (command.op) {
+    case Op::Rectangle:
+        target.drawRectangle({command.x, command.y, command.w, command.h}, color);
+        break;
+    case Op::RoundedRectangle:
+        target.drawRoundedRectangle({command.x, command.y, command.w, command.h}, command.radius, color);
+        break;
+    case Op::RoundedRectangleOutline:
+        target.drawRoundedRectangleOutline(
+            {command.x, command.y, command.w, command.h}, command.radius, color, command.thickness);
+        break;
+    case Op::Line:
+        target.drawLine({command.x, command.y}, {command.w, command.h}, color, command.thickness);
+        break;
+    case Op::Text:
+        scratch.assign(text_.data() + command.textOffset, command.textLength);
+        target.drawText(command.x, command.y, scratch, color);
+        break;
+    case Op::GlyphRun:
+        target.drawGlyphRun(
+            command.x,
+            command.y,
+            std::string_view(text_.data() + command.textOffset, command.textLength),
+            color,
+            command.radius,
+            command.thickness != 0.0f);
+        break;
+    case Op::ConvexPolygon:
+        target.drawConvexPolygon(points_.data() + command.textOffset, command.textLength, color);
+        break;
+    case Op::ClipRect:
+        target.setClipRect({command.x, command.y, command.w, command.h});
+        break;
+    case Op::ClearClip:
+        target.clearClipRect();
+        break;
+    case Op::Count:
+        break;
+    }
+}
+
+const char* DisplayListCanvas::OpName(Op op)
+{
+    switch (op) {
+    case Op::Rectangle: return "rect";
+    case Op::RoundedRectangle: return "rounded_rect";
+    case Op::RoundedRectangleOutline: return "rounded_outline";
+    case Op::Line: return "line";
+    case Op::Text: return "text";
+    case Op::GlyphRun: return "glyph_run";
+    case Op::ConvexPolygon: return "convex_polygon";
+    case Op::ClipRect: return "clip_rect";
+    case Op::ClearClip: return "clear_clip";
+    case Op::Count: break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "core_types.h"
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Records Canvas calls into a flat POD command buffer. The stream can be
+// replayed into any other Canvas, and an FNV-1a hash is folded in as commands
+// are recorded so two frames can be compared without walking either stream.
+// Draws that miss the active clip are dropped at record time.
+class DisplayListCanvas : public Canvas {
+public:
+    enum class Op : uint32_t {
+        Rectangle,
+        RoundedRectangle,
+        RoundedRectangleOutline,
+        Line,
+        Text,
+        GlyphRun,
+        ConvexPolygon,
+        ClipRect,
+        ClearClip,
+        Count
+    };
+
+    // All fields are 4 bytes wide so the struct has no padding and can be hashed
+    // byte-for-byte. Rects use x/y/w/h; lines store the end point in w/h;
+    // glyph runs store scaleMul in radius and the smooth flag in thickness;
+    // polygons store their bounds in x/y/w/h and their points in the point
+    // arena at textOffset/textLength. Colors are recorded packed, so replay
+    // draws them rounded to 8 bits per channel.
+    struct Command {
+        Op op = Op::Rectangle;
+        float x = 0.0f;
+        float y = 0.0f;
+        float w = 0.0f;
+        float h = 0.0f;
+        float radius = 0.0f;
+        float thickness = 0.0f;
+        DFPackedColor color;
+        uint32_t textOffset = 0;
+        uint32_t textLength = 0;
+    };
+
+    void drawRectangle(const DFRect& rect, const DFColor& color) override;
+    void drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color) override;
+    void drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness = 1.0f) override;
+    void drawLine(const DFPoint& a, const DFPoint& b, const DFColor& color, float thickness = 1.0f) override;
+    void drawText(float x, float y, const std::string& text, const DFColor& color) override;
+    void drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul = 1.0f, bool smooth = false) override;
+    void drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color) override;
+    void setClipRect(const DFRect& rect) override;
+    void clearClipRect() override;
+    // Appends list as if its draws were made here (same commands and hash)
+    // when list has no clip commands and the active clip, if any, holds
+    // bounds grown by the cull margin.
+    bool appendRecorded(const DisplayListCanvas& list, const DFRect& bounds) override;
+
+    // Drops recorded commands but keeps buffer capacity for the next frame.
+    void reset();
+    void replay(Canvas& target) const;
+    // Replays under a scissor, skipping commands whose bounds miss the clip.
+    // Recorded clips are intersected with it.
+    void replay(Canvas& target, const DFRect& clip) const;
+
+    // Conservative pixel bounds of a draw command (empty for clip commands).
+    static DFRect Bounds(const Command& command);
+
+    uint64_t hash() const { return hash_; }
+    size_t commandCount() const { return commands_.size(); }
+    size_t count(Op op) const { return counts_[static_cast<size_t>(op)]; }
+    const std::vector<Command>& commands() const { return commands_; }
+    // Views into the arenas; valid until the next record or reset().
+    std::string_view textOf(const Command& command) const;
+    const DFPoint* pointsOf(const Command& command) const;
+
+    static const char* OpName(Op op);
+
+private:
+    void record(const Command& command);
+    void recordText(Command& command, std::string_view text);
+    void replayCommand(Canvas& target, const Command& command, std::string& scratch) const;
+
+    std::vector<Command> commands_;
+    std::vector<char> text_;
+    std::vector<DFPoint> points_;
+    std::array<size_t, static_cast<size_t>(Op::Count)> counts_{};
+    uint64_t hash_ = kHashSeed;
+
+    static constexpr uint64_t kHashSeed = 14695981039346656037ull;
+};
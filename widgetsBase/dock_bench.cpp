@@ -0,0 +1,1330 @@
+// Headless replay of the dx12_demo automation scenarios against
+// dock_framework + dock_components. Events go through the demo's dispatch
+// order and every event is followed by a frame (layout refresh plus a render
+// recorded into a DisplayListCanvas), so the numbers cover layout,
+// hit-testing and draw generation without a GPU or window. high_rate_drag
+// instead queues mouse-rate input through df::InputCoalescer and renders
+// once per batch, as the demo's message loop does.
+//
+// Usage: dock_bench [--scenario NAME]... [--iterations N] [--frames N] [--json PATH]
+//                   [--record PATH] [--replay PATH [--realtime]]
+// Prints one JSON report; the exit code is non-zero when a scenario's layout
+// checks fail. --record writes the first iteration of the one selected
+// scenario as an input recording (input_recording.h); --replay plays a
+// recording, from here or from DX12Demo's DF_RECORD_INPUT, into a fresh host
+// as the "replay" scenario and fails on any layout checksum mismatch.
+
+#include "counting_canvas.h"
+#include "display_list_canvas.h"
+#include "dock_framework.h"
+#include "dock_layout.h"
+#include "dock_renderer.h"
+#include "dock_splitter.h"
+#include "dock_widget_impl.h"
+#include "event_router.h"
+#include "input_coalescer.h"
+#include "input_queue.h"
+#include "input_recording.h"
+#include "latency_tracker.h"
+#include "window_manager.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The replaced operator new/delete go through out-of-line helpers: once GCC
+// inlines both into a caller it pairs free() with operator new and warns
+// (-Wmismatched-new-delete).
+#if defined(__GNUC__)
+#define DF_BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define DF_BENCH_NOINLINE __declspec(noinline)
+#else
+#define DF_BENCH_NOINLINE
+#endif
+
+namespace {
+
+uint64_t gAllocations = 0;
+uint64_t gAllocatedBytes = 0;
+
+DF_BENCH_NOINLINE void* CountedAllocate(std::size_t size)
+{
+    ++gAllocations;
+    gAllocatedBytes += size;
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+DF_BENCH_NOINLINE void CountedRelease(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+} // namespace
+
+// The whole replaceable family (C++17 aligned forms aside) goes through the
+// counter, so every allocation is released by its own counterpart; the
+// runtime's nothrow or array forms would otherwise pair with these deletes.
+void* operator new(std::size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return CountedAllocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return CountedAllocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {
+        return CountedAllocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    CountedRelease(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    CountedRelease(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    CountedRelease(ptr);
+}
+
+namespace {
+
+constexpr float kViewportWidth = 1280.0f;
+constexpr float kViewportHeight = 720.0f;
+constexpr float kTitleBarHeight = df::BasicDockWidget::TITLE_BAR_HEIGHT;
+constexpr int kKeyEscape = 0x1B; // VK_ESCAPE
+
+float SafeClamp(float value, float lo, float hi)
+{
+    return (hi < lo) ? lo : std::clamp(value, lo, hi);
+}
+
+double Percentile(std::vector<double> values, double p)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const size_t index = static_cast<size_t>(std::ceil(p * static_cast<double>(values.size()))) - 1;
+    return values[std::min(index, values.size() - 1)];
+}
+
+// Stand-in for panel content: a few rows of rects and text so frames
+// generate a realistic command count.
+class PanelContent final : public Widget {
+public:
+    explicit PanelContent(std::string label) : label_(std::move(label)) {}
+
+    void paint(Canvas& canvas) override
+    {
+        const DFRect b = bounds();
+        constexpr float rowHeight = 18.0f;
+        for (int row = 0; row < 16 && (row + 1) * rowHeight <= b.height; ++row) {
+            const float y = b.y + static_cast<float>(row) * rowHeight;
+            if (row % 2 == 0) {
+                canvas.drawRectangle({b.x, y, b.width, rowHeight}, {0.16f, 0.17f, 0.19f, 1.0f});
+            }
+            canvas.drawText(b.x + 6.0f, y + 4.0f, label_, {0.8f, 0.8f, 0.8f, 1.0f});
+        }
+    }
+
+private:
+    std::string label_;
+};
+
+// Mirrors DX12Demo's widget set, layout and processEvent routing.
+class BenchHost {
+public:
+    BenchHost()
+    {
+        const char* titles[] = {"Hierarchy", "Viewport", "Inspector", "Console", "Profiler", "Assets", "Timeline"};
+        for (const char* title : titles) {
+            auto widget = std::make_unique<df::BasicDockWidget>(title);
+            widget->setContent(std::make_unique<PanelContent>(title));
+            df::DockManager::instance().registerWidget(widget.get());
+            widgets_.push_back(std::move(widget));
+        }
+        df::DockWidget* hierarchy = widgets_[0].get();
+        df::DockWidget* viewport = widgets_[1].get();
+        df::DockWidget* inspector = widgets_[2].get();
+        df::DockWidget* console = widgets_[3].get();
+        df::DockWidget* profiler = widgets_[4].get();
+        df::DockWidget* assets = widgets_[5].get();
+        df::DockWidget* timeline = widgets_[6].get();
+
+        hierarchy->setMinimumSize(250.0f, 220.0f);
+        viewport->setMinimumSize(520.0f, 320.0f);
+        inspector->setMinimumSize(290.0f, 220.0f);
+        console->setMinimumSize(280.0f, 200.0f);
+        profiler->setMinimumSize(300.0f, 220.0f);
+        assets->setMinimumSize(280.0f, 220.0f);
+        timeline->setMinimumSize(300.0f, 190.0f);
+
+        using Node = df::DockLayout::Node;
+        auto leaf = [](df::DockWidget* widget) {
+            auto node = std::make_unique<Node>();
+            node->type = Node::Type::Widget;
+            node->widget = widget;
+            return node;
+        };
+        auto root = std::make_unique<Node>();
+        root->type = Node::Type::Split;
+        root->vertical = true;
+        root->ratio = 0.22f;
+        root->splitSizing = Node::SplitSizing::FixedFirst;
+        root->fixedSize = 280.0f;
+        root->minFirstSize = 220.0f;
+        root->minSecondSize = 360.0f;
+        root->first = leaf(hierarchy);
+        root->second = std::make_unique<Node>();
+        root->second->type = Node::Type::Split;
+        root->second->vertical = false;
+        root->second->ratio = 0.70f;
+        root->second->splitSizing = Node::SplitSizing::FixedSecond;
+        root->second->fixedSize = 250.0f;
+        root->second->minFirstSize = 220.0f;
+        root->second->minSecondSize = 180.0f;
+        root->second->first = leaf(viewport);
+        root->second->second = std::make_unique<Node>();
+        root->second->second->type = Node::Type::Tab;
+        root->second->second->children.push_back(leaf(inspector));
+        root->second->second->children.push_back(leaf(console));
+        root->second->second->children.push_back(leaf(timeline));
+        root->second->second->children.push_back(leaf(assets));
+        layout_.setRoot(std::move(root));
+
+        floatingWindow_ = df::WindowManager::instance().createFloatingWindow(profiler, {780.0f, 120.0f, 340.0f, 230.0f});
+        refresh();
+        // A fresh session: undo must not reach a previous host's layout.
+        df::DockManager::instance().clearHistory();
+        layout_.resetStats();
+        renderer_.resetStats();
+    }
+
+    ~BenchHost()
+    {
+        clearActiveAction();
+        df::WindowManager::instance().destroyAllWindows();
+        for (const auto& widget : widgets_) {
+            df::DockManager::instance().unregisterWidget(widget.get());
+        }
+        df::DockManager::instance().setMainLayout(nullptr, {});
+    }
+
+    BenchHost(const BenchHost&) = delete;
+    BenchHost& operator=(const BenchHost&) = delete;
+
+    df::DockWidget* widget(size_t index) const { return widgets_[index].get(); }
+    const std::vector<std::unique_ptr<df::BasicDockWidget>>& widgets() const { return widgets_; }
+    df::DockLayout& layout() { return layout_; }
+    const df::DockRenderer& renderer() const { return renderer_; }
+    df::DockSplitter& splitter() { return splitter_; }
+    float width() const { return width_; }
+    float height() const { return height_; }
+    const std::string& lastHandler() const { return lastHandler_; }
+
+    void refresh()
+    {
+        const DFRect client = clientRect();
+        df::DockManager::instance().setMainLayout(&layout_, client);
+        layout_.update(client);
+        splitter_.updateSplitters(layout_.root(), client);
+        df::DockManager::instance().setDragBounds(client);
+        df::WindowManager::instance().setWorkArea({0.0f, 0.0f, width_, height_});
+    }
+
+    // Resizing invalidates in-flight gestures, as in DX12Demo::handleResize.
+    void setSize(float width, float height)
+    {
+        width_ = width;
+        height_ = height;
+        clearActiveAction();
+        if (recorder_) {
+            recorder_->resize(width, height, DFInputClockSeconds());
+        }
+    }
+
+    void resize(float width, float height)
+    {
+        setSize(width, height);
+        frame();
+    }
+
+    // Records every dispatched event, resize and frame from here on, with a
+    // layout checksum after each frame.
+    void record(df::InputRecorder* recorder)
+    {
+        recorder_ = recorder;
+        if (recorder_) {
+            recorder_->resize(width_, height_, DFInputClockSeconds());
+        }
+    }
+
+    void clearActiveAction() { router_.cancel(); }
+
+    // Dispatches one pointer event and renders the frame that follows it.
+    void inject(Event::Type type, float x, float y)
+    {
+        Event event(type);
+        event.x = x;
+        event.y = y;
+        DFStampInput(event);
+        dispatch(event);
+        frame();
+    }
+
+    // Sends one key press through shortcut() and renders the frame after it.
+    // Queued pointer input is dispatched first, as DX12Demo::handleKeyMessage
+    // does, so keys never overtake earlier clicks.
+    void key(int key, uint32_t modifiers = 0)
+    {
+        input_.drain([this](Event& event) { dispatch(event); });
+        Event event(Event::Type::KeyDown);
+        event.key = key;
+        event.modifiers = modifiers;
+        DFStampInput(event);
+        shortcut(event);
+        frame();
+    }
+
+    // Queues a pointer event the way a high-rate mouse delivers it. Nothing
+    // runs until pump().
+    void queue(Event::Type type, float x, float y)
+    {
+        Event event(type);
+        event.x = x;
+        event.y = y;
+        DFStampInput(event);
+        push(event);
+    }
+
+    void push(const Event& event) { input_.push(event); }
+
+    // Dispatches what the queue holds after coalescing, then renders one
+    // frame, as DX12Demo::run does once per message-loop pass.
+    void pump()
+    {
+        input_.drain([this](Event& event) { dispatch(event); });
+        frame();
+    }
+
+    const df::InputCoalescer& input() const { return input_; }
+    const df::LatencyTracker& latency() const { return latency_; }
+
+    // Restores a saved layout state, timed like an event.
+    bool restore(const std::string& state)
+    {
+        clearActiveAction();
+        const auto start = std::chrono::steady_clock::now();
+        const bool restored = df::DockManager::instance().restoreState(state);
+        eventMs.push_back(ElapsedMs(start));
+        ++handlerCounts["restore_state"];
+        frame();
+        return restored;
+    }
+
+    // The frame "presents" once its commands are recorded; latency runs from
+    // each input's stamp to that point.
+    void frame()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        latency_.beginFrame();
+        refresh();
+        canvas_.reset();
+        counting_.beginFrame();
+        renderer_.render(counting_, layout_.root());
+        splitter_.render(counting_);
+        df::WindowManager::instance().renderAllWindows(counting_);
+        latency_.presented(DFInputClockSeconds());
+        frameMs.push_back(ElapsedMs(start));
+        if (recorder_) {
+            recorder_->frame(DFInputClockSeconds());
+            if (recorder_->checkpointDue()) {
+                recorder_->checkpoint(df::DockLayoutChecksum(layout_, df::WindowManager::instance()));
+            }
+        }
+        commandCount += canvas_.commandCount();
+        for (size_t i = 0; i < canvasCounts.size(); ++i) {
+            canvasCounts[i].add(counting_.counts(static_cast<DFCanvasScope>(i)));
+        }
+    }
+
+    // Closing or docking may leave the root empty; an empty layout is valid.
+    int validateLayout(const char* label)
+    {
+        int failures = 0;
+        const DFRect view{0.0f, 0.0f, width_, height_};
+        auto fail = [&](const char* what, const DFRect& b) {
+            std::cerr << "[FAIL] " << label << " " << what << " node=(" << b.x << "," << b.y << ","
+                      << b.width << "," << b.height << ")\n";
+            ++failures;
+        };
+        std::function<void(const df::DockLayout::Node*, const DFRect*)> visit =
+            [&](const df::DockLayout::Node* node, const DFRect* parent) {
+                if (!node) {
+                    return;
+                }
+                const DFRect& b = node->bounds;
+                if (!std::isfinite(b.x) || !std::isfinite(b.y) || !std::isfinite(b.width) || !std::isfinite(b.height)) {
+                    fail("non-finite bounds", b);
+                    return;
+                }
+                if (b.width < -0.5f || b.height < -0.5f) {
+                    fail("negative size", b);
+                }
+                if (b.x < view.x - 1.0f || b.y < view.y - 1.0f ||
+                    b.x + b.width > view.x + view.width + 1.0f || b.y + b.height > view.y + view.height + 1.0f) {
+                    fail("out of viewport", b);
+                }
+                if (parent && (b.width > 1.0f || b.height > 1.0f) &&
+                    (b.x < parent->x - 2.0f || b.y < parent->y - 2.0f ||
+                     b.x + b.width > parent->x + parent->width + 2.0f ||
+                     b.y + b.height > parent->y + parent->height + 2.0f)) {
+                    fail("escapes parent", b);
+                }
+                if (node->type == df::DockLayout::Node::Type::Split && node->first && node->second) {
+                    const float total = node->vertical ? b.width : b.height;
+                    const float first = node->vertical ? node->first->bounds.width : node->first->bounds.height;
+                    const float second = node->vertical ? node->second->bounds.width : node->second->bounds.height;
+                    if (std::fabs(first + second - total) > 2.5f) {
+                        fail("split size mismatch", b);
+                    }
+                }
+                visit(node->first.get(), &b);
+                visit(node->second.get(), &b);
+                for (const auto& child : node->children) {
+                    visit(child.get(), &b);
+                }
+            };
+        visit(layout_.root(), nullptr);
+        return failures;
+    }
+
+    // First docked widget whose title bar is not under a floating window.
+    df::DockWidget* pickDockedWidget() const
+    {
+        for (const auto& widget : widgets_) {
+            if (widget->isFloating()) {
+                continue;
+            }
+            const DFRect b = widget->bounds();
+            if (b.width <= 16.0f || b.height <= 16.0f) {
+                continue;
+            }
+            if (!df::WindowManager::instance().findWindowAtPoint(grabPoint(widget.get()))) {
+                return widget.get();
+            }
+        }
+        return nullptr;
+    }
+
+    // Where a user grabs a docked widget to drag it: its tab header when it is
+    // tabbed (every docked widget is, once the layout wraps leaves in tabs),
+    // otherwise its title bar.
+    static DFPoint grabPoint(const df::DockWidget* widget)
+    {
+        const df::DockLayout::Node* leaf = df::DockLayout::Resolve(widget->layoutNode());
+        const df::DockLayout::Node* tab = leaf ? leaf->parent : nullptr;
+        if (tab && tab->type == df::DockLayout::Node::Type::Tab) {
+            for (size_t i = 0; i < tab->children.size(); ++i) {
+                if (tab->children[i].get() == leaf) {
+                    const DFRect r = df::DockLayout::TabRectForIndex(*tab, tab->bounds, i, tab->children.size());
+                    return {r.x + r.width * 0.5f, r.y + r.height * 0.5f};
+                }
+            }
+        }
+        const DFRect b = widget->bounds();
+        return {
+            b.x + SafeClamp(50.0f, 10.0f, b.width - 10.0f),
+            b.y + SafeClamp(10.0f, 5.0f, kTitleBarHeight - 2.0f)
+        };
+    }
+
+    std::vector<double> eventMs;
+    std::vector<double> frameMs;
+    std::map<std::string, int> handlerCounts;
+    uint64_t commandCount = 0;
+    std::array<CountingCanvas::Counts, static_cast<size_t>(DFCanvasScope::Count)> canvasCounts{};
+
+    // Routes one event without rendering a frame.
+    void dispatch(Event& event)
+    {
+        if (recorder_) {
+            recorder_->event(event);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const df::EventRouter::Route route = router_.dispatch(event);
+        eventMs.push_back(ElapsedMs(start));
+        lastHandler_ = df::EventRouter::HandlerName(route.handler);
+        ++handlerCounts[lastHandler_];
+        latency_.dispatched(event, df::LatencyTracker::Classify(route.handler));
+        // Track the window Ctrl+W closes the way the demo does.
+        using Handler = df::EventRouter::Handler;
+        if ((route.handler == Handler::FloatingClose && route.window == floatingWindow_) ||
+            (route.handler == Handler::FloatingDrag && event.type == Event::Type::MouseUp &&
+             floatingWindow_ && !df::WindowManager::instance().hasWindow(floatingWindow_))) {
+            floatingWindow_ = nullptr;
+        }
+    }
+
+    // The layout shortcuts of DX12Demo::handleShortcutKey (with its tab UI
+    // off), so recorded sessions that use them replay: Esc cancels the active
+    // interaction, Ctrl+W closes the demo's floating window, Ctrl+Z undoes and
+    // Ctrl+Y or Ctrl+Shift+Z redoes.
+    void shortcut(Event& event)
+    {
+        if (recorder_) {
+            recorder_->event(event);
+        }
+        if (event.type != Event::Type::KeyDown) {
+            return;
+        }
+        const bool ctrlDown = event.has(Event::Modifier::Control);
+        const auto start = std::chrono::steady_clock::now();
+        const char* handler = nullptr;
+        if (event.key == kKeyEscape) {
+            clearActiveAction();
+            handler = "key:cancel";
+        } else if (ctrlDown && event.key == 'W' && floatingWindow_) {
+            df::WindowManager::instance().destroyWindow(floatingWindow_);
+            floatingWindow_ = nullptr;
+            clearActiveAction();
+            handler = "key:window_close";
+        } else if (ctrlDown && (event.key == 'Z' || event.key == 'Y')) {
+            const bool redo = event.key == 'Y' || event.has(Event::Modifier::Shift);
+            const df::DockWidget* floatingContent = floatingWindow_ ? floatingWindow_->content() : nullptr;
+            clearActiveAction();
+            auto& mgr = df::DockManager::instance();
+            if (redo ? mgr.redo() : mgr.undo()) {
+                floatingWindow_ = floatingContent ? df::WindowManager::instance().findWindowByContent(floatingContent) : nullptr;
+                handler = redo ? "key:redo" : "key:undo";
+            }
+        }
+        if (!handler) {
+            return;
+        }
+        event.handled = true;
+        eventMs.push_back(ElapsedMs(start));
+        lastHandler_ = handler;
+        ++handlerCounts[lastHandler_];
+    }
+
+private:
+    static double ElapsedMs(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    DFRect clientRect() const
+    {
+        // ComputeMainClientRect with the default theme padding.
+        constexpr float pad = 2.0f;
+        return {pad, pad, std::max(0.0f, width_ - pad * 2.0f), std::max(0.0f, height_ - pad * 2.0f)};
+    }
+
+    std::vector<std::unique_ptr<df::BasicDockWidget>> widgets_;
+    df::DockLayout layout_;
+    df::DockSplitter splitter_;
+    df::DockRenderer renderer_;
+    DisplayListCanvas canvas_;
+    CountingCanvas counting_{canvas_};
+    df::EventRouter router_{layout_, splitter_};
+    df::InputCoalescer input_;
+    df::LatencyTracker latency_;
+    df::InputRecorder* recorder_ = nullptr;
+    df::WindowFrame* floatingWindow_ = nullptr; // DX12Demo::floatingWindow_
+    std::string lastHandler_ = "none";
+    float width_ = kViewportWidth;
+    float height_ = kViewportHeight;
+};
+
+// ---- Scenarios (ported from DX12Demo::runEventAutomation) ----
+
+int SplitterDrag(BenchHost& host, float moveX)
+{
+    const DFRect left = host.widget(0)->bounds();
+    if (!host.layout().root() || host.widget(0)->isFloating()) {
+        return 0;
+    }
+    const float x = left.x + left.width;
+    const float y = SafeClamp(left.y + 120.0f, left.y + 30.0f, left.y + left.height - 30.0f);
+    host.inject(Event::Type::MouseDown, x, y);
+    if (host.lastHandler() != "splitter") {
+        return 0;
+    }
+    host.inject(Event::Type::MouseMove, moveX, y);
+    host.inject(Event::Type::MouseUp, moveX, y);
+    return host.splitter().isDragging() ? 1 : 0;
+}
+
+void WidgetDrag(BenchHost& host, float moveX, float moveY)
+{
+    const DFPoint start = BenchHost::grabPoint(host.widget(0));
+    host.inject(Event::Type::MouseDown, start.x, start.y);
+    host.inject(Event::Type::MouseMove, moveX, moveY);
+    host.inject(Event::Type::MouseUp, moveX, moveY);
+}
+
+int RunSplitterStress(BenchHost& host)
+{
+    int failures = 0;
+    for (int i = 0; i < 8; ++i) {
+        const float step = (i % 2 == 0) ? 30.0f : -20.0f;
+        const DFRect left = host.widget(0)->bounds();
+        failures += SplitterDrag(host, left.x + left.width + step);
+        failures += host.validateLayout("splitter_stress");
+    }
+    return failures;
+}
+
+int RunWidgetDragStress(BenchHost& host)
+{
+    int failures = 0;
+    for (int i = 0; i < 8; ++i) {
+        const DFRect current = host.widget(0)->bounds();
+        WidgetDrag(host, current.x + 35.0f + static_cast<float>(i * 6), current.y + 18.0f + static_cast<float>(i * 2));
+        failures += host.validateLayout("widget_drag_stress");
+    }
+    return failures;
+}
+
+int RunResizeStress(BenchHost& host)
+{
+    int failures = 0;
+    const float baseW = host.width();
+    const float baseH = host.height();
+    for (int i = 0; i < 4; ++i) {
+        // Resize, drag a docked title bar, restore.
+        host.resize(std::max(640.0f, baseW - 220.0f), std::max(420.0f, baseH - 180.0f));
+        failures += host.validateLayout("resize_sync");
+        if (df::DockWidget* target = host.pickDockedWidget()) {
+            const DFPoint start = BenchHost::grabPoint(target);
+            host.inject(Event::Type::MouseDown, start.x, start.y);
+            host.inject(Event::Type::MouseMove, start.x + 25.0f, start.y + 15.0f);
+            host.inject(Event::Type::MouseUp, start.x + 25.0f, start.y + 15.0f);
+        }
+        host.resize(baseW, baseH);
+        failures += host.validateLayout("resize_sync_restore");
+
+        // Resize in the middle of a drag; the gesture must be dropped.
+        if (df::DockWidget* target = host.pickDockedWidget()) {
+            const DFPoint start = BenchHost::grabPoint(target);
+            host.inject(Event::Type::MouseDown, start.x, start.y);
+            host.resize(std::max(640.0f, baseW - 180.0f), std::max(420.0f, baseH - 140.0f));
+            failures += host.validateLayout("resize_action");
+            if (df::DockManager::instance().isDragging() || host.splitter().isDragging() ||
+                df::WindowManager::instance().hasDraggingWindow()) {
+                std::cerr << "[FAIL] resize during action left stale drag state\n";
+                ++failures;
+            }
+            host.resize(baseW, baseH);
+            failures += host.validateLayout("resize_action_restore");
+        }
+    }
+    return failures;
+}
+
+int RunRecursiveConstraintsStress(BenchHost& host)
+{
+    int failures = 0;
+    uint32_t seed = 424242u;
+    auto nextUnit = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed & 0x00FFFFFFu) / 16777215.0f;
+    };
+    const float baseW = host.width();
+    const float baseH = host.height();
+
+    for (int i = 0; i < 24; ++i) {
+        const float widthScale = (i % 5 == 0) ? (0.42f + 0.12f * nextUnit()) : (0.62f + 0.36f * nextUnit());
+        const float heightScale = 0.56f + 0.40f * nextUnit();
+        host.resize(std::max(420.0f, std::floor(baseW * widthScale)), std::max(320.0f, std::floor(baseH * heightScale)));
+        failures += host.validateLayout("recursive_constraints_resize");
+
+        // Click a random tab through the tab-header path.
+        std::vector<df::DockLayout::Node*> tabs;
+        std::vector<df::DockLayout::Node*> splits;
+        std::function<void(df::DockLayout::Node*)> collect = [&](df::DockLayout::Node* node) {
+            if (!node) {
+                return;
+            }
+            if (node->type == df::DockLayout::Node::Type::Tab && node->children.size() > 1) {
+                tabs.push_back(node);
+            }
+            if (node->type == df::DockLayout::Node::Type::Split) {
+                splits.push_back(node);
+            }
+            collect(node->first.get());
+            collect(node->second.get());
+            for (auto& child : node->children) {
+                collect(child.get());
+            }
+        };
+        collect(host.layout().root());
+        if (!tabs.empty()) {
+            df::DockLayout::Node* tab = tabs[static_cast<size_t>(nextUnit() * tabs.size()) % tabs.size()];
+            const size_t index = static_cast<size_t>(nextUnit() * tab->children.size()) % tab->children.size();
+            const DFRect rect = df::DockLayout::TabRectForIndex(*tab, tab->bounds, index, tab->children.size());
+            if (rect.width > 1.0f && rect.height > 1.0f) {
+                const float tx = rect.x + rect.width * 0.5f;
+                const float ty = rect.y + rect.height * 0.5f;
+                host.inject(Event::Type::MouseDown, tx, ty);
+                host.inject(Event::Type::MouseUp, tx, ty);
+                failures += host.validateLayout("recursive_constraints_tab");
+            }
+        }
+
+        // Random drag on a random split seam.
+        splits.clear();
+        tabs.clear();
+        collect(host.layout().root());
+        if (splits.empty()) {
+            continue;
+        }
+        df::DockLayout::Node* split = splits[static_cast<size_t>(nextUnit() * splits.size()) % splits.size()];
+        const DFRect b = split->bounds;
+        float downX = 0.0f;
+        float downY = 0.0f;
+        float moveX = 0.0f;
+        float moveY = 0.0f;
+        if (split->vertical) {
+            downX = split->first ? split->first->bounds.x + split->first->bounds.width : b.x + b.width * 0.5f;
+            const float lowY = b.y + std::min(32.0f, std::max(4.0f, b.height * 0.25f));
+            downY = SafeClamp(b.y + b.height * (0.10f + 0.80f * nextUnit()), lowY, b.y + std::max(4.0f, b.height - 4.0f));
+            moveX = b.x + b.width * (0.02f + 0.96f * nextUnit());
+            moveY = downY;
+        } else {
+            downY = split->first ? split->first->bounds.y + split->first->bounds.height : b.y + b.height * 0.5f;
+            const float lowX = b.x + std::min(32.0f, std::max(4.0f, b.width * 0.25f));
+            downX = SafeClamp(b.x + b.width * (0.10f + 0.80f * nextUnit()), lowX, b.x + std::max(4.0f, b.width - 4.0f));
+            moveX = downX;
+            moveY = b.y + b.height * (0.02f + 0.96f * nextUnit());
+        }
+        const df::DockSplitter::Splitter* hit = host.splitter().splitterAtPoint({downX, downY});
+        if (!hit || hit->node != split) {
+            continue;
+        }
+        host.inject(Event::Type::MouseDown, downX, downY);
+        host.inject(Event::Type::MouseMove, moveX, moveY);
+        host.inject(Event::Type::MouseUp, moveX, moveY);
+        failures += host.validateLayout("recursive_constraints_split");
+    }
+
+    host.resize(baseW, baseH);
+    failures += host.validateLayout("recursive_constraints_restore");
+    return failures;
+}
+
+int RunCloseAll(BenchHost& host)
+{
+    int failures = 0;
+    host.clearActiveAction();
+    host.layout().beginBatch();
+    for (const auto& widget : host.widgets()) {
+        df::DockManager::instance().closeWidget(widget.get());
+    }
+    host.layout().commit();
+    host.frame();
+
+    if (host.layout().root() != nullptr) {
+        std::cerr << "[FAIL] close_all root not cleared\n";
+        ++failures;
+    }
+    const DFPoint probe{host.width() * 0.5f, host.height() * 0.5f};
+    if (host.splitter().splitterAtPoint(probe) != nullptr) {
+        std::cerr << "[FAIL] close_all splitter hit remains\n";
+        ++failures;
+    }
+    host.inject(Event::Type::MouseMove, probe.x, probe.y);
+    if (host.lastHandler() == "splitter") {
+        std::cerr << "[FAIL] close_all dispatch still routed to splitter\n";
+        ++failures;
+    }
+    for (const auto& widget : host.widgets()) {
+        const DFRect b = widget->bounds();
+        if (!widget->isFloating() && b.width > 1.0f && b.height > 1.0f) {
+            std::cerr << "[FAIL] close_all visible docked widget remains: " << widget->title() << "\n";
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+int RunHostTransferStress(BenchHost& host)
+{
+    int failures = 0;
+    auto dockTargetPoint = [&host](const df::DockWidget* exclude) -> DFPoint {
+        for (const auto& candidate : host.widgets()) {
+            if (candidate.get() == exclude || candidate->isFloating()) {
+                continue;
+            }
+            const DFRect b = candidate->bounds();
+            if (b.width > 16.0f && b.height > 16.0f) {
+                return {
+                    SafeClamp(b.x + b.width * 0.5f, 8.0f, host.width() - 8.0f),
+                    SafeClamp(b.y + std::min(12.0f, std::max(1.0f, b.height * 0.5f)), 8.0f, host.height() - 8.0f)
+                };
+            }
+        }
+        return {host.width() * 0.5f, 12.0f};
+    };
+    // Drag a floating window's title bar to target and release.
+    auto dragWindow = [&host](df::DockWidget* widget, const DFPoint& target) {
+        df::WindowFrame* win = df::WindowManager::instance().findWindowByContent(widget);
+        if (!win) {
+            return;
+        }
+        const DFRect wb = win->bounds();
+        host.inject(Event::Type::MouseDown, wb.x + 18.0f, wb.y + 10.0f);
+        host.inject(Event::Type::MouseMove, target.x, target.y);
+        host.inject(Event::Type::MouseUp, target.x, target.y);
+    };
+    auto redock = [&](df::DockWidget* widget, const char* tag) {
+        dragWindow(widget, dockTargetPoint(widget));
+        if (widget->isFloating()) {
+            // Center drop missed; retry on the left edge like the demo.
+            dragWindow(widget, {std::max(0.5f, host.width() * 0.001f), host.height() * 0.5f});
+        }
+        if (widget->isFloating() || widget->hostType() != df::DockWidget::HostType::DockedLayout) {
+            std::cerr << "[FAIL] " << tag << " redock failed\n";
+            ++failures;
+        }
+    };
+
+    df::DockWidget* hierarchy = host.widget(0);
+    const DFPoint title = BenchHost::grabPoint(hierarchy);
+    const DFPoint away{title.x + 160.0f, SafeClamp(title.y + 80.0f, 0.0f, host.height())};
+    host.inject(Event::Type::MouseDown, title.x, title.y);
+    host.inject(Event::Type::MouseMove, away.x, away.y);
+    host.inject(Event::Type::MouseUp, away.x, away.y);
+    if (!hierarchy->isFloating() || hierarchy->hostType() != df::DockWidget::HostType::FloatingWindow) {
+        std::cerr << "[FAIL] host_transfer undock failed\n";
+        ++failures;
+    } else {
+        redock(hierarchy, "host_transfer_hierarchy");
+    }
+    failures += host.validateLayout("host_transfer_hierarchy");
+
+    df::DockWidget* profiler = host.widget(4);
+    if (profiler->isFloating()) {
+        redock(profiler, "host_transfer_profiler");
+    }
+    failures += host.validateLayout("host_transfer_profiler");
+    return failures;
+}
+
+int RunStateRoundTrip(BenchHost& host)
+{
+    int failures = 0;
+    const std::string saved = df::DockManager::instance().saveState();
+    for (int round = 0; round < 20; ++round) {
+        host.layout().beginBatch();
+        for (const auto& widget : host.widgets()) {
+            df::DockManager::instance().closeWidget(widget.get());
+        }
+        host.layout().commit();
+        host.frame();
+        if (!host.restore(saved)) {
+            std::cerr << "[FAIL] state_round_trip restore rejected\n";
+            return failures + 1;
+        }
+    }
+    if (df::DockManager::instance().saveState() != saved) {
+        std::cerr << "[FAIL] state_round_trip state changed after restore\n";
+        ++failures;
+    }
+    failures += host.validateLayout("state_round_trip");
+    return failures;
+}
+
+// A 1000 Hz mouse at 60 fps: sixteen moves arrive between frames. Each frame
+// must dispatch one move that lands exactly where the last one pointed.
+int RunHighRateDrag(BenchHost& host)
+{
+    constexpr int kMovesPerFrame = 16;
+    constexpr int kFrames = 4;
+    int failures = 0;
+
+    const DFRect left = host.widget(0)->bounds();
+    const float seamX = left.x + left.width;
+    const float y = SafeClamp(left.y + 120.0f, left.y + 30.0f, left.y + left.height - 30.0f);
+    host.queue(Event::Type::MouseDown, seamX, y);
+    host.pump();
+    if (host.lastHandler() != "splitter") {
+        std::cerr << "[FAIL] high_rate_drag press missed the splitter\n";
+        return failures + 1;
+    }
+    float x = seamX;
+    for (int frame = 0; frame < kFrames; ++frame) {
+        for (int i = 0; i < kMovesPerFrame; ++i) {
+            x += 0.5f;
+            host.queue(Event::Type::MouseMove, x, y);
+        }
+        host.pump();
+    }
+    host.queue(Event::Type::MouseUp, x, y);
+    host.pump();
+    const DFRect moved = host.widget(0)->bounds();
+    if (std::fabs(moved.x + moved.width - x) > 2.0f) {
+        std::cerr << "[FAIL] high_rate_drag seam at " << moved.x + moved.width << ", pointer at " << x << "\n";
+        ++failures;
+    }
+    failures += host.validateLayout("high_rate_drag_splitter");
+
+    df::WindowFrame* window = df::WindowManager::instance().findWindowByContent(host.widget(4));
+    if (window) {
+        const DFRect before = window->bounds();
+        const DFPoint grab{before.x + 18.0f, before.y + 10.0f};
+        DFPoint p = grab;
+        host.queue(Event::Type::MouseDown, p.x, p.y);
+        for (int frame = 0; frame < kFrames; ++frame) {
+            for (int i = 0; i < kMovesPerFrame; ++i) {
+                p.x += 1.0f;
+                p.y += 0.5f;
+                host.queue(Event::Type::MouseMove, p.x, p.y);
+            }
+            host.pump();
+        }
+        host.queue(Event::Type::MouseUp, p.x, p.y);
+        host.pump();
+        const DFRect after = window->bounds();
+        if (std::fabs(after.x - before.x - (p.x - grab.x)) > 1.0f || std::fabs(after.y - before.y - (p.y - grab.y)) > 1.0f) {
+            std::cerr << "[FAIL] high_rate_drag window lagged the pointer\n";
+            ++failures;
+        }
+    }
+
+    const df::InputCoalescer::Stats& stats = host.input().stats();
+    if (stats.moves - stats.coalesced > static_cast<uint64_t>(2 * kFrames)) {
+        std::cerr << "[FAIL] high_rate_drag dispatched " << stats.moves - stats.coalesced << " moves\n";
+        ++failures;
+    }
+    return failures;
+}
+
+// Undo, redo, Esc and Ctrl+W as the demo binds them. Recorded, this covers
+// the key path of a replay.
+int RunLayoutShortcuts(BenchHost& host)
+{
+    constexpr uint32_t kCtrl = static_cast<uint32_t>(Event::Modifier::Control);
+    int failures = 0;
+    auto expect = [&failures](bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "[FAIL] layout_shortcuts " << what << "\n";
+            ++failures;
+        }
+    };
+    auto seam = [&host]() {
+        const DFRect left = host.widget(0)->bounds();
+        return left.x + left.width;
+    };
+
+    const float start = seam();
+    failures += SplitterDrag(host, start + 48.0f);
+    const float dragged = seam();
+    expect(std::fabs(dragged - start) > 8.0f, "splitter drag did not move the seam");
+    host.key('Z', kCtrl);
+    expect(std::fabs(seam() - start) < 0.5f, "Ctrl+Z did not undo the splitter drag");
+    host.key('Y', kCtrl);
+    expect(std::fabs(seam() - dragged) < 0.5f, "Ctrl+Y did not redo the splitter drag");
+
+    // Esc drops a drag in flight; the next move leaves the seam alone. The
+    // press and move are still queued when Esc arrives and must run first.
+    const DFRect left = host.widget(0)->bounds();
+    const float y = SafeClamp(left.y + 120.0f, left.y + 30.0f, left.y + left.height - 30.0f);
+    host.queue(Event::Type::MouseDown, dragged, y);
+    host.queue(Event::Type::MouseMove, dragged + 20.0f, y);
+    host.key(kKeyEscape);
+    host.inject(Event::Type::MouseMove, dragged + 60.0f, y);
+    host.inject(Event::Type::MouseUp, dragged + 60.0f, y);
+    expect(std::fabs(seam() - (dragged + 20.0f)) < 0.5f, "Esc overtook queued input or did not cancel the drag");
+
+    auto& windows = df::WindowManager::instance();
+    const size_t windowCount = windows.windowCount();
+    host.key('W', kCtrl);
+    expect(windows.windowCount() + 1 == windowCount && !host.widget(4)->isFloating(), "Ctrl+W did not close the floating window");
+    host.key('Z', kCtrl);
+    expect(windows.windowCount() == windowCount && windows.findWindowByContent(host.widget(4)),
+           "Ctrl+Z did not bring the floating window back");
+    return failures + host.validateLayout("layout_shortcuts");
+}
+
+// A platform thread pushes a splitter drag into an InputQueue as fast as it
+// can while this thread drains it at frame boundaries. Nothing may be lost or
+// reordered, and the seam must end under the last position.
+int RunThreadedInput(BenchHost& host)
+{
+    constexpr int kMoves = 2000;
+    const DFRect left = host.widget(0)->bounds();
+    const float seamX = left.x + left.width;
+    const float endX = seamX + 0.02f * static_cast<float>(kMoves);
+    const float y = SafeClamp(left.y + 120.0f, left.y + 30.0f, left.y + left.height - 30.0f);
+
+    df::InputQueue queue(256);
+    std::thread producer([&queue, seamX, endX, y]() {
+        auto send = [&queue](Event::Type type, float x, float y) {
+            Event event(type);
+            event.x = x;
+            event.y = y;
+            DFStampInput(event);
+            while (!queue.push(event)) {
+                std::this_thread::yield();
+            }
+        };
+        send(Event::Type::MouseDown, seamX, y);
+        for (int i = 1; i <= kMoves; ++i) {
+            send(Event::Type::MouseMove, seamX + 0.02f * static_cast<float>(i), y);
+        }
+        send(Event::Type::MouseUp, endX, y);
+    });
+
+    int failures = 0;
+    int received = 0;
+    uint64_t lastSequence = 0;
+    bool released = false;
+    while (!released) {
+        queue.drain([&](Event& event) {
+            if (event.sequence <= lastSequence) {
+                ++failures;
+            }
+            lastSequence = event.sequence;
+            released = released || event.type == Event::Type::MouseUp;
+            ++received;
+            host.push(event);
+        });
+        host.pump();
+    }
+    producer.join();
+
+    if (received != kMoves + 2) {
+        std::cerr << "[FAIL] threaded_input received " << received << " of " << kMoves + 2 << " events\n";
+        ++failures;
+    }
+    const DFRect moved = host.widget(0)->bounds();
+    if (std::fabs(moved.x + moved.width - endX) > 2.0f) {
+        std::cerr << "[FAIL] threaded_input seam at " << moved.x + moved.width << ", pointer at " << endX << "\n";
+        ++failures;
+    }
+    return failures + host.validateLayout("threaded_input");
+}
+
+// Set by --replay; RunReplay plays it into the host.
+const df::InputReplayer* gReplay = nullptr;
+df::InputReplayer::Pace gReplayPace = df::InputReplayer::Pace::Fast;
+
+int RunReplay(BenchHost& host)
+{
+    df::InputReplayer::Hooks hooks;
+    hooks.dispatch = [&host](Event& event) { host.dispatch(event); };
+    hooks.key = [&host](Event& event) { host.shortcut(event); };
+    hooks.resize = [&host](float width, float height) { host.setSize(width, height); };
+    hooks.frame = [&host]() { host.frame(); };
+    hooks.checksum = [&host]() { return df::DockLayoutChecksum(host.layout(), df::WindowManager::instance()); };
+    const df::InputReplayer::Result result = gReplay->run(hooks, gReplayPace);
+    if (result.mismatches > 0) {
+        std::cerr << "[FAIL] replay diverged at record " << result.firstMismatch << ": " << result.mismatches << " of "
+                  << result.checkpoints << " checkpoints differ\n";
+    }
+    return static_cast<int>(result.mismatches) + host.validateLayout("replay");
+}
+
+struct Scenario {
+    const char* name;
+    int (*run)(BenchHost&);
+};
+
+const Scenario kScenarios[] = {
+    {"splitter_stress", RunSplitterStress},
+    {"widget_drag_stress", RunWidgetDragStress},
+    {"resize_stress", RunResizeStress},
+    {"recursive_constraints_stress", RunRecursiveConstraintsStress},
+    {"close_all", RunCloseAll},
+    {"host_transfer_stress", RunHostTransferStress},
+    {"state_round_trip", RunStateRoundTrip},
+    {"high_rate_drag", RunHighRateDrag},
+    {"threaded_input", RunThreadedInput},
+    {"layout_shortcuts", RunLayoutShortcuts},
+};
+
+struct ScenarioResult {
+    std::string name;
+    int failures = 0;
+    std::vector<double> eventMs;
+    std::vector<double> frameMs;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t commands = 0;
+    std::array<CountingCanvas::Counts, static_cast<size_t>(DFCanvasScope::Count)> canvas{};
+    df::DockLayout::Stats layout;
+    df::DockRenderer::Stats renderer;
+    std::map<std::string, int> handlers;
+    df::InputCoalescer::Stats input;
+    df::LatencyTracker latency;
+};
+
+ScenarioResult RunScenario(const Scenario& scenario, int iterations, int idleFrames, df::InputRecorder* recorder = nullptr)
+{
+    ScenarioResult result;
+    result.name = scenario.name;
+    for (int i = 0; i < iterations; ++i) {
+        BenchHost host;
+        host.record(i == 0 ? recorder : nullptr);
+        const uint64_t allocationsBefore = gAllocations;
+        const uint64_t bytesBefore = gAllocatedBytes;
+        result.failures += scenario.run(host);
+        for (int frame = 0; frame < idleFrames; ++frame) {
+            host.frame();
+        }
+        result.allocations += gAllocations - allocationsBefore;
+        result.allocatedBytes += gAllocatedBytes - bytesBefore;
+
+        result.eventMs.insert(result.eventMs.end(), host.eventMs.begin(), host.eventMs.end());
+        result.frameMs.insert(result.frameMs.end(), host.frameMs.begin(), host.frameMs.end());
+        result.commands += host.commandCount;
+        for (size_t scope = 0; scope < result.canvas.size(); ++scope) {
+            result.canvas[scope].add(host.canvasCounts[scope]);
+        }
+        const df::DockLayout::Stats& stats = host.layout().stats();
+        result.layout.fullPasses += stats.fullPasses;
+        result.layout.nodesLaidOut += stats.nodesLaidOut;
+        result.layout.minSizeNodes += stats.minSizeNodes;
+        result.renderer.stripHits += host.renderer().stats().stripHits;
+        result.renderer.stripMisses += host.renderer().stats().stripMisses;
+        for (const auto& [handler, count] : host.handlerCounts) {
+            result.handlers[handler] += count;
+        }
+        result.input.moves += host.input().stats().moves;
+        result.input.coalesced += host.input().stats().coalesced;
+        result.input.delivered += host.input().stats().delivered;
+        result.latency.merge(host.latency());
+    }
+    return result;
+}
+
+void WriteTimings(std::ostream& out, const char* key, const std::vector<double>& ms)
+{
+    double sum = 0.0;
+    for (double value : ms) {
+        sum += value;
+    }
+    out << "      \"" << key << "\": {\"count\": " << ms.size()
+        << ", \"avg_ms\": " << (ms.empty() ? 0.0 : sum / static_cast<double>(ms.size()))
+        << ", \"p50_ms\": " << Percentile(ms, 0.50)
+        << ", \"p95_ms\": " << Percentile(ms, 0.95)
+        << ", \"p99_ms\": " << Percentile(ms, 0.99)
+        << ", \"max_ms\": " << (ms.empty() ? 0.0 : *std::max_element(ms.begin(), ms.end())) << "},\n";
+}
+
+// Per-frame averages for the total and every scope that drew anything.
+void WriteCanvasCounts(std::ostream& out, const ScenarioResult& r)
+{
+    const double frames = std::max<double>(1.0, static_cast<double>(r.frameMs.size()));
+    CountingCanvas::Counts total;
+    for (const CountingCanvas::Counts& counts : r.canvas) {
+        total.add(counts);
+    }
+    auto write = [&](const char* name, const CountingCanvas::Counts& counts) {
+        out << "\"" << name << "\": {\"primitives\": " << static_cast<double>(counts.primitives) / frames
+            << ", \"vertices\": " << static_cast<double>(counts.vertices) / frames
+            << ", \"pixels\": " << counts.pixelArea / frames
+            << ", \"text_chars\": " << static_cast<double>(counts.textChars) / frames << "}";
+    };
+    out << "      \"canvas_per_frame\": {";
+    write("total", total);
+    for (size_t i = 0; i < r.canvas.size(); ++i) {
+        if (r.canvas[i].primitives > 0) {
+            out << ", ";
+            write(CountingCanvas::ScopeName(static_cast<DFCanvasScope>(i)), r.canvas[i]);
+        }
+    }
+    out << "},\n";
+}
+
+void WriteReport(std::ostream& out, const std::vector<ScenarioResult>& results, int iterations, int idleFrames)
+{
+    out << std::fixed << std::setprecision(4);
+    out << "{\n";
+    out << "  \"benchmark\": \"dock_bench\",\n";
+    out << "  \"viewport\": [" << static_cast<int>(kViewportWidth) << ", " << static_cast<int>(kViewportHeight) << "],\n";
+    out << "  \"iterations\": " << iterations << ",\n";
+    out << "  \"idle_frames\": " << idleFrames << ",\n";
+    out << "  \"scenarios\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ScenarioResult& r = results[i];
+        const double perEvent = r.eventMs.empty() ? 0.0 : static_cast<double>(r.allocations) / static_cast<double>(r.eventMs.size());
+        out << "    {\n";
+        out << "      \"name\": \"" << r.name << "\",\n";
+        out << "      \"failures\": " << r.failures << ",\n";
+        WriteTimings(out, "events", r.eventMs);
+        WriteTimings(out, "frames", r.frameMs);
+        out << "      \"allocations\": {\"count\": " << r.allocations << ", \"bytes\": " << r.allocatedBytes
+            << ", \"per_event\": " << perEvent << "},\n";
+        out << "      \"nodes_visited\": {\"laid_out\": " << r.layout.nodesLaidOut
+            << ", \"min_size\": " << r.layout.minSizeNodes
+            << ", \"full_passes\": " << r.layout.fullPasses << "},\n";
+        out << "      \"tab_strips\": {\"cached\": " << r.renderer.stripHits << ", \"recorded\": " << r.renderer.stripMisses
+            << "},\n";
+        out << "      \"draw_commands\": " << r.commands << ",\n";
+        WriteCanvasCounts(out, r);
+        out << "      \"input\": {\"moves\": " << r.input.moves << ", \"coalesced\": " << r.input.coalesced
+            << ", \"delivered\": " << r.input.delivered << "},\n";
+        out << "      \"latency\": " << r.latency.json() << ",\n";
+        out << "      \"handlers\": {";
+        bool first = true;
+        for (const auto& [handler, count] : r.handlers) {
+            out << (first ? "" : ", ") << "\"" << handler << "\": " << count;
+            first = false;
+        }
+        out << "}\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int ParsePositive(const char* text, int fallback)
+{
+    const int value = std::atoi(text);
+    return value > 0 ? value : fallback;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // Drop-trace logging would dominate the timings; DF_DOCK_POPUP_TRACE=1 re-enables it.
+    if (!std::getenv("DF_DOCK_POPUP_TRACE")) {
+#ifdef _WIN32
+        _putenv_s("DF_DOCK_POPUP_TRACE", "0");
+#else
+        setenv("DF_DOCK_POPUP_TRACE", "0", 0);
+#endif
+    }
+
+    std::vector<std::string> selected;
+    int iterations = 3;
+    int idleFrames = 30;
+    std::string jsonPath;
+    std::string recordPath;
+    std::string replayPath;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--scenario" && hasValue) {
+            selected.push_back(argv[++i]);
+        } else if (arg == "--iterations" && hasValue) {
+            iterations = ParsePositive(argv[++i], iterations);
+        } else if (arg == "--frames" && hasValue) {
+            idleFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--realtime") {
+            gReplayPace = df::InputReplayer::Pace::RealTime;
+        } else {
+            std::cerr << "usage: dock_bench [--scenario NAME]... [--iterations N] [--frames N] [--json PATH]\n"
+                         "                  [--record PATH] [--replay PATH [--realtime]]\n";
+            return 2;
+        }
+    }
+    if (!recordPath.empty() && (selected.size() != 1 || !replayPath.empty())) {
+        std::cerr << "--record needs exactly one --scenario and no --replay\n";
+        return 2;
+    }
+
+    std::vector<ScenarioResult> results;
+    df::InputReplayer replayer;
+    if (!replayPath.empty()) {
+        std::string error;
+        if (!replayer.loadFile(replayPath, &error)) {
+            std::cerr << "cannot replay " << replayPath << ": " << error << "\n";
+            return 2;
+        }
+        gReplay = &replayer;
+        results.push_back(RunScenario({"replay", RunReplay}, iterations, 0));
+    }
+    df::InputRecorder recorder(1);
+    for (const Scenario& scenario : kScenarios) {
+        if (!replayPath.empty() ||
+            (!selected.empty() && std::find(selected.begin(), selected.end(), scenario.name) == selected.end())) {
+            continue;
+        }
+        results.push_back(RunScenario(scenario, iterations, idleFrames, recordPath.empty() ? nullptr : &recorder));
+    }
+    if (results.empty()) {
+        std::cerr << "no matching scenario\n";
+        return 2;
+    }
+    if (!recordPath.empty() && !recorder.saveFile(recordPath)) {
+        std::cerr << "cannot write " << recordPath << "\n";
+        return 2;
+    }
+
+    WriteReport(std::cout, results, iterations, idleFrames);
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        WriteReport(file, results, iterations, idleFrames);
+    }
+
+    int failures = 0;
+    for (const ScenarioResult& result : results) {
+        failures += result.failures;
+    }
+    return failures > 0 ? 1 : 0;
+}
@@ -15,6 +15,7 @@ public:
 
     void render(Canvas& canvas) {
         if (!visible_) return;
+        DFCanvasScopeGuard scope(canvas, DFCanvasScope::DragOverlay);
         const auto& theme = CurrentTheme();
         const DFColor edgeColor = theme.overlayAccent;
         const float edgeThickness = std::clamp(theme.clientAreaBorderThickness * 2.0f, 1.5f, 4.0f);
@@ -1,5 +1,7 @@
 #include "dock_framework.h"
 #include "dock_layout.h"
+#include "dock_snapshot.h"
+#include "dock_state.h"
 #include "dock_theme.h"
 #include "window_manager.h"
 #include "core_types.h"
@@ -11,6 +13,8 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
+#include <string_view>
+#include <unordered_map>
 
 namespace {
 
@@ -93,132 +97,6 @@ const char* NodePrimaryWidgetTitle(const Node* node)
     return "";
 }
 
-std::unique_ptr<Node>* FindNodeHandle(std::unique_ptr<Node>& node, Node* target)
-{
-    if (!node || !target) {
-        return nullptr;
-    }
-    if (node.get() == target) {
-        return &node;
-    }
-    if (auto* handle = FindNodeHandle(node->first, target)) {
-        return handle;
-    }
-    if (auto* handle = FindNodeHandle(node->second, target)) {
-        return handle;
-    }
-    for (auto& child : node->children) {
-        if (auto* handle = FindNodeHandle(child, target)) {
-            return handle;
-        }
-    }
-    return nullptr;
-}
-
-std::unique_ptr<Node>* FindParentTabHandle(std::unique_ptr<Node>& node, Node* target)
-{
-    if (!node || !target) {
-        return nullptr;
-    }
-
-    if (node->type == Node::Type::Tab) {
-        for (auto& child : node->children) {
-            if (child.get() == target) {
-                return &node;
-            }
-        }
-    }
-
-    if (auto* handle = FindParentTabHandle(node->first, target)) {
-        return handle;
-    }
-    if (auto* handle = FindParentTabHandle(node->second, target)) {
-        return handle;
-    }
-    for (auto& child : node->children) {
-        if (auto* handle = FindParentTabHandle(child, target)) {
-            return handle;
-        }
-    }
-    return nullptr;
-}
-
-void NormalizeNode(std::unique_ptr<Node>& node)
-{
-    if (!node) {
-        return;
-    }
-
-    if (node->type == Node::Type::Split) {
-        if (!node->first && !node->second) {
-            node.reset();
-            return;
-        }
-        if (!node->first && node->second) {
-            node = std::move(node->second);
-            NormalizeNode(node);
-            return;
-        }
-        if (node->first && !node->second) {
-            node = std::move(node->first);
-            NormalizeNode(node);
-            return;
-        }
-        return;
-    }
-
-    if (node->type == Node::Type::Tab) {
-        node->children.erase(
-            std::remove_if(node->children.begin(), node->children.end(),
-                           [](const std::unique_ptr<Node>& child) { return child == nullptr; }),
-            node->children.end());
-        if (node->children.empty()) {
-            node.reset();
-            return;
-        }
-        node->tabBarHeight = std::max(1.0f, node->tabBarHeight);
-        node->activeTab = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
-    }
-}
-
-bool RemoveWidgetNode(std::unique_ptr<Node>& node, df::DockWidget* target, std::unique_ptr<Node>& extracted)
-{
-    if (!node || !target) {
-        return false;
-    }
-
-    if (node->type == Node::Type::Widget && node->widget == target) {
-        extracted = std::move(node);
-        return true;
-    }
-
-    auto recurseChild = [&](std::unique_ptr<Node>& child) -> bool {
-        if (RemoveWidgetNode(child, target, extracted)) {
-            NormalizeNode(child);
-            return true;
-        }
-        return false;
-    };
-
-    if (recurseChild(node->first)) {
-        NormalizeNode(node);
-        return true;
-    }
-    if (recurseChild(node->second)) {
-        NormalizeNode(node);
-        return true;
-    }
-
-    for (auto& child : node->children) {
-        if (recurseChild(child)) {
-            NormalizeNode(node);
-            return true;
-        }
-    }
-
-    return false;
-}
-
 bool IsInTabDockCenterZone(const DFRect& bounds, const DFPoint& point)
 {
     const float insetX = std::clamp(bounds.width * 0.28f, 18.0f, 140.0f);
@@ -301,6 +179,48 @@ DFRect MakeRightEdgeTabHintRect(const DFRect& stripRect)
     };
 }
 
+DFRect ResolveNodeBoundsToRoot(const DFRect& nodeBounds, const DFRect* parentRootBounds)
+{
+    if (!parentRootBounds) {
+        return nodeBounds;
+    }
+
+    // Some call paths provide child-local bounds. Normalize to parent/root space
+    // so docking hints always render in the same coordinate system.
+    const float eps = 1.0f;
+    const bool fitsParentAsAbsolute =
+        nodeBounds.x >= parentRootBounds->x - eps &&
+        nodeBounds.y >= parentRootBounds->y - eps &&
+        nodeBounds.x + nodeBounds.width <= parentRootBounds->x + parentRootBounds->width + eps &&
+        nodeBounds.y + nodeBounds.height <= parentRootBounds->y + parentRootBounds->height + eps;
+    const bool fitsParentAsLocal =
+        nodeBounds.x >= -eps &&
+        nodeBounds.y >= -eps &&
+        nodeBounds.x + nodeBounds.width <= parentRootBounds->width + eps &&
+        nodeBounds.y + nodeBounds.height <= parentRootBounds->height + eps;
+
+    if (!fitsParentAsLocal) {
+        return nodeBounds;
+    }
+
+    const DFRect translated{
+        parentRootBounds->x + nodeBounds.x,
+        parentRootBounds->y + nodeBounds.y,
+        nodeBounds.width,
+        nodeBounds.height
+    };
+
+    if (!fitsParentAsAbsolute) {
+        return translated;
+    }
+
+    // Ambiguous case (near origin): pick the variant that better overlaps parent.
+    auto area = [](const DFRect& r) { return std::max(0.0f, r.width) * std::max(0.0f, r.height); };
+    const float rawOverlap = area(DFRectIntersection(nodeBounds, *parentRootBounds));
+    const float translatedOverlap = area(DFRectIntersection(translated, *parentRootBounds));
+    return (translatedOverlap > rawOverlap + 0.5f) ? translated : nodeBounds;
+}
+
 Node* FindBestWidgetNodeAtPoint(Node* node, const DFPoint& point, df::DockWidget* movingWidget, float& bestArea)
 {
     if (!node) {
@@ -368,47 +288,32 @@ df::DockWidget* FindWidgetInNode(Node* node)
     return nullptr;
 }
 
-df::DockWidget* FindTabAtPoint(Node* node, const DFPoint& pt)
+// Tab strips come from the layout's hit index; only the strip under the point
+// is walked tab by tab.
+df::DockWidget* FindTabAtPoint(const df::DockLayout& layout, const DFPoint& pt)
 {
-    if (!node) {
+    Node* node = layout.tabNodeAt(pt);
+    if (!node || node->children.empty()) {
         return nullptr;
     }
-
-    if (node->type == Node::Type::Tab && !node->children.empty()) {
-        const DFRect barRect = df::DockLayout::TabStripRect(*node, node->bounds);
-        if (barRect.width > 1.0f && barRect.height > 1.0f && barRect.contains(pt)) {
-            for (size_t i = 0; i < node->children.size(); ++i) {
-                const DFRect tabRect = df::DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
-                if (tabRect.width <= 1.0f || tabRect.height <= 1.0f || !tabRect.contains(pt)) {
-                    continue;
-                }
-                node->activeTab = static_cast<int>(i);
-                if (df::DockWidget* w = FindWidgetInNode(node->children[i].get())) {
-                    return w;
-                }
-                break;
-            }
-            if (df::DockWidget* w = FindWidgetInNode(node)) {
-                return w;
-            }
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        const DFRect tabRect = df::DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
+        if (tabRect.width <= 1.0f || tabRect.height <= 1.0f || !tabRect.contains(pt)) {
+            continue;
         }
-    }
-
-    if (df::DockWidget* w = FindTabAtPoint(node->first.get(), pt)) {
-        return w;
-    }
-    if (df::DockWidget* w = FindTabAtPoint(node->second.get(), pt)) {
-        return w;
-    }
-    for (auto& child : node->children) {
-        if (df::DockWidget* w = FindTabAtPoint(child.get(), pt)) {
+        if (node->activeTab != static_cast<int>(i)) {
+            node->activeTab = static_cast<int>(i);
+            df::DockLayout::MarkDirty(node);
+        }
+        if (df::DockWidget* w = FindWidgetInNode(node->children[i].get())) {
             return w;
         }
+        break;
     }
-    return nullptr;
+    return FindWidgetInNode(node);
 }
 
-const Node* FindNodeByWidget(const Node* node, const df::DockWidget* widget)
+const Node* SearchNodeByWidget(const Node* node, const df::DockWidget* widget)
 {
     if (!node || !widget) {
         return nullptr;
@@ -416,70 +321,37 @@ const Node* FindNodeByWidget(const Node* node, const df::DockWidget* widget)
     if (node->type == Node::Type::Widget && node->widget == widget) {
         return node;
     }
-    if (const Node* found = FindNodeByWidget(node->first.get(), widget)) {
+    if (const Node* found = SearchNodeByWidget(node->first.get(), widget)) {
         return found;
     }
-    if (const Node* found = FindNodeByWidget(node->second.get(), widget)) {
+    if (const Node* found = SearchNodeByWidget(node->second.get(), widget)) {
         return found;
     }
     for (const auto& child : node->children) {
-        if (const Node* found = FindNodeByWidget(child.get(), widget)) {
+        if (const Node* found = SearchNodeByWidget(child.get(), widget)) {
             return found;
         }
     }
     return nullptr;
 }
 
-const Node* FindParentNode(const Node* node, const Node* target)
+const Node* FindNodeByWidget(const Node* root, const df::DockWidget* widget)
 {
-    if (!node || !target) {
+    if (!root || !widget) {
         return nullptr;
     }
-    if ((node->first && node->first.get() == target) ||
-        (node->second && node->second.get() == target)) {
-        return node;
-    }
-    for (const auto& child : node->children) {
-        if (child.get() == target) {
-            return node;
+    const Node* leaf = df::DockLayout::Resolve(widget->layoutNode());
+    if (leaf && leaf->type == Node::Type::Widget && leaf->widget == widget) {
+        // Trust the link chain only if every step is still owned by its parent.
+        const Node* node = leaf;
+        while (node != root && df::DockLayout::ParentSlot(const_cast<Node*>(node))) {
+            node = node->parent;
         }
-    }
-
-    if (const Node* found = FindParentNode(node->first.get(), target)) {
-        return found;
-    }
-    if (const Node* found = FindParentNode(node->second.get(), target)) {
-        return found;
-    }
-    for (const auto& child : node->children) {
-        if (const Node* found = FindParentNode(child.get(), target)) {
-            return found;
-        }
-    }
-    return nullptr;
-}
-
-int FindNodeDepth(const Node* node, const Node* target, int depth = 0)
-{
-    if (!node || !target) {
-        return -1;
-    }
-    if (node == target) {
-        return depth;
-    }
-
-    if (const int d = FindNodeDepth(node->first.get(), target, depth + 1); d >= 0) {
-        return d;
-    }
-    if (const int d = FindNodeDepth(node->second.get(), target, depth + 1); d >= 0) {
-        return d;
-    }
-    for (const auto& child : node->children) {
-        if (const int d = FindNodeDepth(child.get(), target, depth + 1); d >= 0) {
-            return d;
+        if (node == root) {
+            return leaf;
         }
     }
-    return -1;
+    return SearchNodeByWidget(root, widget);
 }
 
 const Node* FindSplitSibling(const Node* parent, const Node* node)
@@ -512,12 +384,19 @@ DockWidget::~DockWidget() = default;
 
 void DockWidget::setTitle(const std::string& title) { title_ = title; }
 
-void DockWidget::setContent(std::unique_ptr<Widget> widget) { content_ = std::move(widget); }
+// Both setters change minimumSize(), which the layout caches per node until
+// the node is marked DirtyMinSize.
+void DockWidget::setContent(std::unique_ptr<Widget> widget)
+{
+    content_ = std::move(widget);
+    DockLayout::MarkDirty(DockLayout::Resolve(layoutNode_), DockLayout::DirtyMinSize);
+}
 
 void DockWidget::setMinimumSize(float width, float height)
 {
     minimumSize_.width = std::max(0.0f, width);
     minimumSize_.height = std::max(0.0f, height);
+    DockLayout::MarkDirty(DockLayout::Resolve(layoutNode_), DockLayout::DirtyMinSize);
 }
 
 DFSize DockWidget::minimumSize() const
@@ -640,6 +519,7 @@ void DockWidget::paint(Canvas& canvas)
     if (content_) {
         const DFRect client = clientAreaRect(bounds_);
         content_->setBounds(client);
+        DFCanvasScopeGuard scope(canvas, DFCanvasScope::WidgetContent);
         content_->paint(canvas);
     }
 }
@@ -829,19 +709,10 @@ void DockManager::closeDockedWidget(DockWidget* widget)
         return;
     }
 
-    std::unique_ptr<Node> root = mainLayout_->takeRoot();
-    if (!root) {
+    checkpoint();
+    if (!mainLayout_->removeWidget(widget)) {
         return;
     }
-
-    std::unique_ptr<Node> extracted;
-    if (!RemoveWidgetNode(root, widget, extracted)) {
-        mainLayout_->setRoot(std::move(root));
-        return;
-    }
-
-    NormalizeNode(root);
-    mainLayout_->setRoot(std::move(root));
     widget->setBounds({0.0f, 0.0f, 0.0f, 0.0f});
     widget->setTabified(false);
     widget->hostType_ = DockWidget::HostType::None;
@@ -854,6 +725,7 @@ void DockManager::closeWidget(DockWidget* widget)
         return;
     }
     if (widget->isFloating()) {
+        checkpoint();
         if (auto* frame = WindowManager::instance().findWindowByContent(widget)) {
             WindowManager::instance().destroyWindow(frame);
         }
@@ -877,20 +749,12 @@ void DockManager::startUndockDrag(DockWidget* widget, const DFPoint& mousePos)
         mousePos.x,
         mousePos.y);
 
-    std::unique_ptr<Node> root = mainLayout_->takeRoot();
-    if (!root) {
-        return;
-    }
-
+    checkpoint();
     std::unique_ptr<Node> extracted;
-    if (!RemoveWidgetNode(root, widget, extracted)) {
-        mainLayout_->setRoot(std::move(root));
+    if (!mainLayout_->removeWidget(widget, &extracted)) {
         return;
     }
 
-    NormalizeNode(root);
-    mainLayout_->setRoot(std::move(root));
-
     if (!extracted || extracted->type != Node::Type::Widget || extracted->widget != widget) {
         return;
     }
@@ -912,6 +776,9 @@ void DockManager::startUndockDrag(DockWidget* widget, const DFPoint& mousePos)
             bounds.width,
             bounds.height);
         startFloatingDrag(frame, mousePos);
+        // The checkpoint above covers the whole gesture, so dropping the
+        // panel back into the layout is one undo step.
+        floatingDragCheckpointed_ = draggedFloatingWindow_ == frame;
     }
 }
 
@@ -934,7 +801,7 @@ bool DockManager::handleEvent(Event& event)
 
     // Allow dragging docked widgets directly from a tab header in tab-centric layouts.
     if (!drag_.active && event.type == Event::Type::MouseDown && mainLayout_) {
-        if (DockWidget* tabWidget = FindTabAtPoint(mainLayout_->root(), {event.x, event.y})) {
+        if (DockWidget* tabWidget = FindTabAtPoint(*mainLayout_, {event.x, event.y})) {
             startDrag(tabWidget, {event.x, event.y}, true);
             event.handled = true;
             return true;
@@ -979,8 +846,9 @@ void DockManager::startFloatingDrag(WindowFrame* window, const DFPoint& mousePos
     overlay_.setPreview({});
     popupTraceActive_ = false;
     popupTraceZone_ = DragOverlay::DropZone::None;
-    popupTraceTarget_ = nullptr;
+    popupTraceTarget_ = {};
     popupTraceDepth_ = -1;
+    dropTargets_.valid = false;
 
     const DockWidget* content = window->content();
     PopupTracePrint(
@@ -1021,7 +889,7 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
             }
             popupTraceActive_ = false;
             popupTraceZone_ = DragOverlay::DropZone::None;
-            popupTraceTarget_ = nullptr;
+            popupTraceTarget_ = {};
             popupTraceDepth_ = -1;
             return;
         }
@@ -1034,7 +902,7 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
             return;
         }
 
-        const Node* node = static_cast<const Node*>(hovered->target);
+        const Node* node = df::DockLayout::Resolve(hovered->target);
         PopupTracePrint(
             "[popup] hover zone=%s depth=%d target_type=%s target_title=\"%s\" rect=(%.1f,%.1f %.1fx%.1f) mouse=(%.1f,%.1f)",
             DropZoneName(hovered->zone),
@@ -1114,72 +982,15 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
         return;
     }
 
-    auto rectIntersection = [](const DFRect& a, const DFRect& b) -> DFRect {
-        const float x0 = std::max(a.x, b.x);
-        const float y0 = std::max(a.y, b.y);
-        const float x1 = std::min(a.x + a.width, b.x + b.width);
-        const float y1 = std::min(a.y + a.height, b.y + b.height);
-        return {
-            x0,
-            y0,
-            std::max(0.0f, x1 - x0),
-            std::max(0.0f, y1 - y0)
-        };
-    };
-
-    auto rectArea = [](const DFRect& r) -> float {
-        return std::max(0.0f, r.width) * std::max(0.0f, r.height);
-    };
-
-    auto resolveNodeBoundsToRoot = [&](const DFRect& nodeBounds, const DFRect* parentRootBounds) -> DFRect {
-        if (!parentRootBounds) {
-            return nodeBounds;
-        }
-
-        // Some call paths provide child-local bounds. Normalize to parent/root space
-        // so docking hints always render in the same coordinate system.
-        const float eps = 1.0f;
-        const bool fitsParentAsAbsolute =
-            nodeBounds.x >= parentRootBounds->x - eps &&
-            nodeBounds.y >= parentRootBounds->y - eps &&
-            nodeBounds.x + nodeBounds.width <= parentRootBounds->x + parentRootBounds->width + eps &&
-            nodeBounds.y + nodeBounds.height <= parentRootBounds->y + parentRootBounds->height + eps;
-        const bool fitsParentAsLocal =
-            nodeBounds.x >= -eps &&
-            nodeBounds.y >= -eps &&
-            nodeBounds.x + nodeBounds.width <= parentRootBounds->width + eps &&
-            nodeBounds.y + nodeBounds.height <= parentRootBounds->height + eps;
-
-        if (!fitsParentAsLocal) {
-            return nodeBounds;
-        }
-
-        const DFRect translated{
-            parentRootBounds->x + nodeBounds.x,
-            parentRootBounds->y + nodeBounds.y,
-            nodeBounds.width,
-            nodeBounds.height
-        };
-
-        if (!fitsParentAsAbsolute) {
-            return translated;
-        }
-
-        // Ambiguous case (near origin): pick the variant that better overlaps parent.
-        const float rawOverlap = rectArea(rectIntersection(nodeBounds, *parentRootBounds));
-        const float translatedOverlap = rectArea(rectIntersection(translated, *parentRootBounds));
-        return (translatedOverlap > rawOverlap + 0.5f) ? translated : nodeBounds;
-    };
-
-    auto addCandidate = [this, &rootContainer, &rectIntersection](DragOverlay::DropZone zone, Node* target, const DFRect& bounds, int depth) {
-        const DFRect clipped = rectIntersection(bounds, rootContainer);
+    auto addCandidate = [this, &rootContainer](DragOverlay::DropZone zone, Node* target, const DFRect& bounds, int depth) {
+        const DFRect clipped = DFRectIntersection(bounds, rootContainer);
         if (clipped.width <= 1.0f || clipped.height <= 1.0f) {
             return;
         }
         const size_t overlayIndex = overlay_.addZone(clipped, zone);
         DropCandidate entry;
         entry.zone = zone;
-        entry.target = target;
+        entry.target = df::DockLayout::HandleOf(target);
         entry.bounds = clipped;
         entry.overlayIndex = overlayIndex;
         entry.depth = depth;
@@ -1254,13 +1065,130 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
     }
     addCandidate(nearestEdge, nullptr, edgeBounds, 0);
 
-    DockWidget* movingWidget = draggedFloatingWindow_->content();
+    // Tab hints come before split hints and each list keeps tree order, so
+    // candidates are added in the order the full tree walks produced them.
+    refreshDropTargets(rootContainer);
+    dropTargets_.tabGrid.find(mousePos, [&](uint32_t index) {
+        const DropTargetCache::TabTarget& target = dropTargets_.tabTargets[index];
+        if (Node* node = df::DockLayout::Resolve(target.node)) {
+            addCandidate(DragOverlay::DropZone::Tab, node, target.hint, target.depth);
+        }
+        return false;
+    });
+    dropTargets_.splitGrid.find(mousePos, [&](uint32_t index) {
+        const DropTargetCache::SplitTarget& target = dropTargets_.splitTargets[index];
+        Node* node = df::DockLayout::Resolve(target.node);
+        if (!node) {
+            return false;
+        }
+        if (target.left.contains(mousePos)) {
+            addCandidate(DragOverlay::DropZone::Left, node, target.left, target.depth);
+        } else if (target.right.contains(mousePos)) {
+            addCandidate(DragOverlay::DropZone::Right, node, target.right, target.depth);
+        } else if (target.top.height > 1.0f && target.top.contains(mousePos)) {
+            addCandidate(DragOverlay::DropZone::Top, node, target.top, target.depth);
+        } else if (target.bottom.contains(mousePos)) {
+            addCandidate(DragOverlay::DropZone::Bottom, node, target.bottom, target.depth);
+        }
+        return false;
+    });
+
+    auto isEdgeZone = [](DragOverlay::DropZone zone) {
+        return zone == DragOverlay::DropZone::Left ||
+            zone == DragOverlay::DropZone::Right ||
+            zone == DragOverlay::DropZone::Top ||
+            zone == DragOverlay::DropZone::Bottom;
+    };
+    const float forceRootEdgePriorityDistancePx = 20.0f;
+
+    const DropCandidate* hovered = nullptr;
+    float bestArea = std::numeric_limits<float>::max();
+    int bestDepth = -1;
+    int bestPriority = -1;
+    for (const auto& candidate : dropCandidates_) {
+        // Keep root edge docking explicit (cursor must be inside the thin edge strip).
+        // Near-edge activation stays enabled for inner split targets only.
+        const bool edgeNearAndMatching = candidate.depth > 0 &&
+            isEdgeZone(candidate.zone) &&
+            candidate.zone == nearestEdge &&
+            minDist <= edgeDockActivateDistancePx_;
+        if (!candidate.bounds.contains(mousePos) && !edgeNearAndMatching) {
+            continue;
+        }
+        const float area = candidate.bounds.width * candidate.bounds.height;
+        int priority = 0;
+        if (candidate.zone == DragOverlay::DropZone::Tab || candidate.zone == DragOverlay::DropZone::Center) {
+            priority = 5;
+        } else if (isEdgeZone(candidate.zone)) {
+            if (candidate.depth == 0 && minDist <= forceRootEdgePriorityDistancePx) {
+                // Near the outer frame edge, root docking must beat inner splits.
+                priority = 6;
+            } else {
+                // Inner split candidates normally outrank root edge candidates.
+                priority = (candidate.depth > 0) ? 4 : 3;
+            }
+        }
+        if (!hovered ||
+            priority > bestPriority ||
+            (priority == bestPriority && candidate.depth > bestDepth) ||
+            (priority == bestPriority && candidate.depth == bestDepth && area < bestArea)) {
+            hovered = &candidate;
+            bestArea = area;
+            bestDepth = candidate.depth;
+            bestPriority = priority;
+        }
+    }
+    if (hovered) {
+        overlay_.highlightZoneIndex(hovered->overlayIndex);
+        highlightedCandidateIndex_ = static_cast<int>(hovered->overlayIndex);
+        tracePopupHover(hovered, "hover");
+    } else {
+        overlay_.highlightZone(DragOverlay::DropZone::None);
+        highlightedCandidateIndex_ = -1;
+        tracePopupHover(nullptr, "no_popup_target");
+    }
+}
+
+void DockManager::refreshDropTargets(const DFRect& rootContainer)
+{
+    const DockWidget* movingWidget = draggedFloatingWindow_ ? draggedFloatingWindow_->content() : nullptr;
+    const uint64_t layoutVersion = mainLayout_ ? mainLayout_->version() : 0;
+    DropTargetCache& cache = dropTargets_;
+    if (cache.valid &&
+        cache.layout == mainLayout_ &&
+        cache.layoutVersion == layoutVersion &&
+        cache.movingWidget == movingWidget &&
+        cache.rootContainer.x == rootContainer.x &&
+        cache.rootContainer.y == rootContainer.y &&
+        cache.rootContainer.width == rootContainer.width &&
+        cache.rootContainer.height == rootContainer.height) {
+        return;
+    }
+
+    cache.valid = true;
+    cache.layout = mainLayout_;
+    cache.layoutVersion = layoutVersion;
+    cache.movingWidget = movingWidget;
+    cache.rootContainer = rootContainer;
+    cache.tabTargets.clear();
+    cache.splitTargets.clear();
+    cache.tabGrid.clear();
+    cache.splitGrid.clear();
+    Node* root = mainLayout_ ? mainLayout_->root() : nullptr;
+
     // Tab docking hints: only appear when cursor is inside a real tab/header strip.
     std::function<void(Node*, int, const DFRect*)> collectTabTargets = [&](Node* node, int depth, const DFRect* parentRootBounds) {
         if (!node) {
             return;
         }
-        const DFRect nodeBoundsRoot = resolveNodeBoundsToRoot(node->bounds, parentRootBounds);
+        const DFRect nodeBoundsRoot = ResolveNodeBoundsToRoot(node->bounds, parentRootBounds);
+
+        auto addTarget = [&](const DFRect& hint) {
+            if (hint.width > 1.0f && hint.height > 1.0f) {
+                cache.tabGrid.add(hint, static_cast<uint32_t>(cache.tabTargets.size()));
+                cache.tabTargets.push_back({df::DockLayout::HandleOf(node), hint, depth});
+            }
+        };
 
         if (node->type == Node::Type::Widget && node->widget && node->widget != movingWidget) {
             const DFRect panelBounds = nodeBoundsRoot;
@@ -1268,22 +1196,14 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
             const DFRect headerRect{panelBounds.x, panelBounds.y, panelBounds.width, headerH};
             // Keep tab hints strictly inside the panel header strip and aligned
             // to the bottom edge for a cleaner target.
-            const DFRect tabHintRect = MakeBottomEdgeTabHintRect(headerRect);
-            if (tabHintRect.width > 1.0f && tabHintRect.height > 1.0f && tabHintRect.contains(mousePos)) {
-                addCandidate(DragOverlay::DropZone::Tab, node, tabHintRect, depth);
-            }
+            addTarget(MakeBottomEdgeTabHintRect(headerRect));
             return;
         }
 
         if (node->type == Node::Type::Tab && !node->children.empty()) {
             const DFRect barRect = DockLayout::TabStripRect(*node, nodeBoundsRoot);
             const bool verticalStrip = DockLayout::UseVerticalTabStrip(*node, nodeBoundsRoot);
-            const DFRect tabHintRect = verticalStrip
-                ? MakeRightEdgeTabHintRect(barRect)
-                : MakeBottomEdgeTabHintRect(barRect);
-            if (tabHintRect.width > 1.0f && tabHintRect.height > 1.0f && tabHintRect.contains(mousePos)) {
-                addCandidate(DragOverlay::DropZone::Tab, node, tabHintRect, depth);
-            }
+            addTarget(verticalStrip ? MakeRightEdgeTabHintRect(barRect) : MakeBottomEdgeTabHintRect(barRect));
         }
 
         collectTabTargets(node->first.get(), depth + 1, &nodeBoundsRoot);
@@ -1300,7 +1220,7 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
         if (!node) {
             return;
         }
-        const DFRect nodeBoundsRoot = resolveNodeBoundsToRoot(node->bounds, parentRootBounds);
+        const DFRect nodeBoundsRoot = ResolveNodeBoundsToRoot(node->bounds, parentRootBounds);
 
         const bool childInsideTabContainer = insideTabContainer || (node->type == Node::Type::Tab);
         collectSplitTargets(node->first.get(), depth + 1, childInsideTabContainer, &nodeBoundsRoot);
@@ -1317,7 +1237,7 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
         }
 
         const DFRect b = nodeBoundsRoot;
-        if (b.width < 40.0f || b.height < 40.0f || !b.contains(mousePos)) {
+        if (b.width < 40.0f || b.height < 40.0f) {
             return;
         }
 
@@ -1335,92 +1255,35 @@ void DockManager::updateFloatingDrag(const DFPoint& mousePos)
         const float zoneW = std::min(innerSplitSnapZonePx_, contentW * 0.4f);
         const float zoneH = std::min(innerSplitSnapZonePx_, contentH * 0.4f);
         const DFRect contentBounds{b.x + leftInset, b.y + topInset, contentW, contentH};
-        const DFRect leftZone{contentBounds.x, contentBounds.y, zoneW, contentBounds.height};
-        const DFRect rightZone{
+        DropTargetCache::SplitTarget target;
+        target.node = df::DockLayout::HandleOf(node);
+        target.depth = depth;
+        target.left = {contentBounds.x, contentBounds.y, zoneW, contentBounds.height};
+        target.right = {
             contentBounds.x + contentBounds.width - zoneW,
             contentBounds.y,
             zoneW,
             contentBounds.height
         };
-        const DFRect topZone{contentBounds.x, contentBounds.y, contentBounds.width, zoneH};
-        const DFRect bottomZone{
+        target.top = {contentBounds.x, contentBounds.y, contentBounds.width, zoneH};
+        target.bottom = {
             contentBounds.x,
             contentBounds.y + contentBounds.height - zoneH,
             contentBounds.width,
             zoneH
         };
-
-        if (leftZone.contains(mousePos)) {
-            addCandidate(DragOverlay::DropZone::Left, node, leftZone, depth);
-        } else if (rightZone.contains(mousePos)) {
-            addCandidate(DragOverlay::DropZone::Right, node, rightZone, depth);
-        } else if (topZone.height > 1.0f && topZone.contains(mousePos)) {
-            addCandidate(DragOverlay::DropZone::Top, node, topZone, depth);
-        } else if (bottomZone.contains(mousePos)) {
-            addCandidate(DragOverlay::DropZone::Bottom, node, bottomZone, depth);
-        }
+        // The zones only apply while the cursor is over the whole node.
+        cache.splitGrid.add(b, static_cast<uint32_t>(cache.splitTargets.size()));
+        cache.splitTargets.push_back(target);
     };
 
-    if (mainLayout_) {
+    if (root) {
         const DFRect rootBoundsSeed = rootContainer;
-        collectTabTargets(mainLayout_->root(), 1, &rootBoundsSeed);
-        collectSplitTargets(mainLayout_->root(), 1, false, &rootBoundsSeed);
-    }
-
-    auto isEdgeZone = [](DragOverlay::DropZone zone) {
-        return zone == DragOverlay::DropZone::Left ||
-            zone == DragOverlay::DropZone::Right ||
-            zone == DragOverlay::DropZone::Top ||
-            zone == DragOverlay::DropZone::Bottom;
-    };
-    const float forceRootEdgePriorityDistancePx = 20.0f;
-
-    const DropCandidate* hovered = nullptr;
-    float bestArea = std::numeric_limits<float>::max();
-    int bestDepth = -1;
-    int bestPriority = -1;
-    for (const auto& candidate : dropCandidates_) {
-        // Keep root edge docking explicit (cursor must be inside the thin edge strip).
-        // Near-edge activation stays enabled for inner split targets only.
-        const bool edgeNearAndMatching = candidate.depth > 0 &&
-            isEdgeZone(candidate.zone) &&
-            candidate.zone == nearestEdge &&
-            minDist <= edgeDockActivateDistancePx_;
-        if (!candidate.bounds.contains(mousePos) && !edgeNearAndMatching) {
-            continue;
-        }
-        const float area = candidate.bounds.width * candidate.bounds.height;
-        int priority = 0;
-        if (candidate.zone == DragOverlay::DropZone::Tab || candidate.zone == DragOverlay::DropZone::Center) {
-            priority = 5;
-        } else if (isEdgeZone(candidate.zone)) {
-            if (candidate.depth == 0 && minDist <= forceRootEdgePriorityDistancePx) {
-                // Near the outer frame edge, root docking must beat inner splits.
-                priority = 6;
-            } else {
-                // Inner split candidates normally outrank root edge candidates.
-                priority = (candidate.depth > 0) ? 4 : 3;
-            }
-        }
-        if (!hovered ||
-            priority > bestPriority ||
-            (priority == bestPriority && candidate.depth > bestDepth) ||
-            (priority == bestPriority && candidate.depth == bestDepth && area < bestArea)) {
-            hovered = &candidate;
-            bestArea = area;
-            bestDepth = candidate.depth;
-            bestPriority = priority;
-        }
-    }
-    if (hovered) {
-        overlay_.highlightZoneIndex(hovered->overlayIndex);
-        highlightedCandidateIndex_ = static_cast<int>(hovered->overlayIndex);
-        tracePopupHover(hovered, "hover");
-    } else {
-        overlay_.highlightZone(DragOverlay::DropZone::None);
-        highlightedCandidateIndex_ = -1;
-        tracePopupHover(nullptr, "no_popup_target");
+        collectTabTargets(root, 1, &rootBoundsSeed);
+        collectSplitTargets(root, 1, false, &rootBoundsSeed);
     }
+    cache.tabGrid.build();
+    cache.splitGrid.build();
 }
 
 void DockManager::endFloatingDrag(const DFPoint& mousePos)
@@ -1521,6 +1384,11 @@ void DockManager::endFloatingDrag(const DFPoint& mousePos)
         !candidate->bounds.contains(mousePos)) {
         candidate = nullptr;
     }
+    // Candidates are collected at drag start; a target node that has since
+    // been freed must not fall through to the empty-handle root drop.
+    if (candidate && candidate->target && !df::DockLayout::Resolve(candidate->target)) {
+        candidate = nullptr;
+    }
 
     WindowFrame* sourceWindow = draggedFloatingWindow_;
     DockWidget* widget = sourceWindow->content();
@@ -1579,10 +1447,10 @@ void DockManager::endFloatingDrag(const DFPoint& mousePos)
             return;
         }
 
-        const Node* parentNode = FindParentNode(rootNode, dockedNode);
+        const Node* parentNode = dockedNode->parent;
         const Node* siblingNode = FindSplitSibling(parentNode, dockedNode);
-        const int nodeDepth = FindNodeDepth(rootNode, dockedNode);
-        const int parentDepth = parentNode ? FindNodeDepth(rootNode, parentNode) : -1;
+        const int nodeDepth = df::DockLayout::Depth(dockedNode);
+        const int parentDepth = parentNode ? df::DockLayout::Depth(parentNode) : -1;
         const int tabChildren = (parentNode && parentNode->type == Node::Type::Tab)
             ? static_cast<int>(parentNode->children.size())
             : 0;
@@ -1674,12 +1542,12 @@ void DockManager::endFloatingDrag(const DFPoint& mousePos)
     const bool forceTabAfterDock = true;
     const DragOverlay::DropZone appliedZone =
         (forceTabAfterDock &&
-         candidate->target != nullptr &&
+         static_cast<bool>(candidate->target) &&
          candidate->zone != DragOverlay::DropZone::Center &&
          candidate->zone != DragOverlay::DropZone::Tab)
             ? DragOverlay::DropZone::Tab
             : candidate->zone;
-    const Node* targetNodeInfo = static_cast<const Node*>(candidate->target);
+    const Node* targetNodeInfo = df::DockLayout::Resolve(candidate->target);
     PopupTracePrint(
         "[popup] drop_result mode=dock widget=\"%s\" zone=%s applied_zone=%s depth=%d target_type=%s target_title=\"%s\"",
         widget->title().c_str(),
@@ -1689,111 +1557,13 @@ void DockManager::endFloatingDrag(const DFPoint& mousePos)
         NodeTypeName(targetNodeInfo),
         NodePrimaryWidgetTitle(targetNodeInfo));
 
-    WindowManager::instance().destroyWindow(sourceWindow);
-
-    auto newLeaf = std::make_unique<Node>();
-    newLeaf->type = Node::Type::Widget;
-    newLeaf->widget = widget;
-
-    std::unique_ptr<Node> root = mainLayout_->takeRoot();
-    if (!root) {
-        mainLayout_->setRoot(std::move(newLeaf));
-        logDockVerify();
-        cancelFloatingDrag();
-        return;
-    }
-
-    Node* targetNode = static_cast<Node*>(candidate->target);
-    if (appliedZone == DragOverlay::DropZone::Center || appliedZone == DragOverlay::DropZone::Tab) {
-        if (targetNode) {
-            // If target widget already belongs to a tab group, append into that tab
-            // instead of creating nested tab-in-tab structures.
-            if (auto* parentTabHandle = FindParentTabHandle(root, targetNode);
-                parentTabHandle && *parentTabHandle && (*parentTabHandle)->type == Node::Type::Tab) {
-                (*parentTabHandle)->children.push_back(std::move(newLeaf));
-                (*parentTabHandle)->activeTab = static_cast<int>((*parentTabHandle)->children.size()) - 1;
-                NormalizeNode(root);
-                mainLayout_->setRoot(std::move(root));
-                logDockVerify();
-                cancelFloatingDrag();
-                return;
-            }
-
-            auto* handle = FindNodeHandle(root, targetNode);
-            if (handle && *handle) {
-                if ((*handle)->type == Node::Type::Tab) {
-                    (*handle)->children.push_back(std::move(newLeaf));
-                    (*handle)->activeTab = static_cast<int>((*handle)->children.size()) - 1;
-                } else if ((*handle)->type == Node::Type::Widget) {
-                    auto existingLeaf = std::make_unique<Node>();
-                    existingLeaf->type = Node::Type::Widget;
-                    existingLeaf->widget = (*handle)->widget;
-
-                    auto tabNode = std::make_unique<Node>();
-                    tabNode->type = Node::Type::Tab;
-                    tabNode->tabBarHeight = DefaultTabBarHeightPx();
-                    tabNode->children.push_back(std::move(existingLeaf));
-                    tabNode->children.push_back(std::move(newLeaf));
-                    tabNode->activeTab = 1;
-                    *handle = std::move(tabNode);
-                } else {
-                    auto tabNode = std::make_unique<Node>();
-                    tabNode->type = Node::Type::Tab;
-                    tabNode->tabBarHeight = DefaultTabBarHeightPx();
-                    tabNode->children.push_back(std::move(*handle));
-                    tabNode->children.push_back(std::move(newLeaf));
-                    tabNode->activeTab = 1;
-                    *handle = std::move(tabNode);
-                }
-            } else {
-                auto tabNode = std::make_unique<Node>();
-                tabNode->type = Node::Type::Tab;
-                tabNode->tabBarHeight = DefaultTabBarHeightPx();
-                tabNode->children.push_back(std::move(root));
-                tabNode->children.push_back(std::move(newLeaf));
-                tabNode->activeTab = 1;
-                root = std::move(tabNode);
-            }
-        } else {
-            auto tabNode = std::make_unique<Node>();
-            tabNode->type = Node::Type::Tab;
-            tabNode->tabBarHeight = DefaultTabBarHeightPx();
-            tabNode->children.push_back(std::move(root));
-            tabNode->children.push_back(std::move(newLeaf));
-            tabNode->activeTab = 1;
-            root = std::move(tabNode);
-        }
-    } else {
-        std::unique_ptr<Node>* handle = nullptr;
-        if (targetNode) {
-            handle = FindNodeHandle(root, targetNode);
-        }
-        if (!handle || !*handle) {
-            handle = &root;
-        }
-
-        std::unique_ptr<Node> existing = std::move(*handle);
-        auto split = std::make_unique<Node>();
-        split->type = Node::Type::Split;
-        split->vertical = (appliedZone == DragOverlay::DropZone::Left || appliedZone == DragOverlay::DropZone::Right);
-        split->ratio = 0.5f;
-        split->minFirstSize = 120.0f;
-        split->minSecondSize = 120.0f;
-
-        if (appliedZone == DragOverlay::DropZone::Left || appliedZone == DragOverlay::DropZone::Top) {
-            split->first = std::move(newLeaf);
-            split->second = std::move(existing);
-            split->ratio = 0.25f;
-        } else {
-            split->first = std::move(existing);
-            split->second = std::move(newLeaf);
-            split->ratio = 0.75f;
-        }
-        *handle = std::move(split);
+    if (!floatingDragCheckpointed_) {
+        checkpoint();
     }
+    WindowManager::instance().destroyWindow(sourceWindow);
 
-    NormalizeNode(root);
-    mainLayout_->setRoot(std::move(root));
+    // Center/tab drops join the target's tab stack; edge drops split it.
+    mainLayout_->insertWidget(widget, df::DockLayout::Resolve(candidate->target), appliedZone);
     logDockVerify();
     cancelFloatingDrag();
 }
@@ -1809,9 +1579,10 @@ void DockManager::cancelFloatingDrag()
     highlightedCandidateIndex_ = -1;
     suppressDockOnNextDrop_ = false;
     draggedFloatingWindow_ = nullptr;
+    floatingDragCheckpointed_ = false;
     popupTraceActive_ = false;
     popupTraceZone_ = DragOverlay::DropZone::None;
-    popupTraceTarget_ = nullptr;
+    popupTraceTarget_ = {};
     popupTraceDepth_ = -1;
 }
 
@@ -1822,14 +1593,512 @@ void DockManager::suppressDockForActiveFloatingDrag()
     }
 }
 
+std::shared_ptr<const DockSnapshot> DockManager::publishSnapshot()
+{
+    collectSnapshotWindows();
+    std::shared_ptr<const DockSnapshot> previous = snapshot();
+    std::shared_ptr<const DockSnapshot> next = BuildDockSnapshot(mainLayout_ ? mainLayout_->root() : nullptr,
+                                                                 mainLayout_ ? mainLayout_->version() : 0,
+                                                                 snapshotWindows_, previous.get());
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    snapshot_ = next;
+    return next;
+}
+
+std::shared_ptr<const DockSnapshot> DockManager::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(snapshotMutex_);
+    return snapshot_;
+}
+
+void DockManager::collectSnapshotWindows()
+{
+    const WindowManager& windows = WindowManager::instance();
+    snapshotWindows_.resize(windows.windowCount());
+    for (size_t i = 0; i < snapshotWindows_.size(); ++i) {
+        const WindowFrame* window = windows.windowAt(i);
+        DockSnapshotWindow& entry = snapshotWindows_[i];
+        entry.frame = window;
+        entry.content = window->content();
+        entry.title = entry.content ? entry.content->title() : std::string();
+        entry.bounds = window->bounds();
+    }
+}
+
+namespace {
+
+bool SameHistoryState(const DockSnapshot& a, const DockSnapshot& b)
+{
+    return a.root == b.root && a.windows == b.windows;
+}
+
+// Live nodes by handle index, unlinked from each other, for applying a
+// history state: a snapshot node whose node is still alive gets that node
+// back, so handles held by widgets, hit indexes and later snapshots survive
+// undo and redo. Nodes freed since the state was taken come back as new ones.
+using LiveNodes = std::unordered_map<uint32_t, std::unique_ptr<Node>>;
+
+void CollectLiveNodes(std::unique_ptr<Node> node, LiveNodes& live)
+{
+    if (!node) {
+        return;
+    }
+    CollectLiveNodes(std::move(node->first), live);
+    CollectLiveNodes(std::move(node->second), live);
+    for (auto& child : node->children) {
+        CollectLiveNodes(std::move(child), live);
+    }
+    node->children.clear();
+    node->parent = nullptr;
+    const uint32_t index = node->handle().index;
+    live[index] = std::move(node);
+}
+
+template <typename Resolve>
+std::unique_ptr<Node> NodeFromSnapshot(const DockSnapshotNode* source, const Resolve& resolve, LiveNodes& live)
+{
+    if (!source) {
+        return nullptr;
+    }
+    std::unique_ptr<Node> node;
+    auto it = live.find(source->handle.index);
+    if (it != live.end() && it->second && it->second->handle() == source->handle) {
+        node = std::move(it->second);
+        node->widget = nullptr;
+    } else {
+        node = std::make_unique<Node>();
+    }
+    node->type = source->type;
+    switch (source->type) {
+    case Node::Type::Widget:
+        node->widget = resolve(source->widget);
+        if (!node->widget) {
+            return nullptr;
+        }
+        break;
+    case Node::Type::Split:
+        node->vertical = source->vertical;
+        node->ratio = source->ratio;
+        node->splitSizing = source->splitSizing;
+        node->fixedSize = source->fixedSize;
+        node->minFirstSize = source->minFirstSize;
+        node->minSecondSize = source->minSecondSize;
+        node->first = NodeFromSnapshot(source->first.get(), resolve, live);
+        node->second = NodeFromSnapshot(source->second.get(), resolve, live);
+        break;
+    case Node::Type::Tab:
+        node->activeTab = source->activeTab;
+        node->tabBarHeight = source->tabBarHeight;
+        node->children.reserve(source->children.size());
+        for (const auto& child : source->children) {
+            if (std::unique_ptr<Node> copy = NodeFromSnapshot(child.get(), resolve, live)) {
+                node->children.push_back(std::move(copy));
+            }
+        }
+        break;
+    }
+    return node;
+}
+
+} // namespace
+
+std::shared_ptr<const DockSnapshot> DockManager::captureHistoryState(const DockSnapshot* previous)
+{
+    collectSnapshotWindows();
+    return BuildDockSnapshot(mainLayout_ ? mainLayout_->root() : nullptr, mainLayout_ ? mainLayout_->version() : 0,
+                             snapshotWindows_, previous, false);
+}
+
+void DockManager::checkpoint()
+{
+    // A batch of edits is one history step.
+    if (mainLayout_ && mainLayout_->inBatch()) {
+        if (historyBatchVersion_ == mainLayout_->version()) {
+            return;
+        }
+        historyBatchVersion_ = mainLayout_->version();
+    }
+    redo_.clear();
+    std::shared_ptr<const DockSnapshot> state = captureHistoryState(historyHead_.get());
+    if (!undo_.empty() && SameHistoryState(*state, *undo_.back())) {
+        return;
+    }
+    historyHead_ = state;
+    undo_.push_back(std::move(state));
+    if (undo_.size() > historyLimit_) {
+        undo_.erase(undo_.begin());
+    }
+}
+
+bool DockManager::undo()
+{
+    if (undo_.empty()) {
+        return false;
+    }
+    std::shared_ptr<const DockSnapshot> current = captureHistoryState(historyHead_.get());
+    // Checkpoints that changed nothing (a splitter click without a move) are
+    // not steps of their own.
+    while (!undo_.empty() && SameHistoryState(*undo_.back(), *current)) {
+        undo_.pop_back();
+    }
+    if (undo_.empty()) {
+        return false;
+    }
+    redo_.push_back(std::move(current));
+    std::shared_ptr<const DockSnapshot> target = std::move(undo_.back());
+    undo_.pop_back();
+    applyHistoryState(*target);
+    historyHead_ = std::move(target);
+    return true;
+}
+
+bool DockManager::redo()
+{
+    if (redo_.empty()) {
+        return false;
+    }
+    undo_.push_back(captureHistoryState(historyHead_.get()));
+    std::shared_ptr<const DockSnapshot> target = std::move(redo_.back());
+    redo_.pop_back();
+    applyHistoryState(*target);
+    historyHead_ = std::move(target);
+    return true;
+}
+
+void DockManager::clearHistory()
+{
+    undo_.clear();
+    redo_.clear();
+    historyHead_.reset();
+}
+
+void DockManager::setHistoryLimit(size_t limit)
+{
+    historyLimit_ = std::max<size_t>(limit, 1);
+    if (undo_.size() > historyLimit_) {
+        undo_.erase(undo_.begin(), undo_.begin() + static_cast<std::ptrdiff_t>(undo_.size() - historyLimit_));
+    }
+}
+
+void DockManager::applyHistoryState(const DockSnapshot& state)
+{
+    sortedWidgets_.assign(widgets_.begin(), widgets_.end());
+    std::sort(sortedWidgets_.begin(), sortedWidgets_.end());
+    auto registered = [this](const DockWidget* widget) -> DockWidget* {
+        auto it = std::lower_bound(sortedWidgets_.begin(), sortedWidgets_.end(), widget);
+        return (it != sortedWidgets_.end() && *it == widget) ? *it : nullptr;
+    };
+
+    detachAllWidgets();
+    if (mainLayout_) {
+        LiveNodes live;
+        CollectLiveNodes(mainLayout_->takeRoot(), live);
+        mainLayout_->setRoot(NodeFromSnapshot(state.root.get(), registered, live));
+    }
+    if (state.windows) {
+        for (const DockSnapshotWindow& window : *state.windows) {
+            if (DockWidget* widget = registered(window.content)) {
+                WindowManager::instance().createFloatingWindow(widget, window.bounds);
+            }
+        }
+    }
+}
+
+void DockManager::detachAllWidgets()
+{
+    endDrag();
+    cancelFloatingDrag();
+    WindowManager& windows = WindowManager::instance();
+    while (windows.windowCount() > 0) {
+        windows.destroyWindow(windows.windowAt(windows.windowCount() - 1));
+    }
+    for (DockWidget* widget : widgets_) {
+        widget->setBounds({0.0f, 0.0f, 0.0f, 0.0f});
+        widget->setTabified(false);
+        widget->hostType_ = DockWidget::HostType::None;
+        widget->hostWindow_ = nullptr;
+        widget->layoutNode_ = {};
+    }
+}
+
 std::string DockManager::saveState() const
 {
-    return "{}";
+    std::vector<WindowFrame*> windows = WindowManager::instance().windowsSnapshot();
+    windows.erase(std::remove_if(windows.begin(), windows.end(), [](WindowFrame* window) { return !window->content(); }),
+                  windows.end());
+
+    // One string per placed widget, not per title: restoreState hands each
+    // string to one widget, so equally titled panels need a string apiece.
+    // Strings follow registration order, which is the order restoreState
+    // claims equal titles in; unregistered widgets (which cannot be restored)
+    // are appended as the body meets them.
+    constexpr uint32_t kUnassigned = std::numeric_limits<uint32_t>::max();
+    std::unordered_map<const DockWidget*, uint32_t> widgetIndex;
+    std::function<void(const Node*)> collect = [&](const Node* node) {
+        if (!node) {
+            return;
+        }
+        if (node->type == Node::Type::Widget && node->widget) {
+            widgetIndex.emplace(node->widget, kUnassigned);
+        }
+        collect(node->first.get());
+        collect(node->second.get());
+        for (const auto& child : node->children) {
+            collect(child.get());
+        }
+    };
+    collect(mainLayout_ ? mainLayout_->root() : nullptr);
+    for (WindowFrame* window : windows) {
+        widgetIndex.emplace(window->content(), kUnassigned);
+    }
+    std::vector<std::string_view> titles;
+    titles.reserve(widgetIndex.size());
+    for (const DockWidget* widget : widgets_) {
+        if (auto it = widgetIndex.find(widget); it != widgetIndex.end()) {
+            it->second = static_cast<uint32_t>(titles.size());
+            titles.push_back(widget->title());
+        }
+    }
+    auto indexOf = [&](const DockWidget* widget) {
+        uint32_t& index = widgetIndex[widget];
+        if (index == kUnassigned) {
+            index = static_cast<uint32_t>(titles.size());
+            titles.push_back(widget->title());
+        }
+        return index;
+    };
+
+    // The body is written first so the string table in front of it is complete.
+    std::string body;
+    DockStateWriter bodyWriter(body);
+    std::function<void(const Node*)> writeNode = [&](const Node* node) {
+        DockStateNode record;
+        if (!node || (node->type == Node::Type::Widget && !node->widget)) {
+            bodyWriter.node(record);
+            return;
+        }
+        switch (node->type) {
+        case Node::Type::Widget:
+            record.tag = DockStateNode::Tag::Widget;
+            record.title = indexOf(node->widget);
+            bodyWriter.node(record);
+            return;
+        case Node::Type::Split:
+            record.tag = DockStateNode::Tag::Split;
+            record.vertical = node->vertical;
+            record.sizing = static_cast<uint8_t>(node->splitSizing);
+            record.ratio = node->ratio;
+            record.fixedSize = node->fixedSize;
+            record.minFirstSize = node->minFirstSize;
+            record.minSecondSize = node->minSecondSize;
+            bodyWriter.node(record);
+            writeNode(node->first.get());
+            writeNode(node->second.get());
+            return;
+        case Node::Type::Tab:
+            record.tag = DockStateNode::Tag::Tab;
+            record.activeTab = static_cast<uint32_t>(std::max(0, node->activeTab));
+            record.childCount = static_cast<uint32_t>(node->children.size());
+            bodyWriter.node(record);
+            for (const auto& child : node->children) {
+                writeNode(child.get());
+            }
+            return;
+        }
+    };
+    writeNode(mainLayout_ ? mainLayout_->root() : nullptr);
+
+    bodyWriter.varint(static_cast<uint32_t>(windows.size()));
+    for (WindowFrame* window : windows) {
+        const DFRect& bounds = window->bounds();
+        bodyWriter.varint(indexOf(window->content()));
+        bodyWriter.f32(bounds.x);
+        bodyWriter.f32(bounds.y);
+        bodyWriter.f32(bounds.width);
+        bodyWriter.f32(bounds.height);
+    }
+
+    std::string out;
+    DockStateWriter writer(out);
+    writer.header();
+    writer.varint(static_cast<uint32_t>(titles.size()));
+    for (std::string_view title : titles) {
+        writer.string(title);
+    }
+    out += body;
+    return out;
+}
+
+namespace {
+
+uint64_t TitleHash(std::string_view title)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (char c : title) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
 }
 
+bool SkipStateNode(DockStateReader& reader, uint32_t stringCount, int depth)
+{
+    DockStateNode record;
+    if (depth > kDockStateMaxDepth || !reader.node(record, stringCount)) {
+        return false;
+    }
+    if (record.tag == DockStateNode::Tag::Split) {
+        return SkipStateNode(reader, stringCount, depth + 1) && SkipStateNode(reader, stringCount, depth + 1);
+    }
+    if (record.tag == DockStateNode::Tag::Tab) {
+        for (uint32_t i = 0; i < record.childCount; ++i) {
+            if (!SkipStateNode(reader, stringCount, depth + 1)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Input already validated by SkipStateNode. A widget is placed at most once:
+// its string slot is cleared when used, and unknown titles leave holes that
+// the next layout update normalizes away.
+std::unique_ptr<Node> ReadStateNode(DockStateReader& reader, uint32_t stringCount, std::vector<DockWidget*>& widgets)
+{
+    DockStateNode record;
+    reader.node(record, stringCount);
+    switch (record.tag) {
+    case DockStateNode::Tag::Empty:
+        return nullptr;
+    case DockStateNode::Tag::Widget: {
+        DockWidget* widget = widgets[record.title];
+        if (!widget) {
+            return nullptr;
+        }
+        widgets[record.title] = nullptr;
+        auto node = std::make_unique<Node>();
+        node->type = Node::Type::Widget;
+        node->widget = widget;
+        return node;
+    }
+    case DockStateNode::Tag::Split: {
+        auto node = std::make_unique<Node>();
+        node->type = Node::Type::Split;
+        node->vertical = record.vertical;
+        node->ratio = record.ratio;
+        node->splitSizing = static_cast<Node::SplitSizing>(record.sizing);
+        if (record.sizing != 0) {
+            node->fixedSize = record.fixedSize;
+        }
+        node->minFirstSize = record.minFirstSize;
+        node->minSecondSize = record.minSecondSize;
+        node->first = ReadStateNode(reader, stringCount, widgets);
+        node->second = ReadStateNode(reader, stringCount, widgets);
+        return node;
+    }
+    case DockStateNode::Tag::Tab: {
+        auto node = std::make_unique<Node>();
+        node->type = Node::Type::Tab;
+        node->tabBarHeight = DefaultTabBarHeightPx();
+        node->children.reserve(record.childCount);
+        // Children with unknown titles are dropped, so the active index is
+        // remapped: the saved tab if it survived, else the nearest one before it.
+        int active = 0;
+        for (uint32_t i = 0; i < record.childCount; ++i) {
+            if (std::unique_ptr<Node> child = ReadStateNode(reader, stringCount, widgets)) {
+                if (i <= record.activeTab) {
+                    active = static_cast<int>(node->children.size());
+                }
+                node->children.push_back(std::move(child));
+            }
+        }
+        node->activeTab = active;
+        return node;
+    }
+    }
+    return nullptr;
+}
+
+} // namespace
+
 bool DockManager::restoreState(const std::string& state)
 {
-    (void)state;
+    DockStateReader reader(state.data(), state.size());
+    uint32_t stringCount = 0;
+    if (!reader.header() || !reader.varint(stringCount) || stringCount > reader.remaining()) {
+        return false;
+    }
+
+    // Resolve the string table against registered widgets; each widget is
+    // claimed by one string. Sorting by hash keeps this to integer compares;
+    // the stable sort lets equal titles claim in registration order.
+    widgetsByTitle_.clear();
+    for (DockWidget* widget : widgets_) {
+        widgetsByTitle_.push_back({TitleHash(widget->title()), widget, false});
+    }
+    std::stable_sort(widgetsByTitle_.begin(), widgetsByTitle_.end(), [](const TitleEntry& a, const TitleEntry& b) {
+        return a.hash < b.hash;
+    });
+    stateWidgets_.assign(stringCount, nullptr);
+    for (uint32_t i = 0; i < stringCount; ++i) {
+        std::string_view title;
+        if (!reader.string(title)) {
+            return false;
+        }
+        const uint64_t hash = TitleHash(title);
+        auto it = std::lower_bound(widgetsByTitle_.begin(), widgetsByTitle_.end(), hash, [](const TitleEntry& entry, uint64_t key) {
+            return entry.hash < key;
+        });
+        for (; it != widgetsByTitle_.end() && it->hash == hash; ++it) {
+            if (!it->claimed && it->widget->title() == title) {
+                it->claimed = true;
+                stateWidgets_[i] = it->widget;
+                break;
+            }
+        }
+    }
+
+    // Validate the rest before changing anything.
+    const DockStateReader treeStart = reader;
+    DockStateReader peek = reader;
+    DockStateNode rootRecord;
+    peek.node(rootRecord, stringCount);
+    if (!SkipStateNode(reader, stringCount, 0)) {
+        return false;
+    }
+    uint32_t floatingCount = 0;
+    if (!reader.varint(floatingCount)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < floatingCount; ++i) {
+        uint32_t title = 0;
+        DFRect bounds{};
+        if (!reader.floating(title, bounds, stringCount)) {
+            return false;
+        }
+    }
+    if (!reader.atEnd() || (rootRecord.tag != DockStateNode::Tag::Empty && !mainLayout_)) {
+        return false;
+    }
+
+    checkpoint();
+    detachAllWidgets();
+    WindowManager& windows = WindowManager::instance();
+
+    reader = treeStart;
+    std::unique_ptr<Node> root = ReadStateNode(reader, stringCount, stateWidgets_);
+    if (mainLayout_) {
+        mainLayout_->setRoot(std::move(root));
+    }
+    reader.varint(floatingCount);
+    for (uint32_t i = 0; i < floatingCount; ++i) {
+        uint32_t title = 0;
+        DFRect bounds{};
+        reader.floating(title, bounds, stringCount);
+        if (DockWidget* widget = stateWidgets_[title]) {
+            stateWidgets_[title] = nullptr;
+            windows.createFloatingWindow(widget, bounds);
+        }
+    }
     return true;
 }
 
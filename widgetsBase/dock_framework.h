@@ -5,10 +5,12 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <functional>
 
 #include "core_types.h"
 #include "dock_drag.h"
+#include "hit_grid.h"
 
 class Event;
 
@@ -21,6 +23,22 @@ class DockManager;
 class DockLayout;
 class WindowFrame;
 class WindowManager;
+struct DockSnapshot;
+struct DockSnapshotWindow;
+
+// Generational reference to a DockLayout::Node. It resolves to nullptr once
+// the node is destroyed, so it is safe to keep across tree surgery.
+struct DockNodeHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; // 0 = null handle
+
+    explicit operator bool() const { return generation != 0; }
+    bool operator==(const DockNodeHandle& other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const DockNodeHandle& other) const { return !(*this == other); }
+};
 
 // -------------------------------------------------------------------
 // DockWidget (analogous to QDockWidget)
@@ -79,9 +97,12 @@ public:
     virtual void paint(Canvas& canvas);
     virtual void handleEvent(Event& event);
     void setTabified(bool tabified) { isTabified_ = tabified; }
+    // Leaf node that last laid this widget out; may be stale after tree edits.
+    DockNodeHandle layoutNode() const { return layoutNode_; }
 
 private:
     friend class DockArea;
+    friend class DockLayout;
     friend class DockManager;
     friend class WindowManager;
     std::string title_;
@@ -94,6 +115,7 @@ private:
     std::function<void()> onCloseRequested_;
     std::function<void(bool)> onDockChanged_;
     DFRect bounds_{};
+    DockNodeHandle layoutNode_{};
     DFSize minimumSize_{};
     bool childrenFloat_ = true;
     float clientAreaPadding_ = 2.0f;
@@ -176,9 +198,36 @@ public:
     void setDragBounds(const DFRect& bounds) { dragBounds_ = bounds; hasDragBounds_ = true; }
     void clearDragBounds() { hasDragBounds_ = false; }
 
-    std::string saveState() const;    // placeholder
+    // Compact binary layout state (format in dock_state.h): the docked tree
+    // with split sizing and active tabs, and floating windows with bounds in
+    // z-order. Widgets are matched to registered widgets by title. restoreState
+    // checks the whole input first and leaves everything untouched when it
+    // does not parse; DockStateToText() renders a state for inspection.
+    std::string saveState() const;
     bool restoreState(const std::string& state);
 
+    // Read-only copy of the docked tree and floating windows for other threads
+    // (dock_snapshot.h). Call publishSnapshot() on the UI thread after the
+    // layout update; nodes that did not change are shared with the previous
+    // snapshot. snapshot() returns the latest one and is safe from any thread.
+    std::shared_ptr<const DockSnapshot> publishSnapshot();
+    std::shared_ptr<const DockSnapshot> snapshot() const;
+
+    // Undo/redo of structural edits (dock, undock, close, splitter drags,
+    // restoreState). Those operations call checkpoint() before they change
+    // anything. History versions are snapshots without bounds, so an entry
+    // costs the nodes on the edited path rather than a copy of the tree.
+    // Undo and redo rebuild the layout and floating windows from a version,
+    // skipping widgets that were unregistered since; layout nodes still alive
+    // are reused, so their handles stay valid across undo and redo.
+    void checkpoint();
+    bool undo();
+    bool redo();
+    bool canUndo() const { return !undo_.empty(); }
+    bool canRedo() const { return !redo_.empty(); }
+    void clearHistory();
+    void setHistoryLimit(size_t limit);
+
 private:
     DockManager() = default;
     struct DragData {
@@ -195,6 +244,7 @@ private:
     bool hasDragBounds_ = false;
     DragOverlay overlay_{};
     WindowFrame* draggedFloatingWindow_ = nullptr;
+    bool floatingDragCheckpointed_ = false; // drag began in startUndockDrag, which took the checkpoint
     DFPoint dragGrabOffset_{};
     DFRect mainContainerBounds_{};
     DockLayout* mainLayout_ = nullptr;
@@ -202,21 +252,76 @@ private:
 
     struct DropCandidate {
         DragOverlay::DropZone zone = DragOverlay::DropZone::None;
-        void* target = nullptr;
+        DockNodeHandle target{};
         DFRect bounds{};
         size_t overlayIndex = 0;
         int depth = 0;
     };
     std::vector<DropCandidate> dropCandidates_;
+
+    // Drop-target geometry for the active floating drag. The docked layout
+    // does not change while a window is dragged, so it is collected once and
+    // each move only queries the grids. Rebuilt when the layout version, root
+    // container or dragged widget changes.
+    struct DropTargetCache {
+        struct TabTarget {
+            DockNodeHandle node{};
+            DFRect hint{};
+            int depth = 0;
+        };
+        struct SplitTarget {
+            DockNodeHandle node{};
+            DFRect left{};
+            DFRect right{};
+            DFRect top{};
+            DFRect bottom{};
+            int depth = 0;
+        };
+        bool valid = false;
+        const DockLayout* layout = nullptr;
+        uint64_t layoutVersion = 0;
+        const DockWidget* movingWidget = nullptr;
+        DFRect rootContainer{};
+        std::vector<TabTarget> tabTargets;
+        std::vector<SplitTarget> splitTargets;
+        DFHitGrid tabGrid;   // hint rects
+        DFHitGrid splitGrid; // node rects
+    };
+    void refreshDropTargets(const DFRect& rootContainer);
+    DropTargetCache dropTargets_;
     int highlightedCandidateIndex_ = -1;
     bool popupTraceActive_ = false;
     DragOverlay::DropZone popupTraceZone_ = DragOverlay::DropZone::None;
-    void* popupTraceTarget_ = nullptr;
+    DockNodeHandle popupTraceTarget_{};
     int popupTraceDepth_ = -1;
     float rootDockHeaderInsetPx_ = 0.0f;
     float edgeDockActivateDistancePx_ = 8.0f;
     float innerSplitSnapZonePx_ = 32.0f;
     std::vector<DockWidget*> widgets_;
+    // restoreState scratch, kept to reuse capacity: registered widgets sorted
+    // by title hash, and the widget resolved for each state string.
+    struct TitleEntry {
+        uint64_t hash;
+        DockWidget* widget;
+        bool claimed;
+    };
+    std::vector<TitleEntry> widgetsByTitle_;
+    std::vector<DockWidget*> stateWidgets_;
+
+    mutable std::mutex snapshotMutex_;
+    std::shared_ptr<const DockSnapshot> snapshot_;
+    std::vector<DockSnapshotWindow> snapshotWindows_;
+
+    std::shared_ptr<const DockSnapshot> captureHistoryState(const DockSnapshot* previous);
+    void applyHistoryState(const DockSnapshot& state);
+    void collectSnapshotWindows();
+    void detachAllWidgets();
+    std::vector<std::shared_ptr<const DockSnapshot>> undo_;
+    std::vector<std::shared_ptr<const DockSnapshot>> redo_;
+    std::shared_ptr<const DockSnapshot> historyHead_; // state last checkpointed or applied; captures share with it
+    size_t historyLimit_ = 100;
+    uint64_t historyBatchVersion_ = 0; // layout version of the checkpoint taken in the open batch
+    std::vector<DockWidget*> sortedWidgets_;
 };
 
 } // namespace df
@@ -2,8 +2,12 @@
 
 #include <memory>
 #include <algorithm>
+#include <cstddef>
+#include <new>
 #include <vector>
 #include "core_types.h"
+#include "damage_region.h"
+#include "hit_grid.h"
 #include "dock_framework.h"
 #include "dock_theme.h"
 
@@ -11,6 +15,142 @@ namespace df {
 
 class DockLayout {
 public:
+    // Per-node invalidation bits. update() only revisits nodes on a dirty path,
+    // so code that edits a laid-out tree in place must report it via MarkDirty.
+    enum DirtyFlags : uint8_t {
+        DirtyLayout = 1 << 0,     // bounds of this subtree (ratio, sizing, active tab)
+        DirtyMinSize = 1 << 1,    // widget minimum changed; refreshed up to the root
+        DirtyStructure = 1 << 2,  // children, types or widgets changed; full pass
+        DirtyDescendant = 1 << 3  // set on every ancestor of a dirty node
+    };
+
+    struct Node;
+    using NodeHandle = DockNodeHandle;
+
+    // Slot table behind NodeHandle: a node takes a slot for its lifetime and
+    // the slot's generation is bumped when it is released, so old handles
+    // stop resolving. Leaked on purpose so nodes outliving static
+    // destruction can still release their slot.
+    class NodeRegistry {
+    public:
+        static NodeRegistry& instance()
+        {
+            static NodeRegistry* registry = new NodeRegistry();
+            return *registry;
+        }
+
+        NodeHandle acquire(Node* node)
+        {
+            uint32_t index = 0;
+            if (!free_.empty()) {
+                index = free_.back();
+                free_.pop_back();
+            } else {
+                index = static_cast<uint32_t>(slots_.size());
+                slots_.push_back({});
+            }
+            slots_[index].node = node;
+            return {index, slots_[index].generation};
+        }
+
+        void release(NodeHandle handle)
+        {
+            if (resolve(handle) == nullptr) {
+                return;
+            }
+            Slot& slot = slots_[handle.index];
+            slot.node = nullptr;
+            slot.generation = (slot.generation == UINT32_MAX) ? 1u : slot.generation + 1u;
+            free_.push_back(handle.index);
+        }
+
+        Node* resolve(NodeHandle handle) const
+        {
+            if (!handle || handle.index >= slots_.size()) {
+                return nullptr;
+            }
+            const Slot& slot = slots_[handle.index];
+            return (slot.generation == handle.generation) ? slot.node : nullptr;
+        }
+
+        size_t liveCount() const { return slots_.size() - free_.size(); }
+
+    private:
+        struct Slot {
+            Node* node = nullptr;
+            uint32_t generation = 1;
+        };
+        std::vector<Slot> slots_;
+        std::vector<uint32_t> free_;
+    };
+
+    // Registry membership of one node. Move-assigning a node (collapsing a
+    // container into its survivor) keeps the destination's handle; nodes are
+    // never move-constructed.
+    class NodeIdentity {
+    public:
+        explicit NodeIdentity(Node* owner) : handle_(NodeRegistry::instance().acquire(owner)) {}
+        NodeIdentity(const NodeIdentity&) = delete;
+        NodeIdentity& operator=(NodeIdentity&&) { return *this; }
+        ~NodeIdentity() { NodeRegistry::instance().release(handle_); }
+
+        NodeHandle handle() const { return handle_; }
+
+    private:
+        NodeHandle handle_;
+    };
+
+    // Free-list pool for Node: blocks are carved from 64-node chunks, so a
+    // tree built together sits in a few contiguous runs and tree surgery
+    // recycles blocks instead of going back to the heap.
+    class NodeArena {
+    public:
+        NodeArena(size_t blockSize, size_t blockAlign)
+            : blockSize_((std::max(blockSize, sizeof(FreeBlock)) + blockAlign - 1) / blockAlign * blockAlign) {}
+
+        void* allocate()
+        {
+            if (!free_) {
+                grow();
+            }
+            FreeBlock* block = free_;
+            free_ = block->next;
+            return block;
+        }
+
+        void deallocate(void* ptr)
+        {
+            auto* block = static_cast<FreeBlock*>(ptr);
+            block->next = free_;
+            free_ = block;
+        }
+
+    private:
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        static constexpr size_t kBlocksPerChunk = 64;
+
+        void grow()
+        {
+            chunks_.push_back(std::make_unique<unsigned char[]>(blockSize_ * kBlocksPerChunk));
+            unsigned char* base = chunks_.back().get();
+            for (size_t i = kBlocksPerChunk; i-- > 0;) {
+                deallocate(base + i * blockSize_);
+            }
+        }
+
+        size_t blockSize_;
+        FreeBlock* free_ = nullptr;
+        std::vector<std::unique_ptr<unsigned char[]>> chunks_;
+    };
+
+    // Layout inputs (ratio, vertical, splitSizing, fixedSize, minFirstSize,
+    // minSecondSize, activeTab, tabBarHeight) and the child links may be
+    // edited directly, but update() does not look for such edits: report
+    // each one with MarkDirty(node, flag) for the matching DirtyFlags bit, or
+    // call invalidate() to force the full pass. An unreported edit is not
+    // laid out until something else dirties that subtree.
     struct Node {
         enum class Type { Split, Tab, Widget };
         enum class SplitSizing { Ratio, FixedFirst, FixedSecond };
@@ -36,9 +176,155 @@ public:
         float calculatedMinHeight = 120.0f;
 
         int activeTab = 0;
+        uint64_t laidOutTabKey = 0; // active tab + tab order at the last update(), for damage
         float tabBarHeight = 16.0f;
+
+        // Per-tab offsets/extents along the strip, rebuilt only when the key
+        // (strip length, text scale, title lengths) changes.
+        struct TabLayoutCache {
+            uint64_t key = 0;
+            std::vector<float> offsets;
+            std::vector<float> extents;
+        };
+        mutable TabLayoutCache tabLayout;
+
+        // Linked and cleared by update(); see MarkDirty.
+        Node* parent = nullptr;
+        uint8_t dirty = 0;
+
+        NodeIdentity identity{this};
+        NodeHandle handle() const { return identity.handle(); }
+
+        static void* operator new(size_t size)
+        {
+            return (size == sizeof(Node)) ? Arena().allocate() : ::operator new(size);
+        }
+        static void operator delete(void* ptr, size_t size)
+        {
+            if (!ptr) {
+                return;
+            }
+            if (size == sizeof(Node)) {
+                Arena().deallocate(ptr);
+            } else {
+                ::operator delete(ptr);
+            }
+        }
+
+    private:
+        static NodeArena& Arena()
+        {
+            static NodeArena* arena = new NodeArena(sizeof(Node), alignof(Node));
+            return *arena;
+        }
     };
 
+    static Node* Resolve(NodeHandle handle) { return NodeRegistry::instance().resolve(handle); }
+    static NodeHandle HandleOf(const Node* node) { return node ? node->handle() : NodeHandle{}; }
+
+    // Number of parent links between node and the root it was laid out in.
+    static int Depth(const Node* node)
+    {
+        int depth = 0;
+        for (const Node* ancestor = node ? node->parent : nullptr; ancestor; ancestor = ancestor->parent) {
+            ++depth;
+        }
+        return depth;
+    }
+
+    // The owning pointer inside node's parent, or nullptr if the parent link
+    // no longer matches the tree.
+    static std::unique_ptr<Node>* ParentSlot(Node* node)
+    {
+        Node* parent = node ? node->parent : nullptr;
+        if (!parent || parent == node) {
+            return nullptr;
+        }
+        if (parent->first.get() == node) {
+            return &parent->first;
+        }
+        if (parent->second.get() == node) {
+            return &parent->second;
+        }
+        for (auto& child : parent->children) {
+            if (child.get() == node) {
+                return &child;
+            }
+        }
+        return nullptr;
+    }
+
+    // Owning pointer of node within the tree held by root, found in O(depth)
+    // from parent links. Returns nullptr when the links are stale (the tree
+    // was edited since the last full update) so callers can fall back to a
+    // search.
+    static std::unique_ptr<Node>* OwnerSlot(std::unique_ptr<Node>& root, Node* node)
+    {
+        if (!node || !root) {
+            return nullptr;
+        }
+        if (root.get() == node) {
+            return &root;
+        }
+        std::unique_ptr<Node>* slot = ParentSlot(node);
+        if (!slot) {
+            return nullptr;
+        }
+        // Every link up to the root must still be owned by its parent.
+        for (Node* ancestor = node->parent; ancestor != root.get(); ancestor = ancestor->parent) {
+            if (!ParentSlot(ancestor)) {
+                return nullptr;
+            }
+        }
+        return slot;
+    }
+
+    static void MarkDirty(Node* node, uint8_t flags = DirtyLayout)
+    {
+        if (!node) {
+            return;
+        }
+        node->dirty |= flags;
+        const uint8_t inherited = DirtyDescendant | (flags & (DirtyMinSize | DirtyStructure));
+        for (Node* ancestor = node->parent; ancestor; ancestor = ancestor->parent) {
+            if ((ancestor->dirty & inherited) == inherited) {
+                break;
+            }
+            ancestor->dirty |= inherited;
+        }
+    }
+
+    // Widget whose title labels a tab: the active/first widget in the subtree.
+    static const DockWidget* TabLabelWidget(const Node* node)
+    {
+        if (!node) {
+            return nullptr;
+        }
+        if (node->type == Node::Type::Widget && node->widget) {
+            return node->widget;
+        }
+        if (node->type == Node::Type::Tab && !node->children.empty()) {
+            const int active = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
+            if (const DockWidget* activeWidget = TabLabelWidget(node->children[static_cast<size_t>(active)].get())) {
+                return activeWidget;
+            }
+            for (const auto& child : node->children) {
+                if (const DockWidget* widget = TabLabelWidget(child.get())) {
+                    return widget;
+                }
+            }
+        }
+        if (const DockWidget* left = TabLabelWidget(node->first.get())) {
+            return left;
+        }
+        return TabLabelWidget(node->second.get());
+    }
+
+    static float TabFontScale()
+    {
+        return std::clamp(CurrentTheme().tabFontScale, 0.3f, 2.0f);
+    }
+
     static bool UseVerticalTabStrip(const Node& node, const DFRect& bounds)
     {
         if (node.type != Node::Type::Tab) {
@@ -81,19 +367,21 @@ public:
         const float leading = verticalStrip ? 3.0f : 1.0f;
         const float gap = verticalStrip ? 2.0f : 1.0f;
         const float available = std::max(0.0f, axisLength - (leading * 2.0f) - gap * static_cast<float>(tabCount > 0 ? tabCount - 1 : 0));
-        const float fitExtent = (tabCount > 0) ? (available / static_cast<float>(tabCount)) : 0.0f;
-        const float preferredExtent = verticalStrip ? 84.0f : 84.0f;
-        const float minExtent = verticalStrip ? 24.0f : 52.0f;
 
-        float extent = preferredExtent;
-        if (fitExtent < minExtent) {
-            extent = std::max(1.0f, fitExtent);
+        float offset = 0.0f;
+        float extent = 0.0f;
+        if (tabCount == node.children.size()) {
+            const Node::TabLayoutCache& layout = TabLayout(node, verticalStrip, available, gap);
+            offset = layout.offsets[index];
+            extent = layout.extents[index];
         } else {
-            extent = std::clamp(preferredExtent, minExtent, fitExtent);
+            const float fitExtent = available / static_cast<float>(tabCount);
+            const float minExtent = verticalStrip ? 24.0f : 52.0f;
+            extent = (fitExtent < minExtent) ? std::max(1.0f, fitExtent) : std::clamp(84.0f, minExtent, fitExtent);
+            offset = static_cast<float>(index) * (extent + gap);
         }
 
-        const float axisStart = (verticalStrip ? strip.y : strip.x) + leading +
-            static_cast<float>(index) * (extent + gap);
+        const float axisStart = (verticalStrip ? strip.y : strip.x) + leading + offset;
         const float axisEnd = std::min(
             verticalStrip ? (strip.y + strip.height) : (strip.x + strip.width),
             axisStart + extent);
@@ -128,8 +416,33 @@ public:
         return 2.0f;
     }
 
+    // Unchanged trees return immediately. Layout bits re-lay out the marked
+    // subtrees only, minimum-size bits recompute minimums along their path,
+    // and structural changes (or a new root, or a theme tab height change)
+    // fall back to the full normalize/rebuild pass. Only edits reported
+    // through MarkDirty() or invalidate() are seen (see Node); DockLayout's
+    // own edits, DockSplitter drags and DockWidget minimum setters report
+    // themselves.
     void update(const DFRect& containerBounds) {
-        if (!root_) return;
+        if (!root_ || batchDepth_ > 0) return;
+        const bool boundsChanged =
+            containerBounds.x != laidOutBounds_.x || containerBounds.y != laidOutBounds_.y ||
+            containerBounds.width != laidOutBounds_.width || containerBounds.height != laidOutBounds_.height;
+        if (!structureDirty_ && !(root_->dirty & DirtyStructure) && laidOutTabBarHeight_ == ThemeTabBarHeight()) {
+            if (!boundsChanged && root_->dirty == 0) {
+                return;
+            }
+            refreshMinSizes(root_.get());
+            if (boundsChanged) {
+                updateNode(root_.get(), containerBounds);
+            } else {
+                relayoutDirty(root_.get());
+            }
+            laidOutBounds_ = containerBounds;
+            ++version_;
+            return;
+        }
+
         normalizeNode(root_);
         if (!root_) return;
 
@@ -143,14 +456,309 @@ public:
         // based on the actual content hierarchy.
         recalculateMinSizes(root_.get());
 
+        linkParents(root_.get(), nullptr);
         updateNode(root_.get(), containerBounds);
+        ++stats_.fullPasses;
+        structureDirty_ = false;
+        laidOutBounds_ = containerBounds;
+        laidOutTabBarHeight_ = ThemeTabBarHeight();
+        ++version_;
+    }
+
+    // Forces the next update() to run the full pass. The catch-all for
+    // callers that edit Node fields directly and do not mark what changed.
+    void invalidate()
+    {
+        structureDirty_ = true;
+        ++version_;
     }
 
-    void setRoot(std::unique_ptr<Node> root) { root_ = std::move(root); }
-    std::unique_ptr<Node> takeRoot() { return std::move(root_); }
+    // Bumped by every update() that moves something and by tree replacement.
+    uint64_t version() const { return version_; }
+
+    // Work done by update(), cumulative until resetStats(); read by dock_bench.
+    struct Stats {
+        uint64_t fullPasses = 0;
+        uint64_t nodesLaidOut = 0;
+        uint64_t minSizeNodes = 0;
+    };
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = {}; }
+
+    // Point queries against the laid-out tree. Both go through grids rebuilt
+    // lazily once per version and try the previous hit first, which is the
+    // usual answer for consecutive mouse moves.
+    // Widget leaf whose widget bounds contain p.
+    Node* widgetNodeAt(const DFPoint& p) const
+    {
+        refreshHitIndex();
+        return hitTest(leafGrid_, leafHits_, lastLeafHit_, p, [](const Node& node) { return node.widget ? node.widget->bounds() : DFRect{}; });
+    }
+    // Tab container whose tab strip contains p.
+    Node* tabNodeAt(const DFPoint& p) const
+    {
+        refreshHitIndex();
+        return hitTest(stripGrid_, stripHits_, lastStripHit_, p, [](const Node& node) { return TabStripRect(node, node.bounds); });
+    }
+
+    // Receives old and new bounds of leaves and tab stacks that move, and the
+    // strip of tab stacks whose active tab or tab order changes, during update().
+    void setDamageRegion(DFDamageRegion* damage) { damage_ = damage; }
+
+    void setRoot(std::unique_ptr<Node> root)
+    {
+        root_ = std::move(root);
+        structureDirty_ = true;
+        ++version_;
+    }
+    std::unique_ptr<Node> takeRoot()
+    {
+        structureDirty_ = true;
+        ++version_;
+        return std::move(root_);
+    }
     Node* root() const { return root_.get(); }
 
+    // Structural edits. Inside beginBatch()/commit() a removal leaves an
+    // empty slot behind and an insertion links its new nodes, so parent links
+    // stay valid and each edit costs O(depth) instead of a tree walk and a
+    // normalize. commit() normalizes once and the next update() runs one full
+    // pass; update() does nothing while a batch is open. Batches nest, and an
+    // edit made outside a batch commits immediately.
+    void beginBatch()
+    {
+        if (batchDepth_++ == 0) {
+            // Links may predate setRoot() or direct edits.
+            linkParents(root_.get(), nullptr, false);
+        }
+    }
+    void commit()
+    {
+        if (batchDepth_ == 0 || --batchDepth_ > 0 || !batchEdited_) {
+            return;
+        }
+        batchEdited_ = false;
+        normalizeNode(root_);
+        // Normalizing hoists children out of collapsed nodes, whose blocks go
+        // back to the arena; relink now so MarkDirty and the slot lookups
+        // never follow a stale parent before the next update().
+        linkParents(root_.get(), nullptr, false);
+        structureDirty_ = true;
+        ++version_;
+    }
+    bool inBatch() const { return batchDepth_ > 0; }
+
+    // Detaches widget's leaf; the leaf is handed to extracted when given.
+    bool removeWidget(DockWidget* widget, std::unique_ptr<Node>* extracted = nullptr)
+    {
+        beginBatch();
+        std::unique_ptr<Node>* slot = widget ? widgetSlot(widget) : nullptr;
+        if (slot) {
+            std::unique_ptr<Node> leaf = std::move(*slot);
+            leaf->parent = nullptr;
+            widget->layoutNode_ = {};
+            if (extracted) {
+                *extracted = std::move(leaf);
+            }
+            batchEdited_ = true;
+        }
+        commit();
+        return slot != nullptr;
+    }
+
+    // Docks widget relative to target (the root when null). Tab and Center
+    // join target's tab stack, wrapping target in one if needed; edge zones
+    // split target with the widget on that side.
+    bool insertWidget(DockWidget* widget, Node* target, DragOverlay::DropZone zone)
+    {
+        if (!widget || zone == DragOverlay::DropZone::None) {
+            return false;
+        }
+        beginBatch();
+        auto leaf = std::make_unique<Node>();
+        leaf->type = Node::Type::Widget;
+        leaf->widget = widget;
+        widget->layoutNode_ = leaf->handle();
+        batchEdited_ = true;
+
+        std::unique_ptr<Node>* targetSlot = target ? nodeSlot(target) : nullptr;
+        if (!root_) {
+            root_ = std::move(leaf);
+        } else if (zone == DragOverlay::DropZone::Tab || zone == DragOverlay::DropZone::Center) {
+            // A leaf that already sits in a tab stack joins that stack rather
+            // than nesting a new one.
+            Node* stack = nullptr;
+            if (targetSlot && ParentSlot(target) == targetSlot && target->parent->type == Node::Type::Tab) {
+                stack = target->parent;
+            } else if (targetSlot && target->type == Node::Type::Tab) {
+                stack = target;
+            }
+            if (stack) {
+                leaf->parent = stack;
+                stack->children.push_back(std::move(leaf));
+                stack->activeTab = static_cast<int>(stack->children.size()) - 1;
+            } else {
+                auto tabs = std::make_unique<Node>();
+                tabs->type = Node::Type::Tab;
+                tabs->tabBarHeight = ThemeTabBarHeight();
+                tabs->activeTab = 1;
+                wrapSlot(targetSlot ? *targetSlot : root_, std::move(tabs), std::move(leaf), false);
+            }
+        } else {
+            auto split = std::make_unique<Node>();
+            split->type = Node::Type::Split;
+            split->vertical = (zone == DragOverlay::DropZone::Left || zone == DragOverlay::DropZone::Right);
+            split->minFirstSize = 120.0f;
+            split->minSecondSize = 120.0f;
+            const bool leafFirst = (zone == DragOverlay::DropZone::Left || zone == DragOverlay::DropZone::Top);
+            split->ratio = leafFirst ? 0.25f : 0.75f;
+            wrapSlot(targetSlot ? *targetSlot : root_, std::move(split), std::move(leaf), leafFirst);
+        }
+        commit();
+        return true;
+    }
+
 private:
+    // Replaces slot's subtree with wrapper holding that subtree and leaf: as
+    // tabs [subtree, leaf], or as split children in the requested order.
+    static void wrapSlot(std::unique_ptr<Node>& slot, std::unique_ptr<Node> wrapper, std::unique_ptr<Node> leaf, bool leafFirst)
+    {
+        std::unique_ptr<Node> existing = std::move(slot);
+        wrapper->parent = existing->parent;
+        existing->parent = wrapper.get();
+        leaf->parent = wrapper.get();
+        if (wrapper->type == Node::Type::Tab) {
+            wrapper->children.push_back(std::move(existing));
+            wrapper->children.push_back(std::move(leaf));
+        } else if (leafFirst) {
+            wrapper->first = std::move(leaf);
+            wrapper->second = std::move(existing);
+        } else {
+            wrapper->first = std::move(existing);
+            wrapper->second = std::move(leaf);
+        }
+        slot = std::move(wrapper);
+    }
+
+    // Owning slot of node via parent links, searching the tree if they are stale.
+    std::unique_ptr<Node>* nodeSlot(Node* node)
+    {
+        if (std::unique_ptr<Node>* slot = OwnerSlot(root_, node)) {
+            return slot;
+        }
+        return searchSlot(root_, [node](const Node& candidate) { return &candidate == node; });
+    }
+
+    std::unique_ptr<Node>* widgetSlot(const DockWidget* widget)
+    {
+        Node* leaf = Resolve(widget->layoutNode());
+        if (leaf && leaf->type == Node::Type::Widget && leaf->widget == widget) {
+            if (std::unique_ptr<Node>* slot = OwnerSlot(root_, leaf)) {
+                return slot;
+            }
+        }
+        return searchSlot(root_, [widget](const Node& candidate) {
+            return candidate.type == Node::Type::Widget && candidate.widget == widget;
+        });
+    }
+
+    template <typename Match>
+    static std::unique_ptr<Node>* searchSlot(std::unique_ptr<Node>& slot, const Match& match)
+    {
+        if (!slot) {
+            return nullptr;
+        }
+        if (match(*slot)) {
+            return &slot;
+        }
+        if (std::unique_ptr<Node>* found = searchSlot(slot->first, match)) {
+            return found;
+        }
+        if (std::unique_ptr<Node>* found = searchSlot(slot->second, match)) {
+            return found;
+        }
+        for (auto& child : slot->children) {
+            if (std::unique_ptr<Node>* found = searchSlot(child, match)) {
+                return found;
+            }
+        }
+        return nullptr;
+    }
+
+    // Tabs are sized to their titles (label padding included) between a minimum
+    // and maximum extent. When the strip is too short, the widest tabs shrink
+    // first; if even minimums do not fit, all tabs share the space equally.
+    static const Node::TabLayoutCache& TabLayout(const Node& node, bool verticalStrip, float available, float gap)
+    {
+        const size_t count = node.children.size();
+        const float fontScale = TabFontScale();
+        const float advance = verticalStrip
+            ? std::max(3.0f, DFGlyphAdvancePx(fontScale) * 0.9f)
+            : DFGlyphAdvancePx(fontScale);
+
+        uint64_t key = 1469598103934665603ull;
+        auto mix = [&key](uint64_t value) {
+            key = (key ^ value) * 1099511628211ull;
+        };
+        mix(count);
+        mix(verticalStrip ? 1u : 0u);
+        mix(static_cast<uint64_t>(available * 16.0f));
+        mix(static_cast<uint64_t>(advance * 256.0f));
+        for (const auto& child : node.children) {
+            const DockWidget* widget = TabLabelWidget(child.get());
+            mix(widget ? widget->title().size() : 3u);
+        }
+
+        Node::TabLayoutCache& cache = node.tabLayout;
+        if (cache.key == key && cache.extents.size() == count) {
+            return cache;
+        }
+        cache.key = key;
+        cache.offsets.resize(count);
+        cache.extents.resize(count);
+
+        const float minExtent = verticalStrip ? 24.0f : 52.0f;
+        const float maxExtent = verticalStrip ? 160.0f : 220.0f;
+        const float padding = verticalStrip ? 8.0f : 25.0f;
+        float desiredTotal = 0.0f;
+        float desiredMax = minExtent;
+        for (size_t i = 0; i < count; ++i) {
+            const DockWidget* widget = TabLabelWidget(node.children[i].get());
+            const float chars = static_cast<float>(widget ? widget->title().size() : 3u);
+            const float desired = std::clamp(chars * advance + padding, minExtent, maxExtent);
+            cache.extents[i] = desired;
+            desiredTotal += desired;
+            desiredMax = std::max(desiredMax, desired);
+        }
+
+        const float fitExtent = available / static_cast<float>(count);
+        if (fitExtent < minExtent) {
+            std::fill(cache.extents.begin(), cache.extents.end(), std::max(1.0f, fitExtent));
+        } else if (desiredTotal > available) {
+            // Find the cap c with sum(min(desired, c)) == available.
+            float lo = minExtent;
+            float hi = desiredMax;
+            for (int iter = 0; iter < 24; ++iter) {
+                const float mid = (lo + hi) * 0.5f;
+                float total = 0.0f;
+                for (float desired : cache.extents) {
+                    total += std::min(desired, mid);
+                }
+                (total > available ? hi : lo) = mid;
+            }
+            for (float& extent : cache.extents) {
+                extent = std::min(extent, lo);
+            }
+        }
+
+        float offset = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            cache.offsets[i] = offset;
+            offset += cache.extents[i] + gap;
+        }
+        return cache;
+    }
+
     void ensureTabContainers(std::unique_ptr<Node>& node, bool insideTab)
     {
         if (!node) {
@@ -188,7 +796,40 @@ private:
 
     void recalculateMinSizes(Node* node) {
         if (!node) return;
+        recalculateMinSizes(node->first.get());
+        recalculateMinSizes(node->second.get());
+        for (const auto& child : node->children) {
+            recalculateMinSizes(child.get());
+        }
+        computeMinSizes(node);
+    }
+
+    // Recomputes minimums along DirtyMinSize paths. A node whose children's
+    // minimums moved must re-lay out its subtree; returns whether this
+    // node's own minimum changed.
+    bool refreshMinSizes(Node* node)
+    {
+        if (!node || !(node->dirty & DirtyMinSize)) {
+            return false;
+        }
+        node->dirty &= static_cast<uint8_t>(~DirtyMinSize);
+        bool childChanged = refreshMinSizes(node->first.get());
+        childChanged = refreshMinSizes(node->second.get()) || childChanged;
+        for (const auto& child : node->children) {
+            childChanged = refreshMinSizes(child.get()) || childChanged;
+        }
+        const float oldWidth = node->calculatedMinWidth;
+        const float oldHeight = node->calculatedMinHeight;
+        computeMinSizes(node);
+        if (childChanged) {
+            node->dirty |= DirtyLayout;
+        }
+        return oldWidth != node->calculatedMinWidth || oldHeight != node->calculatedMinHeight;
+    }
 
+    // Minimums of one node from its children's already computed minimums.
+    void computeMinSizes(Node* node) {
+        ++stats_.minSizeNodes;
         // Fallback when a widget does not provide an explicit minimum.
         const float defaultMin = 120.0f;
         const float splitterThickness = SplitterGapPx();
@@ -213,7 +854,6 @@ private:
             for (const auto& child : node->children) {
                 if (child) {
                     hasChild = true;
-                    recalculateMinSizes(child.get());
                     maxW = std::max(maxW, child->calculatedMinWidth);
                     maxH = std::max(maxH, child->calculatedMinHeight);
                 }
@@ -229,9 +869,6 @@ private:
         }
 
         case Node::Type::Split: {
-            recalculateMinSizes(node->first.get());
-            recalculateMinSizes(node->second.get());
-
             const float w1 = node->first ? node->first->calculatedMinWidth : 0.0f;
             const float h1 = node->first ? node->first->calculatedMinHeight : 0.0f;
             const float w2 = node->second ? node->second->calculatedMinWidth : 0.0f;
@@ -361,7 +998,51 @@ private:
         markTabified(node->second.get(), tabified);
     }
 
+    void linkParents(Node* node, Node* parent, bool clearDirty = true)
+    {
+        if (!node) {
+            return;
+        }
+        node->parent = parent;
+        if (clearDirty) {
+            node->dirty = 0;
+        }
+        linkParents(node->first.get(), node, clearDirty);
+        linkParents(node->second.get(), node, clearDirty);
+        for (auto& child : node->children) {
+            linkParents(child.get(), node, clearDirty);
+        }
+    }
+
+    // Follows DirtyDescendant bits down to DirtyLayout subtrees, which are
+    // laid out again inside their current bounds.
+    void relayoutDirty(Node* node)
+    {
+        if (!node || node->dirty == 0) {
+            return;
+        }
+        if (node->dirty & DirtyLayout) {
+            updateNode(node, node->bounds);
+            return;
+        }
+        node->dirty = 0;
+        relayoutDirty(node->first.get());
+        relayoutDirty(node->second.get());
+        for (auto& child : node->children) {
+            relayoutDirty(child.get());
+        }
+    }
+
     void updateNode(Node* node, const DFRect& bounds) {
+        ++stats_.nodesLaidOut;
+        node->dirty = 0;
+        if (damage_ && node->type != Node::Type::Split) {
+            const DFRect& old = node->bounds;
+            if (old.x != bounds.x || old.y != bounds.y || old.width != bounds.width || old.height != bounds.height) {
+                damage_->add(old);
+                damage_->add(bounds);
+            }
+        }
         node->bounds = bounds;
         switch (node->type) {
         case Node::Type::Split: {
@@ -449,6 +1130,20 @@ private:
                 };
             const int active = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
             node->activeTab = active;
+            if (damage_) {
+                uint64_t key = 1469598103934665603ull;
+                auto mix = [&key](uint64_t value) {
+                    key = (key ^ value) * 1099511628211ull;
+                };
+                mix(static_cast<uint64_t>(active));
+                for (const auto& child : node->children) {
+                    mix(reinterpret_cast<uintptr_t>(TabLabelWidget(child.get())));
+                }
+                if (key != node->laidOutTabKey) {
+                    damage_->add(strip);
+                }
+                node->laidOutTabKey = key;
+            }
             for (size_t i = 0; i < node->children.size(); ++i) {
                 if (!node->children[i]) {
                     continue;
@@ -462,12 +1157,93 @@ private:
             break;
         }
         case Node::Type::Widget:
-            if (node->widget) node->widget->setBounds(bounds);
+            if (node->widget) {
+                node->widget->setBounds(bounds);
+                node->widget->layoutNode_ = node->handle();
+            }
             break;
         }
     }
 
+    void refreshHitIndex() const
+    {
+        if (indexedVersion_ == version_) {
+            return;
+        }
+        indexedVersion_ = version_;
+        leafGrid_.clear();
+        stripGrid_.clear();
+        leafHits_.clear();
+        stripHits_.clear();
+        lastLeafHit_ = DFHitGrid::kNone;
+        lastStripHit_ = DFHitGrid::kNone;
+        collectHitRects(root_.get());
+        leafGrid_.build();
+        stripGrid_.build();
+    }
+
+    // Pre-order, matching the recursive walks the grids replace.
+    void collectHitRects(const Node* node) const
+    {
+        if (!node) {
+            return;
+        }
+        if (node->type == Node::Type::Widget && node->widget) {
+            const DFRect& bounds = node->widget->bounds();
+            if (bounds.width > 1.0f && bounds.height > 1.0f) {
+                leafGrid_.add(bounds, static_cast<uint32_t>(leafHits_.size()));
+                leafHits_.push_back(node->handle());
+            }
+        }
+        if (node->type == Node::Type::Tab && !node->children.empty()) {
+            const DFRect strip = TabStripRect(*node, node->bounds);
+            if (strip.width > 1.0f && strip.height > 1.0f) {
+                stripGrid_.add(strip, static_cast<uint32_t>(stripHits_.size()));
+                stripHits_.push_back(node->handle());
+            }
+        }
+        collectHitRects(node->first.get());
+        collectHitRects(node->second.get());
+        for (const auto& child : node->children) {
+            collectHitRects(child.get());
+        }
+    }
+
+    // Handles keep an index entry whose node was freed by an in-place edit
+    // from being dereferenced; such entries simply miss.
+    template <typename RectOf>
+    static Node* hitTest(const DFHitGrid& grid, const std::vector<NodeHandle>& hits, uint32_t& last, const DFPoint& p, RectOf rectOf)
+    {
+        if (last != DFHitGrid::kNone) {
+            if (Node* node = Resolve(hits[last]); node && rectOf(*node).contains(p)) {
+                return node;
+            }
+        }
+        const uint32_t found = grid.find(p, [&hits](uint32_t id) { return Resolve(hits[id]) != nullptr; });
+        if (found == DFHitGrid::kNone) {
+            return nullptr;
+        }
+        last = found;
+        return Resolve(hits[found]);
+    }
+
     std::unique_ptr<Node> root_;
+    DFDamageRegion* damage_ = nullptr;
+    bool structureDirty_ = true;
+    DFRect laidOutBounds_{};
+    float laidOutTabBarHeight_ = 0.0f;
+    uint64_t version_ = 1;
+    Stats stats_;
+    int batchDepth_ = 0;
+    bool batchEdited_ = false;
+
+    mutable uint64_t indexedVersion_ = 0;
+    mutable DFHitGrid leafGrid_;
+    mutable DFHitGrid stripGrid_;
+    mutable std::vector<NodeHandle> leafHits_;
+    mutable std::vector<NodeHandle> stripHits_;
+    mutable uint32_t lastLeafHit_ = DFHitGrid::kNone;
+    mutable uint32_t lastStripHit_ = DFHitGrid::kNone;
 };
 
 } // namespace df
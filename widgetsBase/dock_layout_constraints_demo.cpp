@@ -1,67 +1,51 @@
 #include "dock_layout.h"
+#include "dock_snapshot.h"
 #include "dock_splitter.h"
+#include "dock_state.h"
 #include "dock_widget_impl.h"
+#include "test_support.h"
+#include "window_manager.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <set>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 
 class MinSizedContent final : public Widget {
 public:
     MinSizedContent(float minWidth, float minHeight)
         : min_{std::max(0.0f, minWidth), std::max(0.0f, minHeight)} {}
 
-    DFSize minimumSize() const override { return min_; }
-
-private:
-    DFSize min_{};
-};
-
-class CheckSuite {
-public:
-    void expect(bool condition, const std::string& label)
+    DFSize minimumSize() const override
     {
-        if (condition) {
-            ++passed_;
-            std::cout << "[PASS] " << label << "\n";
-            return;
-        }
-        ++failed_;
-        std::cout << "[FAIL] " << label << "\n";
+        ++queries;
+        return min_;
     }
 
-    void expectNear(float actual, float expected, float epsilon, const std::string& label)
-    {
-        std::ostringstream oss;
-        oss << label << " actual=" << actual << " expected=" << expected << " eps=" << epsilon;
-        expect(std::fabs(actual - expected) <= epsilon, oss.str());
-    }
+    void setMinimum(float minWidth, float minHeight) { min_ = {minWidth, minHeight}; }
 
-    int failed() const { return failed_; }
-    int passed() const { return passed_; }
+    mutable int queries = 0;
 
 private:
-    int passed_ = 0;
-    int failed_ = 0;
+    DFSize min_{};
 };
 
-std::unique_ptr<df::DockLayout::Node> makeLeaf(df::DockWidget* widget)
-{
-    auto node = std::make_unique<df::DockLayout::Node>();
-    node->type = df::DockLayout::Node::Type::Widget;
-    node->widget = widget;
-    return node;
-}
-
 int main()
 {
     CheckSuite checks;
 
     auto hierarchy = std::make_unique<df::BasicDockWidget>("Hierarchy");
-    hierarchy->setContent(std::make_unique<MinSizedContent>(260.0f, 220.0f));
+    auto hierarchyContent = std::make_unique<MinSizedContent>(260.0f, 220.0f);
+    auto* hierarchyMin = hierarchyContent.get();
+    hierarchy->setContent(std::move(hierarchyContent));
 
     auto viewport = std::make_unique<df::BasicDockWidget>("Viewport");
     viewport->setContent(std::make_unique<MinSizedContent>(480.0f, 280.0f));
@@ -133,17 +117,21 @@ int main()
     // Root ratio requests 15% width, but content minimum clamps it to 260.
     checks.expectNear(rootNode->first->bounds.width, 260.0f, 0.6f, "initial left width clamps to min");
 
-    // Fixed sizing modes must still obey dynamically propagated minimums.
+    // Fixed sizing modes must still obey dynamically propagated minimums. A
+    // direct edit followed by invalidate() still gets the full pass.
     bottomNode->splitSizing = df::DockLayout::Node::SplitSizing::FixedFirst;
     bottomNode->fixedSize = 10.0f;
+    layout.invalidate();
     layout.update(wideBounds);
     checks.expectNear(bottomNode->first->bounds.width, 300.0f, 0.6f, "FixedFirst clamped to child minimum");
 
     bottomNode->splitSizing = df::DockLayout::Node::SplitSizing::FixedSecond;
     bottomNode->fixedSize = 40.0f;
+    df::DockLayout::MarkDirty(bottomNode);
     layout.update(wideBounds);
     checks.expectNear(bottomNode->second->bounds.width, 260.0f, 0.6f, "FixedSecond clamped to child minimum");
     bottomNode->splitSizing = df::DockLayout::Node::SplitSizing::Ratio;
+    df::DockLayout::MarkDirty(bottomNode);
 
     // Drag root splitter beyond both extremes and verify clamping against propagated minima.
     df::DockSplitter splitters;
@@ -192,12 +180,708 @@ int main()
 
     // Stacked tab containers keep both children visible and sum vertical requirements.
     topTabsNode->activeTab = 1;
+    df::DockLayout::MarkDirty(topTabsNode);
     layout.update(wideBounds);
     checks.expectNear(topTabsNode->calculatedMinWidth, 480.0f, 0.6f, "tab min width uses largest child");
     checks.expectNear(topTabsNode->calculatedMinHeight, 588.0f, 0.6f, "tab min height stacks children");
     checks.expect(viewportLeafNode->bounds.width > 1.0f, "first stacked child visible");
     checks.expect(sceneLeafNode->bounds.width > 1.0f, "second stacked child visible");
 
+    // Incremental update: an unchanged tree does no work, a splitter drag only
+    // re-lays out its own split, and minimum changes mark their own path.
+    {
+        const int queriesBefore = hierarchyMin->queries;
+        layout.update(wideBounds);
+        checks.expect(hierarchyMin->queries == queriesBefore, "unchanged layout skips minimum queries");
+
+        splitters.updateSplitters(layout.root(), wideBounds);
+        const DFRect hierarchyBounds = rootNode->first->bounds;
+        const DFPoint bottomGrab{
+            bottomNode->first->bounds.x + bottomNode->first->bounds.width + 1.0f,
+            bottomNode->bounds.y + 20.0f
+        };
+        auto* bottomSplitter = splitters.splitterAtPoint(bottomGrab);
+        checks.expect(bottomSplitter && bottomSplitter->node == bottomNode, "bottom splitter hit test");
+        if (bottomSplitter) {
+            const float consoleX = bottomNode->second->bounds.x;
+            splitters.startDrag(bottomSplitter, bottomGrab);
+            splitters.updateDrag({bottomGrab.x + 60.0f, bottomGrab.y});
+            splitters.endDrag();
+            checks.expect(bottomNode->dirty != 0 && rootNode->dirty == df::DockLayout::DirtyDescendant,
+                          "splitter drag marks its split and flags ancestors");
+            layout.update(wideBounds);
+            checks.expectNear(bottomNode->second->bounds.x, consoleX + 60.0f, 0.6f, "dragged split re-laid out");
+            checks.expect(hierarchyMin->queries == queriesBefore, "splitter drag skips minimum queries");
+            checks.expect(rootNode->first->bounds.width == hierarchyBounds.width && rootNode->dirty == 0,
+                          "splitter drag leaves other subtrees alone");
+        }
+
+        hierarchy->setMinimumSize(300.0f, 220.0f);
+        layout.update(wideBounds);
+        checks.expectNear(rootNode->minFirstSize, 300.0f, 0.6f, "setMinimumSize reaches the root split");
+        checks.expect(rootNode->first->bounds.width >= 299.4f, "setMinimumSize re-lays out the split");
+
+        layout.setRoot(layout.takeRoot());
+        layout.update(wideBounds);
+        checks.expect(hierarchyMin->queries > queriesBefore, "new root runs the full pass");
+    }
+
+    // Nodes hand out generational handles: a handle stops resolving once its
+    // node is freed, even after the slot is reused, and parent links give
+    // O(depth) ownership lookups.
+    {
+        checks.expect(df::DockLayout::Resolve(viewport->layoutNode()) == viewportLeafNode, "widget handle resolves to its leaf");
+        checks.expect(df::DockLayout::Depth(viewportLeafNode) == 3 && df::DockLayout::Depth(rootNode) == 0,
+                      "depth follows parent links");
+
+        std::unique_ptr<df::DockLayout::Node> taken = layout.takeRoot();
+        checks.expect(df::DockLayout::OwnerSlot(taken, bottomNode) == &rightNode->second, "owner slot from parent links");
+        std::unique_ptr<df::DockLayout::Node> detached = std::move(rightNode->second);
+        checks.expect(df::DockLayout::OwnerSlot(taken, detached->first.get()) == nullptr, "detached subtree has no owner slot");
+        rightNode->second = std::move(detached);
+        layout.setRoot(std::move(taken));
+        layout.update(wideBounds);
+
+        const size_t liveBefore = df::DockLayout::NodeRegistry::instance().liveCount();
+        auto temp = std::make_unique<df::DockLayout::Node>();
+        const df::DockLayout::NodeHandle tempHandle = temp->handle();
+        checks.expect(df::DockLayout::Resolve(tempHandle) == temp.get(), "live handle resolves");
+        checks.expect(df::DockLayout::NodeRegistry::instance().liveCount() == liveBefore + 1, "node holds a registry slot");
+        temp.reset();
+        checks.expect(df::DockLayout::Resolve(tempHandle) == nullptr, "freed node handle is stale");
+        auto reused = std::make_unique<df::DockLayout::Node>();
+        checks.expect(reused->handle().index == tempHandle.index && reused->handle() != tempHandle &&
+                          df::DockLayout::Resolve(tempHandle) == nullptr,
+                      "reused slot bumps the generation");
+        reused.reset();
+        checks.expect(df::DockLayout::NodeRegistry::instance().liveCount() == liveBefore, "freed nodes release their slot");
+
+        // A split freed mid-drag ends the drag instead of writing through it.
+        df::BasicDockWidget left("Left");
+        df::BasicDockWidget rightWidget("Right");
+        auto split = std::make_unique<df::DockLayout::Node>();
+        split->type = df::DockLayout::Node::Type::Split;
+        split->first = makeLeaf(&left);
+        split->second = makeLeaf(&rightWidget);
+        df::DockLayout small;
+        small.setRoot(std::move(split));
+        const DFRect smallBounds{0.0f, 0.0f, 600.0f, 300.0f};
+        small.update(smallBounds);
+        df::DockSplitter smallSplitters;
+        smallSplitters.updateSplitters(small.root(), smallBounds);
+        const DFPoint grab{small.root()->first->bounds.x + small.root()->first->bounds.width + 1.0f, 100.0f};
+        if (auto* s = smallSplitters.splitterAtPoint(grab)) {
+            smallSplitters.startDrag(s, grab);
+        }
+        checks.expect(smallSplitters.isDragging(), "drag starts on split");
+        small.takeRoot().reset();
+        checks.expect(df::DockLayout::Resolve(left.layoutNode()) == nullptr, "freed leaf handle is stale");
+        smallSplitters.updateDrag({grab.x + 40.0f, grab.y});
+        checks.expect(!smallSplitters.isDragging(), "stale split ends the drag");
+    }
+
+    // Point queries go through grids rebuilt once per layout version.
+    {
+        layout.update(wideBounds);
+        const DFRect consoleBounds = console->bounds();
+        const DFPoint inConsole{consoleBounds.x + consoleBounds.width * 0.5f, consoleBounds.y + consoleBounds.height * 0.5f};
+        const df::DockLayout::Node* consoleLeaf = layout.widgetNodeAt(inConsole);
+        checks.expect(consoleLeaf && consoleLeaf->widget == console.get(), "widget hit test finds the leaf under the point");
+        checks.expect(layout.widgetNodeAt(inConsole) == consoleLeaf, "repeated widget hit test is stable");
+        const DFRect strip = df::DockLayout::TabStripRect(*topTabsNode, topTabsNode->bounds);
+        checks.expect(layout.tabNodeAt({strip.x + 4.0f, strip.y + strip.height * 0.5f}) == topTabsNode, "tab strip hit test");
+        checks.expect(layout.tabNodeAt(inConsole) == nullptr, "no tab strip under a plain leaf");
+        checks.expect(layout.widgetNodeAt({wideBounds.width + 50.0f, 10.0f}) == nullptr, "point outside the layout misses");
+
+        const uint64_t versionBefore = layout.version();
+        bottomNode->ratio = 0.7f;
+        df::DockLayout::MarkDirty(bottomNode);
+        layout.update(wideBounds);
+        const DFPoint oldConsoleEdge{consoleBounds.x + 4.0f, inConsole.y};
+        const df::DockLayout::Node* movedHit = layout.widgetNodeAt(oldConsoleEdge);
+        checks.expect(layout.version() != versionBefore && movedHit && movedHit->widget == inspector.get(),
+                      "hit index follows a re-laid-out split");
+    }
+
+    // Floating-drag drop targets are collected once per drag and follow a
+    // layout version change.
+    {
+        auto& mgr = df::DockManager::instance();
+        auto& wm = df::WindowManager::instance();
+        df::BasicDockWidget floater("Floater");
+        layout.update(wideBounds);
+        mgr.setMainLayout(&layout, wideBounds);
+        df::WindowFrame* frame = wm.createFloatingWindow(&floater, {900.0f, 100.0f, 220.0f, 160.0f});
+        mgr.startFloatingDrag(frame, {910.0f, 110.0f});
+
+        auto leftZonePoint = [&]() {
+            const DFRect b = console->bounds();
+            return DFPoint{b.x + 6.0f, b.y + b.height * 0.5f};
+        };
+        const DFPoint before = leftZonePoint();
+        mgr.updateFloatingDrag(before);
+        checks.expect(mgr.overlay().findZone(before) == df::DragOverlay::DropZone::Left, "drag finds the left split zone");
+        mgr.updateFloatingDrag({before.x + 200.0f, before.y});
+        mgr.updateFloatingDrag(before);
+        checks.expect(mgr.overlay().findZone(before) == df::DragOverlay::DropZone::Left, "cached targets answer repeated moves");
+
+        bottomNode->ratio = 0.3f;
+        df::DockLayout::MarkDirty(bottomNode);
+        layout.update(wideBounds);
+        const DFPoint after = leftZonePoint();
+        mgr.updateFloatingDrag(after);
+        checks.expect(after.x < before.x - 40.0f && mgr.overlay().findZone(after) == df::DragOverlay::DropZone::Left,
+                      "drop targets rebuilt after the layout changed");
+
+        mgr.cancelFloatingDrag();
+        wm.destroyWindow(frame);
+        mgr.setMainLayout(nullptr, {});
+    }
+
+    // Batched edits leave empty slots until commit(), which normalizes once;
+    // the next update() is a single full pass.
+    {
+        std::vector<std::unique_ptr<df::BasicDockWidget>> panels;
+        auto batchRoot = std::make_unique<df::DockLayout::Node>();
+        batchRoot->type = df::DockLayout::Node::Type::Split;
+        batchRoot->first = std::make_unique<df::DockLayout::Node>();
+        batchRoot->second = std::make_unique<df::DockLayout::Node>();
+        for (auto* stack : {batchRoot->first.get(), batchRoot->second.get()}) {
+            stack->type = df::DockLayout::Node::Type::Tab;
+            for (int i = 0; i < 100; ++i) {
+                panels.push_back(std::make_unique<df::BasicDockWidget>("Panel" + std::to_string(panels.size())));
+                stack->children.push_back(makeLeaf(panels.back().get()));
+            }
+        }
+        df::DockLayout batchLayout;
+        batchLayout.setRoot(std::move(batchRoot));
+        const DFRect batchBounds{0.0f, 0.0f, 1600.0f, 900.0f};
+        batchLayout.update(batchBounds);
+        auto& mgr = df::DockManager::instance();
+        mgr.setMainLayout(&batchLayout, batchBounds);
+
+        batchLayout.resetStats();
+        const uint64_t versionBefore = batchLayout.version();
+        batchLayout.beginBatch();
+        for (size_t i = 0; i < 150; ++i) {
+            mgr.closeWidget(panels[i].get());
+        }
+        batchLayout.update(batchBounds);
+        checks.expect(batchLayout.inBatch() && batchLayout.version() == versionBefore && batchLayout.stats().nodesLaidOut == 0,
+                      "layout is left alone while a batch is open");
+        checks.expect(df::DockLayout::Resolve(panels[0]->layoutNode()) == nullptr, "closed panel drops its leaf");
+        batchLayout.commit();
+        batchLayout.update(batchBounds);
+        const df::DockLayout::Node* remaining = batchLayout.root();
+        checks.expect(remaining && remaining->type == df::DockLayout::Node::Type::Tab && remaining->children.size() == 50,
+                      "commit normalizes the emptied stack away");
+        checks.expect(batchLayout.stats().fullPasses == 1, "batched closes cost one full pass");
+
+        batchLayout.beginBatch();
+        batchLayout.insertWidget(panels[0].get(), nullptr, df::DragOverlay::DropZone::Left);
+        df::DockLayout::Node* docked = df::DockLayout::Resolve(panels[0]->layoutNode());
+        batchLayout.insertWidget(panels[1].get(), docked, df::DragOverlay::DropZone::Tab);
+        batchLayout.commit();
+        batchLayout.update(batchBounds);
+        const df::DockLayout::Node* split = batchLayout.root();
+        checks.expect(split && split->type == df::DockLayout::Node::Type::Split && split->first &&
+                          split->first->type == df::DockLayout::Node::Type::Tab && split->first->children.size() == 2 &&
+                          split->second && split->second->children.size() == 50,
+                      "batched inserts split the root and tabify the new leaf");
+        checks.expect(panels[1]->bounds().width > 1.0f && panels[1]->isTabified(), "inserted panel is laid out");
+
+        // A close that collapses a split relinks the survivors at commit(),
+        // so marking one before the next update() stays inside this tree.
+        df::DockWidget* survivor = panels[200 - 1].get();
+        mgr.closeWidget(panels[0].get());
+        mgr.closeWidget(panels[1].get());
+        auto linkedToRoot = [&batchLayout](const df::DockLayout::Node* node) {
+            for (; node && node->parent; node = node->parent) {
+                const df::DockLayout::Node* p = node->parent;
+                bool owned = p->first.get() == node || p->second.get() == node;
+                for (const auto& child : p->children) {
+                    owned = owned || child.get() == node;
+                }
+                if (!owned) {
+                    return false;
+                }
+            }
+            return node == batchLayout.root();
+        };
+        const df::DockLayout::Node* survivorLeaf = df::DockLayout::Resolve(survivor->layoutNode());
+        checks.expect(batchLayout.root()->type == df::DockLayout::Node::Type::Tab && survivorLeaf && linkedToRoot(survivorLeaf),
+                      "commit relinks parents after collapsing a split");
+        auto fresh = std::make_unique<df::DockLayout::Node>();
+        const uint8_t freshDirty = fresh->dirty;
+        survivor->setMinimumSize(320.0f, 200.0f);
+        checks.expect(fresh->dirty == freshDirty && (batchLayout.root()->dirty & df::DockLayout::DirtyMinSize),
+                      "setMinimumSize between commit() and update() marks the live tree only");
+        batchLayout.update(batchBounds);
+
+        mgr.setMainLayout(nullptr, {});
+    }
+
+    // saveState/restoreState round-trip the docked tree and floating windows;
+    // malformed input is rejected without side effects.
+    {
+        auto& mgr = df::DockManager::instance();
+        auto& wm = df::WindowManager::instance();
+        df::BasicDockWidget outliner("Outliner");
+        df::BasicDockWidget viewport("Viewport");
+        df::BasicDockWidget output("Output");
+        df::BasicDockWidget palette("Palette");
+        for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&outliner, &viewport, &output, &palette}) {
+            mgr.registerWidget(w);
+        }
+
+        auto stateRoot = std::make_unique<df::DockLayout::Node>();
+        stateRoot->type = df::DockLayout::Node::Type::Split;
+        stateRoot->vertical = true;
+        stateRoot->splitSizing = df::DockLayout::Node::SplitSizing::FixedFirst;
+        stateRoot->fixedSize = 240.0f;
+        stateRoot->minFirstSize = 120.0f;
+        stateRoot->first = makeLeaf(&outliner);
+        stateRoot->second = std::make_unique<df::DockLayout::Node>();
+        stateRoot->second->type = df::DockLayout::Node::Type::Tab;
+        stateRoot->second->children.push_back(makeLeaf(&viewport));
+        stateRoot->second->children.push_back(makeLeaf(&output));
+        stateRoot->second->activeTab = 1;
+        df::DockLayout stateLayout;
+        stateLayout.setRoot(std::move(stateRoot));
+        const DFRect stateBounds{0.0f, 0.0f, 1200.0f, 800.0f};
+        stateLayout.update(stateBounds);
+        mgr.setMainLayout(&stateLayout, stateBounds);
+        wm.createFloatingWindow(&palette, {700.0f, 120.0f, 260.0f, 180.0f});
+
+        const std::string saved = mgr.saveState();
+        const std::string text = df::DockStateToText(saved);
+        checks.expect(saved.size() < 120 && saved.compare(0, 4, "DFLS") == 0, "state is compact and tagged");
+        checks.expect(text.find("tabs active=1 count=2") != std::string::npos &&
+                          text.find("floating \"Palette\" 700 120 260 180") != std::string::npos,
+                      "text export lists tabs and floating windows");
+
+        mgr.closeWidget(&outliner);
+        wm.destroyAllWindows();
+        checks.expect(mgr.restoreState(saved), "saved state restores");
+        stateLayout.update(stateBounds);
+        const df::DockLayout::Node* restored = stateLayout.root();
+        const df::DockLayout::Node* restoredTabs = restored ? restored->second.get() : nullptr;
+        checks.expect(restored && restored->type == df::DockLayout::Node::Type::Split &&
+                          restored->splitSizing == df::DockLayout::Node::SplitSizing::FixedFirst &&
+                          restored->fixedSize == 240.0f && restored->minFirstSize == 120.0f,
+                      "restored split keeps sizing");
+        checks.expect(restoredTabs && restoredTabs->children.size() == 2 && restoredTabs->activeTab == 1 &&
+                          outliner.bounds().width > 1.0f,
+                      "restored tabs keep order and active tab");
+        df::WindowFrame* paletteFrame = wm.findWindowByContent(&palette);
+        checks.expect(paletteFrame && paletteFrame->bounds().x == 700.0f && wm.windowsSnapshot().size() == 1,
+                      "floating window restored with its bounds");
+        checks.expect(mgr.saveState() == saved, "save after restore is byte-identical");
+
+        const uint64_t versionBefore = stateLayout.version();
+        checks.expect(!mgr.restoreState(saved.substr(0, saved.size() - 3)) && !mgr.restoreState("DFLS garbage") &&
+                          !mgr.restoreState(saved + "x"),
+                      "truncated or trailing input is rejected");
+        checks.expect(stateLayout.version() == versionBefore && wm.windowsSnapshot().size() == 1 && df::DockStateToText("junk").empty(),
+                      "rejected input leaves the layout alone");
+
+        // Equally titled panels each get their own string, and a tab whose
+        // panel is gone on restore keeps the saved active panel selected.
+        {
+            df::BasicDockWidget logA("Log");
+            df::BasicDockWidget scratch("Scratch");
+            df::BasicDockWidget logB("Log");
+            df::BasicDockWidget logC("Log");
+            for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&logA, &scratch, &logB, &logC}) {
+                mgr.registerWidget(w);
+            }
+            auto tabs = std::make_unique<df::DockLayout::Node>();
+            tabs->type = df::DockLayout::Node::Type::Tab;
+            tabs->children.push_back(makeLeaf(&logA));
+            tabs->children.push_back(makeLeaf(&scratch));
+            tabs->children.push_back(makeLeaf(&logB));
+            tabs->activeTab = 2;
+            stateLayout.setRoot(std::move(tabs));
+            wm.destroyAllWindows();
+            wm.createFloatingWindow(&logC, {600.0f, 100.0f, 240.0f, 160.0f});
+            const std::string logs = mgr.saveState();
+
+            mgr.unregisterWidget(&scratch);
+            stateLayout.setRoot(nullptr);
+            wm.destroyAllWindows();
+            checks.expect(mgr.restoreState(logs), "state with repeated titles restores");
+            const df::DockLayout::Node* logTabs = stateLayout.root();
+            checks.expect(logTabs && logTabs->children.size() == 2 && logTabs->children[0]->widget == &logA &&
+                              logTabs->children[1]->widget == &logB && wm.findWindowByContent(&logC),
+                          "equally titled panels all restore in place");
+            checks.expect(logTabs && logTabs->activeTab == 1, "active tab follows its panel past a dropped sibling");
+
+            wm.destroyAllWindows();
+            stateLayout.setRoot(nullptr);
+            for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&logA, &logB, &logC}) {
+                mgr.unregisterWidget(w);
+            }
+        }
+
+        // A few thousand panels in nested splits of tab stacks.
+        std::vector<std::unique_ptr<df::BasicDockWidget>> many;
+        std::function<std::unique_ptr<df::DockLayout::Node>(int)> build = [&](int depth) {
+            auto node = std::make_unique<df::DockLayout::Node>();
+            if (depth == 0) {
+                node->type = df::DockLayout::Node::Type::Tab;
+                for (int i = 0; i < 8; ++i) {
+                    many.push_back(std::make_unique<df::BasicDockWidget>("Doc" + std::to_string(many.size())));
+                    mgr.registerWidget(many.back().get());
+                    node->children.push_back(makeLeaf(many.back().get()));
+                }
+                return node;
+            }
+            node->type = df::DockLayout::Node::Type::Split;
+            node->vertical = (depth % 2) == 0;
+            node->first = build(depth - 1);
+            node->second = build(depth - 1);
+            return node;
+        };
+        stateLayout.setRoot(build(8));
+        const std::string large = mgr.saveState();
+        stateLayout.setRoot(nullptr);
+        const auto restoreStart = std::chrono::steady_clock::now();
+        const bool largeRestored = mgr.restoreState(large);
+        const double restoreMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - restoreStart).count();
+        std::cout << "[INFO] restored " << many.size() << " panels from " << large.size() << " bytes in " << restoreMs
+                  << " ms\n";
+        checks.expect(largeRestored && mgr.saveState() == large, "large state round-trips");
+
+        for (auto& w : many) {
+            mgr.unregisterWidget(w.get());
+        }
+        wm.destroyAllWindows();
+        mgr.setMainLayout(nullptr, {});
+        for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&outliner, &viewport, &output, &palette}) {
+            mgr.unregisterWidget(w);
+        }
+    }
+
+    // Published snapshots are immutable, share unchanged subtrees with the
+    // previous publish, and can be read from another thread during edits.
+    {
+        auto& mgr = df::DockManager::instance();
+        auto& wm = df::WindowManager::instance();
+        df::BasicDockWidget tree("Tree");
+        df::BasicDockWidget scene("Scene");
+        df::BasicDockWidget log("Log");
+        df::BasicDockWidget tool("Tool");
+        auto snapRoot = std::make_unique<df::DockLayout::Node>();
+        snapRoot->type = df::DockLayout::Node::Type::Split;
+        snapRoot->vertical = true;
+        snapRoot->ratio = 0.25f;
+        snapRoot->first = makeLeaf(&tree);
+        snapRoot->second = std::make_unique<df::DockLayout::Node>();
+        snapRoot->second->type = df::DockLayout::Node::Type::Split;
+        snapRoot->second->vertical = false;
+        snapRoot->second->first = makeLeaf(&scene);
+        snapRoot->second->second = makeLeaf(&log);
+        df::DockLayout::Node* inner = snapRoot->second.get();
+        df::DockLayout snapLayout;
+        snapLayout.setRoot(std::move(snapRoot));
+        const DFRect snapBounds{0.0f, 0.0f, 1000.0f, 700.0f};
+        snapLayout.update(snapBounds);
+        mgr.setMainLayout(&snapLayout, snapBounds);
+        wm.createFloatingWindow(&tool, {600.0f, 80.0f, 200.0f, 150.0f});
+
+        const auto first = mgr.publishSnapshot();
+        const auto idle = mgr.publishSnapshot();
+        checks.expect(idle->sequence == first->sequence + 1 && idle->root == first->root && idle->windows == first->windows,
+                      "unchanged publish shares the whole snapshot");
+        checks.expect(first->windows->size() == 1 && first->windows->front().title == "Tool" &&
+                          first->root->first->children.front()->title == "Tree",
+                      "snapshot copies titles and floating windows");
+
+        const float oldRatio = inner->ratio;
+        inner->ratio = 0.7f;
+        df::DockLayout::MarkDirty(inner);
+        snapLayout.update(snapBounds);
+        const auto edited = mgr.publishSnapshot();
+        checks.expect(edited->root != first->root && edited->root->first == first->root->first &&
+                          edited->root->second != first->root->second,
+                      "edit copies only the changed path");
+        checks.expect(first->root->second->ratio == oldRatio && edited->root->second->ratio == 0.7f &&
+                          mgr.snapshot() == edited,
+                      "older snapshot keeps its values");
+
+        std::atomic<bool> stop{false};
+        std::atomic<int> reads{0};
+        std::atomic<int> torn{0};
+        std::thread reader([&]() {
+            while (!stop.load()) {
+                const auto snap = mgr.snapshot();
+                const df::DockSnapshotNode* right = snap->root ? snap->root->second.get() : nullptr;
+                if (!right || !right->first || !right->second ||
+                    std::fabs(right->first->bounds.height + right->second->bounds.height - right->bounds.height) > 8.0f) {
+                    ++torn;
+                }
+                ++reads;
+            }
+        });
+        for (int i = 0; i < 400 || reads.load() < 50; ++i) {
+            inner->ratio = 0.3f + 0.4f * static_cast<float>(i % 10) / 10.0f;
+            df::DockLayout::MarkDirty(inner);
+            snapLayout.update(snapBounds);
+            mgr.publishSnapshot();
+        }
+        stop = true;
+        reader.join();
+        checks.expect(torn.load() == 0 && reads.load() >= 50, "reader thread sees consistent snapshots during edits");
+
+        wm.destroyAllWindows();
+        mgr.setMainLayout(nullptr, {});
+        mgr.publishSnapshot();
+    }
+
+    // Structural edits are undoable; history versions share everything off
+    // the edited path.
+    {
+        auto& mgr = df::DockManager::instance();
+        auto& wm = df::WindowManager::instance();
+        df::BasicDockWidget files("Files");
+        df::BasicDockWidget editor("Editor");
+        df::BasicDockWidget terminal("Terminal");
+        for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&files, &editor, &terminal}) {
+            mgr.registerWidget(w);
+        }
+        auto histRoot = std::make_unique<df::DockLayout::Node>();
+        histRoot->type = df::DockLayout::Node::Type::Split;
+        histRoot->vertical = true;
+        histRoot->ratio = 0.3f;
+        histRoot->first = makeLeaf(&files);
+        histRoot->second = std::make_unique<df::DockLayout::Node>();
+        histRoot->second->type = df::DockLayout::Node::Type::Tab;
+        histRoot->second->children.push_back(makeLeaf(&editor));
+        histRoot->second->children.push_back(makeLeaf(&terminal));
+        df::DockLayout histLayout;
+        histLayout.setRoot(std::move(histRoot));
+        const DFRect histBounds{0.0f, 0.0f, 1000.0f, 600.0f};
+        histLayout.update(histBounds);
+        mgr.setMainLayout(&histLayout, histBounds);
+        mgr.clearHistory();
+        auto docked = [&](df::DockWidget* w) {
+            histLayout.update(histBounds);
+            return df::DockLayout::Resolve(w->layoutNode()) != nullptr && !w->isFloating();
+        };
+
+        mgr.closeWidget(&terminal);
+        checks.expect(!docked(&terminal) && mgr.canUndo() && !mgr.canRedo(), "close is recorded");
+        checks.expect(mgr.undo() && docked(&terminal) && mgr.canRedo(), "undo brings a closed panel back");
+        checks.expect(mgr.redo() && !docked(&terminal) && mgr.undo() && docked(&terminal), "redo repeats the close");
+
+        mgr.startUndockDrag(&files, {50.0f, 50.0f});
+        mgr.cancelFloatingDrag();
+        checks.expect(files.isFloating() && wm.windowsSnapshot().size() == 1, "undock makes a floating window");
+        checks.expect(mgr.undo() && docked(&files) && wm.windowsSnapshot().empty(), "undo re-docks an undocked panel");
+
+        // Dragging a docked panel out and dropping it elsewhere is one step.
+        const std::string beforeMove = mgr.saveState();
+        mgr.startUndockDrag(&files, {50.0f, 50.0f});
+        histLayout.update(histBounds);
+        const DFRect editorBounds = editor.bounds();
+        Event over(Event::Type::MouseMove);
+        over.x = editorBounds.x + 6.0f;
+        over.y = editorBounds.y + editorBounds.height * 0.5f;
+        mgr.handleEvent(over);
+        Event drop(Event::Type::MouseUp);
+        drop.x = over.x;
+        drop.y = over.y;
+        mgr.handleEvent(drop);
+        checks.expect(docked(&files) && wm.windowsSnapshot().empty() && mgr.saveState() != beforeMove,
+                      "undock drag re-docks on drop");
+        checks.expect(mgr.undo() && docked(&files) && mgr.saveState() == beforeMove,
+                      "one undo reverts the whole undock-and-drop gesture");
+
+        df::DockSplitter histSplitters;
+        histLayout.update(histBounds);
+        histSplitters.updateSplitters(histLayout.root(), histBounds);
+        const DFPoint grab{histLayout.root()->first->bounds.x + histLayout.root()->first->bounds.width + 1.0f, 300.0f};
+        if (auto* splitter = histSplitters.splitterAtPoint(grab)) {
+            histSplitters.startDrag(splitter, grab);
+        }
+        histSplitters.updateDrag({grab.x + 200.0f, grab.y});
+        histSplitters.endDrag();
+        const float draggedRatio = histLayout.root()->ratio;
+        checks.expect(mgr.undo() && std::fabs(histLayout.root()->ratio - 0.3f) < 0.001f && draggedRatio > 0.4f,
+                      "undo restores a splitter drag");
+        checks.expect(mgr.redo() && histLayout.root()->ratio == draggedRatio, "redo reapplies the splitter drag");
+
+        mgr.setHistoryLimit(2);
+        mgr.closeWidget(&terminal);
+        mgr.closeWidget(&editor);
+        mgr.closeWidget(&files);
+        checks.expect(mgr.undo() && mgr.undo() && !mgr.undo() && docked(&editor) && !docked(&terminal),
+                      "history is capped at the limit");
+        mgr.setHistoryLimit(100);
+
+        // Sharing: a ratio edit deep in a large tree copies only its path.
+        std::vector<std::unique_ptr<df::BasicDockWidget>> leaves;
+        std::function<std::unique_ptr<df::DockLayout::Node>(int)> build = [&](int depth) {
+            if (depth == 0) {
+                leaves.push_back(std::make_unique<df::BasicDockWidget>("Leaf" + std::to_string(leaves.size())));
+                return makeLeaf(leaves.back().get());
+            }
+            auto node = std::make_unique<df::DockLayout::Node>();
+            node->type = df::DockLayout::Node::Type::Split;
+            node->first = build(depth - 1);
+            node->second = build(depth - 1);
+            return node;
+        };
+        df::DockLayout bigLayout;
+        bigLayout.setRoot(build(10));
+        bigLayout.update(histBounds);
+        const std::vector<df::DockSnapshotWindow> noWindows;
+        const auto before = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, nullptr, false);
+        df::DockLayout::Node* deep = bigLayout.root();
+        int pathLength = 1;
+        while (deep->first && deep->first->type == df::DockLayout::Node::Type::Split) {
+            deep = deep->first.get();
+            ++pathLength;
+        }
+        deep->ratio = 0.8f;
+        df::DockLayout::MarkDirty(deep);
+        bigLayout.update(histBounds);
+        const auto after = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, before.get(), false);
+        std::set<const df::DockSnapshotNode*> oldNodes;
+        std::function<void(const df::DockSnapshotNode*, std::set<const df::DockSnapshotNode*>&)> collect =
+            [&](const df::DockSnapshotNode* node, std::set<const df::DockSnapshotNode*>& out) {
+                if (!node || !out.insert(node).second) {
+                    return;
+                }
+                collect(node->first.get(), out);
+                collect(node->second.get(), out);
+                for (const auto& child : node->children) {
+                    collect(child.get(), out);
+                }
+            };
+        collect(before->root.get(), oldNodes);
+        std::set<const df::DockSnapshotNode*> allNodes = oldNodes;
+        collect(after->root.get(), allNodes);
+        std::ostringstream sharing;
+        sharing << "history version copies only the edited path new=" << (allNodes.size() - oldNodes.size())
+                << " path=" << pathLength << " tree=" << oldNodes.size();
+        checks.expect(allNodes.size() - oldNodes.size() == static_cast<size_t>(pathLength) && oldNodes.size() > 3000,
+                      sharing.str());
+        auto newNodes = [&](const df::DockSnapshot& from, const df::DockSnapshot& to) {
+            std::set<const df::DockSnapshotNode*> fromNodes;
+            collect(from.root.get(), fromNodes);
+            std::set<const df::DockSnapshotNode*> toNodes = fromNodes;
+            collect(to.root.get(), toNodes);
+            return toNodes.size() - fromNodes.size();
+        };
+
+        // Closing leaves[0] hoists its sibling into deep's place; only the
+        // ancestors above it are copied.
+        bigLayout.removeWidget(leaves[0].get());
+        bigLayout.update(histBounds);
+        const auto closed = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, after.get(), false);
+        std::ostringstream closeSharing;
+        closeSharing << "close copies only the ancestors of the removed split new=" << newNodes(*after, *closed);
+        checks.expect(newNodes(*after, *closed) == static_cast<size_t>(pathLength - 1), closeSharing.str());
+
+        // An edge dock wraps the target leaf in a new split inside its tab
+        // stack; the target itself is shared.
+        df::BasicDockWidget extra("Extra");
+        bigLayout.insertWidget(&extra, df::DockLayout::Resolve(leaves.back()->layoutNode()),
+                               df::DragOverlay::DropZone::Right);
+        bigLayout.update(histBounds);
+        const auto edged = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, closed.get(), false);
+        std::ostringstream dockSharing;
+        dockSharing << "edge dock copies the target's ancestors, the new split and the new leaf new="
+                    << newNodes(*closed, *edged);
+        checks.expect(newNodes(*closed, *edged) == static_cast<size_t>(pathLength + 3), dockSharing.str());
+
+        // Undo keeps the nodes that are still alive, so what follows it
+        // shares with the versions before it.
+        for (const auto& leaf : leaves) {
+            mgr.registerWidget(leaf.get());
+        }
+        mgr.registerWidget(&extra);
+        mgr.setMainLayout(&bigLayout, histBounds);
+        mgr.clearHistory();
+        const df::DockNodeHandle rootHandle = bigLayout.root()->handle();
+        const df::DockNodeHandle farHandle = leaves[500]->layoutNode();
+        const df::DockNodeHandle siblingHandle = leaves[3]->layoutNode();
+        mgr.closeWidget(leaves[2].get());
+        bigLayout.update(histBounds);
+        checks.expect(mgr.undo(), "undo of a close in a large tree");
+        bigLayout.update(histBounds);
+        checks.expect(bigLayout.root()->handle() == rootHandle && leaves[500]->layoutNode() == farHandle &&
+                          leaves[3]->layoutNode() == siblingHandle,
+                      "undo keeps the handles of nodes that survived the edit");
+        const auto undone = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, edged.get(), false);
+        std::ostringstream undoSharing;
+        undoSharing << "undo only renews the restored panel's path new=" << newNodes(*edged, *undone);
+        checks.expect(newNodes(*edged, *undone) == static_cast<size_t>(pathLength + 2), undoSharing.str());
+
+        df::DockLayout::Node* farSplit = df::DockLayout::Resolve(leaves[500]->layoutNode())->parent->parent;
+        farSplit->ratio = 0.7f;
+        df::DockLayout::MarkDirty(farSplit);
+        bigLayout.update(histBounds);
+        const auto edited = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, undone.get(), false);
+        std::ostringstream editSharing;
+        editSharing << "an edit after undo copies only its path new=" << newNodes(*undone, *edited);
+        checks.expect(newNodes(*undone, *edited) == static_cast<size_t>(pathLength), editSharing.str());
+
+        mgr.checkpoint();
+        farSplit->ratio = 0.4f;
+        df::DockLayout::MarkDirty(farSplit);
+        checks.expect(mgr.undo(), "undo of a ratio edit in a large tree");
+        bigLayout.update(histBounds);
+        const auto reverted = df::BuildDockSnapshot(bigLayout.root(), bigLayout.version(), noWindows, edited.get(), false);
+        checks.expect(reverted->root == edited->root, "undo of an in-place edit restores the same nodes");
+
+        mgr.clearHistory();
+        mgr.setMainLayout(nullptr, {});
+        for (const auto& leaf : leaves) {
+            mgr.unregisterWidget(leaf.get());
+        }
+        mgr.unregisterWidget(&extra);
+
+        mgr.clearHistory();
+        wm.destroyAllWindows();
+        mgr.setMainLayout(nullptr, {});
+        for (df::DockWidget* w : std::initializer_list<df::DockWidget*>{&files, &editor, &terminal}) {
+            mgr.unregisterWidget(w);
+        }
+    }
+
+    // Tabs are sized to their titles and shrink widest-first in a short strip.
+    {
+        df::BasicDockWidget shortTab("Log");
+        df::BasicDockWidget longTab("Material Graph Editor");
+        df::DockLayout::Node tabs;
+        tabs.type = df::DockLayout::Node::Type::Tab;
+        tabs.tabBarHeight = df::DockLayout::ThemeTabBarHeight();
+        tabs.children.push_back(makeLeaf(&shortTab));
+        tabs.children.push_back(makeLeaf(&longTab));
+
+        const DFRect tabBounds{0.0f, 0.0f, 900.0f, 400.0f};
+        const DFRect shortRect = df::DockLayout::TabRectForIndex(tabs, tabBounds, 0, 2);
+        const DFRect longRect = df::DockLayout::TabRectForIndex(tabs, tabBounds, 1, 2);
+        checks.expect(longRect.width > shortRect.width + 20.0f, "tab width follows title length");
+        checks.expect(longRect.x >= shortRect.x + shortRect.width, "title-sized tabs do not overlap");
+
+        const uint64_t cachedKey = tabs.tabLayout.key;
+        const DFRect longAgain = df::DockLayout::TabRectForIndex(tabs, tabBounds, 1, 2);
+        checks.expect(
+            tabs.tabLayout.key == cachedKey && longAgain.x == longRect.x && longAgain.width == longRect.width,
+            "tab layout cache reused for unchanged strip");
+
+        const DFRect narrowBounds{0.0f, 0.0f, 150.0f, 400.0f};
+        const DFRect narrowShort = df::DockLayout::TabRectForIndex(tabs, narrowBounds, 0, 2);
+        const DFRect narrowLong = df::DockLayout::TabRectForIndex(tabs, narrowBounds, 1, 2);
+        checks.expect(narrowLong.width < longRect.width, "long tab shrinks in narrow strip");
+        checks.expectNear(narrowShort.width, shortRect.width, 0.6f, "short tab keeps its width in narrow strip");
+        checks.expect(narrowLong.x + narrowLong.width <= narrowBounds.width + 0.5f, "narrow tabs stay inside strip");
+    }
+
     if (checks.failed() > 0) {
         std::cout << "CHECKS FAILED passed=" << checks.passed() << " failed=" << checks.failed() << "\n";
         return 1;
@@ -3,8 +3,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <functional>
-#include <string>
+#include <string_view>
 
 namespace {
 
@@ -18,36 +19,6 @@ DFColor ShiftColor(const DFColor& color, float delta)
     };
 }
 
-std::string ClipTextForWidth(const std::string& text, float maxWidth, bool withEllipsis, float scaleMul)
-{
-    return DFClipTextToWidth(text, maxWidth, withEllipsis, scaleMul);
-}
-
-const df::DockWidget* ResolveWidgetForLabel(const df::DockLayout::Node* node)
-{
-    if (!node) {
-        return nullptr;
-    }
-    if (node->type == df::DockLayout::Node::Type::Widget && node->widget) {
-        return node->widget;
-    }
-    if (node->type == df::DockLayout::Node::Type::Tab && !node->children.empty()) {
-        const int active = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
-        if (const df::DockWidget* activeWidget = ResolveWidgetForLabel(node->children[static_cast<size_t>(active)].get())) {
-            return activeWidget;
-        }
-        for (const auto& child : node->children) {
-            if (const df::DockWidget* widget = ResolveWidgetForLabel(child.get())) {
-                return widget;
-            }
-        }
-    }
-    if (const df::DockWidget* left = ResolveWidgetForLabel(node->first.get())) {
-        return left;
-    }
-    return ResolveWidgetForLabel(node->second.get());
-}
-
 void DrawHorizontalTabShape(
     Canvas& canvas,
     const DFRect& tabRect,
@@ -135,20 +106,18 @@ void DrawHorizontalSteppedTabShape(
     const float bottomY = active
         ? std::clamp(baseY + 1.0f, topY + 1.0f, activeMaxBottomY)
         : std::clamp(baseY, topY + 1.0f, inactiveMaxBottomY);
-    const float slopeH = std::max(1.0f, bottomY - topY);
-    const int yStart = static_cast<int>(topY);
-    const int yEnd = static_cast<int>(bottomY);
 
     // Fill as one coherent trapezoid to avoid "rectangle behind tab" artifacts.
-    for (int y = yStart; y <= yEnd; ++y) {
-        const float yy = std::clamp(static_cast<float>(y), topY, bottomY);
-        const float t = std::clamp((yy - topY) / slopeH, 0.0f, 1.0f);
-        const float lx = leftTopX + (left - leftTopX) * t;
-        const float rx = rightTopX + (right - rightTopX) * t;
-        const float x = std::min(lx, rx);
-        const float w = std::max(1.0f, std::abs(rx - lx));
-        canvas.drawRectangle({x, yy, w, 1.0f}, fill);
-    }
+    // The bottom row is a full-width pixel row, so active tabs cover the baseline.
+    const DFPoint shape[] = {
+        {leftTopX, topY},
+        {rightTopX, topY},
+        {right, bottomY},
+        {right, bottomY + 1.0f},
+        {left, bottomY + 1.0f},
+        {left, bottomY},
+    };
+    canvas.drawConvexPolygon(shape, sizeof(shape) / sizeof(shape[0]), fill);
 
     // Outline: /----\ ; active tabs skip bottom edge and rely on geometric overlap.
     canvas.drawLine({left, bottomY}, {leftTopX, topY}, outline, 1.0f);
@@ -199,7 +168,7 @@ void DrawVerticalTabShape(
 void DrawVerticalLabel(
     Canvas& canvas,
     const DFRect& tabRect,
-    const std::string& label,
+    std::string_view label,
     const DFColor& textColor,
     float scaleMul,
     bool smooth)
@@ -216,20 +185,15 @@ void DrawVerticalLabel(
         return;
     }
 
-    std::string clipped = label;
-    if (static_cast<int>(clipped.size()) > maxChars) {
-        if (maxChars > 1) {
-            clipped = clipped.substr(0, static_cast<size_t>(maxChars - 1)) + ".";
-        } else {
-            clipped = clipped.substr(0, 1);
-        }
-    }
-
-    const float textHeight = static_cast<float>(clipped.size()) * kVerticalAdvance;
+    // Clip in place: a truncated label ends in '.', drawn one glyph per row.
+    const bool truncated = static_cast<int>(label.size()) > maxChars;
+    const int count = truncated ? maxChars : static_cast<int>(label.size());
+    const float textHeight = static_cast<float>(count) * kVerticalAdvance;
     float y = tabRect.y + std::max(3.0f, (tabRect.height - textHeight) * 0.5f);
     const float x = tabRect.x + std::max(3.0f, (tabRect.width - DFGlyphAdvancePx(scaleMul)) * 0.5f);
-    for (char ch : clipped) {
-        DFDrawText(canvas, x, y, std::string(1, ch), textColor, scaleMul, smooth);
+    for (int i = 0; i < count; ++i) {
+        const char ch = (truncated && maxChars > 1 && i == count - 1) ? '.' : label[static_cast<size_t>(i)];
+        canvas.drawGlyphRun(x, y, std::string_view(&ch, 1), textColor, scaleMul, smooth);
         y += kVerticalAdvance;
     }
 }
@@ -266,15 +230,222 @@ void DockRenderer::drawTitlePlaceholder(Canvas& canvas, const DFRect& tabRect, c
     canvas.drawRectangle({startX, y, w, h}, color);
 }
 
+void DockRenderer::setMousePosition(const DFPoint& pos)
+{
+    mousePos_ = pos;
+    hasMousePos_ = true;
+    setHoveredTab(tabAt(pos));
+}
+
+void DockRenderer::clearMousePosition()
+{
+    hasMousePos_ = false;
+    setHoveredTab(nullptr);
+}
+
+const DFRect* DockRenderer::tabAt(const DFPoint& pos) const
+{
+    for (const DFRect& tab : tabRects_) {
+        if (tab.contains(pos)) {
+            return &tab;
+        }
+    }
+    return nullptr;
+}
+
+void DockRenderer::setHoveredTab(const DFRect* tab)
+{
+    const bool same = tab && hasHoveredTab_ &&
+        tab->x == hoveredTab_.x && tab->y == hoveredTab_.y &&
+        tab->width == hoveredTab_.width && tab->height == hoveredTab_.height;
+    if (same || (!tab && !hasHoveredTab_)) {
+        return;
+    }
+    if (damage_) {
+        if (hasHoveredTab_) {
+            damage_->add(hoveredTab_);
+        }
+        if (tab) {
+            damage_->add(*tab);
+        }
+    }
+    hasHoveredTab_ = tab != nullptr;
+    hoveredTab_ = tab ? *tab : DFRect{};
+}
+
 void DockRenderer::render(Canvas& canvas, DockLayout::Node* node)
 {
     if (!node) return;
+    tabRects_.clear();
+    collectTabRects(node);
+    if (hasMousePos_) {
+        setHoveredTab(tabAt(mousePos_));
+    }
+    DFCanvasScopeGuard scope(canvas, DFCanvasScope::DockRenderer);
     renderNode(canvas, node, CurrentTheme());
 }
 
+void DockRenderer::collectTabRects(const DockLayout::Node* node)
+{
+    if (!node) return;
+    if (node->type == DockLayout::Node::Type::Tab) {
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            const DFRect tabRect = DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
+            if (tabRect.width > 1.0f && tabRect.height > 1.0f) {
+                tabRects_.push_back(tabRect);
+            }
+        }
+        if (!node->children.empty()) {
+            const int active = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
+            collectTabRects(node->children[static_cast<size_t>(active)].get());
+        }
+        return;
+    }
+    collectTabRects(node->first.get());
+    collectTabRects(node->second.get());
+}
+
+uint64_t DockRenderer::stripKey(const DockLayout::Node& node, int active, const DockTheme& theme) const
+{
+    uint64_t key = 1469598103934665603ull;
+    auto mix = [&key](uint64_t value) {
+        key = (key ^ value) * 1099511628211ull;
+    };
+    auto mixFloat = [&mix](float value) {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    };
+    mixFloat(node.bounds.x);
+    mixFloat(node.bounds.y);
+    mixFloat(node.bounds.width);
+    mixFloat(node.bounds.height);
+    mixFloat(node.tabBarHeight);
+    mixFloat(DFTextPixelScale());
+    mix(ThemeVersion());
+    mix(theme.smoothFont ? 1u : 0u);
+    mix(static_cast<uint64_t>(active));
+    mix(node.children.size());
+
+    for (size_t i = 0; i < node.children.size(); ++i) {
+        const bool hovered =
+            hasMousePos_ && DockLayout::TabRectForIndex(node, node.bounds, i, node.children.size()).contains(mousePos_);
+        mix(hovered ? 1u : 0u);
+        const DockWidget* widget = DockLayout::TabLabelWidget(node.children[i].get());
+        mix(reinterpret_cast<uintptr_t>(widget));
+        if (widget) {
+            for (char c : widget->title()) {
+                mix(static_cast<uint8_t>(c));
+            }
+        }
+    }
+    return key;
+}
+
+void DockRenderer::drawTabStrip(Canvas& canvas, const DockLayout::Node& node, const DFRect& bar, int active,
+                                const DockTheme& theme) const
+{
+    const bool verticalStrip = DockLayout::UseVerticalTabStrip(node, node.bounds);
+    const float tabFontScale = DockLayout::TabFontScale();
+    const float barBottomY = bar.y + bar.height - 1.0f;
+    canvas.drawRectangle(bar, theme.tabStrip);
+    const DFColor stripHi = ShiftColor(theme.tabStrip, 0.05f);
+    const DFColor stripLo = ShiftColor(theme.tabStrip, -0.04f);
+    if (verticalStrip) {
+        canvas.drawLine({bar.x, bar.y}, {bar.x + bar.width, bar.y}, stripHi, 1.0f);
+        canvas.drawLine({bar.x + bar.width - 1.0f, bar.y}, {bar.x + bar.width - 1.0f, bar.y + bar.height}, theme.tabOutline, 1.0f);
+        canvas.drawLine({bar.x, bar.y + bar.height - 1.0f}, {bar.x + bar.width, bar.y + bar.height - 1.0f}, stripLo, 1.0f);
+    } else {
+        canvas.drawLine({bar.x, bar.y}, {bar.x + bar.width, bar.y}, stripHi, 1.0f);
+        canvas.drawLine({bar.x, barBottomY}, {bar.x + bar.width, barBottomY}, theme.tabOutline, 1.0f);
+    }
+
+    const float paneDividerX = bar.x + bar.width - 1.0f;
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool drawActive = (pass == 1);
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            DFRect tabRect = DockLayout::TabRectForIndex(node, node.bounds, i, node.children.size());
+            if (tabRect.width <= 1.0f || tabRect.height <= 1.0f) {
+                continue;
+            }
+
+            const bool isActive = static_cast<int>(i) == active;
+            if (isActive != drawActive) {
+                continue;
+            }
+            if (canvas.isClippedOut(tabRect)) {
+                continue;
+            }
+
+            const bool isHover = hasMousePos_ && tabRect.contains(mousePos_);
+            DFColor tabBg = isActive ? theme.tabActive : theme.tabInactive;
+            if (isHover && !isActive) {
+                tabBg = ShiftColor(tabBg, 0.06f);
+            }
+
+            if (verticalStrip) {
+                DrawVerticalTabShape(
+                    canvas,
+                    tabRect,
+                    tabBg,
+                    theme.tabOutline,
+                    isActive,
+                    theme.tabAccent,
+                    theme.tabCornerRadius,
+                    theme.drawTabAccent,
+                    paneDividerX);
+            } else {
+                if (theme.drawSteppedTabShape) {
+                    DrawHorizontalSteppedTabShape(
+                        canvas,
+                        tabRect,
+                        tabBg,
+                        theme.tabOutline,
+                        barBottomY,
+                        theme.tabShoulderWidth,
+                        theme.tabLiftPx,
+                        isActive);
+                } else {
+                    DrawHorizontalTabShape(
+                        canvas,
+                        tabRect,
+                        tabBg,
+                        theme.tabOutline,
+                        isActive,
+                        theme.tabAccent,
+                        theme.tabCornerRadius,
+                        theme.drawTabAccent,
+                        barBottomY);
+                }
+            }
+
+            const DockLayout::Node* child = node.children[i].get();
+            const DockWidget* widget = DockLayout::TabLabelWidget(child);
+            const std::string_view label = widget ? std::string_view(widget->title()) : std::string_view("Tab");
+            DFColor textColor = isActive ? theme.tabTextActive : theme.tabTextInactive;
+            if (isHover && !isActive) {
+                textColor = ShiftColor(textColor, 0.06f);
+            }
+
+            if (verticalStrip) {
+                DrawVerticalLabel(canvas, tabRect, label, textColor, tabFontScale, theme.smoothFont);
+            } else {
+                const float textLeft = tabRect.x + 9.0f;
+                const float textTop = DFTextBaselineYForRect(tabRect, tabFontScale);
+                const float textMax = std::max(0.0f, tabRect.width - 16.0f);
+                const DFTextFit fit = DFFitTextToWidth(label, textMax, true, tabFontScale);
+                DFDrawTextFit(canvas, textLeft, textTop, label, fit, textColor, tabFontScale, theme.smoothFont);
+            }
+        }
+    }
+}
+
 void DockRenderer::renderNode(Canvas& canvas, DockLayout::Node* node, const DockTheme& theme)
 {
     if (!node) return;
+    if (canvas.isClippedOut(node->bounds)) {
+        return;
+    }
 
     if (node->type == DockLayout::Node::Type::Widget) {
         if (node->widget) {
@@ -291,99 +462,28 @@ void DockRenderer::renderNode(Canvas& canvas, DockLayout::Node* node, const Dock
         const int active = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
         node->activeTab = active;
 
-        const bool verticalStrip = DockLayout::UseVerticalTabStrip(*node, node->bounds);
         const DFRect bar = DockLayout::TabStripRect(*node, node->bounds);
         if (bar.width > 1.0f && bar.height > 1.0f) {
-            const float tabFontScale = std::clamp(theme.tabFontScale, 0.3f, 2.0f);
-            const float barBottomY = bar.y + bar.height - 1.0f;
-            canvas.drawRectangle(bar, theme.tabStrip);
-            const DFColor stripHi = ShiftColor(theme.tabStrip, 0.05f);
-            const DFColor stripLo = ShiftColor(theme.tabStrip, -0.04f);
-            if (verticalStrip) {
-                canvas.drawLine({bar.x, bar.y}, {bar.x + bar.width, bar.y}, stripHi, 1.0f);
-                canvas.drawLine({bar.x + bar.width - 1.0f, bar.y}, {bar.x + bar.width - 1.0f, bar.y + bar.height}, theme.tabOutline, 1.0f);
-                canvas.drawLine({bar.x, bar.y + bar.height - 1.0f}, {bar.x + bar.width, bar.y + bar.height - 1.0f}, stripLo, 1.0f);
-            } else {
-                canvas.drawLine({bar.x, bar.y}, {bar.x + bar.width, bar.y}, stripHi, 1.0f);
-                canvas.drawLine({bar.x, barBottomY}, {bar.x + bar.width, barBottomY}, theme.tabOutline, 1.0f);
-            }
-
-            const float paneDividerX = bar.x + bar.width - 1.0f;
-            for (int pass = 0; pass < 2; ++pass) {
-                const bool drawActive = (pass == 1);
-                for (size_t i = 0; i < node->children.size(); ++i) {
-                    DFRect tabRect = DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
-                    if (tabRect.width <= 1.0f || tabRect.height <= 1.0f) {
-                        continue;
-                    }
-
-                    const bool isActive = static_cast<int>(i) == active;
-                    if (isActive != drawActive) {
-                        continue;
-                    }
-
-                    const bool isHover = hasMousePos_ && tabRect.contains(mousePos_);
-                    DFColor tabBg = isActive ? theme.tabActive : theme.tabInactive;
-                    if (isHover && !isActive) {
-                        tabBg = ShiftColor(tabBg, 0.06f);
-                    }
-
-                    if (verticalStrip) {
-                        DrawVerticalTabShape(
-                            canvas,
-                            tabRect,
-                            tabBg,
-                            theme.tabOutline,
-                            isActive,
-                            theme.tabAccent,
-                            theme.tabCornerRadius,
-                            theme.drawTabAccent,
-                            paneDividerX);
-                    } else {
-                        if (theme.drawSteppedTabShape) {
-                            DrawHorizontalSteppedTabShape(
-                                canvas,
-                                tabRect,
-                                tabBg,
-                                theme.tabOutline,
-                                barBottomY,
-                                theme.tabShoulderWidth,
-                                theme.tabLiftPx,
-                                isActive);
-                        } else {
-                            DrawHorizontalTabShape(
-                                canvas,
-                                tabRect,
-                                tabBg,
-                                theme.tabOutline,
-                                isActive,
-                                theme.tabAccent,
-                                theme.tabCornerRadius,
-                                theme.drawTabAccent,
-                                barBottomY);
-                        }
-                    }
-
-                    const DockLayout::Node* child = node->children[i].get();
-                    const DockWidget* widget = ResolveWidgetForLabel(child);
-                    const std::string label = widget ? widget->title() : std::string("Tab");
-                    DFColor textColor = isActive ? theme.tabTextActive : theme.tabTextInactive;
-                    if (isHover && !isActive) {
-                        textColor = ShiftColor(textColor, 0.06f);
-                    }
-
-                    if (verticalStrip) {
-                        DrawVerticalLabel(canvas, tabRect, label, textColor, tabFontScale, theme.smoothFont);
-                    } else {
-                        const float textLeft = tabRect.x + 9.0f;
-                        const float textTop = DFTextBaselineYForRect(tabRect, tabFontScale);
-                        const float textMax = std::max(0.0f, tabRect.width - 16.0f);
-                        const std::string clipped = ClipTextForWidth(label, textMax, true, tabFontScale);
-                        if (!clipped.empty()) {
-                            DFDrawText(canvas, textLeft, textTop, clipped, textColor, tabFontScale, theme.smoothFont);
-                        }
-                    }
+            if (stripCacheEnabled_) {
+                if (node->handle().index >= stripCache_.size()) {
+                    stripCache_.resize(node->handle().index + 1);
+                }
+                StripCache& cache = stripCache_[node->handle().index];
+                const uint64_t key = stripKey(*node, active, theme);
+                if (cache.handle != node->handle() || cache.key != key) {
+                    cache.handle = node->handle();
+                    cache.key = key;
+                    cache.commands.reset();
+                    drawTabStrip(cache.commands, *node, bar, active, theme);
+                    ++stats_.stripMisses;
+                } else {
+                    ++stats_.stripHits;
                 }
+                if (!canvas.appendRecorded(cache.commands, node->bounds)) {
+                    cache.commands.replay(canvas);
+                }
+            } else {
+                drawTabStrip(canvas, *node, bar, active, theme);
             }
         }
 
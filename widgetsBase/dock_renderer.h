@@ -3,21 +3,59 @@
 #include "dock_layout.h"
 #include "dock_theme.h"
 #include "core_types.h"
+#include "damage_region.h"
+#include "display_list_canvas.h"
+#include <cstdint>
+#include <vector>
 
 namespace df {
 
 class DockRenderer {
 public:
-    void setMousePosition(const DFPoint& pos) { mousePos_ = pos; hasMousePos_ = true; }
-    void clearMousePosition() { hasMousePos_ = false; }
+    // Hover damage is resolved against the tab rects of the previous render,
+    // so the renderer must live across frames when damage is tracked.
+    void setMousePosition(const DFPoint& pos);
+    void clearMousePosition();
+    void setDamageRegion(DFDamageRegion* damage) { damage_ = damage; }
+    // Skips subtrees outside canvas.clipRect() when a clip is set.
     void render(Canvas& canvas, DockLayout::Node* node);
     static DFRect tabCloseRect(const DFRect& tabRect);
 
+    // Tab strips (shapes and fitted labels) are recorded per Tab node and
+    // replayed while the node's bounds, tabs, titles, hovered tab and theme
+    // are unchanged. Widget content is painted every frame.
+    void setStripCacheEnabled(bool enabled) { stripCacheEnabled_ = enabled; }
+    struct Stats {
+        uint64_t stripHits = 0;
+        uint64_t stripMisses = 0;
+    };
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = {}; }
+
 private:
     static void drawTitlePlaceholder(Canvas& canvas, const DFRect& tabRect, const DFRect& closeRect, const DFColor& color);
     void renderNode(Canvas& canvas, DockLayout::Node* node, const DockTheme& theme);
+    void drawTabStrip(Canvas& canvas, const DockLayout::Node& node, const DFRect& bar, int active, const DockTheme& theme) const;
+    uint64_t stripKey(const DockLayout::Node& node, int active, const DockTheme& theme) const;
+    void collectTabRects(const DockLayout::Node* node);
+    const DFRect* tabAt(const DFPoint& pos) const;
+    void setHoveredTab(const DFRect* tab);
+
     DFPoint mousePos_{};
     bool hasMousePos_ = false;
+    DFDamageRegion* damage_ = nullptr;
+    std::vector<DFRect> tabRects_;
+    DFRect hoveredTab_{};
+    bool hasHoveredTab_ = false;
+
+    struct StripCache {
+        DockNodeHandle handle{};
+        uint64_t key = 0;
+        DisplayListCanvas commands;
+    };
+    std::vector<StripCache> stripCache_; // indexed by node handle slot
+    bool stripCacheEnabled_ = true;
+    Stats stats_;
 };
 
 } // namespace df
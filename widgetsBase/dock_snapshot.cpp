@@ -0,0 +1,170 @@
+#include "dock_snapshot.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace df {
+
+namespace {
+
+using Node = DockLayout::Node;
+
+bool SameRect(const DFRect& a, const DFRect& b)
+{
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+// Whether prev still describes node, given node's already-built children.
+bool Unchanged(const DockSnapshotNode& prev, const Node& node, const DFRect& bounds, const DockSnapshotNode::Ptr& first,
+               const DockSnapshotNode::Ptr& second, bool sameChildren)
+{
+    if (prev.handle != node.handle() || prev.type != node.type || !SameRect(prev.bounds, bounds)) {
+        return false;
+    }
+    switch (node.type) {
+    case Node::Type::Widget:
+        return prev.widget == node.widget && (!node.widget || prev.title == node.widget->title());
+    case Node::Type::Split:
+        return prev.vertical == node.vertical && prev.splitSizing == node.splitSizing && prev.ratio == node.ratio &&
+            prev.fixedSize == node.fixedSize && prev.minFirstSize == node.minFirstSize &&
+            prev.minSecondSize == node.minSecondSize && prev.first == first && prev.second == second;
+    case Node::Type::Tab:
+        return prev.activeTab == node.activeTab && prev.tabBarHeight == node.tabBarHeight && sameChildren;
+    }
+    return false;
+}
+
+const DockSnapshotNode::Ptr kNoNode;
+
+// Previous nodes by handle. Edits move subtrees: closing a panel hoists its
+// sibling into the parent's place and an edge dock wraps the target in a new
+// split, so a child that is not at its old position is looked up here. The
+// index is only built on the first such miss, which keeps an unchanged or
+// edited-in-place tree free of the map.
+class PreviousNodes {
+public:
+    explicit PreviousNodes(const DockSnapshotNode::Ptr& root) : root_(root) {}
+
+    const DockSnapshotNode::Ptr& find(const DockSnapshotNode::Ptr& atPosition, DockNodeHandle handle)
+    {
+        if (atPosition && atPosition->handle == handle) {
+            return atPosition;
+        }
+        if (!root_ || !handle) {
+            return kNoNode;
+        }
+        if (!indexed_) {
+            add(root_);
+            indexed_ = true;
+        }
+        auto it = byIndex_.find(handle.index);
+        return (it != byIndex_.end() && (*it->second)->handle == handle) ? *it->second : kNoNode;
+    }
+
+private:
+    void add(const DockSnapshotNode::Ptr& node)
+    {
+        if (!node) {
+            return;
+        }
+        byIndex_[node->handle.index] = &node;
+        add(node->first);
+        add(node->second);
+        for (const auto& child : node->children) {
+            add(child);
+        }
+    }
+
+    const DockSnapshotNode::Ptr& root_;
+    bool indexed_ = false;
+    std::unordered_map<uint32_t, const DockSnapshotNode::Ptr*> byIndex_;
+};
+
+const DockSnapshotNode::Ptr& PrevChild(const DockSnapshotNode* prev, size_t index)
+{
+    return (prev && index < prev->children.size()) ? prev->children[index] : kNoNode;
+}
+
+// Each node is compared with the previous node of the same handle: the one
+// at the same position when it still matches, else wherever it was before.
+DockSnapshotNode::Ptr ShareNode(const Node* node, const DockSnapshotNode::Ptr& atPosition, PreviousNodes& previous,
+                                bool includeBounds)
+{
+    if (!node) {
+        return nullptr;
+    }
+    const DockSnapshotNode::Ptr& prev = previous.find(atPosition, node->handle());
+    DockSnapshotNode::Ptr first;
+    DockSnapshotNode::Ptr second;
+    // Tab children are only collected once one differs from prev's, so an
+    // unchanged stack costs no allocation.
+    std::vector<DockSnapshotNode::Ptr> children;
+    bool sameChildren = prev && prev->children.size() == node->children.size();
+    if (node->type == Node::Type::Split) {
+        first = ShareNode(node->first.get(), prev ? prev->first : kNoNode, previous, includeBounds);
+        second = ShareNode(node->second.get(), prev ? prev->second : kNoNode, previous, includeBounds);
+    } else if (node->type == Node::Type::Tab) {
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            DockSnapshotNode::Ptr child =
+                ShareNode(node->children[i].get(), PrevChild(prev.get(), i), previous, includeBounds);
+            if (sameChildren && child == prev->children[i]) {
+                continue;
+            }
+            if (children.empty()) {
+                children.reserve(node->children.size());
+            }
+            if (sameChildren) {
+                children.assign(prev->children.begin(), prev->children.begin() + static_cast<std::ptrdiff_t>(i));
+                sameChildren = false;
+            }
+            children.push_back(std::move(child));
+        }
+    }
+    const DFRect bounds = includeBounds ? node->bounds : DFRect{};
+    if (prev && Unchanged(*prev, *node, bounds, first, second, sameChildren)) {
+        return prev;
+    }
+
+    auto copy = std::make_shared<DockSnapshotNode>();
+    copy->type = node->type;
+    copy->handle = node->handle();
+    copy->bounds = bounds;
+    copy->widget = node->widget;
+    if (node->widget) {
+        copy->title = node->widget->title();
+    }
+    copy->vertical = node->vertical;
+    copy->splitSizing = node->splitSizing;
+    copy->ratio = node->ratio;
+    copy->fixedSize = node->fixedSize;
+    copy->minFirstSize = node->minFirstSize;
+    copy->minSecondSize = node->minSecondSize;
+    copy->activeTab = node->activeTab;
+    copy->tabBarHeight = node->tabBarHeight;
+    copy->first = std::move(first);
+    copy->second = std::move(second);
+    copy->children = sameChildren ? prev->children : std::move(children);
+    return copy;
+}
+
+} // namespace
+
+std::shared_ptr<const DockSnapshot> BuildDockSnapshot(const Node* root, uint64_t layoutVersion,
+                                                      const std::vector<DockSnapshotWindow>& windows,
+                                                      const DockSnapshot* previous, bool includeBounds)
+{
+    auto snapshot = std::make_shared<DockSnapshot>();
+    snapshot->sequence = previous ? previous->sequence + 1 : 1;
+    snapshot->layoutVersion = layoutVersion;
+    const DockSnapshotNode::Ptr& previousRoot = previous ? previous->root : kNoNode;
+    PreviousNodes previousNodes(previousRoot);
+    snapshot->root = ShareNode(root, previousRoot, previousNodes, includeBounds);
+    if (previous && previous->windows && *previous->windows == windows) {
+        snapshot->windows = previous->windows;
+    } else {
+        snapshot->windows = std::make_shared<const std::vector<DockSnapshotWindow>>(windows);
+    }
+    return snapshot;
+}
+
+} // namespace df
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "dock_layout.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace df {
+
+class WindowFrame;
+
+// Immutable copy of one layout node as of a publish. Widget and window
+// pointers identify the live objects but must not be dereferenced off the UI
+// thread; the title is copied for that reason.
+struct DockSnapshotNode {
+    using Ptr = std::shared_ptr<const DockSnapshotNode>;
+
+    DockLayout::Node::Type type = DockLayout::Node::Type::Widget;
+    DockNodeHandle handle;
+    DFRect bounds{};
+    const DockWidget* widget = nullptr;
+    std::string title;
+
+    bool vertical = true;
+    DockLayout::Node::SplitSizing splitSizing = DockLayout::Node::SplitSizing::Ratio;
+    float ratio = 0.5f;
+    float fixedSize = 0.0f;
+    float minFirstSize = 0.0f;
+    float minSecondSize = 0.0f;
+    int activeTab = 0;
+    float tabBarHeight = 0.0f;
+
+    Ptr first;
+    Ptr second;
+    std::vector<Ptr> children;
+};
+
+struct DockSnapshotWindow {
+    const WindowFrame* frame = nullptr;
+    const DockWidget* content = nullptr;
+    std::string title;
+    DFRect bounds{};
+
+    bool operator==(const DockSnapshotWindow& other) const
+    {
+        return frame == other.frame && content == other.content && title == other.title &&
+            bounds.x == other.bounds.x && bounds.y == other.bounds.y &&
+            bounds.width == other.bounds.width && bounds.height == other.bounds.height;
+    }
+};
+
+// One published state of the dock: the docked tree and the floating windows
+// back to front. Snapshots never change after publishing, so any thread may
+// read one it holds. Nodes and the window list that did not change since the
+// previous snapshot are the same objects, which makes publishing an idle
+// frame allocation-free apart from the snapshot header itself.
+struct DockSnapshot {
+    uint64_t sequence = 0;
+    uint64_t layoutVersion = 0;
+    DockSnapshotNode::Ptr root;
+    std::shared_ptr<const std::vector<DockSnapshotWindow>> windows;
+};
+
+// Builds the next snapshot from the live tree, sharing with previous where
+// nodes (matched by handle, wherever they sit in previous) and windows are
+// unchanged.
+// Without includeBounds node bounds are left empty, so a ratio change only
+// copies the path to the split (used for undo history). UI thread only.
+std::shared_ptr<const DockSnapshot> BuildDockSnapshot(const DockLayout::Node* root, uint64_t layoutVersion,
+                                                      const std::vector<DockSnapshotWindow>& windows,
+                                                      const DockSnapshot* previous, bool includeBounds = true);
+
+} // namespace df
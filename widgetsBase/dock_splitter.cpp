@@ -9,31 +9,36 @@ void DockSplitter::updateSplitters(DockLayout::Node* root, const DFRect& contain
 {
     splitters_.clear();
     collectSplitters(root, containerBounds);
+    hitGrid_.clear();
+    for (size_t i = 0; i < splitters_.size(); ++i) {
+        hitGrid_.add(hoverRect(splitters_[i]), static_cast<uint32_t>(i));
+    }
+    hitGrid_.build();
 
     // If layout changed while dragging, drop stale drag state.
     if (activeNode_) {
         bool found = false;
         for (const auto& splitter : splitters_) {
-            if (splitter.node == activeNode_) {
+            if (splitter.node->handle() == activeNode_) {
                 found = true;
                 break;
             }
         }
         if (!found) {
-            activeNode_ = nullptr;
+            activeNode_ = {};
             activeGrabOffset_ = 0.0f;
         }
     }
     if (hoveredNode_) {
         bool foundHover = false;
         for (const auto& splitter : splitters_) {
-            if (splitter.node == hoveredNode_) {
+            if (splitter.node->handle() == hoveredNode_) {
                 foundHover = true;
                 break;
             }
         }
         if (!foundHover) {
-            hoveredNode_ = nullptr;
+            hoveredNode_ = {};
         }
     }
 }
@@ -47,7 +52,7 @@ void DockSplitter::collectSplitters(DockLayout::Node* node, const DFRect& bounds
     splitter.vertical = node->vertical;
     splitter.position = node->ratio;
     splitter.parentBounds = bounds;
-    splitter.dragging = (activeNode_ != nullptr && activeNode_ == node);
+    splitter.dragging = (activeNode_ && activeNode_ == node->handle());
 
     // Splitter lane sits in the explicit inter-widget gap reserved by DockLayout.
     if (splitter.vertical) {
@@ -75,49 +80,60 @@ void DockSplitter::collectSplitters(DockLayout::Node* node, const DFRect& bounds
     splitters_.push_back(splitter);
 }
 
-DockSplitter::Splitter* DockSplitter::splitterAtPoint(const DFPoint& p)
+DFRect DockSplitter::hoverRect(const Splitter& splitter)
 {
-    for (auto& s : splitters_) {
-        DFRect expanded = s.bounds;
-        // Qt 6 style: Invisible hover padding makes grabbing thin splitters easier
-        if (s.vertical) {
-            expanded.x -= (SPLITTER_HOVER_THICKNESS - SPLITTER_THICKNESS) * 0.5f;
-            expanded.width = SPLITTER_HOVER_THICKNESS;
-        } else {
-            expanded.y -= (SPLITTER_HOVER_THICKNESS - SPLITTER_THICKNESS) * 0.5f;
-            expanded.height = SPLITTER_HOVER_THICKNESS;
-        }
-        if (expanded.contains(p)) return &s;
+    DFRect expanded = splitter.bounds;
+    // Qt 6 style: Invisible hover padding makes grabbing thin splitters easier
+    if (splitter.vertical) {
+        expanded.x -= (SPLITTER_HOVER_THICKNESS - SPLITTER_THICKNESS) * 0.5f;
+        expanded.width = SPLITTER_HOVER_THICKNESS;
+    } else {
+        expanded.y -= (SPLITTER_HOVER_THICKNESS - SPLITTER_THICKNESS) * 0.5f;
+        expanded.height = SPLITTER_HOVER_THICKNESS;
     }
-    return nullptr;
+    return expanded;
+}
+
+DockSplitter::Splitter* DockSplitter::splitterAtPoint(const DFPoint& p)
+{
+    const uint32_t index = hitGrid_.find(p);
+    return (index == DFHitGrid::kNone) ? nullptr : &splitters_[index];
 }
 
 void DockSplitter::startDrag(Splitter* splitter, const DFPoint& p)
 {
-    if (!splitter) return;
-    activeNode_ = splitter->node;
+    if (!splitter || !splitter->node) return;
+    // The ratio is committed as the drag goes; record the layout before it.
+    DockManager::instance().checkpoint();
+    DockLayout::Node* node = splitter->node;
+    activeNode_ = node->handle();
     activeVertical_ = splitter->vertical;
     activeParentBounds_ = splitter->parentBounds;
     if (activeVertical_) {
         const float availableWidth = std::max(0.0f, activeParentBounds_.width - SPLITTER_THICKNESS);
-        const float splitX = activeParentBounds_.x + availableWidth * std::clamp(activeNode_->ratio, 0.0f, 1.0f);
+        const float splitX = activeParentBounds_.x + availableWidth * std::clamp(node->ratio, 0.0f, 1.0f);
         activeGrabOffset_ = p.x - splitX;
     } else {
         const float availableHeight = std::max(0.0f, activeParentBounds_.height - SPLITTER_THICKNESS);
-        const float splitY = activeParentBounds_.y + availableHeight * std::clamp(activeNode_->ratio, 0.0f, 1.0f);
+        const float splitY = activeParentBounds_.y + availableHeight * std::clamp(node->ratio, 0.0f, 1.0f);
         activeGrabOffset_ = p.y - splitY;
     }
     splitter->dragging = true;
+    damageSplitter(node);
 }
 
 void DockSplitter::updateDrag(const DFPoint& p)
 {
-    if (!activeNode_) return;
+    DockLayout::Node* node = DockLayout::Resolve(activeNode_);
+    if (!node) {
+        activeNode_ = {};
+        return;
+    }
 
     // Refresh active splitter bounds every event so drag stays correct
     // even after per-frame splitter list rebuild.
     for (const auto& splitter : splitters_) {
-        if (splitter.node == activeNode_) {
+        if (splitter.node == node) {
             activeVertical_ = splitter.vertical;
             activeParentBounds_ = splitter.parentBounds;
             break;
@@ -130,8 +146,8 @@ void DockSplitter::updateDrag(const DFPoint& p)
 
     // Use the values calculated by DockLayout::recalculateMinSizes
     // This ensures the splitter stops exactly where the content says it must.
-    float minFirst = std::clamp(activeNode_->minFirstSize, 0.0f, available);
-    float minSecond = std::clamp(activeNode_->minSecondSize, 0.0f, available);
+    float minFirst = std::clamp(node->minFirstSize, 0.0f, available);
+    float minSecond = std::clamp(node->minSecondSize, 0.0f, available);
     const float minSum = minFirst + minSecond;
     if (minSum > available) {
         // Handle compression when window is too small
@@ -158,29 +174,57 @@ void DockSplitter::updateDrag(const DFPoint& p)
     const float secondSize = available - firstSize;
 
     // Update the node state
-    activeNode_->ratio = (available > 0.0f) ? (firstSize / available) : 0.5f;
-    if (activeNode_->splitSizing == DockLayout::Node::SplitSizing::FixedFirst) {
-        activeNode_->fixedSize = firstSize;
-    } else if (activeNode_->splitSizing == DockLayout::Node::SplitSizing::FixedSecond) {
-        activeNode_->fixedSize = secondSize;
+    const float ratio = (available > 0.0f) ? (firstSize / available) : 0.5f;
+    if (ratio != node->ratio) {
+        if (damage_) {
+            damage_->add(activeParentBounds_);
+        }
+        DockLayout::MarkDirty(node);
+    }
+    node->ratio = ratio;
+    if (node->splitSizing == DockLayout::Node::SplitSizing::FixedFirst) {
+        node->fixedSize = firstSize;
+    } else if (node->splitSizing == DockLayout::Node::SplitSizing::FixedSecond) {
+        node->fixedSize = secondSize;
     }
 }
 
 void DockSplitter::endDrag()
 {
-    activeNode_ = nullptr;
+    damageSplitter(DockLayout::Resolve(activeNode_));
+    activeNode_ = {};
     activeGrabOffset_ = 0.0f;
 }
 
+void DockSplitter::damageSplitter(const DockLayout::Node* node)
+{
+    if (!damage_ || !node) {
+        return;
+    }
+    for (const auto& s : splitters_) {
+        if (s.node == node) {
+            // The handle is wider than the lane; cover it and its antialiasing.
+            constexpr float pad = SPLITTER_HOVER_THICKNESS;
+            damage_->add({s.bounds.x - pad, s.bounds.y - pad, s.bounds.width + pad * 2.0f, s.bounds.height + pad * 2.0f});
+            return;
+        }
+    }
+}
+
 void DockSplitter::render(Canvas& canvas)
 {
     const auto& theme = CurrentTheme();
     if (!theme.drawSplitter) {
         return;
     }
+    DFCanvasScopeGuard scope(canvas, DFCanvasScope::DockSplitter);
     for (const auto& s : splitters_) {
-        const bool dragging = (activeNode_ != nullptr && activeNode_ == s.node);
-        const bool hovered = (hoveredNode_ != nullptr && hoveredNode_ == s.node);
+        constexpr float pad = SPLITTER_HOVER_THICKNESS;
+        if (canvas.isClippedOut({s.bounds.x - pad, s.bounds.y - pad, s.bounds.width + pad * 2.0f, s.bounds.height + pad * 2.0f})) {
+            continue;
+        }
+        const bool dragging = (activeNode_ && activeNode_ == s.node->handle());
+        const bool hovered = (hoveredNode_ && hoveredNode_ == s.node->handle());
 
         const DFColor lineColor = theme.splitter;
         DFColor handleColor = theme.splitter;
@@ -284,10 +328,16 @@ void DockSplitter::render(Canvas& canvas)
 }
 
 bool DockSplitter::handleEvent(Event& event)
+{
+    const bool needsHit = event.type == Event::Type::MouseDown || (event.type == Event::Type::MouseMove && !activeNode_);
+    return handleEvent(event, needsHit ? splitterAtPoint({event.x, event.y}) : nullptr);
+}
+
+bool DockSplitter::handleEvent(Event& event, Splitter* hit)
 {
     switch (event.type) {
     case Event::Type::MouseDown: {
-        if (auto* s = splitterAtPoint({event.x, event.y})) {
+        if (auto* s = hit) {
             startDrag(s, {event.x, event.y});
             event.handled = true;
             return true;
@@ -300,10 +350,12 @@ bool DockSplitter::handleEvent(Event& event)
             event.handled = true;
             return true;
         }
-        if (auto* s = splitterAtPoint({event.x, event.y})) {
-            hoveredNode_ = s->node;
-        } else {
-            hoveredNode_ = nullptr;
+        auto* s = hit;
+        const DockLayout::NodeHandle hovered = DockLayout::HandleOf(s ? s->node : nullptr);
+        if (hovered != hoveredNode_) {
+            damageSplitter(DockLayout::Resolve(hoveredNode_));
+            damageSplitter(s ? s->node : nullptr);
+            hoveredNode_ = hovered;
         }
         break;
     }
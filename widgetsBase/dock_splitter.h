@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dock_layout.h"
+#include "hit_grid.h"
 #include <vector>
 
 namespace df {
@@ -23,18 +24,34 @@ public:
     void endDrag();
     void render(Canvas& canvas);
     bool handleEvent(Event& event);
-    bool isDragging() const { return activeNode_ != nullptr; }
-    void clear() { splitters_.clear(); }
+    // Same, with the splitter under the pointer already known (an
+    // EventRouter hit); presses and hover moves use it instead of a query.
+    bool handleEvent(Event& event, Splitter* hit);
+    bool isDragging() const { return DockLayout::Resolve(activeNode_) != nullptr; }
+    void clear()
+    {
+        splitters_.clear();
+        hitGrid_.clear();
+    }
+    // Receives the handle of splitters whose hover/drag state changes and the
+    // parent area of a split whose ratio moves.
+    void setDamageRegion(DFDamageRegion* damage) { damage_ = damage; }
 
 private:
     void collectSplitters(DockLayout::Node* node, const DFRect& bounds);
+    void damageSplitter(const DockLayout::Node* node);
+    static DFRect hoverRect(const Splitter& splitter);
 
     std::vector<Splitter> splitters_;
-    DockLayout::Node* activeNode_ = nullptr;
-    DockLayout::Node* hoveredNode_ = nullptr;
+    DFHitGrid hitGrid_; // hover rects, rebuilt with splitters_
+    // Held by handle: a layout edit mid-drag can free the split node, which
+    // then resolves to null instead of leaving a dangling pointer.
+    DockLayout::NodeHandle activeNode_{};
+    DockLayout::NodeHandle hoveredNode_{};
     bool activeVertical_ = true;
     DFRect activeParentBounds_{};
     float activeGrabOffset_ = 0.0f;
+    DFDamageRegion* damage_ = nullptr;
 
     static constexpr float SPLITTER_THICKNESS = DockLayout::SplitterGapPx();
     static constexpr float SPLITTER_HOVER_THICKNESS = 4.0f;
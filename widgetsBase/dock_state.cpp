@@ -0,0 +1,99 @@
+#include "dock_state.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace df {
+
+namespace {
+
+const char* SizingName(uint8_t sizing)
+{
+    switch (sizing) {
+    case 1: return "fixed-first";
+    case 2: return "fixed-second";
+    default: return "ratio";
+    }
+}
+
+bool DumpNode(DockStateReader& reader, const std::vector<std::string_view>& strings, int depth, std::string& out)
+{
+    DockStateNode node;
+    if (depth > kDockStateMaxDepth || !reader.node(node, static_cast<uint32_t>(strings.size()))) {
+        return false;
+    }
+    out.append(static_cast<size_t>(depth) * 2, ' ');
+    char line[160];
+    switch (node.tag) {
+    case DockStateNode::Tag::Empty:
+        out += "empty\n";
+        return true;
+    case DockStateNode::Tag::Widget:
+        out += "widget \"";
+        out.append(strings[node.title].data(), strings[node.title].size());
+        out += "\"\n";
+        return true;
+    case DockStateNode::Tag::Split:
+        std::snprintf(line, sizeof(line), "split %s ratio=%g sizing=%s", node.vertical ? "vertical" : "horizontal",
+                      node.ratio, SizingName(node.sizing));
+        out += line;
+        if (node.sizing != 0) {
+            std::snprintf(line, sizeof(line), " fixed=%g", node.fixedSize);
+            out += line;
+        }
+        std::snprintf(line, sizeof(line), " min=%g/%g\n", node.minFirstSize, node.minSecondSize);
+        out += line;
+        return DumpNode(reader, strings, depth + 1, out) && DumpNode(reader, strings, depth + 1, out);
+    case DockStateNode::Tag::Tab:
+        std::snprintf(line, sizeof(line), "tabs active=%u count=%u\n", node.activeTab, node.childCount);
+        out += line;
+        for (uint32_t i = 0; i < node.childCount; ++i) {
+            if (!DumpNode(reader, strings, depth + 1, out)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::string DockStateToText(std::string_view state)
+{
+    DockStateReader reader(state.data(), state.size());
+    uint32_t stringCount = 0;
+    if (!reader.header() || !reader.varint(stringCount) || stringCount > reader.remaining()) {
+        return {};
+    }
+    std::vector<std::string_view> strings(stringCount);
+    for (auto& text : strings) {
+        if (!reader.string(text)) {
+            return {};
+        }
+    }
+
+    std::string out = "dock-state v" + std::to_string(kDockStateVersion) + "\n";
+    if (!DumpNode(reader, strings, 0, out)) {
+        return {};
+    }
+    uint32_t floatingCount = 0;
+    if (!reader.varint(floatingCount)) {
+        return {};
+    }
+    for (uint32_t i = 0; i < floatingCount; ++i) {
+        uint32_t title = 0;
+        DFRect bounds{};
+        if (!reader.floating(title, bounds, stringCount)) {
+            return {};
+        }
+        char line[96];
+        std::snprintf(line, sizeof(line), "\" %g %g %g %g\n", bounds.x, bounds.y, bounds.width, bounds.height);
+        out += "floating \"";
+        out.append(strings[title].data(), strings[title].size());
+        out += line;
+    }
+    return reader.atEnd() ? out : std::string{};
+}
+
+} // namespace df
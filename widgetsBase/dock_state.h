@@ -0,0 +1,240 @@
+#pragma once
+
+#include "core_types.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace df {
+
+// Binary dock layout state written by DockManager::saveState():
+//
+//   "DFLS" magic, version varint
+//   string table: count varint, then per string a length varint and bytes;
+//                 one title per placed widget, so equal titles may repeat
+//   tree: one node record in pre-order (an Empty record when there is none)
+//   floating windows, back to front: count varint, then per window a title
+//   index varint and x, y, width, height floats
+//
+// A node record is a tag byte followed by its fields:
+//   Widget: title index varint
+//   Split:  flags byte (bit 0 vertical, bits 1-2 SplitSizing), ratio,
+//           fixedSize (non-Ratio sizing only), minFirstSize, minSecondSize
+//           floats, then the first and second child records
+//   Tab:    active tab varint, child count varint, then the child records
+// Integers are LEB128 varints and floats are little-endian IEEE 754 bits.
+struct DockStateNode {
+    enum class Tag : uint8_t { Empty = 0, Widget = 1, Split = 2, Tab = 3 };
+
+    Tag tag = Tag::Empty;
+    uint32_t title = 0;
+    bool vertical = true;
+    uint8_t sizing = 0;
+    float ratio = 0.5f;
+    float fixedSize = 0.0f;
+    float minFirstSize = 0.0f;
+    float minSecondSize = 0.0f;
+    uint32_t activeTab = 0;
+    uint32_t childCount = 0;
+};
+
+constexpr char kDockStateMagic[4] = {'D', 'F', 'L', 'S'};
+constexpr uint32_t kDockStateVersion = 1;
+constexpr int kDockStateMaxDepth = 256;
+
+class DockStateWriter {
+public:
+    explicit DockStateWriter(std::string& out) : out_(out) {}
+
+    void header()
+    {
+        out_.append(kDockStateMagic, sizeof(kDockStateMagic));
+        varint(kDockStateVersion);
+    }
+
+    void varint(uint32_t value)
+    {
+        while (value >= 0x80u) {
+            out_.push_back(static_cast<char>((value & 0x7Fu) | 0x80u));
+            value >>= 7;
+        }
+        out_.push_back(static_cast<char>(value));
+    }
+
+    void byte(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void f32(float value)
+    {
+        uint32_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; ++i) {
+            out_.push_back(static_cast<char>((bits >> (i * 8)) & 0xFFu));
+        }
+    }
+
+    void string(std::string_view text)
+    {
+        varint(static_cast<uint32_t>(text.size()));
+        out_.append(text.data(), text.size());
+    }
+
+    void node(const DockStateNode& node)
+    {
+        byte(static_cast<uint8_t>(node.tag));
+        switch (node.tag) {
+        case DockStateNode::Tag::Widget:
+            varint(node.title);
+            break;
+        case DockStateNode::Tag::Split:
+            byte(static_cast<uint8_t>((node.vertical ? 1u : 0u) | ((node.sizing & 3u) << 1)));
+            f32(node.ratio);
+            if (node.sizing != 0) {
+                f32(node.fixedSize);
+            }
+            f32(node.minFirstSize);
+            f32(node.minSecondSize);
+            break;
+        case DockStateNode::Tag::Tab:
+            varint(node.activeTab);
+            varint(node.childCount);
+            break;
+        case DockStateNode::Tag::Empty:
+            break;
+        }
+    }
+
+private:
+    std::string& out_;
+};
+
+// Cursor over an encoded state. Strings are views into the input, so reading
+// never allocates. Any malformed or truncated field fails the reader and every
+// later read.
+class DockStateReader {
+public:
+    DockStateReader(const void* data, size_t size)
+        : cur_(static_cast<const uint8_t*>(data)), end_(cur_ + size) {}
+
+    bool header()
+    {
+        if (remaining() < sizeof(kDockStateMagic) || std::memcmp(cur_, kDockStateMagic, sizeof(kDockStateMagic)) != 0) {
+            return fail();
+        }
+        cur_ += sizeof(kDockStateMagic);
+        uint32_t version = 0;
+        return varint(version) && (version == kDockStateVersion || fail());
+    }
+
+    bool varint(uint32_t& value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (cur_ == end_) {
+                return fail();
+            }
+            const uint8_t b = *cur_++;
+            value |= static_cast<uint32_t>(b & 0x7Fu) << shift;
+            if ((b & 0x80u) == 0) {
+                return ok_;
+            }
+        }
+        return fail();
+    }
+
+    bool byte(uint8_t& value)
+    {
+        if (cur_ == end_) {
+            return fail();
+        }
+        value = *cur_++;
+        return ok_;
+    }
+
+    bool f32(float& value)
+    {
+        if (remaining() < 4) {
+            return fail();
+        }
+        const uint32_t bits = static_cast<uint32_t>(cur_[0]) | (static_cast<uint32_t>(cur_[1]) << 8) |
+            (static_cast<uint32_t>(cur_[2]) << 16) | (static_cast<uint32_t>(cur_[3]) << 24);
+        cur_ += 4;
+        std::memcpy(&value, &bits, sizeof(value));
+        return std::isfinite(value) || fail();
+    }
+
+    bool string(std::string_view& text)
+    {
+        uint32_t length = 0;
+        if (!varint(length) || remaining() < length) {
+            return fail();
+        }
+        text = {reinterpret_cast<const char*>(cur_), length};
+        cur_ += length;
+        return ok_;
+    }
+
+    // Reads one node record without its children. Title indices are checked
+    // against stringCount.
+    bool node(DockStateNode& node, uint32_t stringCount)
+    {
+        node = {};
+        uint8_t tag = 0;
+        if (!byte(tag)) {
+            return false;
+        }
+        switch (static_cast<DockStateNode::Tag>(tag)) {
+        case DockStateNode::Tag::Empty:
+            node.tag = DockStateNode::Tag::Empty;
+            return ok_;
+        case DockStateNode::Tag::Widget:
+            node.tag = DockStateNode::Tag::Widget;
+            return varint(node.title) && (node.title < stringCount || fail());
+        case DockStateNode::Tag::Split: {
+            node.tag = DockStateNode::Tag::Split;
+            uint8_t flags = 0;
+            if (!byte(flags) || (flags >> 3) != 0 || ((flags >> 1) & 3u) > 2) {
+                return fail();
+            }
+            node.vertical = (flags & 1u) != 0;
+            node.sizing = static_cast<uint8_t>((flags >> 1) & 3u);
+            return f32(node.ratio) && (node.sizing == 0 || f32(node.fixedSize)) &&
+                f32(node.minFirstSize) && f32(node.minSecondSize);
+        }
+        case DockStateNode::Tag::Tab:
+            node.tag = DockStateNode::Tag::Tab;
+            // Each child takes at least one byte.
+            return varint(node.activeTab) && varint(node.childCount) && (node.childCount <= remaining() || fail());
+        }
+        return fail();
+    }
+
+    bool floating(uint32_t& title, DFRect& bounds, uint32_t stringCount)
+    {
+        return varint(title) && (title < stringCount || fail()) &&
+            f32(bounds.x) && f32(bounds.y) && f32(bounds.width) && f32(bounds.height);
+    }
+
+    bool ok() const { return ok_; }
+    bool atEnd() const { return ok_ && cur_ == end_; }
+    size_t remaining() const { return static_cast<size_t>(end_ - cur_); }
+
+private:
+    bool fail()
+    {
+        ok_ = false;
+        cur_ = end_;
+        return false;
+    }
+
+    const uint8_t* cur_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+// Indented text dump of an encoded state for logs and diffs; empty when the
+// state does not parse.
+std::string DockStateToText(std::string_view state);
+
+} // namespace df
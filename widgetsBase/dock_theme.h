@@ -166,8 +166,21 @@ inline const DockTheme& CurrentTheme()
     return MutableTheme();
 }
 
+// Bumped by SetTheme so caches of themed drawing can tell a theme switch.
+inline uint64_t& MutableThemeVersion()
+{
+    static uint64_t version = 1;
+    return version;
+}
+
+inline uint64_t ThemeVersion()
+{
+    return MutableThemeVersion();
+}
+
 inline void SetTheme(const DockTheme& theme)
 {
+    ++MutableThemeVersion();
     MutableTheme() = theme;
     DFSetTextPixelScale(theme.fontPixelScale);
     DFSetTextSmooth(theme.smoothFont);
@@ -36,7 +36,14 @@ public:
         if (content()) {
             const DFRect client = clientAreaRect(contentArea);
             content()->setBounds(client);
-            content()->paint(canvas);
+            // Content may draw past its client rect; clip it and skip it
+            // entirely when the current clip (e.g. a damage rect) misses it.
+            if (!canvas.isClippedOut(client)) {
+                DFCanvasScopeGuard scope(canvas, DFCanvasScope::WidgetContent);
+                canvas.pushClip(client);
+                content()->paint(canvas);
+                canvas.popClip();
+            }
         }
     }
 
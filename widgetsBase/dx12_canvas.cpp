@@ -1,4 +1,5 @@
 #include "dx12_canvas.h"
+#include "corner_tessellation.h"
 #include <d3dcompiler.h>
 #include <algorithm>
 #include <stdexcept>
@@ -8,7 +9,6 @@
 using Microsoft::WRL::ComPtr;
 
 namespace {
-constexpr float kPi = 3.14159265358979323846f;
 const char* kVS = R"(
 cbuffer View : register(b0)
 {
@@ -90,7 +90,7 @@ void DX12Canvas::initializePipeline()
 
     D3D12_INPUT_ELEMENT_DESC layout[] = {
         { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
-        { "COLOR",    0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 8,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 8,  D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
     };
 
     D3D12_RASTERIZER_DESC rast{};
@@ -154,14 +154,16 @@ void DX12Canvas::createVertexBuffer(size_t vertexCount)
     vertexBufferView_.SizeInBytes = bufferSize;
 }
 
-void DX12Canvas::drawRectangle(const DFRect& rect, const DFColor& color)
+void DX12Canvas::drawRectangle(const DFRect& source, const DFColor& color)
 {
-    if (rect.width <= 0.0f || rect.height <= 0.0f) {
+    DFRect rect = source;
+    if (rect.width <= 0.0f || rect.height <= 0.0f || !cullRect(rect)) {
         return;
     }
     if (vertices_.size() + 6 > MAX_VERTICES) flush();
-    auto makeV = [&](float x, float y) {
-        return D3DVertex{{x, y}, {color.r, color.g, color.b, color.a}};
+    const DFPackedColor packed = DFPackColor(color);
+    auto makeV = [packed](float x, float y) {
+        return D3DVertex{x, y, packed};
     };
     D3DVertex v1 = makeV(rect.x, rect.y);
     D3DVertex v2 = makeV(rect.x + rect.width, rect.y);
@@ -173,7 +175,7 @@ void DX12Canvas::drawRectangle(const DFRect& rect, const DFColor& color)
 
 void DX12Canvas::drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color)
 {
-    if (rect.width <= 0.0f || rect.height <= 0.0f) {
+    if (rect.width <= 0.0f || rect.height <= 0.0f || isClippedOut(rect)) {
         return;
     }
 
@@ -184,58 +186,16 @@ void DX12Canvas::drawRoundedRectangle(const DFRect& rect, float radius, const DF
         return;
     }
 
-    auto makeVertex = [&](float x, float y) {
-        return D3DVertex{{x, y}, {color.r, color.g, color.b, color.a}};
-    };
-    auto addTriangle = [&](const D3DVertex& a, const D3DVertex& b, const D3DVertex& c) {
-        if (vertices_.size() + 3 > MAX_VERTICES) {
-            flush();
-        }
-        vertices_.push_back(a);
-        vertices_.push_back(b);
-        vertices_.push_back(c);
-    };
-    auto addRect = [&](float x, float y, float w, float h) {
-        if (w <= 0.0f || h <= 0.0f) {
-            return;
-        }
-        D3DVertex v1 = makeVertex(x, y);
-        D3DVertex v2 = makeVertex(x + w, y);
-        D3DVertex v3 = makeVertex(x, y + h);
-        D3DVertex v4 = makeVertex(x + w, y + h);
-        addTriangle(v1, v2, v3);
-        addTriangle(v2, v4, v3);
-    };
-
-    addRect(rect.x + r, rect.y + r, rect.width - r * 2.0f, rect.height - r * 2.0f);
-    addRect(rect.x + r, rect.y, rect.width - r * 2.0f, r);
-    addRect(rect.x + r, rect.y + rect.height - r, rect.width - r * 2.0f, r);
-    addRect(rect.x, rect.y + r, r, rect.height - r * 2.0f);
-    addRect(rect.x + rect.width - r, rect.y + r, r, rect.height - r * 2.0f);
-
-    const int segments = std::max(6, static_cast<int>(std::ceil(r * 0.75f)));
-    auto addCornerFan = [&](float cx, float cy, float startAngle, float endAngle) {
-        const D3DVertex center = makeVertex(cx, cy);
-        for (int i = 0; i < segments; ++i) {
-            const float t0 = static_cast<float>(i) / static_cast<float>(segments);
-            const float t1 = static_cast<float>(i + 1) / static_cast<float>(segments);
-            const float a0 = startAngle + (endAngle - startAngle) * t0;
-            const float a1 = startAngle + (endAngle - startAngle) * t1;
-            const D3DVertex p0 = makeVertex(cx + std::cos(a0) * r, cy + std::sin(a0) * r);
-            const D3DVertex p1 = makeVertex(cx + std::cos(a1) * r, cy + std::sin(a1) * r);
-            addTriangle(center, p0, p1);
-        }
-    };
-
-    addCornerFan(rect.x + r, rect.y + r, kPi, kPi * 1.5f);
-    addCornerFan(rect.x + rect.width - r, rect.y + r, kPi * 1.5f, kPi * 2.0f);
-    addCornerFan(rect.x + rect.width - r, rect.y + rect.height - r, 0.0f, kPi * 0.5f);
-    addCornerFan(rect.x + r, rect.y + rect.height - r, kPi * 0.5f, kPi);
+    // One fan over the traced outline; the scissor trims what the clip hides.
+    const DFCornerTable& corners = DFCornerTessellation::instance().fill(r);
+    outline_.resize(corners.pointCount());
+    corners.trace(rect, false, outline_.data());
+    drawConvexPolygon(outline_.data(), outline_.size(), color);
 }
 
 void DX12Canvas::drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness)
 {
-    if (rect.width <= 0.0f || rect.height <= 0.0f || thickness <= 0.0f) {
+    if (rect.width <= 0.0f || rect.height <= 0.0f || thickness <= 0.0f || isClippedOut(rect)) {
         return;
     }
 
@@ -251,31 +211,36 @@ void DX12Canvas::drawRoundedRectangleOutline(const DFRect& rect, float radius, c
         return;
     }
 
-    drawLine({rect.x + r, rect.y}, {rect.x + rect.width - r, rect.y}, color, t);
-    drawLine({rect.x + r, rect.y + rect.height}, {rect.x + rect.width - r, rect.y + rect.height}, color, t);
-    drawLine({rect.x, rect.y + r}, {rect.x, rect.y + rect.height - r}, color, t);
-    drawLine({rect.x + rect.width, rect.y + r}, {rect.x + rect.width, rect.y + rect.height - r}, color, t);
-
-    const int segments = std::max(8, static_cast<int>(std::ceil(r)));
-    auto drawArc = [&](float cx, float cy, float startAngle, float endAngle) {
-        DFPoint previous{cx + std::cos(startAngle) * r, cy + std::sin(startAngle) * r};
-        for (int i = 1; i <= segments; ++i) {
-            const float tNorm = static_cast<float>(i) / static_cast<float>(segments);
-            const float angle = startAngle + (endAngle - startAngle) * tNorm;
-            DFPoint current{cx + std::cos(angle) * r, cy + std::sin(angle) * r};
-            drawLine(previous, current, color, t);
-            previous = current;
-        }
+    // Closed strip between the outer and inner traces: one quad per arc
+    // segment plus one per straight edge, all from the cached offsets.
+    const DFCornerTable& corners = DFCornerTessellation::instance().ring(r, t);
+    const size_t count = corners.pointCount();
+    outline_.resize(count * 2);
+    corners.trace(rect, false, outline_.data());
+    corners.trace(rect, true, outline_.data() + count);
+    if (vertices_.size() + count * 6 > MAX_VERTICES) flush();
+    const DFPackedColor packed = DFPackColor(color);
+    auto makeV = [packed](const DFPoint& p) {
+        return D3DVertex{p.x, p.y, packed};
     };
-
-    drawArc(rect.x + r, rect.y + r, kPi, kPi * 1.5f);
-    drawArc(rect.x + rect.width - r, rect.y + r, kPi * 1.5f, kPi * 2.0f);
-    drawArc(rect.x + rect.width - r, rect.y + rect.height - r, 0.0f, kPi * 0.5f);
-    drawArc(rect.x + r, rect.y + rect.height - r, kPi * 0.5f, kPi);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t next = (i + 1) % count;
+        const D3DVertex o0 = makeV(outline_[i]);
+        const D3DVertex o1 = makeV(outline_[next]);
+        const D3DVertex i0 = makeV(outline_[count + i]);
+        const D3DVertex i1 = makeV(outline_[count + next]);
+        vertices_.push_back(o0); vertices_.push_back(o1); vertices_.push_back(i0);
+        vertices_.push_back(o1); vertices_.push_back(i1); vertices_.push_back(i0);
+    }
 }
 
-void DX12Canvas::drawLine(const DFPoint& a, const DFPoint& b, const DFColor& color, float thickness)
+void DX12Canvas::drawLine(const DFPoint& from, const DFPoint& to, const DFColor& color, float thickness)
 {
+    DFPoint a = from;
+    DFPoint b = to;
+    if (!cullLine(a, b, thickness)) {
+        return;
+    }
     const float dx = b.x - a.x;
     const float dy = b.y - a.y;
     const float len = std::sqrt(dx * dx + dy * dy);
@@ -289,24 +254,86 @@ void DX12Canvas::drawLine(const DFPoint& a, const DFPoint& b, const DFColor& col
     const float ny = dx / len;
     const float half = std::max(0.5f, thickness * 0.5f);
 
-    const D3DVertex v1{{a.x + nx * half, a.y + ny * half}, {color.r, color.g, color.b, color.a}};
-    const D3DVertex v2{{a.x - nx * half, a.y - ny * half}, {color.r, color.g, color.b, color.a}};
-    const D3DVertex v3{{b.x + nx * half, b.y + ny * half}, {color.r, color.g, color.b, color.a}};
-    const D3DVertex v4{{b.x - nx * half, b.y - ny * half}, {color.r, color.g, color.b, color.a}};
+    const DFPackedColor packed = DFPackColor(color);
+    const D3DVertex v1{a.x + nx * half, a.y + ny * half, packed};
+    const D3DVertex v2{a.x - nx * half, a.y - ny * half, packed};
+    const D3DVertex v3{b.x + nx * half, b.y + ny * half, packed};
+    const D3DVertex v4{b.x - nx * half, b.y - ny * half, packed};
 
     if (vertices_.size() + 6 > MAX_VERTICES) flush();
     vertices_.push_back(v1); vertices_.push_back(v2); vertices_.push_back(v3);
     vertices_.push_back(v2); vertices_.push_back(v4); vertices_.push_back(v3);
 }
 
+void DX12Canvas::drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color)
+{
+    if (count < 3 || isClippedOut(DFPointsBounds(points, count))) {
+        return;
+    }
+    const size_t needed = (count - 2) * 3;
+    if (needed > MAX_VERTICES) {
+        Canvas::drawConvexPolygon(points, count, color);
+        return;
+    }
+    if (vertices_.size() + needed > MAX_VERTICES) flush();
+    const DFPackedColor packed = DFPackColor(color);
+    auto makeV = [packed](const DFPoint& p) {
+        return D3DVertex{p.x, p.y, packed};
+    };
+    const D3DVertex pivot = makeV(points[0]);
+    for (size_t i = 1; i + 1 < count; ++i) {
+        vertices_.push_back(pivot);
+        vertices_.push_back(makeV(points[i]));
+        vertices_.push_back(makeV(points[i + 1]));
+    }
+}
+
+void DX12Canvas::drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul, bool /*smooth*/)
+{
+    // Plain quads per atlas rectangle: rounded "smooth" cells would each become
+    // a triangle fan, which is what made tab labels dominate the vertex count.
+    DFDrawGlyphRunRects(*this, x, y, text, color, scaleMul, false);
+}
+
+void DX12Canvas::setClipRect(const DFRect& rect)
+{
+    flush();
+    Canvas::setClipRect(rect);
+    applyScissor(rect);
+}
+
+void DX12Canvas::clearClipRect()
+{
+    flush();
+    Canvas::clearClipRect();
+    applyScissor({0.0f, 0.0f, targetWidth_, targetHeight_});
+}
+
+void DX12Canvas::applyScissor(const DFRect& rect)
+{
+    const LONG maxX = static_cast<LONG>(std::ceil(targetWidth_));
+    const LONG maxY = static_cast<LONG>(std::ceil(targetHeight_));
+    D3D12_RECT scissor{};
+    scissor.left = std::clamp(static_cast<LONG>(std::floor(rect.x)), 0L, maxX);
+    scissor.top = std::clamp(static_cast<LONG>(std::floor(rect.y)), 0L, maxY);
+    scissor.right = std::clamp(static_cast<LONG>(std::ceil(rect.x + rect.width)), scissor.left, maxX);
+    scissor.bottom = std::clamp(static_cast<LONG>(std::ceil(rect.y + rect.height)), scissor.top, maxY);
+    commandList_->RSSetScissorRects(1, &scissor);
+}
+
 void DX12Canvas::flush()
 {
     if (vertices_.empty()) return;
 
+    // Out of room: restart at the front, as single-flush frames always did.
+    if (uploadedVertices_ + vertices_.size() > MAX_VERTICES) {
+        uploadedVertices_ = 0;
+    }
+
     D3D12_RANGE readRange{0, 0};
     uint8_t* data = nullptr;
     vertexBuffer_->Map(0, &readRange, reinterpret_cast<void**>(&data));
-    std::memcpy(data, vertices_.data(), vertices_.size() * sizeof(D3DVertex));
+    std::memcpy(data + uploadedVertices_ * sizeof(D3DVertex), vertices_.data(), vertices_.size() * sizeof(D3DVertex));
     vertexBuffer_->Unmap(0, nullptr);
 
     struct ViewCB { float screenSize[2]; float pad[2]; } cb{{targetWidth_, targetHeight_}, {0,0}};
@@ -315,13 +342,17 @@ void DX12Canvas::flush()
     commandList_->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     commandList_->IASetVertexBuffers(0, 1, &vertexBufferView_);
     commandList_->SetGraphicsRoot32BitConstants(0, 2, cb.screenSize, 0);
-    commandList_->DrawInstanced(static_cast<UINT>(vertices_.size()), 1, 0, 0);
+    commandList_->DrawInstanced(static_cast<UINT>(vertices_.size()), 1, static_cast<UINT>(uploadedVertices_), 0);
 
+    uploadedVertices_ += vertices_.size();
     vertices_.clear();
 }
 
 void DX12Canvas::clear()
 {
     vertices_.clear();
+    uploadedVertices_ = 0;
+    Canvas::clearClipRect();
+    dropClipStack();
 }
 
@@ -13,10 +13,8 @@
 
 class DX12Canvas : public Canvas {
 public:
-    struct D3DVertex {
-        float position[2];
-        float color[4];
-    };
+    // Position and packed RGBA8 color, read as R8G8B8A8_UNORM.
+    using D3DVertex = DFVertex;
 
     DX12Canvas(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, float targetWidth, float targetHeight);
     ~DX12Canvas() = default;
@@ -25,10 +23,16 @@ public:
     void drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color) override;
     void drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness = 1.0f) override;
     void drawLine(const DFPoint& a, const DFPoint& b, const DFColor& color, float thickness = 1.0f) override;
+    // Triangle fan from the first point: count - 2 triangles.
+    void drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color) override;
     void drawText(float x, float y, const std::string& text, const DFColor& color) override
     {
         Canvas::drawText(x, y, text, color);
     }
+    void drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul = 1.0f, bool smooth = false) override;
+    // Flushes pending vertices, then sets the command list scissor.
+    void setClipRect(const DFRect& rect) override;
+    void clearClipRect() override;
 
     void setRenderSize(float w, float h) { targetWidth_ = w; targetHeight_ = h; }
     void flush();
@@ -37,6 +41,7 @@ public:
 private:
     void initializePipeline();
     void createVertexBuffer(size_t vertexCount);
+    void applyScissor(const DFRect& rect);
 
     ID3D12Device* device_;
     ID3D12GraphicsCommandList* commandList_;
@@ -49,6 +54,11 @@ private:
     D3D12_VERTEX_BUFFER_VIEW vertexBufferView_{};
 
     std::vector<D3DVertex> vertices_;
+    // Traced rounded-rect outlines, reused across calls.
+    std::vector<DFPoint> outline_;
+    // Vertices already uploaded this frame; each flush appends after them so
+    // draws recorded earlier in the command list keep their data.
+    size_t uploadedVertices_ = 0;
     static constexpr size_t MAX_VERTICES = 65536;
 };
 
@@ -1,12 +1,20 @@
+#include "damage_region.h"
 #include "dock_framework.h"
 #include "dock_layout.h"
 #include "dx12_canvas.h"
+#include "counting_canvas.h"
+#include "display_list_canvas.h"
 #include "dx12_dock_widget.h"
 #include "window_manager.h"
 #include "dock_splitter.h"
 #include "dock_theme.h"
 #include "dock_renderer.h"
+#include "event_router.h"
 #include "icon_module.h"
+#include "input_coalescer.h"
+#include "input_queue.h"
+#include "input_recording.h"
+#include "latency_tracker.h"
 
 #include <windows.h>
 #include <windowsx.h>
@@ -16,6 +24,7 @@
 #include <dxgi1_6.h>
 #include <d3dcompiler.h>
 #include <wrl.h>
+#include <array>
 #include <vector>
 #include <string>
 #include <memory>
@@ -72,6 +81,15 @@ int EnvInt(const char* name, int defaultValue)
     return std::atoi(value);
 }
 
+uint32_t CurrentModifiers()
+{
+    uint32_t modifiers = 0;
+    if (GetKeyState(VK_SHIFT) & 0x8000) modifiers |= static_cast<uint32_t>(Event::Modifier::Shift);
+    if (GetKeyState(VK_CONTROL) & 0x8000) modifiers |= static_cast<uint32_t>(Event::Modifier::Control);
+    if (GetKeyState(VK_MENU) & 0x8000) modifiers |= static_cast<uint32_t>(Event::Modifier::Alt);
+    return modifiers;
+}
+
 std::string EnvString(const char* name, const char* defaultValue)
 {
     const char* value = std::getenv(name);
@@ -147,8 +165,10 @@ bool IsPointInTabDockCenterZone(const DFRect& bounds, const DFPoint& point)
     return center.width > 1.0f && center.height > 1.0f && center.contains(point);
 }
 
+// Visuals and gestures outlive the event that produced them, so they refer to
+// their tab node by handle and resolve it on use.
 struct TabVisual {
-    df::DockLayout::Node* node = nullptr;
+    df::DockLayout::NodeHandle node{};
     DFRect strip{};
     std::vector<DFRect> tabRects{};
     std::vector<df::DockWidget*> widgets{};
@@ -162,18 +182,13 @@ struct TabInteractionHit {
     bool closeHit = false;
 };
 
-enum class ActionOwner {
-    None,
-    FloatingWindow,
-    DockWidgetDrag,
-    SplitterDrag,
-    TabGesture
-};
+// Pointer capture owners; the router releases the capture on mouse up.
+using ActionOwner = df::EventRouter::Capture;
 
 struct TabGestureState {
     bool active = false;
     bool undocked = false;
-    df::DockLayout::Node* node = nullptr;
+    df::DockLayout::NodeHandle node{};
     int tabIndex = 0;
     DFRect strip{};
     DFPoint start{};
@@ -202,7 +217,7 @@ void CollectTabVisuals(df::DockLayout::Node* node, std::vector<TabVisual>& out)
     if (!node) return;
     if (node->type == df::DockLayout::Node::Type::Tab && !node->children.empty()) {
         TabVisual visual;
-        visual.node = node;
+        visual.node = node->handle();
         visual.strip = df::DockLayout::TabStripRect(*node, node->bounds);
         for (size_t i = 0; i < node->children.size(); ++i) {
             visual.tabRects.push_back(df::DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size()));
@@ -217,50 +232,36 @@ void CollectTabVisuals(df::DockLayout::Node* node, std::vector<TabVisual>& out)
     CollectTabVisuals(node->second.get(), out);
 }
 
-bool HandleTabInteraction(df::DockLayout::Node* node, const DFPoint& p, TabInteractionHit& outHit)
+bool HandleTabInteraction(const df::DockLayout& layout, const DFPoint& p, TabInteractionHit& outHit)
 {
     if (!kEnableTabUi) {
         return false;
     }
-    if (!node || !node->bounds.contains(p)) return false;
+    df::DockLayout::Node* node = layout.tabNodeAt(p);
+    if (!node) return false;
 
-    if (node->type == df::DockLayout::Node::Type::Tab && !node->children.empty()) {
-        const DFRect bar = df::DockLayout::TabStripRect(*node, node->bounds);
-        if (bar.contains(p)) {
-            for (size_t i = 0; i < node->children.size(); ++i) {
-                const DFRect tabRect = df::DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
-                if (tabRect.width <= 1.0f || tabRect.height <= 1.0f || !tabRect.contains(p)) {
-                    continue;
-                }
-                outHit.node = node;
-                outHit.tabIndex = static_cast<int>(i);
-                outHit.tabRect = tabRect;
-                outHit.closeRect = df::DockRenderer::tabCloseRect(tabRect);
-                outHit.closeHit = outHit.closeRect.contains(p);
-                return true;
-            }
-        }
-    }
-
-    if (node->type == df::DockLayout::Node::Type::Tab) {
-        for (auto& child : node->children) {
-            if (HandleTabInteraction(child.get(), p, outHit)) return true;
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        const DFRect tabRect = df::DockLayout::TabRectForIndex(*node, node->bounds, i, node->children.size());
+        if (tabRect.width <= 1.0f || tabRect.height <= 1.0f || !tabRect.contains(p)) {
+            continue;
         }
-    } else if (node->type == df::DockLayout::Node::Type::Split) {
-        if (node->first && HandleTabInteraction(node->first.get(), p, outHit)) return true;
-        if (node->second && HandleTabInteraction(node->second.get(), p, outHit)) return true;
+        outHit.node = node;
+        outHit.tabIndex = static_cast<int>(i);
+        outHit.tabRect = tabRect;
+        outHit.closeRect = df::DockRenderer::tabCloseRect(tabRect);
+        outHit.closeHit = outHit.closeRect.contains(p);
+        return true;
     }
-
     return false;
 }
 
-bool HandleTabInteraction(df::DockLayout::Node* node, const DFPoint& p)
+bool HandleTabInteraction(const df::DockLayout& layout, const DFPoint& p)
 {
     if (!kEnableTabUi) {
         return false;
     }
     TabInteractionHit hit{};
-    if (!HandleTabInteraction(node, p, hit)) {
+    if (!HandleTabInteraction(layout, p, hit)) {
         return false;
     }
     if (hit.closeHit) {
@@ -275,6 +276,7 @@ bool HandleTabInteraction(df::DockLayout::Node* node, const DFPoint& p)
     }
     if (hit.node) {
         hit.node->activeTab = hit.tabIndex;
+        df::DockLayout::MarkDirty(hit.node);
         return true;
     }
     return false;
@@ -612,13 +614,15 @@ private:
     LRESULT handleMouseMessage(UINT msg, WPARAM wParam, LPARAM lParam);
     LRESULT handleKeyMessage(WPARAM wParam, LPARAM lParam);
     void processEvent(Event& event);
+    void pumpInput();
+    void recordFrame();
+    void saveRecording();
     void dispatchMouseEvent(Event& event);
     bool handleShortcutKey(int key, bool ctrlDown, bool shiftDown);
     bool closeTabNode(df::DockLayout::Node* node, int tabIndex);
     df::DockLayout::Node* findTabNodeNearCursor() const;
     void updateHoverState(const DFPoint& point);
-    bool handleActiveAction(Event& event);
-    bool beginTabGesture(Event& event);
+    bool beginTabGesture(Event& event, const df::DockHit& hit);
     bool handleTabGesture(Event& event);
     bool undockActiveTab(const DFPoint& mousePos);
     bool tryDockFloatingWindowAtPoint(df::WindowFrame* window, const DFPoint& mousePos);
@@ -626,7 +630,8 @@ private:
     df::DockWidget* pickDockTarget(const DFPoint& mousePos, df::DockWidget* movingWidget) const;
     df::DockWidget* pickDockTargetByOverlap(const DFRect& movingBounds, const DFPoint& dropPoint, df::DockWidget* movingWidget) const;
     bool dockFloatingWindowIntoTarget(df::WindowFrame* window, df::DockWidget* targetWidget);
-    void renderDebugOverlay();
+    void renderDebugOverlay(Canvas& canvas);
+    void trackUntrackedHoverDamage();
     void updateStatusCaption();
     void clearActiveAction();
     void refreshLayoutState();
@@ -670,13 +675,34 @@ private:
 
     // Docking
     std::unique_ptr<DX12Canvas> canvas_;
+    DisplayListCanvas frameList_;
+    // Wraps frameList_ while recording to attribute draws per subsystem.
+    CountingCanvas frameStats_{frameList_};
+    uint64_t lastPresentedHash_ = 0;
+    bool forcePresent_ = true;
+    bool skipIdleFrames_ = true;
+    bool lastFrameSkipped_ = false;
+    size_t skippedFrames_ = 0;
+    // Partial redraw: components report damage into frameDamage_; the back
+    // buffer being drawn also missed what the previous present repainted.
+    DFDamageRegion frameDamage_;
+    DFDamageRegion presentedDamage_;
+    bool partialRedraw_ = true;
+    size_t partialFrames_ = 0;
+    DFRect hoverOutlineRect_{};
+    DFRect hoverTitleButtonRect_{};
     df::DockLayout layout_;
     df::DockSplitter splitter_;
+    df::DockRenderer dockRenderer_;
     std::vector<std::unique_ptr<df::DX12DockWidget>> widgets_;
     std::vector<TabVisual> tabVisuals_;
     df::WindowFrame* floatingWindow_ = nullptr;
-    ActionOwner activeAction_ = ActionOwner::None;
-    df::WindowFrame* activeWindow_ = nullptr;
+    df::EventRouter router_{layout_, splitter_};
+    df::InputQueue inputQueue_{1024};
+    df::InputCoalescer input_;
+    df::LatencyTracker latency_;
+    std::unique_ptr<df::InputRecorder> recorder_; // DF_RECORD_INPUT
+    std::string recordPath_;
     TabGestureState tabGesture_{};
     EventConsole eventConsole_;
     DFPoint lastMousePos_{};
@@ -725,8 +751,20 @@ DX12Demo::DX12Demo(HINSTANCE hInstance)
     resizeDebug_ = EnvEnabled("DF_RESIZE_DEBUG", false);
     nativeFloatHostsEnabled_ = EnvEnabled("DF_NATIVE_FLOAT_HOSTS", !automationMode_);
     showDebugOverlay_ = !automationMode_;
+    // Automation keeps presenting every frame so perf_frames stays comparable.
+    skipIdleFrames_ = EnvEnabled("DF_SKIP_IDLE_FRAMES", !automationMode_);
+    partialRedraw_ = EnvEnabled("DF_PARTIAL_REDRAW", !automationMode_);
+    layout_.setDamageRegion(&frameDamage_);
+    splitter_.setDamageRegion(&frameDamage_);
+    dockRenderer_.setDamageRegion(&frameDamage_);
+    df::WindowManager::instance().setDamageRegion(&frameDamage_);
     themeName_ = EnvString("DF_THEME", "dark");
     df::SetThemeByName(themeName_);
+    recordPath_ = EnvString("DF_RECORD_INPUT", "");
+    if (!recordPath_.empty()) {
+        recorder_ = std::make_unique<df::InputRecorder>();
+        recorder_->resize(viewport_.Width, viewport_.Height, DFInputClockSeconds());
+    }
     if (EnvEnabled("DF_FAST_VISUALS", false)) {
         df::DockTheme theme = df::CurrentTheme();
         df::ApplyFastVisualPreset(theme);
@@ -753,6 +791,7 @@ DX12Demo::DX12Demo(HINSTANCE hInstance)
 
 DX12Demo::~DX12Demo()
 {
+    df::WindowManager::instance().setDamageRegion(nullptr);
     destroyAllNativeFloatingHosts();
     waitForGPU();
     if (fenceEvent_) CloseHandle(fenceEvent_);
@@ -824,7 +863,8 @@ void DX12Demo::initD3D12()
     scDesc.Height = WINDOW_HEIGHT;
     scDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     scDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    scDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+    // Sequential flip keeps back buffer contents, which partial redraw relies on.
+    scDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
     scDesc.SampleDesc.Count = 1;
 
     ComPtr<IDXGISwapChain1> swapChain1;
@@ -937,6 +977,11 @@ void DX12Demo::initDocking()
         df::WindowManager::instance().createFloatingWindow(
             tools, {920.0f, 210.0f, 320.0f, 220.0f});
     }
+    if (kEnableTabUi) {
+        router_.setTabGestureHandler([this](Event& event, const df::DockHit& hit) {
+            return event.type == Event::Type::MouseDown ? beginTabGesture(event, hit) : handleTabGesture(event);
+        });
+    }
     refreshLayoutState();
 }
 
@@ -1421,12 +1466,7 @@ void DX12Demo::syncNativeFloatingHosts()
 
 void DX12Demo::clearActiveAction()
 {
-    df::DockManager::instance().endDrag();
-    df::DockManager::instance().cancelFloatingDrag();
-    splitter_.endDrag();
-    df::WindowManager::instance().cancelAllDrags();
-    activeAction_ = ActionOwner::None;
-    activeWindow_ = nullptr;
+    router_.cancel();
     tabGesture_ = TabGestureState{};
     statusDirty_ = true;
 }
@@ -1453,26 +1493,59 @@ void DX12Demo::updateHoverState(const DFPoint& point)
         }
     }
 
-    for (auto& widget : widgets_) {
-        if (!IsRenderableDockWidget(widget.get())) {
-            continue;
-        }
-        if (widget->bounds().contains(point)) {
-            hoveredDockWidget_ = widget.get();
+    if (const df::DockLayout::Node* leaf = layout_.widgetNodeAt(point); leaf && IsRenderableDockWidget(leaf->widget)) {
+        hoveredDockWidget_ = leaf->widget;
+    }
+}
+
+// Hover visuals drawn by the demo itself or by live cursor polling in
+// DX12DockWidget::paint are not reported by the framework; compare what this
+// frame will show against the last frame and damage both when they differ.
+void DX12Demo::trackUntrackedHoverDamage()
+{
+    auto damageIfChanged = [this](DFRect& last, const DFRect& current) {
+        if (last.x == current.x && last.y == current.y &&
+            last.width == current.width && last.height == current.height) {
             return;
         }
+        frameDamage_.add(last);
+        frameDamage_.add(current);
+        last = current;
+    };
+
+    const auto& theme = df::CurrentTheme();
+    DFRect outline{};
+    DFRect titleButton{};
+    if (hoveredDockWidget_ && IsRenderableDockWidget(hoveredDockWidget_)) {
+        const DFRect b = hoveredDockWidget_->bounds();
+        if (theme.drawWidgetHoverOutline && router_.captured() == ActionOwner::None) {
+            outline = b;
+        }
+        if (hoveredDockWidget_->isSingleDocked() && theme.drawTitleBarIcons) {
+            const DFRect titleBar{b.x, b.y, b.width, df::DX12DockWidget::TITLE_BAR_HEIGHT};
+            const DFRect closeRect = df::DX12DockWidget::CloseButtonRect(titleBar);
+            const DFRect undockRect = df::DX12DockWidget::UndockButtonRect(titleBar);
+            if (closeRect.contains(lastMousePos_)) {
+                titleButton = closeRect;
+            } else if (theme.drawUndockIcon && undockRect.contains(lastMousePos_)) {
+                titleButton = undockRect;
+            }
+        }
     }
+    damageIfChanged(hoverOutlineRect_, outline);
+    damageIfChanged(hoverTitleButtonRect_, titleButton);
 }
 
 df::DockLayout::Node* DX12Demo::findTabNodeNearCursor() const
 {
     for (const auto& visual : tabVisuals_) {
-        if (!visual.node) continue;
-        if (visual.strip.contains(lastMousePos_) || visual.node->bounds.contains(lastMousePos_)) {
-            return visual.node;
+        df::DockLayout::Node* node = df::DockLayout::Resolve(visual.node);
+        if (!node) continue;
+        if (visual.strip.contains(lastMousePos_) || node->bounds.contains(lastMousePos_)) {
+            return node;
         }
     }
-    return tabVisuals_.empty() ? nullptr : tabVisuals_.front().node;
+    return tabVisuals_.empty() ? nullptr : df::DockLayout::Resolve(tabVisuals_.front().node);
 }
 
 bool DX12Demo::closeTabNode(df::DockLayout::Node* node, int tabIndex)
@@ -1512,6 +1585,7 @@ bool DX12Demo::closeTabNode(df::DockLayout::Node* node, int tabIndex)
     // Keep a closed widget out of hit-testing/rendering until reopened.
     closingWidget->setBounds({0.0f, 0.0f, 0.0f, 0.0f});
 
+    layout_.invalidate();
     refreshLayoutState();
     statusDirty_ = true;
     return true;
@@ -1547,6 +1621,7 @@ bool DX12Demo::handleShortcutKey(int key, bool ctrlDown, bool shiftDown)
             const int step = shiftDown ? -1 : 1;
             const int count = static_cast<int>(node->children.size());
             node->activeTab = (node->activeTab + step + count) % count;
+            df::DockLayout::MarkDirty(node);
             refreshLayoutState();
             lastDispatchHandler_ = "key:tab_cycle";
             eventConsole_.logAutomation("shortcut Ctrl+Tab -> cycle tab");
@@ -1576,18 +1651,44 @@ bool DX12Demo::handleShortcutKey(int key, bool ctrlDown, bool shiftDown)
         }
     }
 
+    if (ctrlDown && (key == 'Z' || key == 'Y')) {
+        const bool redo = key == 'Y' || shiftDown;
+        const df::DockWidget* floatingContent = floatingWindow_ ? floatingWindow_->content() : nullptr;
+        clearActiveAction();
+        auto& mgr = df::DockManager::instance();
+        if (!(redo ? mgr.redo() : mgr.undo())) {
+            return false;
+        }
+        // Undo/redo recreate floating windows.
+        floatingWindow_ = floatingContent ? df::WindowManager::instance().findWindowByContent(floatingContent) : nullptr;
+        refreshLayoutState();
+        lastDispatchHandler_ = redo ? "key:redo" : "key:undo";
+        eventConsole_.logAutomation(redo ? "shortcut Ctrl+Y -> redo layout" : "shortcut Ctrl+Z -> undo layout");
+        return true;
+    }
+
     return false;
 }
 
 LRESULT DX12Demo::handleKeyMessage(WPARAM wParam, LPARAM lParam)
 {
     (void)lParam;
+    // Keys run now because DefWindowProc needs to know whether they were
+    // handled. Dispatch the mouse input queued ahead of this key first, so
+    // a click followed by Ctrl+W or Esc is seen in that order.
+    pumpInput();
     Event event(Event::Type::KeyDown);
     event.key = static_cast<int>(wParam);
+    event.modifiers = CurrentModifiers();
+    DFStampInput(event);
 
-    const bool ctrlDown = (GetKeyState(VK_CONTROL) & 0x8000) != 0;
-    const bool shiftDown = (GetKeyState(VK_SHIFT) & 0x8000) != 0;
+    const bool ctrlDown = event.has(Event::Modifier::Control);
+    const bool shiftDown = event.has(Event::Modifier::Shift);
 
+    // Shortcuts edit the layout, so a replay needs them in the stream.
+    if (recorder_) {
+        recorder_->event(event);
+    }
     event.handled = handleShortcutKey(event.key, ctrlDown, shiftDown);
     statusDirty_ = true;
     updateStatusCaption();
@@ -1662,13 +1763,12 @@ bool DX12Demo::dockFloatingWindowIntoTarget(df::WindowFrame* window, df::DockWid
         incoming->widget = movingWidget;
         tabParent->children.push_back(std::move(incoming));
         tabParent->activeTab = static_cast<int>(tabParent->children.size()) - 1;
+        layout_.invalidate();
 
         if (floatingWindow_ == window) {
             floatingWindow_ = nullptr;
         }
-        if (activeWindow_ == window) {
-            activeWindow_ = nullptr;
-        }
+        router_.forgetWindow(window);
         df::WindowManager::instance().destroyWindow(window);
         refreshLayoutState();
         statusDirty_ = true;
@@ -1696,13 +1796,12 @@ bool DX12Demo::dockFloatingWindowIntoTarget(df::WindowFrame* window, df::DockWid
     targetNode->children.push_back(std::move(original));
     targetNode->children.push_back(std::move(incoming));
     targetNode->activeTab = 1;
+    layout_.invalidate();
 
     if (floatingWindow_ == window) {
         floatingWindow_ = nullptr;
     }
-    if (activeWindow_ == window) {
-        activeWindow_ = nullptr;
-    }
+    router_.forgetWindow(window);
     df::WindowManager::instance().destroyWindow(window);
     refreshLayoutState();
     statusDirty_ = true;
@@ -1791,9 +1890,7 @@ bool DX12Demo::tryDockFloatingWindowAtEdge(df::WindowFrame* window, const DFPoin
     if (floatingWindow_ == window) {
         floatingWindow_ = nullptr;
     }
-    if (activeWindow_ == window) {
-        activeWindow_ = nullptr;
-    }
+    router_.forgetWindow(window);
     df::WindowManager::instance().destroyWindow(window);
     refreshLayoutState();
     statusDirty_ = true;
@@ -1837,16 +1934,24 @@ bool DX12Demo::tryDockNativeFloatingHost(df::DockWidget* widget, HWND hwnd)
     return false;
 }
 
-void DX12Demo::renderDebugOverlay()
+namespace {
+
+DFRect DebugOverlayPanelRect()
+{
+    return {8.0f, 8.0f, 180.0f, 44.0f};
+}
+
+} // namespace
+
+void DX12Demo::renderDebugOverlay(Canvas& canvas)
 {
     const auto& theme = df::CurrentTheme();
-    const float overlayW = 180.0f;
-    const float overlayH = 44.0f;
-    const DFRect panel{8.0f, 8.0f, overlayW, overlayH};
-    canvas_->drawRectangle(panel, theme.overlayPanel);
+    const DFRect panel = DebugOverlayPanelRect();
+    DFCanvasScopeGuard scope(canvas, DFCanvasScope::DebugOverlay);
+    canvas.drawRectangle(panel, theme.overlayPanel);
 
     DFColor actionColor{0.35f, 0.35f, 0.35f, 1.0f};
-    switch (activeAction_) {
+    switch (router_.captured()) {
     case ActionOwner::FloatingWindow: actionColor = {0.85f, 0.55f, 0.20f, 1.0f}; break;
     case ActionOwner::DockWidgetDrag: actionColor = {0.20f, 0.72f, 0.95f, 1.0f}; break;
     case ActionOwner::SplitterDrag: actionColor = {0.38f, 0.78f, 0.34f, 1.0f}; break;
@@ -1856,22 +1961,22 @@ void DX12Demo::renderDebugOverlay()
         break;
     }
 
-    canvas_->drawRectangle({panel.x + 8.0f, panel.y + 8.0f, 18.0f, 18.0f}, actionColor);
-    canvas_->drawRectangle(
+    canvas.drawRectangle({panel.x + 8.0f, panel.y + 8.0f, 18.0f, 18.0f}, actionColor);
+    canvas.drawRectangle(
         {panel.x + 30.0f, panel.y + 8.0f, 18.0f, 18.0f},
         leftMouseDown_ ? DFColor{0.95f, 0.28f, 0.28f, 1.0f} : DFColor{0.35f, 0.35f, 0.35f, 1.0f});
-    canvas_->drawRectangle(
+    canvas.drawRectangle(
         {panel.x + 52.0f, panel.y + 8.0f, 18.0f, 18.0f},
         splitter_.isDragging() ? DFColor{0.30f, 0.6f, 1.0f, 1.0f} : DFColor{0.35f, 0.35f, 0.35f, 1.0f});
-    canvas_->drawRectangle(
+    canvas.drawRectangle(
         {panel.x + 74.0f, panel.y + 8.0f, 18.0f, 18.0f},
         df::DockManager::instance().isDragging() ? DFColor{0.2f, 0.72f, 0.95f, 1.0f} : DFColor{0.35f, 0.35f, 0.35f, 1.0f});
-    canvas_->drawRectangle(
+    canvas.drawRectangle(
         {panel.x + 96.0f, panel.y + 8.0f, 18.0f, 18.0f},
         df::WindowManager::instance().hasDraggingWindow() ? DFColor{0.85f, 0.55f, 0.20f, 1.0f} : DFColor{0.35f, 0.35f, 0.35f, 1.0f});
 
     if (df::DockManager::instance().isFloatingDragging()) {
-        canvas_->drawRectangle({panel.x + 118.0f, panel.y + 8.0f, 18.0f, 18.0f}, theme.overlayAccent);
+        canvas.drawRectangle({panel.x + 118.0f, panel.y + 8.0f, 18.0f, 18.0f}, theme.overlayAccent);
     }
 }
 
@@ -1906,9 +2011,17 @@ void DX12Demo::updateStatusCaption()
         << " | theme=" << themeName_
         << " | fps=" << static_cast<int>(fps + 0.5)
         << " (" << std::fixed << std::setprecision(1) << avgFrameMs << "ms)"
+        << " | cmds=" << frameList_.commandCount()
+        << " verts=" << frameStats_.total().vertices
+        << " skipped=" << skippedFrames_
+        << " partial=" << partialFrames_
+        << " | lat_p95 split/tab/float="
+        << latency_.histogram(df::LatencyTracker::Interaction::SplitterDrag).percentileMs(0.95) << "/"
+        << latency_.histogram(df::LatencyTracker::Interaction::TabDrag).percentileMs(0.95) << "/"
+        << latency_.histogram(df::LatencyTracker::Interaction::FloatingMove).percentileMs(0.95) << "ms"
         << " | mouse=(" << static_cast<int>(lastMousePos_.x) << "," << static_cast<int>(lastMousePos_.y) << ")"
         << " lmb=" << (leftMouseDown_ ? "down" : "up")
-        << " action=" << ActionOwnerName(activeAction_)
+        << " action=" << ActionOwnerName(router_.captured())
         << " dock_drag=" << (df::DockManager::instance().isDragging() ? "1" : "0")
         << " float_drag=" << (df::DockManager::instance().isFloatingDragging() ? "1" : "0")
         << " split_drag=" << (splitter_.isDragging() ? "1" : "0")
@@ -1922,18 +2035,18 @@ void DX12Demo::updateStatusCaption()
     captionFrameCountdown_ = 8;
 }
 
-bool DX12Demo::beginTabGesture(Event& event)
+bool DX12Demo::beginTabGesture(Event& event, const df::DockHit& hit)
 {
     if (!kEnableTabUi) return false;
     if (event.type != Event::Type::MouseDown) return false;
     const DFPoint p{event.x, event.y};
-    TabInteractionHit hit{};
-    if (!HandleTabInteraction(layout_.root(), p, hit) || !hit.node) {
+    df::DockLayout::Node* node = df::DockLayout::Resolve(hit.tabNode);
+    if (!node || hit.tabIndex < 0) {
         return false;
     }
 
-    if (hit.closeHit) {
-        if (closeTabNode(hit.node, hit.tabIndex)) {
+    if (hit.kind == df::DockHit::Kind::TabClose) {
+        if (closeTabNode(node, hit.tabIndex)) {
             event.handled = true;
             lastDispatchHandler_ = "tab:close";
             eventConsole_.logHandled(event, lastDispatchHandler_);
@@ -1943,24 +2056,25 @@ bool DX12Demo::beginTabGesture(Event& event)
         return false;
     }
 
-    if (hit.node->activeTab != hit.tabIndex) {
+    if (node->activeTab != hit.tabIndex) {
         // Activate tab immediately on press so click behavior feels responsive.
-        hit.node->activeTab = hit.tabIndex;
+        node->activeTab = hit.tabIndex;
+        df::DockLayout::MarkDirty(node);
         refreshLayoutState();
         updateHoverState(p);
     }
 
     tabGesture_.active = true;
-    tabGesture_.node = hit.node;
+    tabGesture_.node = node->handle();
     tabGesture_.tabIndex = hit.tabIndex;
     tabGesture_.strip = {
-        hit.node->bounds.x,
-        hit.node->bounds.y,
-        hit.node->bounds.width,
-        hit.node->tabBarHeight
+        node->bounds.x,
+        node->bounds.y,
+        node->bounds.width,
+        node->tabBarHeight
     };
     tabGesture_.start = p;
-    activeAction_ = ActionOwner::TabGesture;
+    router_.capture(ActionOwner::TabGesture);
     event.handled = true;
     lastDispatchHandler_ = "tab:hold";
     eventConsole_.logHandled(event, lastDispatchHandler_);
@@ -1970,8 +2084,8 @@ bool DX12Demo::beginTabGesture(Event& event)
 
 bool DX12Demo::undockActiveTab(const DFPoint& mousePos)
 {
-    if (!tabGesture_.active || !tabGesture_.node) return false;
-    auto* node = tabGesture_.node;
+    auto* node = df::DockLayout::Resolve(tabGesture_.node);
+    if (!tabGesture_.active || !node) return false;
     if (!node->children.size()) return false;
     if (tabGesture_.tabIndex < 0 || tabGesture_.tabIndex >= static_cast<int>(node->children.size())) return false;
 
@@ -2007,6 +2121,7 @@ bool DX12Demo::undockActiveTab(const DFPoint& mousePos)
         node->activeTab = std::clamp(node->activeTab, 0, static_cast<int>(node->children.size()) - 1);
     }
 
+    layout_.invalidate();
     auto* newWindow = df::WindowManager::instance().createFloatingWindow(undockedWidget, floatBounds);
     if (!newWindow) return false;
 
@@ -2017,8 +2132,7 @@ bool DX12Demo::undockActiveTab(const DFPoint& mousePos)
     // still resolves docking targets (edges/center) deterministically.
     mgr.updateFloatingDrag(mousePos);
 
-    activeWindow_ = newWindow;
-    activeAction_ = ActionOwner::FloatingWindow;
+    router_.capture(ActionOwner::FloatingWindow, newWindow);
     tabGesture_.undocked = true;
     tabGesture_.active = false;
     lastDispatchHandler_ = "tab:undock";
@@ -2031,19 +2145,21 @@ bool DX12Demo::handleTabGesture(Event& event)
     if (!tabGesture_.active) return false;
 
     const DFPoint p{event.x, event.y};
+    df::DockLayout::Node* gestureNode = df::DockLayout::Resolve(tabGesture_.node);
     if (event.type == Event::Type::MouseMove) {
-        if (tabGesture_.node &&
-            tabGesture_.node->type == df::DockLayout::Node::Type::Tab &&
+        if (gestureNode &&
+            gestureNode->type == df::DockLayout::Node::Type::Tab &&
             tabGesture_.strip.contains(p) &&
-            tabGesture_.node->children.size() > 1) {
-            const float tabWidth = tabGesture_.strip.width / static_cast<float>(tabGesture_.node->children.size());
+            gestureNode->children.size() > 1) {
+            const float tabWidth = tabGesture_.strip.width / static_cast<float>(gestureNode->children.size());
             const int hoveredIndex = static_cast<int>((p.x - tabGesture_.strip.x) / std::max(1.0f, tabWidth));
             if (hoveredIndex >= 0 &&
-                hoveredIndex < static_cast<int>(tabGesture_.node->children.size()) &&
+                hoveredIndex < static_cast<int>(gestureNode->children.size()) &&
                 hoveredIndex != tabGesture_.tabIndex) {
-                std::swap(tabGesture_.node->children[hoveredIndex], tabGesture_.node->children[tabGesture_.tabIndex]);
+                std::swap(gestureNode->children[hoveredIndex], gestureNode->children[tabGesture_.tabIndex]);
                 tabGesture_.tabIndex = hoveredIndex;
-                tabGesture_.node->activeTab = hoveredIndex;
+                gestureNode->activeTab = hoveredIndex;
+                df::DockLayout::MarkDirty(gestureNode);
                 refreshLayoutState();
                 statusDirty_ = true;
             }
@@ -2070,8 +2186,11 @@ bool DX12Demo::handleTabGesture(Event& event)
     }
 
     if (event.type == Event::Type::MouseUp) {
-        if (tabGesture_.node) {
-            tabGesture_.node->activeTab = tabGesture_.tabIndex;
+        if (gestureNode) {
+            if (gestureNode->activeTab != tabGesture_.tabIndex) {
+                gestureNode->activeTab = tabGesture_.tabIndex;
+                df::DockLayout::MarkDirty(gestureNode);
+            }
             refreshLayoutState();
             lastDispatchHandler_ = "tab:select";
             eventConsole_.logHandled(event, lastDispatchHandler_);
@@ -2085,152 +2204,17 @@ bool DX12Demo::handleTabGesture(Event& event)
     return false;
 }
 
-bool DX12Demo::handleActiveAction(Event& event)
-{
-    if (activeAction_ == ActionOwner::None) return false;
-    if (activeWindow_ && !df::WindowManager::instance().hasWindow(activeWindow_)) {
-        activeWindow_ = nullptr;
-    }
-
-    switch (activeAction_) {
-    case ActionOwner::FloatingWindow: {
-        auto& mgr = df::DockManager::instance();
-        if (mgr.isFloatingDragging() && mgr.handleEvent(event)) {
-            event.handled = true;
-            lastDispatchHandler_ = "floating_drag";
-            eventConsole_.logHandled(event, lastDispatchHandler_);
-            if (event.type == Event::Type::MouseUp) {
-                activeWindow_ = nullptr;
-                clearActiveAction();
-                refreshLayoutState();
-                if (widgets_.size() > 4 && widgets_[4] && !widgets_[4]->isFloating()) {
-                    floatingWindow_ = nullptr;
-                }
-            }
-            statusDirty_ = true;
-            return true;
-        }
-        if (activeWindow_ && activeWindow_->handleEvent(event)) {
-            if (activeWindow_->consumeCloseRequest()) {
-                df::DockManager::instance().closeWidget(activeWindow_->content());
-                auto* closing = activeWindow_;
-                activeWindow_ = nullptr;
-                if (closing == floatingWindow_) {
-                    floatingWindow_ = nullptr;
-                }
-                clearActiveAction();
-                refreshLayoutState();
-                event.handled = true;
-                lastDispatchHandler_ = "floating_close";
-                eventConsole_.logHandled(event, lastDispatchHandler_);
-                statusDirty_ = true;
-                return true;
-            }
-            event.handled = true;
-            lastDispatchHandler_ = "floating_window";
-            eventConsole_.logHandled(event, lastDispatchHandler_);
-            if (event.type == Event::Type::MouseUp) {
-                clearActiveAction();
-            }
-            statusDirty_ = true;
-            return true;
-        }
-        if (event.type == Event::Type::MouseUp) {
-            activeWindow_ = nullptr;
-            clearActiveAction();
-            event.handled = true;
-            statusDirty_ = true;
-            return true;
-        }
-        event.handled = true;
-        statusDirty_ = true;
-        return true;
-    }
-
-    case ActionOwner::DockWidgetDrag: {
-        auto& mgr = df::DockManager::instance();
-        if (mgr.handleEvent(event)) {
-            if (mgr.isFloatingDragging()) {
-                activeAction_ = ActionOwner::FloatingWindow;
-                activeWindow_ = df::WindowManager::instance().findWindowAtPoint({event.x, event.y});
-                lastDispatchHandler_ = "floating_drag";
-            } else {
-                lastDispatchHandler_ = "dock_drag";
-            }
-            eventConsole_.logHandled(event, lastDispatchHandler_);
-            if (event.type == Event::Type::MouseUp) {
-                clearActiveAction();
-            }
-            statusDirty_ = true;
-            return true;
-        }
-        if (event.type == Event::Type::MouseUp) {
-            clearActiveAction();
-            event.handled = true;
-            statusDirty_ = true;
-            return true;
-        }
-        event.handled = true;
-        statusDirty_ = true;
-        return true;
-    }
-
-    case ActionOwner::SplitterDrag:
-        if (splitter_.handleEvent(event)) {
-            lastDispatchHandler_ = "splitter";
-            eventConsole_.logHandled(event, lastDispatchHandler_);
-            refreshLayoutState();
-            if (event.type == Event::Type::MouseUp) {
-                clearActiveAction();
-            }
-            statusDirty_ = true;
-            return true;
-        }
-        if (event.type == Event::Type::MouseUp) {
-            clearActiveAction();
-            event.handled = true;
-            statusDirty_ = true;
-            return true;
-        }
-        event.handled = true;
-        statusDirty_ = true;
-        return true;
-
-    case ActionOwner::TabGesture:
-        return handleTabGesture(event);
-
-    case ActionOwner::None:
-    default:
-        return false;
-    }
-}
-
 void DX12Demo::renderFrame()
 {
     const auto frameStart = std::chrono::steady_clock::now();
-    ThrowIfFailed(commandAllocator_->Reset());
-    ThrowIfFailed(commandList_->Reset(commandAllocator_.Get(), nullptr));
-
-    // Transition to render target
-    D3D12_RESOURCE_BARRIER barrier{};
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-    barrier.Transition.pResource = renderTargets_[frameIndex_].Get();
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-    commandList_->ResourceBarrier(1, &barrier);
-
-    D3D12_CPU_DESCRIPTOR_HANDLE rtv = rtvHeap_->GetCPUDescriptorHandleForHeapStart();
-    rtv.ptr += frameIndex_ * rtvStride_;
-    const float clearDFColor[] = {55.0f / 255.0f, 53.0f / 255.0f, 62.0f / 255.0f, 1.0f};
-    commandList_->ClearRenderTargetView(rtv, clearDFColor, 0, nullptr);
-    commandList_->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
-    commandList_->RSSetViewports(1, &viewport_);
-    commandList_->RSSetScissorRects(1, &scissor_);
-
-    canvas_->clear();
+    latency_.beginFrame();
     refreshLayoutState();
     syncNativeFloatingHosts();
+
+    // Record the whole frame first; the GPU pass only runs when the stream changed.
+    frameList_.reset();
+    frameStats_.beginFrame();
+    Canvas& frameCanvas = frameStats_;
     const auto& theme = df::CurrentTheme();
     const DFRect viewRect{0.0f, 0.0f, viewport_.Width, viewport_.Height};
     const DFRect mainClientRect = ComputeMainClientRect(viewRect, theme);
@@ -2242,43 +2226,131 @@ void DX12Demo::renderFrame()
             ? std::clamp(theme.clientAreaCornerRadius, 0.0f, maxRadius)
             : 0.0f;
         if (cornerRadius > 0.0f) {
-            canvas_->drawRoundedRectangle(mainClientRect, cornerRadius, theme.clientAreaFill);
+            frameCanvas.drawRoundedRectangle(mainClientRect, cornerRadius, theme.clientAreaFill);
         } else {
-            canvas_->drawRectangle(mainClientRect, theme.clientAreaFill);
+            frameCanvas.drawRectangle(mainClientRect, theme.clientAreaFill);
         }
         if (theme.drawClientAreaBorder) {
-            canvas_->drawRoundedRectangleOutline(
+            frameCanvas.drawRoundedRectangleOutline(
                 mainClientRect,
                 cornerRadius,
                 theme.clientAreaBorder,
                 std::max(0.5f, theme.clientAreaBorderThickness));
         }
     }
-    df::DockRenderer renderer;
-    renderer.setMousePosition(lastMousePos_);
-    renderer.render(*canvas_, layout_.root());
+    dockRenderer_.setMousePosition(lastMousePos_);
+    dockRenderer_.render(frameCanvas, layout_.root());
 
     for (auto& w : widgets_) {
         if (IsRenderableDockWidget(w.get())) {
             if (theme.drawWidgetHoverOutline &&
                 hoveredDockWidget_ == w.get() &&
-                activeAction_ == ActionOwner::None) {
+                router_.captured() == ActionOwner::None) {
                 const DFRect b = w->bounds();
                 const DFColor hover = theme.overlayAccentSoft;
-                canvas_->drawRectangle({b.x, b.y, b.width, 2.0f}, hover);
-                canvas_->drawRectangle({b.x, b.y + b.height - 2.0f, b.width, 2.0f}, hover);
+                frameCanvas.drawRectangle({b.x, b.y, b.width, 2.0f}, hover);
+                frameCanvas.drawRectangle({b.x, b.y + b.height - 2.0f, b.width, 2.0f}, hover);
             }
         }
     }
     if (showDebugOverlay_) {
-        renderDebugOverlay();
+        renderDebugOverlay(frameCanvas);
     }
-    splitter_.render(*canvas_);
+    splitter_.render(frameCanvas);
     df::WindowManager::instance().updateAllWindows();
     if (!nativeFloatHostsEnabled_) {
-        df::WindowManager::instance().renderAllWindows(*canvas_);
+        df::WindowManager::instance().renderAllWindows(frameCanvas);
+    }
+    df::DockManager::instance().overlay().render(frameCanvas);
+
+    const uint64_t frameHash = frameList_.hash();
+    lastFrameSkipped_ = skipIdleFrames_ && !forcePresent_ && frameHash == lastPresentedHash_;
+    if (lastFrameSkipped_) {
+        // Same pixels as the last present; whatever was reported changed nothing.
+        frameDamage_.clear();
+        ++skippedFrames_;
+        latency_.presented(DFInputClockSeconds());
+        recordFrame();
+        updateStatusCaption();
+        return;
+    }
+
+    // Repaint only the damage unless something untracked may have changed:
+    // first frames and resizes, the dock drop overlay, tab drag gestures, or
+    // a stream that differs while nothing reported damage.
+    trackUntrackedHoverDamage();
+    const auto& dockManager = df::DockManager::instance();
+    bool partial = partialRedraw_ &&
+        !forcePresent_ &&
+        !frameDamage_.empty() &&
+        !dockManager.isDragging() &&
+        !dockManager.isFloatingDragging() &&
+        router_.captured() != ActionOwner::TabGesture;
+    // The overlay panel repaints every frame, so it joins the region only
+    // after the check above; otherwise it would make any frame look damaged.
+    if (showDebugOverlay_) {
+        frameDamage_.add(DebugOverlayPanelRect());
+    }
+    const DFRect fullRect{0.0f, 0.0f, viewport_.Width, viewport_.Height};
+    DFDamageRegion repaint = frameDamage_;
+    repaint.add(presentedDamage_);
+    partial = partial && repaint.area() < fullRect.width * fullRect.height * 0.5f;
+
+    std::array<D3D12_RECT, DFDamageRegion::kMaxRects> dirtyRects{};
+    UINT dirtyCount = 0;
+    for (const DFRect& rect : repaint) {
+        const DFRect clipped = DFRectIntersection(rect, fullRect);
+        if (clipped.width <= 0.0f || clipped.height <= 0.0f) {
+            continue;
+        }
+        D3D12_RECT& out = dirtyRects[dirtyCount++];
+        out.left = static_cast<LONG>(clipped.x);
+        out.top = static_cast<LONG>(clipped.y);
+        out.right = static_cast<LONG>(std::ceil(clipped.x + clipped.width));
+        out.bottom = static_cast<LONG>(std::ceil(clipped.y + clipped.height));
+    }
+    // Zero rects would make the clear below cover the whole target.
+    partial = partial && dirtyCount > 0;
+
+    presentedDamage_ = frameDamage_;
+    frameDamage_.clear();
+    if (!partial) {
+        presentedDamage_.clear();
+        presentedDamage_.add(fullRect);
+    }
+
+    ThrowIfFailed(commandAllocator_->Reset());
+    ThrowIfFailed(commandList_->Reset(commandAllocator_.Get(), nullptr));
+
+    // Transition to render target
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = renderTargets_[frameIndex_].Get();
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+    commandList_->ResourceBarrier(1, &barrier);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE rtv = rtvHeap_->GetCPUDescriptorHandleForHeapStart();
+    rtv.ptr += frameIndex_ * rtvStride_;
+    const float clearDFColor[] = {55.0f / 255.0f, 53.0f / 255.0f, 62.0f / 255.0f, 1.0f};
+    if (partial) {
+        commandList_->ClearRenderTargetView(rtv, clearDFColor, dirtyCount, dirtyRects.data());
+    } else {
+        commandList_->ClearRenderTargetView(rtv, clearDFColor, 0, nullptr);
+    }
+    commandList_->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+    commandList_->RSSetViewports(1, &viewport_);
+    commandList_->RSSetScissorRects(1, &scissor_);
+
+    canvas_->clear();
+    if (partial) {
+        for (const DFRect& rect : repaint) {
+            frameList_.replay(*canvas_, rect);
+        }
+    } else {
+        frameList_.replay(*canvas_);
     }
-    df::DockManager::instance().overlay().render(*canvas_);
     canvas_->flush();
 
     // Transition to present
@@ -2289,10 +2361,22 @@ void DX12Demo::renderFrame()
     ThrowIfFailed(commandList_->Close());
     ID3D12CommandList* lists[] = { commandList_.Get() };
     commandQueue_->ExecuteCommandLists(1, lists);
-    swapChain_->Present(1, 0);
+    if (partial) {
+        DXGI_PRESENT_PARAMETERS present{};
+        present.DirtyRectsCount = dirtyCount;
+        present.pDirtyRects = dirtyRects.data();
+        swapChain_->Present1(1, 0, &present);
+        ++partialFrames_;
+    } else {
+        swapChain_->Present(1, 0);
+    }
 
     waitForGPU();
+    latency_.presented(DFInputClockSeconds());
+    recordFrame();
     frameIndex_ = swapChain_->GetCurrentBackBufferIndex();
+    lastPresentedHash_ = frameHash;
+    forcePresent_ = false;
 
     const auto frameEnd = std::chrono::steady_clock::now();
     const double ms = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
@@ -2344,6 +2428,9 @@ void DX12Demo::handleResize(UINT width, UINT height)
 
     viewport_.Width = static_cast<float>(width);
     viewport_.Height = static_cast<float>(height);
+    if (recorder_) {
+        recorder_->resize(viewport_.Width, viewport_.Height, DFInputClockSeconds());
+    }
     scissor_.left = 0;
     scissor_.top = 0;
     scissor_.right = static_cast<LONG>(width);
@@ -2352,6 +2439,8 @@ void DX12Demo::handleResize(UINT width, UINT height)
     if (canvas_) {
         canvas_->setRenderSize(static_cast<float>(width), static_cast<float>(height));
     }
+    // New back buffers have undefined contents; never skip the next present.
+    forcePresent_ = true;
 
     lastMousePos_.x = SafeClamp(lastMousePos_.x, 0.0f, viewport_.Width);
     lastMousePos_.y = SafeClamp(lastMousePos_.y, 0.0f, viewport_.Height);
@@ -2372,7 +2461,7 @@ void DX12Demo::handleResize(UINT width, UINT height)
         oss << "resize_debug old=" << currentW << "x" << currentH
             << " new=" << width << "x" << height
             << " scale=(1.000,1.000)"
-            << " action=" << ActionOwnerName(activeAction_)
+            << " action=" << ActionOwnerName(router_.captured())
             << " dock_drag=" << (df::DockManager::instance().isDragging() ? "1" : "0")
             << " split_drag=" << (splitter_.isDragging() ? "1" : "0")
             << " win_drag=" << (df::WindowManager::instance().hasDraggingWindow() ? "1" : "0");
@@ -2398,7 +2487,9 @@ int DX12Demo::run()
     }
 
     if (automationMode_) {
-        return runAutomatedEventChecks() ? 0 : 2;
+        const bool passed = runAutomatedEventChecks();
+        saveRecording();
+        return passed ? 0 : 2;
     }
 
     MSG msg{};
@@ -2409,12 +2500,35 @@ int DX12Demo::run()
             DispatchMessage(&msg);
         }
         if (running_) {
+            pumpInput();
             renderFrame();
+            if (lastFrameSkipped_) {
+                // Nothing changed: block until input arrives instead of spinning.
+                MsgWaitForMultipleObjects(0, nullptr, FALSE, 16, QS_ALLINPUT);
+            }
         }
     }
+    saveRecording();
     return 0;
 }
 
+void DX12Demo::recordFrame()
+{
+    if (!recorder_) return;
+    recorder_->frame(DFInputClockSeconds());
+    if (recorder_->checkpointDue()) {
+        recorder_->checkpoint(df::DockLayoutChecksum(layout_, df::WindowManager::instance()));
+    }
+}
+
+// Replay with: dock_bench --replay <DF_RECORD_INPUT path> [--realtime]
+void DX12Demo::saveRecording()
+{
+    if (recorder_ && !recorder_->saveFile(recordPath_)) {
+        AppendRuntimeError("DF_RECORD_INPUT", "cannot write " + recordPath_);
+    }
+}
+
 bool DX12Demo::isEnvEnabled(const char* name)
 {
     return EnvEnabled(name, false);
@@ -2592,8 +2706,7 @@ LRESULT CALLBACK DX12Demo::FloatingHostWndProc(HWND hWnd, UINT msg, WPARAM wPara
                 if (!mgr.isFloatingDragging()) {
                     mgr.startFloatingDrag(frame, localMouse);
                 }
-                demo->activeWindow_ = frame;
-                demo->activeAction_ = ActionOwner::FloatingWindow;
+                demo->router_.capture(ActionOwner::FloatingWindow, frame);
                 demo->statusDirty_ = true;
                 InvalidateRect(demo->hwnd_, nullptr, FALSE);
             }
@@ -2652,8 +2765,7 @@ LRESULT CALLBACK DX12Demo::FloatingHostWndProc(HWND hWnd, UINT msg, WPARAM wPara
             }
             // Ensure drag lifecycle is closed even when docking did not occur.
             df::DockManager::instance().cancelFloatingDrag();
-            demo->activeWindow_ = nullptr;
-            demo->activeAction_ = ActionOwner::None;
+            demo->router_.capture(ActionOwner::None);
             demo->statusDirty_ = true;
         }
         return DefWindowProcW(hWnd, msg, wParam, lParam);
@@ -2697,12 +2809,13 @@ int main(int /*argc*/, char** /*argv*/)
     return wWinMain(GetModuleHandleW(nullptr), nullptr, GetCommandLineW(), SW_SHOWDEFAULT);
 }
 
-LRESULT DX12Demo::handleMouseMessage(UINT msg, WPARAM wParam, LPARAM lParam)
+LRESULT DX12Demo::handleMouseMessage(UINT msg, WPARAM /*wParam*/, LPARAM lParam)
 {
-    (void)wParam;
     Event e;
     e.x = static_cast<float>(GET_X_LPARAM(lParam));
     e.y = static_cast<float>(GET_Y_LPARAM(lParam));
+    e.modifiers = CurrentModifiers();
+    DFStampInput(e);
     lastMousePos_ = {e.x, e.y};
 
     switch (msg) {
@@ -2727,8 +2840,25 @@ LRESULT DX12Demo::handleMouseMessage(UINT msg, WPARAM wParam, LPARAM lParam)
     }
 
     statusDirty_ = true;
-    processEvent(e);
-    return e.handled ? 0 : DefWindowProc(hwnd_, msg, wParam, lParam);
+    // Message handling only enqueues. Dispatch, layout refresh and the caption
+    // run from pumpInput at the next frame boundary, so a slow frame never
+    // holds up the message pump. A full ring is drained here, on the consumer
+    // thread, rather than dropping a press or release.
+    if (!inputQueue_.push(e)) {
+        pumpInput();
+        inputQueue_.push(e);
+    }
+    // Whether the event is handled is not known yet, but nothing is lost by
+    // not asking: only client-area WM_LBUTTONDOWN/UP and WM_MOUSEMOVE come
+    // here, and DefWindowProc has no default processing for them.
+    return 0;
+}
+
+// Moves the ring's batch through the coalescer and dispatches it in order.
+void DX12Demo::pumpInput()
+{
+    inputQueue_.drain([this](Event& event) { input_.push(event); });
+    input_.drain([this](Event& event) { processEvent(event); });
 }
 
 void DX12Demo::processEvent(Event& event)
@@ -2758,6 +2888,9 @@ void DX12Demo::processEvent(Event& event)
     eventConsole_.logIncoming(event, anyDrag);
 
     lastDispatchHandler_.clear();
+    if (recorder_) {
+        recorder_->event(event);
+    }
     dispatchMouseEvent(event);
 
     if (!event.handled) {
@@ -2785,141 +2918,62 @@ void DX12Demo::dispatchMouseEvent(Event& event)
         return;
     }
 
-    auto& mgr = df::DockManager::instance();
-
     if (event.type == Event::Type::MouseDown) {
         refreshLayoutState();
         updateHoverState({event.x, event.y});
     }
 
-    if (activeAction_ != ActionOwner::None && event.type != Event::Type::MouseDown) {
-        if (handleActiveAction(event)) {
-            return;
-        }
-    }
+    using Handler = df::EventRouter::Handler;
+    const df::EventRouter::Route route = router_.dispatch(event);
+    latency_.dispatched(event, df::LatencyTracker::Classify(route.handler));
 
-    const DFPoint p{event.x, event.y};
-    const bool hitFloating = df::WindowManager::instance().findWindowAtPoint(p) != nullptr;
-    const bool hitSplitter = splitter_.splitterAtPoint(p) != nullptr;
-    int widgetHits = 0;
-    for (const auto& w : widgets_) {
-        if (!IsRenderableDockWidget(w.get())) {
-            continue;
+    // Overlaps are judged from the router's hit; captured events skip it.
+    if (!route.captured) {
+        const df::DockHit& hit = router_.lastHit();
+        const bool hitFloating = hit.window != nullptr;
+        const bool hitSplitter = static_cast<bool>(hit.split);
+        // The handler may have closed the leaf; it then resolves to null.
+        const df::DockLayout::Node* leaf = df::DockLayout::Resolve(hit.leaf);
+        const int widgetHits = (leaf && IsRenderableDockWidget(leaf->widget)) ? 1 : 0;
+        const int hitGroups = (hitFloating ? 1 : 0) + (hitSplitter ? 1 : 0) + (widgetHits > 0 ? 1 : 0);
+        if (hitGroups > 1) {
+            eventConsole_.logConflict(event, hitFloating, hitSplitter, widgetHits);
         }
-        if (w->bounds().contains(p)) {
-            ++widgetHits;
-        }
-    }
-    const int hitGroups = (hitFloating ? 1 : 0) + (hitSplitter ? 1 : 0) + (widgetHits > 0 ? 1 : 0);
-    if (hitGroups > 1) {
-        eventConsole_.logConflict(event, hitFloating, hitSplitter, widgetHits);
     }
 
-    // 1) Active floating drag (capture can route outside original window).
-    if (!event.handled && mgr.isFloatingDragging() && mgr.handleEvent(event)) {
-        lastDispatchHandler_ = "floating_drag";
-        eventConsole_.logHandled(event, lastDispatchHandler_);
-        if (event.type == Event::Type::MouseUp) {
-            activeWindow_ = nullptr;
-            clearActiveAction();
-            refreshLayoutState();
-        }
-        statusDirty_ = true;
+    switch (route.handler) {
+    case Handler::None:
         return;
-    }
-
-    // 2) Floating windows first (top-most semantics).
-    if (auto* win = df::WindowManager::instance().findWindowAtPoint(p)) {
-        if (event.type == Event::Type::MouseDown) {
-            df::WindowManager::instance().bringToFront(win);
-        }
-        if (win->handleEvent(event)) {
-            if (win->consumeCloseRequest()) {
-                df::DockManager::instance().closeWidget(win->content());
-                if (win == floatingWindow_) {
-                    floatingWindow_ = nullptr;
-                }
-                if (win == activeWindow_) {
-                    activeWindow_ = nullptr;
-                    activeAction_ = ActionOwner::None;
-                }
-                refreshLayoutState();
-                lastDispatchHandler_ = "floating_close";
-                eventConsole_.logHandled(event, lastDispatchHandler_);
-                statusDirty_ = true;
-                return;
-            }
-            const bool startedFloatingDrag = mgr.isFloatingDragging();
-            lastDispatchHandler_ = startedFloatingDrag ? "floating_drag_start" : "floating_window";
-            eventConsole_.logHandled(event, lastDispatchHandler_);
-            if (event.type == Event::Type::MouseDown) {
-                activeWindow_ = win;
-                activeAction_ = ActionOwner::FloatingWindow;
-            } else if (event.type == Event::Type::MouseUp) {
-                clearActiveAction();
-            }
-            statusDirty_ = true;
-            return;
-        }
-    }
-
-    // 3) Tab strip interactions (currently disabled).
-    if (kEnableTabUi && !event.handled && event.type == Event::Type::MouseDown && beginTabGesture(event)) {
-        statusDirty_ = true;
-        return;
-    }
-
-    // 4) Active drags via DockManager (widget drag). Only if not already handled.
-    if (!event.handled && mgr.handleEvent(event)) {
-        lastDispatchHandler_ = "dock_drag";
+    case Handler::TabGesture:
+        // The tab gesture handlers report their own tab:* names.
+    case Handler::Captured:
+        // Swallowed by the capture owner; processEvent reports it unclassified.
+        break;
+    case Handler::Widget:
+        lastDispatchHandler_ = std::string("widget:") + route.widget->title();
         eventConsole_.logHandled(event, lastDispatchHandler_);
-        if (event.type == Event::Type::MouseDown) {
-            activeAction_ = ActionOwner::DockWidgetDrag;
-        } else if (event.type == Event::Type::MouseUp) {
-            clearActiveAction();
-        }
-        statusDirty_ = true;
-        return;
+        break;
+    default:
+        lastDispatchHandler_ = df::EventRouter::HandlerName(route.handler);
+        eventConsole_.logHandled(event, lastDispatchHandler_);
+        break;
     }
 
-    // 5) Docked widgets under cursor.
-    for (auto& w : widgets_) {
-        if (!IsRenderableDockWidget(w.get())) {
-            continue;
-        }
-        if (w->bounds().contains(p)) {
-            w->handleEvent(event);
-            if (event.handled) {
-                lastDispatchHandler_ = std::string("widget:") + w->title();
-                eventConsole_.logHandled(event, lastDispatchHandler_);
-                if (event.type == Event::Type::MouseDown) {
-                    if (mgr.isFloatingDragging()) {
-                        activeAction_ = ActionOwner::FloatingWindow;
-                        activeWindow_ = df::WindowManager::instance().findWindowAtPoint(p);
-                    } else if (mgr.isDragging()) {
-                        activeAction_ = ActionOwner::DockWidgetDrag;
-                    }
-                }
-                refreshLayoutState();
-                statusDirty_ = true;
-                return;
-            }
-        }
+    const bool release = event.type == Event::Type::MouseUp;
+    if (route.handler == Handler::FloatingClose && route.window == floatingWindow_) {
+        floatingWindow_ = nullptr;
     }
-
-    // 6) Splitters last so title/tab/widget interactions win near overlaps.
-    if (!event.handled && splitter_.handleEvent(event)) {
-        lastDispatchHandler_ = "splitter";
-        eventConsole_.logHandled(event, lastDispatchHandler_);
-        if (event.type == Event::Type::MouseDown) {
-            activeAction_ = ActionOwner::SplitterDrag;
-        } else if (event.type == Event::Type::MouseUp) {
-            clearActiveAction();
-        }
+    if (route.handler == Handler::FloatingDrag && release &&
+        floatingWindow_ && !df::WindowManager::instance().hasWindow(floatingWindow_)) {
+        floatingWindow_ = nullptr;
+    }
+    if (route.handler == Handler::FloatingClose ||
+        route.handler == Handler::Widget ||
+        route.handler == Handler::Splitter ||
+        (route.handler == Handler::FloatingDrag && release)) {
         refreshLayoutState();
-        statusDirty_ = true;
-        return;
     }
+    statusDirty_ = true;
 }
 
 bool DX12Demo::injectEvent(Event::Type type, float x, float y, const char* expectedPrefix, const char* label)
@@ -3335,7 +3389,8 @@ bool DX12Demo::runAutomatedEventChecks()
         failures += injectEvent(Event::Type::MouseUp, tx, ty, "tab:", "tab_switch_up") ? 0 : 1;
 
         refreshLayoutState();
-        if (tab.node && tab.node->activeTab != 1) {
+        const df::DockLayout::Node* tabNode = df::DockLayout::Resolve(tab.node);
+        if (tabNode && tabNode->activeTab != 1) {
             eventConsole_.logAutomation("tab active index did not switch [FAIL]");
             ++failures;
         }
@@ -3524,7 +3579,7 @@ bool DX12Demo::runAutomatedEventChecks()
         refreshLayoutState();
         validatePanelSizes("resize_action");
 
-        if (activeAction_ != ActionOwner::None ||
+        if (router_.captured() != ActionOwner::None ||
             df::DockManager::instance().isDragging() ||
             splitter_.isDragging() ||
             df::WindowManager::instance().hasDraggingWindow()) {
@@ -3831,12 +3886,13 @@ bool DX12Demo::runAutomatedEventChecks()
 
     auto runCloseAllWidgetsCheck = [&]() {
         clearActiveAction();
+        layout_.beginBatch();
         for (auto& widget : widgets_) {
             if (!widget) continue;
             df::DockManager::instance().closeWidget(widget.get());
         }
+        layout_.commit();
         floatingWindow_ = nullptr;
-        activeWindow_ = nullptr;
         refreshLayoutState();
 
         if (layout_.root() != nullptr) {
@@ -4128,8 +4184,12 @@ bool DX12Demo::runAutomatedEventChecks()
         perf << "perf_frames count=" << frameTimesMs_.size()
              << " avg_ms=" << std::fixed << std::setprecision(3) << avg
              << " p95_ms=" << std::fixed << std::setprecision(3) << p95
-             << " avg_fps=" << std::fixed << std::setprecision(1) << avgFps;
+             << " avg_fps=" << std::fixed << std::setprecision(1) << avgFps
+             << " skipped=" << skippedFrames_
+             << " partial=" << partialFrames_
+             << " cmds=" << frameList_.commandCount();
         eventConsole_.logAutomation(perf.str());
+        eventConsole_.logAutomation("perf_canvas " + frameStats_.json());
     }
 
     if (stats.handledNone > 8) {
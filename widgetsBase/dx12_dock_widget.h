@@ -2,9 +2,9 @@
 
 #include "dock_framework.h"
 #include "dock_theme.h"
-#include "dx12_canvas.h"
 #include "icon_module.h"
 #include "window_manager.h"
+#include <windows.h>
 #include <algorithm>
 #include <string>
 
@@ -46,11 +46,6 @@ public:
         return (luminance > 0.50f) ? DFColor{0.08f, 0.09f, 0.10f, 1.0f} : DFColor{0.90f, 0.91f, 0.94f, 1.0f};
     }
 
-    static std::string ClipTitle(const std::string& title, float maxWidthPx)
-    {
-        return DFClipTextToWidth(title, maxWidthPx, true);
-    }
-
     DFSize minimumSize() const override {
         DFSize min = DockWidget::minimumSize();
         if (isDocked() && isSingleDocked()) {
@@ -60,12 +55,10 @@ public:
     }
 
     void paint(Canvas& canvas) override {
-        auto* dx12 = dynamic_cast<DX12Canvas*>(&canvas);
-        if (!dx12) return;
         const auto& theme = df::CurrentTheme();
 
         const DFRect& b = bounds();
-        dx12->drawRectangle(b, theme.dockBackground);
+        canvas.drawRectangle(b, theme.dockBackground);
 
         const bool showTitleBar = isDocked() && isSingleDocked();
         const bool drawCloseIcon = theme.drawTitleBarIcons && visualOptions().drawTitleBarIcons;
@@ -73,7 +66,7 @@ public:
         const float topOffset = showTitleBar ? TITLE_BAR_HEIGHT : 0.0f;
         if (showTitleBar) {
             const DFRect titleBar{b.x, b.y, b.width, TITLE_BAR_HEIGHT};
-            dx12->drawRectangle(titleBar, theme.titleBar);
+            canvas.drawRectangle(titleBar, theme.titleBar);
 
             const float textLeft = titleBar.x + 8.0f;
             float textRight = titleBar.x + titleBar.width - 8.0f;
@@ -84,11 +77,11 @@ public:
                     textRight = std::min(textRight, UndockButtonRect(titleBar).x - 6.0f);
                 }
             }
-            const std::string clippedTitle = ClipTitle(title(), textRight - textLeft);
-            if (!clippedTitle.empty()) {
+            const DFTextFit fit = DFFitTextToWidth(title(), textRight - textLeft, true);
+            if (fit.visibleChars > 0) {
                 const DFColor textColor = TitleTextColor(theme.titleBar);
                 const float textTop = DFTextBaselineYForRect(titleBar);
-                dx12->drawText(textLeft, textTop, clippedTitle, textColor);
+                DFDrawTextFit(canvas, textLeft, textTop, title(), fit, textColor, 1.0f, DFTextSmooth());
             }
 
             if (drawCloseIcon) {
@@ -127,16 +120,21 @@ public:
         const bool tabHosted = isDocked() && isTabified();
         const DFColor frameColor = tabHosted ? theme.tabOutline : theme.dockBorder;
         if (!tabHosted) {
-            dx12->drawRectangle({b.x, b.y, b.width, 1.0f}, frameColor);
+            canvas.drawRectangle({b.x, b.y, b.width, 1.0f}, frameColor);
         }
-        dx12->drawRectangle({b.x, b.y + b.height - 1.0f, b.width, 1.0f}, frameColor);
-        dx12->drawRectangle({b.x, b.y, 1.0f, b.height}, frameColor);
-        dx12->drawRectangle({b.x + b.width - 1.0f, b.y, 1.0f, b.height}, frameColor);
+        canvas.drawRectangle({b.x, b.y + b.height - 1.0f, b.width, 1.0f}, frameColor);
+        canvas.drawRectangle({b.x, b.y, 1.0f, b.height}, frameColor);
+        canvas.drawRectangle({b.x + b.width - 1.0f, b.y, 1.0f, b.height}, frameColor);
 
         if (content()) {
             const DFRect client = clientAreaRect(contentHost);
             content()->setBounds(client);
-            content()->paint(canvas);
+            // Scissor content to the client area, below the frame lines.
+            if (!canvas.isClippedOut(client)) {
+                canvas.pushClip(client);
+                content()->paint(canvas);
+                canvas.popClip();
+            }
         }
     }
 
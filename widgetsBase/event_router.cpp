@@ -0,0 +1,267 @@
+#include "event_router.h"
+
+#include "dock_framework.h"
+#include "dock_renderer.h"
+#include "window_manager.h"
+
+namespace df {
+
+DockHit EventRouter::hitTest(const DFPoint& p)
+{
+    DockSplitter::Splitter* lane = nullptr;
+    return hitTest(p, lane);
+}
+
+// lane is the splitter under p, for routing the same event; it is only valid
+// until the splitters are rebuilt.
+DockHit EventRouter::hitTest(const DFPoint& p, DockSplitter::Splitter*& lane)
+{
+    DockHit hit;
+    hit.window = WindowManager::instance().findWindowAtPoint(p);
+    lane = splitter_.splitterAtPoint(p);
+    hit.split = DockLayout::HandleOf(lane ? lane->node : nullptr);
+    DockLayout::Node* leaf = layout_.widgetNodeAt(p);
+    hit.leaf = DockLayout::HandleOf(leaf);
+    if (DockLayout::Node* strip = layout_.tabNodeAt(p)) {
+        const size_t count = strip->children.size();
+        for (size_t i = 0; i < count; ++i) {
+            const DFRect tab = DockLayout::TabRectForIndex(*strip, strip->bounds, i, count);
+            if (tab.width <= 1.0f || tab.height <= 1.0f || !tab.contains(p)) {
+                continue;
+            }
+            hit.tabNode = strip->handle();
+            hit.tabIndex = static_cast<int>(i);
+            hit.kind = DockRenderer::tabCloseRect(tab).contains(p) ? DockHit::Kind::TabClose : DockHit::Kind::Tab;
+            break;
+        }
+    }
+
+    if (hit.window) {
+        switch (hit.window->partAt(p)) {
+        case WindowFrame::Part::CloseButton: hit.kind = DockHit::Kind::FrameClose; break;
+        case WindowFrame::Part::ResizeEdge: hit.kind = DockHit::Kind::ResizeEdge; break;
+        case WindowFrame::Part::TitleBar: hit.kind = DockHit::Kind::TitleBar; break;
+        case WindowFrame::Part::Client:
+        case WindowFrame::Part::None: hit.kind = DockHit::Kind::Client; break;
+        }
+    } else if (hit.kind == DockHit::Kind::None) {
+        if (lane) {
+            hit.kind = DockHit::Kind::Splitter;
+        } else if (leaf && leaf->widget) {
+            hit.kind = DockHit::Kind::Client;
+        }
+    }
+    return hit;
+}
+
+EventRouter::Route EventRouter::dispatch(Event& event)
+{
+    if (capture_ != Capture::None && event.type != Event::Type::MouseDown) {
+        Route route = routeCaptured(event);
+        if (route.handler != Handler::None) {
+            route.captured = true;
+            return route;
+        }
+    }
+    DockSplitter::Splitter* lane = nullptr;
+    lastHit_ = hitTest({event.x, event.y}, lane);
+    return routeByHit(event, lane);
+}
+
+void EventRouter::capture(Capture owner, WindowFrame* window)
+{
+    capture_ = owner;
+    captureWindow_ = owner == Capture::FloatingWindow ? window : nullptr;
+}
+
+void EventRouter::cancel()
+{
+    DockManager::instance().endDrag();
+    DockManager::instance().cancelFloatingDrag();
+    splitter_.endDrag();
+    WindowManager::instance().cancelAllDrags();
+    capture(Capture::None);
+}
+
+WindowFrame* EventRouter::captureWindow() const
+{
+    return captureWindow_ && WindowManager::instance().hasWindow(captureWindow_) ? captureWindow_ : nullptr;
+}
+
+EventRouter::Route EventRouter::routeCaptured(Event& event)
+{
+    auto& mgr = DockManager::instance();
+    const bool release = event.type == Event::Type::MouseUp;
+    Route route;
+    switch (capture_) {
+    case Capture::FloatingWindow: {
+        WindowFrame* window = captureWindow();
+        if (mgr.isFloatingDragging() && mgr.handleEvent(event)) {
+            route.handler = Handler::FloatingDrag;
+            route.window = mgr.floatingDragWindow();
+        } else if (window && window->handleEvent(event)) {
+            if (window->consumeCloseRequest()) {
+                route = closeFloating(window);
+                cancel();
+            } else {
+                route.handler = Handler::FloatingWindow;
+                route.window = window;
+            }
+        }
+        break;
+    }
+    case Capture::DockWidgetDrag:
+        if (mgr.handleEvent(event)) {
+            if (mgr.isFloatingDragging()) {
+                // The drag left the layout and continues as a floating window.
+                capture(Capture::FloatingWindow, mgr.floatingDragWindow());
+                route.handler = Handler::FloatingDrag;
+                route.window = captureWindow_;
+            } else {
+                route.handler = Handler::DockDrag;
+            }
+        }
+        break;
+    case Capture::SplitterDrag:
+        if (splitter_.handleEvent(event, nullptr)) {
+            route.handler = Handler::Splitter;
+        }
+        break;
+    case Capture::TabGesture:
+        // An idle gesture hands the event back to the stages.
+        if (!tabGesture_ || !tabGesture_(event, DockHit{})) {
+            return route;
+        }
+        route.handler = Handler::TabGesture;
+        break;
+    case Capture::None:
+        return route;
+    }
+
+    // The owner keeps everything until the release, handled or not.
+    event.handled = true;
+    if (route.handler == Handler::None) {
+        route.handler = Handler::Captured;
+    }
+    if (release) {
+        cancel();
+    }
+    return route;
+}
+
+EventRouter::Route EventRouter::routeByHit(Event& event, DockSplitter::Splitter* lane)
+{
+    auto& mgr = DockManager::instance();
+    auto& wm = WindowManager::instance();
+    const bool press = event.type == Event::Type::MouseDown;
+    const bool release = event.type == Event::Type::MouseUp;
+    const DockHit& hit = lastHit_;
+    Route route;
+
+    // 1) A floating drag the host started without capturing.
+    if (mgr.isFloatingDragging() && mgr.handleEvent(event)) {
+        route.handler = Handler::FloatingDrag;
+        route.window = mgr.floatingDragWindow();
+        if (release) {
+            cancel();
+        }
+        return route;
+    }
+
+    // 2) Floating windows, top-most first.
+    if (WindowFrame* window = hit.window) {
+        if (press) {
+            wm.bringToFront(window);
+        }
+        if (window->handleEvent(event)) {
+            if (window->consumeCloseRequest()) {
+                if (captureWindow_ == window) {
+                    capture(Capture::None);
+                }
+                return closeFloating(window);
+            }
+            route.handler = mgr.isFloatingDragging() ? Handler::FloatingDragStart : Handler::FloatingWindow;
+            route.window = window;
+            if (press) {
+                capture(Capture::FloatingWindow, window);
+            } else if (release) {
+                cancel();
+            }
+            return route;
+        }
+    }
+
+    // 3) Host tab gestures.
+    if (press && !event.handled && tabGesture_ && tabGesture_(event, hit)) {
+        route.handler = Handler::TabGesture;
+        return route;
+    }
+
+    // 4) DockManager: tab-header drags and drags already in flight.
+    if (!event.handled && mgr.handleEvent(event)) {
+        route.handler = Handler::DockDrag;
+        if (press) {
+            capture(Capture::DockWidgetDrag);
+        } else if (release) {
+            cancel();
+        }
+        return route;
+    }
+
+    // 5) The docked widget under the pointer.
+    DockLayout::Node* leaf = DockLayout::Resolve(hit.leaf);
+    if (leaf && leaf->widget && !leaf->widget->isFloating()) {
+        DockWidget* widget = leaf->widget;
+        widget->handleEvent(event);
+        if (event.handled) {
+            route.handler = Handler::Widget;
+            route.widget = widget;
+            if (press && mgr.isFloatingDragging()) {
+                capture(Capture::FloatingWindow, mgr.floatingDragWindow());
+            } else if (press && mgr.isDragging()) {
+                capture(Capture::DockWidgetDrag);
+            }
+            return route;
+        }
+    }
+
+    // 6) Splitters last, so title bars, tabs and widgets win where they overlap.
+    if (!event.handled && splitter_.handleEvent(event, lane)) {
+        route.handler = Handler::Splitter;
+        if (press) {
+            capture(Capture::SplitterDrag);
+        } else if (release) {
+            cancel();
+        }
+    }
+    return route;
+}
+
+EventRouter::Route EventRouter::closeFloating(WindowFrame* window)
+{
+    Route route;
+    route.handler = Handler::FloatingClose;
+    route.window = window;
+    route.widget = window->content();
+    DockManager::instance().closeWidget(window->content());
+    return route;
+}
+
+const char* EventRouter::HandlerName(Handler handler)
+{
+    switch (handler) {
+    case Handler::None: return "none";
+    case Handler::FloatingDrag: return "floating_drag";
+    case Handler::FloatingDragStart: return "floating_drag_start";
+    case Handler::FloatingWindow: return "floating_window";
+    case Handler::FloatingClose: return "floating_close";
+    case Handler::TabGesture: return "tab";
+    case Handler::DockDrag: return "dock_drag";
+    case Handler::Widget: return "widget";
+    case Handler::Splitter: return "splitter";
+    case Handler::Captured: return "captured";
+    }
+    return "none";
+}
+
+} // namespace df
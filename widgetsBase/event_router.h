@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core_types.h"
+#include "dock_layout.h"
+#include "dock_splitter.h"
+#include <cstdint>
+#include <functional>
+
+namespace df {
+
+class DockWidget;
+class WindowFrame;
+
+// Everything under one pointer position, gathered in a single query. kind
+// names the top-most part; the docked fields are filled even beneath a
+// floating window, so a host can tell when the groups overlap. Layout nodes
+// are held by handle: the handler an event is routed to may close a tab or
+// rebuild the splitters, so resolve them with DockLayout::Resolve when used.
+struct DockHit {
+    enum class Kind : uint8_t { None, Splitter, Tab, TabClose, TitleBar, FrameClose, ResizeEdge, Client };
+
+    Kind kind = Kind::None;
+    WindowFrame* window = nullptr;          // top-most floating frame
+    DockNodeHandle tabNode;                 // tab stack whose strip holds the point
+    int tabIndex = -1;
+    DockNodeHandle split;                   // split whose splitter lane holds the point
+    DockNodeHandle leaf;                    // docked widget leaf
+};
+
+// Routes pointer events through the docking stages in priority order:
+// an active floating drag, floating windows, the host's tab gesture,
+// DockManager, the docked widget under the pointer, then splitters.
+// A press that starts an interaction captures the pointer for its owner;
+// moves and the release then go straight to that owner without a hit query,
+// and the release ends every drag and frees the capture.
+class EventRouter {
+public:
+    enum class Capture : uint8_t { None, FloatingWindow, DockWidgetDrag, SplitterDrag, TabGesture };
+    enum class Handler : uint8_t {
+        None,
+        FloatingDrag,
+        FloatingDragStart,
+        FloatingWindow,
+        FloatingClose,
+        TabGesture,
+        DockDrag,
+        Widget,
+        Splitter,
+        Captured // swallowed by the capture owner
+    };
+
+    struct Route {
+        Handler handler = Handler::None;
+        bool captured = false;          // went to the capture owner, no hit query
+        WindowFrame* window = nullptr;  // floating handlers; destroyed after FloatingClose
+        DockWidget* widget = nullptr;   // Widget, FloatingClose
+    };
+
+    // Optional host stage between floating windows and DockManager. It sees
+    // uncaptured presses with their hit and returns true when it took one;
+    // to keep the pointer it calls capture(Capture::TabGesture), after which
+    // it also gets the moves and the release (with an empty hit).
+    using TabGestureHandler = std::function<bool(Event&, const DockHit&)>;
+
+    EventRouter(DockLayout& layout, DockSplitter& splitter) : layout_(layout), splitter_(splitter) {}
+
+    DockHit hitTest(const DFPoint& p);
+    Route dispatch(Event& event);
+
+    void capture(Capture owner, WindowFrame* window = nullptr);
+    // Ends every drag the stages may hold and releases the capture.
+    void cancel();
+    Capture captured() const { return capture_; }
+    // The frame a FloatingWindow capture holds, or null once it is destroyed.
+    WindowFrame* captureWindow() const;
+    // Drops window from the capture; call before destroying it.
+    void forgetWindow(const WindowFrame* window)
+    {
+        if (captureWindow_ == window) {
+            captureWindow_ = nullptr;
+        }
+    }
+    // Hit of the last event that was not routed by capture.
+    const DockHit& lastHit() const { return lastHit_; }
+
+    void setTabGestureHandler(TabGestureHandler handler) { tabGesture_ = std::move(handler); }
+
+    static const char* HandlerName(Handler handler);
+
+private:
+    Route routeCaptured(Event& event);
+    DockHit hitTest(const DFPoint& p, DockSplitter::Splitter*& lane);
+    Route routeByHit(Event& event, DockSplitter::Splitter* lane);
+    Route closeFloating(WindowFrame* window);
+
+    DockLayout& layout_;
+    DockSplitter& splitter_;
+    Capture capture_ = Capture::None;
+    WindowFrame* captureWindow_ = nullptr;
+    DockHit lastHit_{};
+    TabGestureHandler tabGesture_;
+};
+
+} // namespace df
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "core_types.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Uniform grid for point hit-testing over a set of rects. Each rect is binned
+// into every cell it overlaps, so a query only tests the entries of the cell
+// under the point. Cells keep insertion order: the first containing entry is
+// the one a linear scan over the same rects would return. Buffers are reused
+// across rebuilds.
+class DFHitGrid {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    void clear()
+    {
+        entries_.clear();
+        cellStart_.clear();
+        cellItems_.clear();
+        cols_ = 0;
+        rows_ = 0;
+    }
+
+    // Rects are staged until build(); id is returned by find().
+    void add(const DFRect& rect, uint32_t id)
+    {
+        if (rect.width >= 0.0f && rect.height >= 0.0f) {
+            entries_.push_back({rect, id});
+        }
+    }
+
+    void build()
+    {
+        cellStart_.clear();
+        cellItems_.clear();
+        if (entries_.empty()) {
+            cols_ = 0;
+            rows_ = 0;
+            return;
+        }
+
+        float x0 = entries_.front().rect.x;
+        float y0 = entries_.front().rect.y;
+        float x1 = x0 + entries_.front().rect.width;
+        float y1 = y0 + entries_.front().rect.height;
+        for (const Entry& entry : entries_) {
+            x0 = std::min(x0, entry.rect.x);
+            y0 = std::min(y0, entry.rect.y);
+            x1 = std::max(x1, entry.rect.x + entry.rect.width);
+            y1 = std::max(y1, entry.rect.y + entry.rect.height);
+        }
+        area_ = {x0, y0, x1 - x0, y1 - y0};
+
+        // About one entry per cell for a layout that tiles its area.
+        const int side = std::clamp(static_cast<int>(std::ceil(std::sqrt(static_cast<float>(entries_.size())))), 1, kMaxSide);
+        cols_ = side;
+        rows_ = side;
+        cellW_ = std::max(area_.width / static_cast<float>(cols_), 1.0f);
+        cellH_ = std::max(area_.height / static_cast<float>(rows_), 1.0f);
+
+        cellStart_.assign(static_cast<size_t>(cols_ * rows_) + 1, 0);
+        forEachCell([this](size_t, int cell) { ++cellStart_[static_cast<size_t>(cell) + 1]; });
+        for (size_t i = 1; i < cellStart_.size(); ++i) {
+            cellStart_[i] += cellStart_[i - 1];
+        }
+        cellItems_.resize(cellStart_.back());
+        fill_.assign(cellStart_.begin(), cellStart_.end() - 1);
+        forEachCell([this](size_t entry, int cell) {
+            cellItems_[fill_[static_cast<size_t>(cell)]++] = static_cast<uint32_t>(entry);
+        });
+    }
+
+    // First id in insertion order whose rect contains p and that accept(id)
+    // agrees to, or kNone.
+    template <typename Accept>
+    uint32_t find(const DFPoint& p, Accept&& accept) const
+    {
+        if (cols_ == 0 || !area_.contains(p)) {
+            return kNone;
+        }
+        const size_t cell = static_cast<size_t>(cellY(p.y) * cols_ + cellX(p.x));
+        for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i) {
+            const Entry& entry = entries_[cellItems_[i]];
+            if (entry.rect.contains(p) && accept(entry.id)) {
+                return entry.id;
+            }
+        }
+        return kNone;
+    }
+
+    uint32_t find(const DFPoint& p) const
+    {
+        return find(p, [](uint32_t) { return true; });
+    }
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+
+private:
+    struct Entry {
+        DFRect rect;
+        uint32_t id;
+    };
+    static constexpr int kMaxSide = 32;
+
+    int cellX(float x) const { return std::clamp(static_cast<int>(std::floor((x - area_.x) / cellW_)), 0, cols_ - 1); }
+    int cellY(float y) const { return std::clamp(static_cast<int>(std::floor((y - area_.y) / cellH_)), 0, rows_ - 1); }
+
+    template <typename Fn>
+    void forEachCell(Fn&& fn) const
+    {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            const DFRect& r = entries_[i].rect;
+            const int cx0 = cellX(r.x);
+            const int cx1 = cellX(r.x + r.width);
+            const int cy0 = cellY(r.y);
+            const int cy1 = cellY(r.y + r.height);
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    fn(i, cy * cols_ + cx);
+                }
+            }
+        }
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<uint32_t> cellStart_;
+    std::vector<uint32_t> cellItems_;
+    std::vector<uint32_t> fill_;
+    DFRect area_{};
+    float cellW_ = 1.0f;
+    float cellH_ = 1.0f;
+    int cols_ = 0;
+    int rows_ = 0;
+};
@@ -0,0 +1,81 @@
+#include "input_coalescer.h"
+
+namespace df {
+
+void InputCoalescer::push(const Event& event)
+{
+    const bool move = event.type == Event::Type::MouseMove;
+    const bool pointer = move || event.type == Event::Type::MouseDown || event.type == Event::Type::MouseUp;
+    if (pointer) {
+        record(event.x, event.y, event.time);
+    }
+    if (move) {
+        ++stats_.moves;
+        if (!queue_.empty() && queue_.back().type == Event::Type::MouseMove) {
+            Event& pending = queue_.back();
+            const double time = pending.time;
+            const uint64_t sequence = pending.sequence;
+            pending = event;
+            if (sequence != 0) {
+                pending.time = time;
+                pending.sequence = sequence;
+            }
+            ++stats_.coalesced;
+            return;
+        }
+    }
+    queue_.push_back(event);
+}
+
+void InputCoalescer::clear()
+{
+    queue_.clear();
+    historyHead_ = 0;
+    historyCount_ = 0;
+}
+
+const InputCoalescer::PointerSample& InputCoalescer::sample(size_t age) const
+{
+    return history_[(historyHead_ + kHistorySize - 1 - age) % kHistorySize];
+}
+
+DFPoint InputCoalescer::velocity(double window) const
+{
+    if (historyCount_ < 2) {
+        return {0.0f, 0.0f};
+    }
+    const PointerSample& newest = sample(0);
+    const PointerSample* oldest = &sample(1);
+    for (size_t age = 2; age < historyCount_ && newest.time - sample(age).time <= window; ++age) {
+        oldest = &sample(age);
+    }
+    const double dt = newest.time - oldest->time;
+    if (dt <= 0.0) {
+        return {0.0f, 0.0f};
+    }
+    return {
+        static_cast<float>((newest.x - oldest->x) / dt),
+        static_cast<float>((newest.y - oldest->y) / dt)
+    };
+}
+
+DFPoint InputCoalescer::predict(double ahead, double window) const
+{
+    if (historyCount_ == 0) {
+        return {0.0f, 0.0f};
+    }
+    const PointerSample& newest = sample(0);
+    const DFPoint v = velocity(window);
+    return {newest.x + static_cast<float>(v.x * ahead), newest.y + static_cast<float>(v.y * ahead)};
+}
+
+void InputCoalescer::record(float x, float y, double time)
+{
+    history_[historyHead_] = {x, y, time};
+    historyHead_ = (historyHead_ + 1) % kHistorySize;
+    if (historyCount_ < kHistorySize) {
+        ++historyCount_;
+    }
+}
+
+} // namespace df
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core_types.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace df {
+
+// Sits between the platform message pump and EventRouter so dispatch runs at
+// frame rate rather than at the mouse polling rate. A move that arrives while
+// the newest queued event is also a move replaces it; presses, releases and
+// keys are always queued, so nothing but stale positions is ever dropped and
+// the order of the rest is kept. Every pointer position, coalesced or not,
+// lands in a history stamped with Event::time for velocity and prediction.
+class InputCoalescer {
+public:
+    struct PointerSample {
+        float x = 0.0f;
+        float y = 0.0f;
+        double time = 0.0; // Event::time, seconds
+    };
+
+    struct Stats {
+        uint64_t moves = 0;     // moves pushed
+        uint64_t coalesced = 0; // moves folded into a newer one
+        uint64_t delivered = 0; // events handed to drain callbacks
+    };
+
+    static constexpr size_t kHistorySize = 64;
+
+    void push(const Event& event);
+
+    // Hands the queued events to fn(Event&) in arrival order. Events pushed
+    // from inside fn wait for the next drain. Returns how many were delivered.
+    template <typename Fn>
+    size_t drain(Fn&& fn)
+    {
+        draining_.swap(queue_);
+        for (Event& event : draining_) {
+            fn(event);
+        }
+        const size_t count = draining_.size();
+        draining_.clear();
+        stats_.delivered += count;
+        return count;
+    }
+
+    bool empty() const { return queue_.empty(); }
+    size_t pending() const { return queue_.size(); }
+    // Drops queued events and the pointer history; the stats are kept.
+    void clear();
+
+    size_t historySize() const { return historyCount_; }
+    // age 0 is the newest sample; age must be below historySize().
+    const PointerSample& sample(size_t age) const;
+    // Average pointer velocity in px/s across the samples of the newest window
+    // seconds (always at least the two newest); zero until two samples span a
+    // positive interval.
+    DFPoint velocity(double window = 0.05) const;
+    // Newest position extrapolated ahead seconds along velocity().
+    DFPoint predict(double ahead, double window = 0.05) const;
+
+    const Stats& stats() const { return stats_; }
+    void resetStats() { stats_ = {}; }
+
+private:
+    void record(float x, float y, double time);
+
+    std::vector<Event> queue_;
+    std::vector<Event> draining_;
+    std::array<PointerSample, kHistorySize> history_{};
+    size_t historyHead_ = 0; // slot of the next sample
+    size_t historyCount_ = 0;
+    Stats stats_;
+};
+
+} // namespace df
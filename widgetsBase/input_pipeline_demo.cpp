@@ -0,0 +1,401 @@
+#include "dock_framework.h"
+#include "dock_layout.h"
+#include "dock_renderer.h"
+#include "dock_splitter.h"
+#include "dock_widget_impl.h"
+#include "event_router.h"
+#include "input_coalescer.h"
+#include "input_queue.h"
+#include "input_recording.h"
+#include "latency_tracker.h"
+#include "test_support.h"
+#include "window_manager.h"
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    CheckSuite checks;
+    Workspace workspace;
+    workspace.build();
+
+    // EventRouter classifies a point in one query and routes captured drags
+    // straight to their owner until the release.
+    {
+        df::EventRouter router(workspace.layout, workspace.splitter);
+        using Kind = df::DockHit::Kind;
+        df::DockLayout::Node* root = workspace.layout.root();
+        df::DockLayout::Node* tabs = root->second->first.get();
+        const DFRect tab = df::DockLayout::TabRectForIndex(*tabs, tabs->bounds, 0, tabs->children.size());
+        const DFRect tabClose = df::DockRenderer::tabCloseRect(tab);
+        df::WindowFrame* window = df::WindowManager::instance().findWindowByContent(workspace.widgets[5].get());
+        const DFRect frame = window->bounds();
+        const DFRect inspector = workspace.widgets[2]->bounds();
+        const DFPoint lane{root->first->bounds.x + root->first->bounds.width + 1.0f, 400.0f};
+
+        const df::DockHit tabHit = router.hitTest({tab.x + 6.0f, tab.y + tab.height * 0.5f});
+        checks.expect(tabHit.kind == Kind::Tab && tabHit.tabNode == tabs->handle() && tabHit.tabIndex == 0, "router hits a tab");
+        checks.expect(router.hitTest({tabClose.x + tabClose.width * 0.5f, tabClose.y + tabClose.height * 0.5f}).kind == Kind::TabClose,
+                      "router hits a tab close button");
+        const df::DockHit laneHit = router.hitTest(lane);
+        checks.expect(laneHit.kind == Kind::Splitter && laneHit.split == root->handle(), "router hits a splitter");
+        const df::DockHit clientHit = router.hitTest({inspector.x + inspector.width * 0.5f, inspector.y + inspector.height * 0.5f});
+        checks.expect(clientHit.kind == Kind::Client && clientHit.leaf == workspace.widgets[2]->layoutNode(),
+                      "router hits a docked client area");
+        checks.expect(router.hitTest({frame.x + 60.0f, frame.y + 12.0f}).kind == Kind::TitleBar &&
+                          router.hitTest({frame.x + frame.width - 2.0f, frame.y + frame.height * 0.5f}).kind == Kind::ResizeEdge &&
+                          router.hitTest({frame.x + frame.width * 0.5f, frame.y + frame.height * 0.5f}).window == window,
+                      "router hits floating frame parts");
+
+        auto send = [&router](Event::Type type, float x, float y) {
+            Event event(type);
+            event.x = x;
+            event.y = y;
+            return router.dispatch(event);
+        };
+        using Handler = df::EventRouter::Handler;
+        using Capture = df::EventRouter::Capture;
+        const float ratio = root->ratio;
+        const df::EventRouter::Route press = send(Event::Type::MouseDown, lane.x, lane.y);
+        checks.expect(press.handler == Handler::Splitter && router.captured() == Capture::SplitterDrag,
+                      "a splitter press captures the pointer");
+        // Captured moves skip the hit query, so lastHit still describes the press.
+        const df::EventRouter::Route drag = send(Event::Type::MouseMove, frame.x + 10.0f, frame.y + 40.0f);
+        checks.expect(drag.captured && drag.handler == Handler::Splitter && router.lastHit().kind == Kind::Splitter,
+                      "captured moves go to the splitter even over a floating window");
+        send(Event::Type::MouseMove, lane.x, lane.y);
+        const df::EventRouter::Route release = send(Event::Type::MouseUp, lane.x, lane.y);
+        checks.expect(release.captured && router.captured() == Capture::None && !workspace.splitter.isDragging(),
+                      "the release ends the drag and frees the capture");
+        root->ratio = ratio;
+        df::DockLayout::MarkDirty(root);
+        workspace.layout.update(workspace.bounds);
+        workspace.splitter.updateSplitters(workspace.layout.root(), workspace.bounds);
+
+        const float edgeX = frame.x + frame.width - 2.0f;
+        const float edgeY = frame.y + frame.height * 0.5f;
+        const df::EventRouter::Route grab = send(Event::Type::MouseDown, edgeX, edgeY);
+        send(Event::Type::MouseMove, edgeX + 40.0f, edgeY);
+        send(Event::Type::MouseUp, edgeX + 40.0f, edgeY);
+        checks.expect(grab.handler == Handler::FloatingWindow && grab.window == window &&
+                          std::fabs(window->bounds().width - (frame.width + 40.0f)) < 0.5f &&
+                          router.captured() == Capture::None && !window->isDragging(),
+                      "frame resizes route through a floating window capture");
+        window->setBounds(frame);
+
+        // A hit outlives the node it names once the layout is edited.
+        send(Event::Type::MouseMove, inspector.x + inspector.width * 0.5f, inspector.y + inspector.height * 0.5f);
+        const df::DockNodeHandle inspectorLeaf = router.lastHit().leaf;
+        workspace.layout.removeWidget(workspace.widgets[2].get());
+        checks.expect(inspectorLeaf && df::DockLayout::Resolve(router.lastHit().leaf) == nullptr,
+                      "a hit on a closed leaf resolves to null");
+        workspace.layout.insertWidget(workspace.widgets[2].get(),
+                                      df::DockLayout::Resolve(workspace.widgets[3]->layoutNode())->parent,
+                                      df::DragOverlay::DropZone::Left);
+        root->second->second->ratio = 0.5f;
+        workspace.layout.update(workspace.bounds);
+        workspace.splitter.updateSplitters(workspace.layout.root(), workspace.bounds);
+    }
+
+    // InputCoalescer folds move bursts into the newest move without dropping
+    // or reordering presses, releases and keys, and keeps every position.
+    {
+        df::InputCoalescer input;
+        auto push = [&input](Event::Type type, float x, float y, double time) {
+            Event event(type);
+            event.x = x;
+            event.y = y;
+            event.time = time;
+            input.push(event);
+        };
+        push(Event::Type::MouseMove, 10.0f, 10.0f, 0.000);
+        push(Event::Type::MouseMove, 11.0f, 10.0f, 0.001);
+        push(Event::Type::MouseMove, 12.0f, 10.0f, 0.002);
+        push(Event::Type::MouseDown, 12.0f, 10.0f, 0.003);
+        push(Event::Type::MouseMove, 14.0f, 11.0f, 0.004);
+        push(Event::Type::MouseMove, 16.0f, 12.0f, 0.005);
+        Event key(Event::Type::KeyDown);
+        key.key = 27;
+        key.time = 0.006;
+        input.push(key);
+        push(Event::Type::MouseMove, 18.0f, 13.0f, 0.007);
+        push(Event::Type::MouseUp, 18.0f, 13.0f, 0.008);
+        checks.expect(input.pending() == 6, "move bursts collapse to one queued move");
+
+        std::vector<Event> delivered;
+        input.drain([&delivered](Event& event) { delivered.push_back(event); });
+        const bool ordered = delivered.size() == 6 &&
+            delivered[0].type == Event::Type::MouseMove && delivered[0].x == 12.0f &&
+            delivered[1].type == Event::Type::MouseDown &&
+            delivered[2].type == Event::Type::MouseMove && delivered[2].x == 16.0f &&
+            delivered[3].type == Event::Type::KeyDown && delivered[3].key == 27 &&
+            delivered[4].type == Event::Type::MouseMove && delivered[4].x == 18.0f &&
+            delivered[5].type == Event::Type::MouseUp;
+        checks.expect(ordered && input.empty(), "drain keeps presses, keys and releases in arrival order");
+        checks.expect(input.stats().moves == 6 && input.stats().coalesced == 3 && input.stats().delivered == 6,
+                      "stats count pushed, folded and delivered events");
+        checks.expect(input.historySize() == 8 && input.sample(0).x == 18.0f && input.sample(7).x == 10.0f,
+                      "pointer history keeps coalesced positions, key events excluded");
+
+        input.clear();
+        for (int i = 0; i < 80; ++i) {
+            push(Event::Type::MouseMove, 100.0f + 2.0f * static_cast<float>(i), 50.0f - static_cast<float>(i), 0.001 * i);
+        }
+        const DFPoint v = input.velocity();
+        const DFPoint ahead = input.predict(0.010);
+        checks.expect(input.historySize() == df::InputCoalescer::kHistorySize && input.pending() == 1,
+                      "history is a bounded ring and the queue holds one move");
+        checks.expect(std::fabs(v.x - 2000.0f) < 1.0f && std::fabs(v.y + 1000.0f) < 1.0f,
+                      "velocity follows a steady 1000 Hz stream");
+        checks.expect(std::fabs(ahead.x - (258.0f + 20.0f)) < 0.1f && std::fabs(ahead.y - (-29.0f - 10.0f)) < 0.1f,
+                      "prediction extrapolates along the velocity");
+
+        input.clear();
+        push(Event::Type::MouseDown, 5.0f, 5.0f, 1.0);
+        checks.expect(input.velocity().x == 0.0f && input.predict(0.5).x == 5.0f,
+                      "a single sample predicts no motion");
+    }
+
+    // Stamped events carry time, order and modifiers; LatencyTracker charges
+    // each input from its stamp to the present of the first frame begun after
+    // its dispatch.
+    {
+        Event first(Event::Type::MouseMove);
+        first.modifiers = static_cast<uint32_t>(Event::Modifier::Shift) | static_cast<uint32_t>(Event::Modifier::Alt);
+        DFStampInput(first);
+        Event second(Event::Type::MouseMove);
+        second.x = 40.0f;
+        DFStampInput(second);
+        checks.expect(first.sequence > 0 && second.sequence > first.sequence && second.time >= first.time,
+                      "stamps are monotonic in time and sequence");
+        checks.expect(first.has(Event::Modifier::Shift) && first.has(Event::Modifier::Alt) &&
+                          !first.has(Event::Modifier::Control),
+                      "modifier bits read back");
+
+        df::InputCoalescer input;
+        input.push(first);
+        input.push(second);
+        Event merged;
+        input.drain([&merged](Event& event) { merged = event; });
+        checks.expect(merged.x == 40.0f && merged.sequence == first.sequence && merged.time == first.time,
+                      "a coalesced move keeps the oldest stamp and the newest position");
+
+        using Interaction = df::LatencyTracker::Interaction;
+        using Handler = df::EventRouter::Handler;
+        checks.expect(df::LatencyTracker::Classify(Handler::Splitter) == Interaction::SplitterDrag &&
+                          df::LatencyTracker::Classify(Handler::DockDrag) == Interaction::TabDrag &&
+                          df::LatencyTracker::Classify(Handler::FloatingDrag) == Interaction::FloatingMove &&
+                          df::LatencyTracker::Classify(Handler::Widget) == Interaction::Other,
+                      "router handlers map to interactions");
+
+        df::LatencyTracker latency;
+        auto event = [](uint64_t sequence, double time, bool handled) {
+            Event e(Event::Type::MouseMove);
+            e.sequence = sequence;
+            e.time = time;
+            e.handled = handled;
+            return e;
+        };
+        latency.dispatched(event(1, 10.001, true), Interaction::SplitterDrag);
+        latency.dispatched(event(2, 10.005, true), Interaction::SplitterDrag);
+        latency.dispatched(event(3, 10.004, false), Interaction::SplitterDrag);
+        latency.dispatched(event(0, 10.004, true), Interaction::FloatingMove);
+        latency.beginFrame();
+        latency.dispatched(event(4, 10.010, true), Interaction::FloatingMove);
+        latency.presented(10.016);
+        const df::LatencyTracker::Histogram& split = latency.histogram(Interaction::SplitterDrag);
+        checks.expect(split.count == 2 && std::fabs(split.maxMs - 15.0) < 1e-6 && std::fabs(split.meanMs() - 13.0) < 1e-6,
+                      "a present closes the inputs its frame answers");
+        checks.expect(latency.pending() == 1 && latency.histogram(Interaction::FloatingMove).count == 0,
+                      "unhandled, unstamped and late inputs are not charged to the frame");
+        latency.beginFrame();
+        latency.presented(10.030);
+        const df::LatencyTracker::Histogram& floating = latency.histogram(Interaction::FloatingMove);
+        checks.expect(floating.count == 1 && std::fabs(floating.maxMs - 20.0) < 1e-6 && latency.pending() == 0,
+                      "a late input lands on the next present");
+        checks.expect(split.percentileMs(0.5) == 12.0 && split.percentileMs(0.99) == split.maxMs &&
+                          latency.json().find("\"splitter_drag\": {\"count\": 2") != std::string::npos &&
+                          latency.json().find("other") == std::string::npos,
+                      "percentiles come from bucket edges and the JSON skips empty interactions");
+    }
+
+    // An input recording round-trips the stream compactly, and replaying it
+    // into the same layout reproduces every checkpoint.
+    {
+        df::EventRouter router(workspace.layout, workspace.splitter);
+        df::DockLayout::Node* root = workspace.layout.root();
+        const float ratio = root->ratio;
+        const DFPoint lane{std::round(root->first->bounds.x + root->first->bounds.width + 1.0f), 400.0f};
+        auto layout = [&workspace]() {
+            workspace.layout.update(workspace.bounds);
+            workspace.splitter.updateSplitters(workspace.layout.root(), workspace.bounds);
+        };
+
+        df::InputRecorder recorder(1);
+        double time = 50.0;
+        auto send = [&](Event::Type type, float x, float y) {
+            Event event(type);
+            event.x = x;
+            event.y = y;
+            event.time = (time += 0.004);
+            event.sequence = 1;
+            recorder.event(event);
+            router.dispatch(event);
+        };
+        auto frame = [&]() {
+            layout();
+            recorder.frame(time);
+            recorder.checkpoint(df::DockLayoutChecksum(workspace.layout, df::WindowManager::instance()));
+        };
+        recorder.resize(workspace.bounds.width, workspace.bounds.height, time);
+        send(Event::Type::MouseDown, lane.x, lane.y);
+        frame();
+        const size_t before = recorder.bytes().size();
+        for (int i = 1; i <= 20; ++i) {
+            send(Event::Type::MouseMove, lane.x + 3.0f * static_cast<float>(i), lane.y + 0.5f);
+        }
+        const size_t moveBytes = recorder.bytes().size() - before;
+        frame();
+        send(Event::Type::MouseUp, lane.x + 60.0f, lane.y + 0.5f);
+        frame();
+        const float draggedRatio = root->ratio;
+        send(Event::Type::MouseMove, 10.3f, 20.7f);
+        Event key(Event::Type::KeyDown);
+        key.key = 'Z';
+        key.modifiers = static_cast<uint32_t>(Event::Modifier::Control);
+        recorder.event(key);
+        frame();
+        checks.expect(moveBytes <= 20 * 8, "pointer moves cost a few bytes each");
+
+        df::InputReplayer replayer;
+        std::string error;
+        const bool loaded = replayer.load(recorder.bytes(), &error);
+        const std::vector<df::InputRecord>& records = replayer.records();
+        checks.expect(loaded && records.size() == recorder.recordCount(), "a recording decodes record for record");
+        const df::InputRecord& offGrid = records[records.size() - 4];
+        const df::InputRecord& keyRecord = records[records.size() - 3];
+        checks.expect(loaded && records[1].event.type == Event::Type::MouseDown && records[1].event.x == lane.x &&
+                          offGrid.event.x == 10.3f && offGrid.event.y == 20.7f &&
+                          keyRecord.event.key == 'Z' && keyRecord.event.has(Event::Modifier::Control) &&
+                          std::fabs(replayer.duration() - 23 * 0.004) < 1e-6,
+                      "positions, keys, modifiers and time offsets survive exactly");
+
+        root->ratio = ratio;
+        df::DockLayout::MarkDirty(root);
+        layout();
+        std::vector<Event> keys;
+        bool keyDispatched = false;
+        df::InputReplayer::Hooks hooks;
+        hooks.dispatch = [&router, &keyDispatched](Event& event) {
+            keyDispatched = keyDispatched || event.type == Event::Type::KeyDown;
+            router.dispatch(event);
+        };
+        hooks.key = [&keys](Event& event) { keys.push_back(event); };
+        hooks.frame = layout;
+        hooks.checksum = [&workspace]() { return df::DockLayoutChecksum(workspace.layout, df::WindowManager::instance()); };
+        const df::InputReplayer::Result replay = replayer.run(hooks);
+        checks.expect(replay.events == 24 && replay.frames == 4 && replay.checkpoints == 4 && replay.mismatches == 0 &&
+                          root->ratio == draggedRatio && draggedRatio != ratio,
+                      "replay reproduces the drag and every checkpoint");
+        checks.expect(keys.size() == 1 && keys[0].key == 'Z' && keys[0].has(Event::Modifier::Control) && !keyDispatched,
+                      "replayed keys go to the key hook, pointer events to dispatch");
+        root->ratio = ratio + 0.05f;
+        df::DockLayout::MarkDirty(root);
+        layout();
+        const df::InputReplayer::Result diverged = replayer.run(hooks);
+        checks.expect(diverged.mismatches > 0 && records[diverged.firstMismatch].tag == df::InputRecord::Tag::Checkpoint,
+                      "replay from a different layout reports the first diverging checkpoint");
+
+        std::string truncated = recorder.bytes();
+        truncated.pop_back();
+        checks.expect(!replayer.load(truncated, &error) && !replayer.load("DFLS", &error) && replayer.records().size() == records.size(),
+                      "malformed recordings are rejected whole");
+
+        // The checksum reads the given layout and, when passed, the windows;
+        // which layout the DockManager holds does not enter it.
+        df::WindowManager& windows = df::WindowManager::instance();
+        const uint64_t dockedSum = df::DockLayoutChecksum(workspace.layout);
+        const uint64_t fullSum = df::DockLayoutChecksum(workspace.layout, windows);
+        df::DockManager::instance().setMainLayout(&workspace.layout, workspace.bounds);
+        checks.expect(df::DockLayoutChecksum(workspace.layout) == dockedSum &&
+                          df::DockLayoutChecksum(workspace.layout, windows) == fullSum,
+                      "layout checksum ignores the DockManager's main layout");
+        df::DockManager::instance().setMainLayout(nullptr, {});
+        df::WindowFrame* floating = windows.findWindowByContent(workspace.widgets[5].get());
+        const DFRect floatingBounds = floating->bounds();
+        floating->setBounds({floatingBounds.x + 8.0f, floatingBounds.y, floatingBounds.width, floatingBounds.height});
+        checks.expect(df::DockLayoutChecksum(workspace.layout) == dockedSum &&
+                          df::DockLayoutChecksum(workspace.layout, windows) != fullSum,
+                      "floating window moves only change the checksum that includes windows");
+        floating->setBounds(floatingBounds);
+
+        root->ratio = ratio;
+        df::DockLayout::MarkDirty(root);
+        layout();
+    }
+
+    {
+        // InputQueue hands events from a producer thread to the consumer in
+        // order, bounds each drain to what was queued when it began, and
+        // rejects pushes into a full ring instead of blocking.
+        df::InputQueue queue(5);
+        checks.expect(queue.capacity() == 8 && queue.empty(), "queue capacity rounds up to a power of two");
+        bool accepted = true;
+        for (int i = 0; i < 8; ++i) {
+            Event event(Event::Type::MouseMove);
+            event.x = static_cast<float>(i);
+            accepted = queue.push(event) && accepted;
+        }
+        checks.expect(accepted, "queue accepts pushes up to capacity");
+        checks.expect(!queue.push(Event(Event::Type::MouseMove)) && queue.overflows() == 1 && queue.size() == 8,
+                      "full queue rejects the push and counts an overflow");
+        std::vector<float> drained;
+        const size_t batch = queue.drain([&](Event& event) {
+            drained.push_back(event.x);
+            if (event.x == 0.0f) {
+                Event late(Event::Type::MouseMove);
+                late.x = 100.0f;
+                queue.push(late);
+            }
+        });
+        checks.expect(batch == 8 && drained.size() == 8 && drained.front() == 0.0f && drained.back() == 7.0f && queue.size() == 1,
+                      "drain delivers the queued batch in order and leaves later pushes for the next drain");
+        queue.drain([](Event&) {});
+
+        constexpr int kEvents = 20000;
+        std::thread producer([&queue]() {
+            for (int i = 1; i <= kEvents; ++i) {
+                Event event(Event::Type::MouseMove);
+                event.sequence = static_cast<uint64_t>(i);
+                while (!queue.push(event)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        uint64_t expected = 1;
+        bool ordered = true;
+        while (expected <= kEvents) {
+            queue.drain([&](Event& event) {
+                ordered = ordered && event.sequence == expected;
+                ++expected;
+            });
+        }
+        producer.join();
+        checks.expect(ordered && expected == kEvents + 1 && queue.empty(),
+                      "events cross threads without loss or reordering");
+    }
+
+    if (checks.failed() > 0) {
+        std::cout << "CHECKS FAILED passed=" << checks.passed() << " failed=" << checks.failed() << "\n";
+        return 1;
+    }
+
+    std::cout << "ALL CHECKS PASSED passed=" << checks.passed() << " failed=0\n";
+    return 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core_types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace df {
+
+// Lock-free single-producer/single-consumer ring of Events. The platform
+// message loop pushes from one thread and the UI thread drains at frame
+// boundaries, so a slow frame never blocks message handling and input is
+// never reordered. push() and drain() are wait-free; the capacity is fixed
+// (rounded up to a power of two) and allocated once.
+//
+// A full queue rejects the push and counts an overflow; the producer picks
+// the policy. Same-thread hosts drain and retry. A producer thread can spin
+// for presses and releases and drop moves, since InputCoalescer would fold
+// them anyway.
+class InputQueue {
+public:
+    explicit InputQueue(size_t capacity = 1024) : slots_(RoundUp(capacity)), mask_(slots_.size() - 1) {}
+
+    InputQueue(const InputQueue&) = delete;
+    InputQueue& operator=(const InputQueue&) = delete;
+
+    // Producer thread only.
+    bool push(const Event& event)
+    {
+        const uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ > mask_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ > mask_) {
+                overflows_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        slots_[tail & mask_] = event;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Hands fn(Event&) the events that were queued when
+    // the drain began, oldest first; a producer that keeps pushing cannot
+    // stretch the batch. Each slot is released before fn runs.
+    template <typename Fn>
+    size_t drain(Fn&& fn)
+    {
+        const uint64_t start = head_.load(std::memory_order_relaxed);
+        const uint64_t end = tail_.load(std::memory_order_acquire);
+        for (uint64_t head = start; head != end; ++head) {
+            Event event = slots_[head & mask_];
+            head_.store(head + 1, std::memory_order_release);
+            fn(event);
+        }
+        return static_cast<size_t>(end - start);
+    }
+
+    // Either thread; a snapshot that may be stale by the time it returns.
+    size_t size() const
+    {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head);
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return slots_.size(); }
+    uint64_t overflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    static size_t RoundUp(size_t capacity)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    std::vector<Event> slots_;
+    const uint64_t mask_;
+    // Producer and consumer indices on separate cache lines; the producer's
+    // cached copy of head sits beside the index it owns.
+    alignas(64) std::atomic<uint64_t> tail_{0};
+    uint64_t cachedHead_ = 0;
+    alignas(64) std::atomic<uint64_t> head_{0};
+    alignas(64) std::atomic<uint64_t> overflows_{0};
+};
+
+} // namespace df
@@ -0,0 +1,368 @@
+#include "input_recording.h"
+
+#include "dock_framework.h"
+#include "dock_layout.h"
+#include "dock_state.h"
+#include "window_manager.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+namespace df {
+
+namespace {
+
+constexpr float kPositionScale = 64.0f;
+constexpr uint8_t kRawPosition = 0x80; // Event type flag: x, y follow as floats
+
+uint64_t Fnv(uint64_t hash, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t HashRect(uint64_t hash, const DFRect& rect)
+{
+    const float values[4] = {rect.x, rect.y, rect.width, rect.height};
+    return Fnv(hash, values, sizeof(values));
+}
+
+uint64_t HashTitle(uint64_t hash, const DockWidget* widget)
+{
+    const uint32_t size = widget ? static_cast<uint32_t>(widget->title().size()) : 0u;
+    hash = Fnv(hash, &size, sizeof(size));
+    return widget ? Fnv(hash, widget->title().data(), size) : hash;
+}
+
+// Widgets are hashed by title, not address, so a replay in another process
+// produces the same checksum.
+uint64_t HashNode(uint64_t hash, const DockLayout::Node* node)
+{
+    const uint8_t type = node ? static_cast<uint8_t>(static_cast<uint8_t>(node->type) + 1) : 0;
+    hash = Fnv(hash, &type, sizeof(type));
+    if (!node) {
+        return hash;
+    }
+    hash = HashRect(hash, node->bounds);
+    switch (node->type) {
+    case DockLayout::Node::Type::Widget:
+        return HashTitle(hash, node->widget);
+    case DockLayout::Node::Type::Split: {
+        const uint8_t flags[2] = {static_cast<uint8_t>(node->vertical), static_cast<uint8_t>(node->splitSizing)};
+        const float sizing[2] = {node->ratio, node->fixedSize};
+        hash = Fnv(hash, flags, sizeof(flags));
+        hash = Fnv(hash, sizing, sizeof(sizing));
+        hash = HashNode(hash, node->first.get());
+        return HashNode(hash, node->second.get());
+    }
+    case DockLayout::Node::Type::Tab: {
+        const int32_t tabs[2] = {node->activeTab, static_cast<int32_t>(node->children.size())};
+        hash = Fnv(hash, tabs, sizeof(tabs));
+        for (const auto& child : node->children) {
+            hash = HashNode(hash, child.get());
+        }
+        return hash;
+    }
+    }
+    return hash;
+}
+
+int32_t Quantize(float value)
+{
+    const float scaled = std::round(value * kPositionScale);
+    constexpr float limit = static_cast<float>(1 << 30);
+    return static_cast<int32_t>(std::isfinite(scaled) ? std::clamp(scaled, -limit, limit) : 0.0f);
+}
+
+uint32_t ZigZag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t UnZigZag(uint32_t value)
+{
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1u);
+}
+
+bool OnGrid(float value, int32_t fixed)
+{
+    return static_cast<float>(fixed) / kPositionScale == value;
+}
+
+bool KeyEvent(Event::Type type)
+{
+    return type == Event::Type::KeyDown || type == Event::Type::KeyUp;
+}
+
+} // namespace
+
+uint64_t DockLayoutChecksum(const DockLayout& layout)
+{
+    return HashNode(14695981039346656037ull, layout.root());
+}
+
+uint64_t DockLayoutChecksum(const DockLayout& layout, const WindowManager& windows)
+{
+    uint64_t hash = DockLayoutChecksum(layout);
+    const uint32_t count = static_cast<uint32_t>(windows.windowCount());
+    hash = Fnv(hash, &count, sizeof(count));
+    for (size_t i = 0; i < windows.windowCount(); ++i) {
+        const WindowFrame* window = windows.windowAt(i);
+        hash = HashTitle(hash, window->content());
+        hash = HashRect(hash, window->bounds());
+    }
+    return hash;
+}
+
+InputRecorder::InputRecorder(uint32_t checkpointEvery)
+    : checkpointEvery_(std::max(1u, checkpointEvery))
+{
+    bytes_.append(kInputRecordingMagic, sizeof(kInputRecordingMagic));
+    DockStateWriter(bytes_).varint(kInputRecordingVersion);
+}
+
+void InputRecorder::event(const Event& event)
+{
+    DockStateWriter out(bytes_);
+    const int32_t x = Quantize(event.x);
+    const int32_t y = Quantize(event.y);
+    const bool raw = !OnGrid(event.x, x) || !OnGrid(event.y, y);
+    out.byte(static_cast<uint8_t>(InputRecord::Tag::Event));
+    out.byte(static_cast<uint8_t>(static_cast<uint8_t>(event.type) | (raw ? kRawPosition : 0u)));
+    time(event.time > 0.0 ? event.time : lastTime_);
+    if (raw) {
+        out.f32(event.x);
+        out.f32(event.y);
+    } else {
+        out.varint(ZigZag(x - lastX_));
+        out.varint(ZigZag(y - lastY_));
+    }
+    lastX_ = x;
+    lastY_ = y;
+    out.byte(static_cast<uint8_t>(event.modifiers));
+    if (KeyEvent(event.type)) {
+        out.varint(static_cast<uint32_t>(event.key));
+    }
+    ++records_;
+}
+
+void InputRecorder::resize(float width, float height, double time)
+{
+    DockStateWriter out(bytes_);
+    out.byte(static_cast<uint8_t>(InputRecord::Tag::Resize));
+    this->time(time);
+    out.f32(width);
+    out.f32(height);
+    ++records_;
+}
+
+void InputRecorder::frame(double time)
+{
+    DockStateWriter(bytes_).byte(static_cast<uint8_t>(InputRecord::Tag::Frame));
+    this->time(time);
+    ++framesSinceCheckpoint_;
+    ++records_;
+}
+
+void InputRecorder::checkpoint(uint64_t checksum)
+{
+    DockStateWriter out(bytes_);
+    out.byte(static_cast<uint8_t>(InputRecord::Tag::Checkpoint));
+    for (int i = 0; i < 8; ++i) {
+        out.byte(static_cast<uint8_t>(checksum >> (i * 8)));
+    }
+    framesSinceCheckpoint_ = 0;
+    ++records_;
+}
+
+bool InputRecorder::saveFile(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    file.write(bytes_.data(), static_cast<std::streamsize>(bytes_.size()));
+    return static_cast<bool>(file);
+}
+
+void InputRecorder::time(double seconds)
+{
+    if (!hasTime_) {
+        hasTime_ = true;
+        lastTime_ = seconds;
+    }
+    const double micros = std::round((seconds - lastTime_) * 1e6);
+    const uint32_t dt = micros <= 0.0 ? 0u
+        : static_cast<uint32_t>(std::min(micros, static_cast<double>(std::numeric_limits<uint32_t>::max())));
+    DockStateWriter(bytes_).varint(dt);
+    lastTime_ = std::max(lastTime_, seconds);
+}
+
+bool InputReplayer::load(const std::string& bytes, std::string* error)
+{
+    auto reject = [error](const char* what) {
+        if (error) {
+            *error = what;
+        }
+        return false;
+    };
+    if (bytes.size() < sizeof(kInputRecordingMagic) ||
+        std::memcmp(bytes.data(), kInputRecordingMagic, sizeof(kInputRecordingMagic)) != 0) {
+        return reject("not an input recording");
+    }
+    DockStateReader in(bytes.data() + sizeof(kInputRecordingMagic), bytes.size() - sizeof(kInputRecordingMagic));
+    uint32_t version = 0;
+    if (!in.varint(version) || version != kInputRecordingVersion) {
+        return reject("unsupported recording version");
+    }
+
+    std::vector<InputRecord> records;
+    uint64_t micros = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+    auto readTime = [&](InputRecord& record) {
+        uint32_t dt = 0;
+        if (!in.varint(dt)) {
+            return false;
+        }
+        micros += dt;
+        record.time = static_cast<double>(micros) * 1e-6;
+        return true;
+    };
+    while (in.remaining() > 0) {
+        InputRecord record;
+        record.time = static_cast<double>(micros) * 1e-6;
+        uint8_t tag = 0;
+        in.byte(tag);
+        switch (static_cast<InputRecord::Tag>(tag)) {
+        case InputRecord::Tag::Event: {
+            uint8_t type = 0;
+            if (!in.byte(type) || (type & ~kRawPosition) > static_cast<uint8_t>(Event::Type::Close) || !readTime(record)) {
+                return reject("bad event record");
+            }
+            record.event = Event(static_cast<Event::Type>(type & ~kRawPosition));
+            if (type & kRawPosition) {
+                if (!in.f32(record.event.x) || !in.f32(record.event.y)) {
+                    return reject("bad event position");
+                }
+                x = Quantize(record.event.x);
+                y = Quantize(record.event.y);
+            } else {
+                uint32_t dx = 0;
+                uint32_t dy = 0;
+                if (!in.varint(dx) || !in.varint(dy)) {
+                    return reject("truncated event position");
+                }
+                x += UnZigZag(dx);
+                y += UnZigZag(dy);
+                record.event.x = static_cast<float>(x) / kPositionScale;
+                record.event.y = static_cast<float>(y) / kPositionScale;
+            }
+            uint8_t modifiers = 0;
+            if (!in.byte(modifiers)) {
+                return reject("truncated event record");
+            }
+            record.event.modifiers = modifiers;
+            if (KeyEvent(record.event.type)) {
+                uint32_t key = 0;
+                if (!in.varint(key)) {
+                    return reject("truncated key record");
+                }
+                record.event.key = static_cast<int>(key);
+            }
+            break;
+        }
+        case InputRecord::Tag::Resize:
+            if (!readTime(record) || !in.f32(record.width) || !in.f32(record.height)) {
+                return reject("bad resize record");
+            }
+            break;
+        case InputRecord::Tag::Frame:
+            if (!readTime(record)) {
+                return reject("truncated frame record");
+            }
+            break;
+        case InputRecord::Tag::Checkpoint:
+            for (int i = 0; i < 8; ++i) {
+                uint8_t b = 0;
+                if (!in.byte(b)) {
+                    return reject("truncated checkpoint record");
+                }
+                record.checksum |= static_cast<uint64_t>(b) << (i * 8);
+            }
+            break;
+        default:
+            return reject("unknown record tag");
+        }
+        record.tag = static_cast<InputRecord::Tag>(tag);
+        records.push_back(record);
+    }
+    records_ = std::move(records);
+    return true;
+}
+
+bool InputReplayer::loadFile(const std::string& path, std::string* error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        if (error) {
+            *error = "cannot open " + path;
+        }
+        return false;
+    }
+    const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return load(bytes, error);
+}
+
+InputReplayer::Result InputReplayer::run(const Hooks& hooks, Pace pace) const
+{
+    Result result;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < records_.size(); ++i) {
+        const InputRecord& record = records_[i];
+        if (pace == Pace::RealTime && record.tag != InputRecord::Tag::Checkpoint) {
+            std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(record.time)));
+        }
+        switch (record.tag) {
+        case InputRecord::Tag::Event: {
+            const std::function<void(Event&)>& hook = KeyEvent(record.event.type) && hooks.key ? hooks.key : hooks.dispatch;
+            if (hook) {
+                Event event = record.event;
+                DFStampInput(event);
+                hook(event);
+            }
+            ++result.events;
+            break;
+        }
+        case InputRecord::Tag::Resize:
+            if (hooks.resize) {
+                hooks.resize(record.width, record.height);
+            }
+            ++result.resizes;
+            break;
+        case InputRecord::Tag::Frame:
+            if (hooks.frame) {
+                hooks.frame();
+            }
+            ++result.frames;
+            break;
+        case InputRecord::Tag::Checkpoint:
+            if (hooks.checksum) {
+                ++result.checkpoints;
+                if (hooks.checksum() != record.checksum && result.mismatches++ == 0) {
+                    result.firstMismatch = i;
+                }
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace df
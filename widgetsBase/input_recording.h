@@ -0,0 +1,122 @@
+#pragma once
+
+#include "core_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace df {
+
+class DockLayout;
+class WindowManager;
+
+// Binary input recording written by InputRecorder:
+//
+//   "DFIR" magic, version varint
+//   records until the end of the data, each a tag byte and its fields:
+//     Event:      type byte, dt varint, dx and dy zigzag varints, modifiers
+//                 byte, then a key varint for key events only. Bit 7 of the
+//                 type byte replaces dx and dy with x and y floats.
+//     Resize:     dt varint, width and height floats
+//     Frame:      dt varint
+//     Checkpoint: layout checksum, 8 bytes little-endian
+//
+// dt is microseconds since the previous timed record. Pointer positions are
+// 1/64 px fixed point, stored as the change from the previous event, so a
+// drag costs a few bytes per move; positions off that grid are stored as
+// floats instead, so replay is exact either way. Varints and floats use the
+// dock_state.h encoding. Events are recorded as they are dispatched (after
+// coalescing), and a Frame marks where the host laid out and rendered, so a
+// replay runs the same dispatch and layout sequence as the session.
+struct InputRecord {
+    enum class Tag : uint8_t { Event = 1, Resize = 2, Frame = 3, Checkpoint = 4 };
+
+    Tag tag = Tag::Frame;
+    double time = 0.0; // seconds since the first record; Checkpoint repeats the previous time
+    Event event;
+    float width = 0.0f;
+    float height = 0.0f;
+    uint64_t checksum = 0;
+};
+
+constexpr char kInputRecordingMagic[4] = {'D', 'F', 'I', 'R'};
+constexpr uint32_t kInputRecordingVersion = 1;
+
+// FNV-1a over the docked tree of layout only: node types, widget titles,
+// split sizing, active tabs and the laid-out bounds of every node, so it
+// catches both structural and geometric divergence. The second form adds the
+// floating windows of windows back to front (content title and bounds),
+// which is where floating drags diverge first.
+uint64_t DockLayoutChecksum(const DockLayout& layout);
+uint64_t DockLayoutChecksum(const DockLayout& layout, const WindowManager& windows);
+
+// Appends records to an in-memory encoding; nothing is written until
+// saveFile(). Events without a stamp take the previous record's time.
+class InputRecorder {
+public:
+    explicit InputRecorder(uint32_t checkpointEvery = 60);
+
+    void event(const Event& event);
+    void resize(float width, float height, double time);
+    void frame(double time);
+    // True once checkpointEvery frames were recorded since the last checkpoint.
+    bool checkpointDue() const { return framesSinceCheckpoint_ >= checkpointEvery_; }
+    void checkpoint(uint64_t checksum);
+
+    const std::string& bytes() const { return bytes_; }
+    size_t recordCount() const { return records_; }
+    bool saveFile(const std::string& path) const;
+
+private:
+    void time(double seconds);
+
+    std::string bytes_;
+    size_t records_ = 0;
+    uint32_t checkpointEvery_ = 60;
+    uint32_t framesSinceCheckpoint_ = 0;
+    bool hasTime_ = false;
+    double lastTime_ = 0.0;
+    int32_t lastX_ = 0;
+    int32_t lastY_ = 0;
+};
+
+// Decodes a recording up front (rejecting it whole when any record is
+// malformed) and plays it into host hooks. Replayed events are restamped on
+// dispatch, so latency tracking measures the replay itself.
+class InputReplayer {
+public:
+    enum class Pace : uint8_t { Fast, RealTime };
+
+    struct Hooks {
+        std::function<void(Event&)> dispatch;     // typically EventRouter::dispatch
+        std::function<void(Event&)> key;          // host shortcuts; key events go to dispatch when unset
+        std::function<void(float, float)> resize; // set the container size; no frame
+        std::function<void()> frame;              // lay out and render
+        std::function<uint64_t()> checksum;       // typically DockLayoutChecksum
+    };
+
+    struct Result {
+        size_t events = 0;
+        size_t resizes = 0;
+        size_t frames = 0;
+        size_t checkpoints = 0;
+        size_t mismatches = 0;
+        size_t firstMismatch = 0; // index into records(), valid when mismatches > 0
+    };
+
+    bool load(const std::string& bytes, std::string* error = nullptr);
+    bool loadFile(const std::string& path, std::string* error = nullptr);
+
+    // Fast plays back to back; RealTime sleeps to the recorded offsets.
+    Result run(const Hooks& hooks, Pace pace = Pace::Fast) const;
+
+    const std::vector<InputRecord>& records() const { return records_; }
+    double duration() const { return records_.empty() ? 0.0 : records_.back().time; }
+
+private:
+    std::vector<InputRecord> records_;
+};
+
+} // namespace df
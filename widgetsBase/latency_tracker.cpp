@@ -0,0 +1,139 @@
+#include "latency_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace df {
+
+void LatencyTracker::Histogram::add(double ms)
+{
+    size_t bucket = 0;
+    while (bucket + 1 < kBuckets && ms > kBucketMs[bucket]) {
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++count;
+    sumMs += ms;
+    maxMs = std::max(maxMs, ms);
+}
+
+void LatencyTracker::Histogram::merge(const Histogram& other)
+{
+    for (size_t i = 0; i < kBuckets; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumMs += other.sumMs;
+    maxMs = std::max(maxMs, other.maxMs);
+}
+
+double LatencyTracker::Histogram::percentileMs(double p) const
+{
+    if (count == 0) {
+        return 0.0;
+    }
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i + 1 < kBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(kBucketMs[i], maxMs);
+        }
+    }
+    return maxMs;
+}
+
+LatencyTracker::Interaction LatencyTracker::Classify(EventRouter::Handler handler)
+{
+    using Handler = EventRouter::Handler;
+    switch (handler) {
+    case Handler::Splitter:
+        return Interaction::SplitterDrag;
+    case Handler::TabGesture:
+    case Handler::DockDrag:
+        return Interaction::TabDrag;
+    case Handler::FloatingDrag:
+    case Handler::FloatingDragStart:
+    case Handler::FloatingWindow:
+        return Interaction::FloatingMove;
+    default:
+        return Interaction::Other;
+    }
+}
+
+void LatencyTracker::dispatched(const Event& event, Interaction interaction)
+{
+    if (!event.handled || event.sequence == 0 || interaction == Interaction::Count) {
+        return;
+    }
+    pending_.push_back({event.sequence, event.time, interaction});
+    dispatchedSequence_ = std::max(dispatchedSequence_, event.sequence);
+}
+
+void LatencyTracker::presented(double time)
+{
+    // Inputs dispatched while the frame was being built wait for the next one.
+    auto answered = [this](const Pending& p) { return p.sequence <= frameSequence_; };
+    for (const Pending& p : pending_) {
+        if (answered(p)) {
+            histograms_[static_cast<size_t>(p.interaction)].add(std::max(0.0, time - p.time) * 1000.0);
+        }
+    }
+    pending_.erase(std::remove_if(pending_.begin(), pending_.end(), answered), pending_.end());
+}
+
+void LatencyTracker::merge(const LatencyTracker& other)
+{
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        histograms_[i].merge(other.histograms_[i]);
+    }
+}
+
+void LatencyTracker::reset()
+{
+    pending_.clear();
+    dispatchedSequence_ = 0;
+    frameSequence_ = 0;
+    histograms_.fill({});
+}
+
+std::string LatencyTracker::json() const
+{
+    std::ostringstream out;
+    out << "{\"bucket_ms\": [";
+    for (size_t i = 0; i + 1 < Histogram::kBuckets; ++i) {
+        out << (i > 0 ? ", " : "") << Histogram::kBucketMs[i];
+    }
+    out << "]";
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        const Histogram& h = histograms_[i];
+        if (h.count == 0) {
+            continue;
+        }
+        out << ", \"" << InteractionName(static_cast<Interaction>(i)) << "\": {\"count\": " << h.count
+            << ", \"mean_ms\": " << h.meanMs() << ", \"p50_ms\": " << h.percentileMs(0.50)
+            << ", \"p95_ms\": " << h.percentileMs(0.95) << ", \"p99_ms\": " << h.percentileMs(0.99)
+            << ", \"max_ms\": " << h.maxMs << ", \"buckets\": [";
+        for (size_t b = 0; b < Histogram::kBuckets; ++b) {
+            out << (b > 0 ? ", " : "") << h.buckets[b];
+        }
+        out << "]}";
+    }
+    out << "}";
+    return out.str();
+}
+
+const char* LatencyTracker::InteractionName(Interaction interaction)
+{
+    switch (interaction) {
+    case Interaction::SplitterDrag: return "splitter_drag";
+    case Interaction::TabDrag: return "tab_drag";
+    case Interaction::FloatingMove: return "floating_move";
+    case Interaction::Other: return "other";
+    case Interaction::Count: break;
+    }
+    return "unknown";
+}
+
+} // namespace df
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "core_types.h"
+#include "event_router.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace df {
+
+// Input-to-present latency per interaction. The host reports every routed
+// event with dispatched(), calls beginFrame() before building a frame and
+// presented() once that frame is on screen (or was skipped as identical).
+// The frame answers every input sequence dispatched before it began; each of
+// those inputs adds present time minus Event::time to its interaction's
+// histogram. Unstamped (synthetic) and unhandled events are not tracked.
+class LatencyTracker {
+public:
+    enum class Interaction : uint8_t { SplitterDrag, TabDrag, FloatingMove, Other, Count };
+
+    struct Histogram {
+        // Upper bucket edges in ms; the last bucket takes everything slower.
+        static constexpr double kBucketMs[] = {0.1, 0.25, 0.5, 1, 2, 4, 8, 12, 16, 20, 25, 33, 50, 66, 100, 200};
+        static constexpr size_t kBuckets = sizeof(kBucketMs) / sizeof(kBucketMs[0]) + 1;
+
+        std::array<uint64_t, kBuckets> buckets{};
+        uint64_t count = 0;
+        double sumMs = 0.0;
+        double maxMs = 0.0;
+
+        void add(double ms);
+        void merge(const Histogram& other);
+        double meanMs() const { return count > 0 ? sumMs / static_cast<double>(count) : 0.0; }
+        // Upper edge of the bucket holding fraction p, capped at maxMs.
+        double percentileMs(double p) const;
+    };
+
+    static Interaction Classify(EventRouter::Handler handler);
+
+    void dispatched(const Event& event, Interaction interaction);
+    void beginFrame() { frameSequence_ = dispatchedSequence_; }
+    void presented(double time);
+
+    // Newest input sequence the frame in flight answers.
+    uint64_t frameSequence() const { return frameSequence_; }
+    size_t pending() const { return pending_.size(); }
+    const Histogram& histogram(Interaction interaction) const { return histograms_[static_cast<size_t>(interaction)]; }
+    void merge(const LatencyTracker& other);
+    void reset();
+
+    // {"bucket_ms": [...], "splitter_drag": {"count": .., "mean_ms": .., ...}, ...}
+    // on one line, listing interactions that recorded anything.
+    std::string json() const;
+    static const char* InteractionName(Interaction interaction);
+
+private:
+    struct Pending {
+        uint64_t sequence = 0;
+        double time = 0.0;
+        Interaction interaction = Interaction::Other;
+    };
+
+    std::vector<Pending> pending_;
+    uint64_t dispatchedSequence_ = 0;
+    uint64_t frameSequence_ = 0;
+    std::array<Histogram, static_cast<size_t>(Interaction::Count)> histograms_{};
+};
+
+} // namespace df
@@ -63,7 +63,11 @@ termios Keyboard::orig_{};
 // Console renderer using the base Canvas
 class ConsoleCanvas : public Canvas {
 public:
-    void drawRectangle(const DFRect& rect, const DFColor& DFColor) override {
+    void drawRectangle(const DFRect& source, const DFColor& DFColor) override {
+        DFRect rect = source;
+        if (!cullRect(rect)) {
+            return;
+        }
         // Very lightweight: just log DFRect and dominant DFColor
         char c = ' ';
         if (DFColor.r > DFColor.g && DFColor.r > DFColor.b) c = 'R';
@@ -0,0 +1,812 @@
+#include "software_canvas.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DF_SOFTWARE_CANVAS_AVX2 1
+#define DF_SOFTWARE_CANVAS_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DF_SOFTWARE_CANVAS_SSE2 1
+#endif
+
+namespace {
+
+uint32_t ToByte(float v)
+{
+    return static_cast<uint32_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+// Premultiplies the packed color, so a draw and its display-list replay
+// (which records packed colors) produce the same bytes.
+uint32_t PackPremultiplied(const DFColor& c)
+{
+    const uint32_t packed = DFPackColor(c).rgba;
+    const uint32_t a = packed >> 24;
+    auto scale = [a](uint32_t channel) { return (channel * a + 127u) / 255u; };
+    return scale(packed & 0xFFu) | (scale((packed >> 8) & 0xFFu) << 8) | (scale((packed >> 16) & 0xFFu) << 16) | (a << 24);
+}
+
+// Multiplies every channel by scale/255 (two channels per 32-bit lane).
+uint32_t ScaleChannels(uint32_t c, uint32_t scale)
+{
+    uint32_t rb = (c & 0x00FF00FFu) * scale + 0x00800080u;
+    uint32_t ag = ((c >> 8) & 0x00FF00FFu) * scale + 0x00800080u;
+    rb = ((rb + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    ag = ((ag + ((ag >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    return rb | (ag << 8);
+}
+
+// Premultiplied "over": dst = src + dst * (1 - srcA).
+uint32_t BlendOver(uint32_t dst, uint32_t src)
+{
+    const uint32_t inv = 255u - (src >> 24);
+    return src + ScaleChannels(dst, inv);
+}
+
+void StorePixel(uint32_t& dst, uint32_t src, uint32_t coverage)
+{
+    if (coverage >= 255u) {
+        dst = (src >> 24) == 255u ? src : BlendOver(dst, src);
+        return;
+    }
+    dst = BlendOver(dst, ScaleChannels(src, coverage));
+}
+
+uint32_t CoverageByte(float signedDistance)
+{
+    return ToByte(0.5f - signedDistance);
+}
+
+#if defined(DF_SOFTWARE_CANVAS_SSE2)
+inline __m128i BlendOver4(__m128i dst, __m128i src16, __m128i inv16, __m128i bias)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), inv16), bias);
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), inv16), bias);
+    lo = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8), src16);
+    hi = _mm_add_epi16(_mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8), src16);
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+#if defined(DF_SOFTWARE_CANVAS_AVX2)
+inline __m256i BlendOver8(__m256i dst, __m256i src16, __m256i inv16, __m256i bias)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), inv16), bias);
+    __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), inv16), bias);
+    lo = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(lo, _mm256_srli_epi16(lo, 8)), 8), src16);
+    hi = _mm256_add_epi16(_mm256_srli_epi16(_mm256_add_epi16(hi, _mm256_srli_epi16(hi, 8)), 8), src16);
+    return _mm256_packus_epi16(lo, hi);
+}
+#endif
+
+// Fully covered run of pixels: plain store for opaque colors, "over" otherwise.
+void FillSpan(uint32_t* dst, int count, uint32_t src)
+{
+    const uint32_t alpha = src >> 24;
+    if (count <= 0 || alpha == 0u) {
+        return;
+    }
+    int i = 0;
+    if (alpha == 255u) {
+#if defined(DF_SOFTWARE_CANVAS_AVX2)
+        const __m256i v8 = _mm256_set1_epi32(static_cast<int>(src));
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v8);
+        }
+#endif
+#if defined(DF_SOFTWARE_CANVAS_SSE2)
+        const __m128i v4 = _mm_set1_epi32(static_cast<int>(src));
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v4);
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = src;
+        }
+        return;
+    }
+
+    const uint32_t inv = 255u - alpha;
+#if defined(DF_SOFTWARE_CANVAS_AVX2)
+    {
+        const __m256i src16 = _mm256_unpacklo_epi8(_mm256_set1_epi32(static_cast<int>(src)), _mm256_setzero_si256());
+        const __m256i inv16 = _mm256_set1_epi16(static_cast<short>(inv));
+        const __m256i bias = _mm256_set1_epi16(128);
+        for (; i + 8 <= count; i += 8) {
+            __m256i* p = reinterpret_cast<__m256i*>(dst + i);
+            _mm256_storeu_si256(p, BlendOver8(_mm256_loadu_si256(p), src16, inv16, bias));
+        }
+    }
+#endif
+#if defined(DF_SOFTWARE_CANVAS_SSE2)
+    {
+        const __m128i src16 = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(src)), _mm_setzero_si128());
+        const __m128i inv16 = _mm_set1_epi16(static_cast<short>(inv));
+        const __m128i bias = _mm_set1_epi16(128);
+        for (; i + 4 <= count; i += 4) {
+            __m128i* p = reinterpret_cast<__m128i*>(dst + i);
+            _mm_storeu_si128(p, BlendOver4(_mm_loadu_si128(p), src16, inv16, bias));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = BlendOver(dst[i], src);
+    }
+}
+
+// Rounded box in center/half-extent form; radius 0 is a plain rectangle.
+struct RoundBox {
+    float cx = 0.0f;
+    float cy = 0.0f;
+    float bx = 0.0f; // half extent minus radius
+    float by = 0.0f;
+    float r = 0.0f;
+
+    static RoundBox fromRect(float x, float y, float w, float h, float radius)
+    {
+        RoundBox box;
+        const float hw = w * 0.5f;
+        const float hh = h * 0.5f;
+        box.r = std::clamp(radius, 0.0f, std::min(hw, hh));
+        box.cx = x + hw;
+        box.cy = y + hh;
+        box.bx = hw - box.r;
+        box.by = hh - box.r;
+        return box;
+    }
+
+    float distance(float px, float qy) const
+    {
+        const float qx = std::fabs(px - cx) - bx;
+        const float ox = std::max(qx, 0.0f);
+        const float oy = std::max(qy, 0.0f);
+        return std::sqrt(ox * ox + oy * oy) + std::min(std::max(qx, qy), 0.0f) - r;
+    }
+
+    float rowQ(float py) const { return std::fabs(py - cy) - by; }
+
+    // Columns whose pixel centers have distance <= -0.5 (coverage 1) on this row.
+    bool fullColumns(float qy, int& first, int& last) const
+    {
+        const float e = r - 0.5f;
+        if (qy > e) {
+            return false;
+        }
+        float reach = e;
+        if (qy > 0.0f) {
+            reach = std::sqrt(std::max(0.0f, e * e - qy * qy));
+        }
+        const float half = bx + reach;
+        if (half < 0.0f) {
+            return false;
+        }
+        first = static_cast<int>(std::ceil(cx - half - 0.5f));
+        last = static_cast<int>(std::floor(cx + half - 0.5f));
+        return first <= last;
+    }
+};
+
+// Solves lo <= k * x + c <= hi for x; returns false when empty.
+bool SolveLinear(float k, float c, float lo, float hi, float& xMin, float& xMax)
+{
+    if (std::fabs(k) < 1e-6f) {
+        if (c < lo || c > hi) {
+            return false;
+        }
+        xMin = -1e30f;
+        xMax = 1e30f;
+        return true;
+    }
+    const float a = (lo - c) / k;
+    const float b = (hi - c) / k;
+    xMin = std::min(a, b);
+    xMax = std::max(a, b);
+    return true;
+}
+
+} // namespace
+
+SoftwareCanvas::SoftwareCanvas(int width, int height)
+{
+    resize(width, height);
+}
+
+void SoftwareCanvas::resize(int width, int height)
+{
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    pixels_.assign(static_cast<size_t>(width_) * static_cast<size_t>(height_), 0u);
+    queue_.clear();
+    text_.clear();
+    edges_.clear();
+    if (hasClip_) {
+        setClipRect(clipRect_);
+    } else {
+        clearClipRect();
+    }
+}
+
+void SoftwareCanvas::setClipRect(const DFRect& rect)
+{
+    Canvas::setClipRect(rect);
+    clipMinX_ = std::clamp(static_cast<int>(std::floor(rect.x)), 0, width_);
+    clipMinY_ = std::clamp(static_cast<int>(std::floor(rect.y)), 0, height_);
+    clipMaxX_ = std::clamp(static_cast<int>(std::ceil(rect.x + rect.width)), clipMinX_, width_);
+    clipMaxY_ = std::clamp(static_cast<int>(std::ceil(rect.y + rect.height)), clipMinY_, height_);
+}
+
+void SoftwareCanvas::clearClipRect()
+{
+    Canvas::clearClipRect();
+    clipMinX_ = 0;
+    clipMinY_ = 0;
+    clipMaxX_ = width_;
+    clipMaxY_ = height_;
+}
+
+void SoftwareCanvas::clear(const DFColor& color)
+{
+    const uint32_t packed = PackPremultiplied(color);
+    if (hasClip_) {
+        // Queued primitives outside the clip must still land, and in order.
+        flush();
+        for (int y = clipMinY_; y < clipMaxY_; ++y) {
+            std::fill(row(y) + clipMinX_, row(y) + clipMaxX_, packed);
+        }
+        return;
+    }
+    queue_.clear();
+    text_.clear();
+    edges_.clear();
+    if ((packed >> 24) == 255u) {
+        FillSpan(pixels_.data(), static_cast<int>(pixels_.size()), packed);
+    } else {
+        std::fill(pixels_.begin(), pixels_.end(), packed);
+    }
+}
+
+void SoftwareCanvas::setTileParallel(int threads, int bandHeight)
+{
+    flush();
+    tileThreads_ = std::max(1, threads);
+    bandHeight_ = std::max(8, bandHeight);
+}
+
+uint32_t SoftwareCanvas::pixel(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return 0u;
+    }
+    return pixels_[static_cast<size_t>(y) * static_cast<size_t>(width_) + static_cast<size_t>(x)];
+}
+
+void SoftwareCanvas::drawRectangle(const DFRect& rect, const DFColor& color)
+{
+    DFRect clipped = rect;
+    if (!cullRect(clipped)) {
+        return;
+    }
+    drawRoundedRectangle(clipped, 0.0f, color);
+}
+
+void SoftwareCanvas::drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color)
+{
+    if (rect.width <= 0.0f || rect.height <= 0.0f || isClippedOut(rect)) {
+        return;
+    }
+    Primitive prim;
+    prim.kind = Primitive::Kind::RoundRect;
+    prim.color = PackPremultiplied(color);
+    prim.x0 = rect.x;
+    prim.y0 = rect.y;
+    prim.x1 = rect.width;
+    prim.y1 = rect.height;
+    prim.radius = radius;
+    prim.minY = static_cast<int>(std::floor(rect.y));
+    prim.maxY = static_cast<int>(std::ceil(rect.y + rect.height));
+    submit(prim);
+}
+
+void SoftwareCanvas::drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness)
+{
+    if (rect.width <= 0.0f || rect.height <= 0.0f || thickness <= 0.0f || isClippedOut(rect)) {
+        return;
+    }
+    // The stroke sits inside the rect, like the base Canvas fallback.
+    const float t = std::max(0.5f, thickness);
+    if (t * 2.0f >= std::min(rect.width, rect.height)) {
+        drawRoundedRectangle(rect, radius, color);
+        return;
+    }
+    Primitive prim;
+    prim.kind = Primitive::Kind::RoundRectOutline;
+    prim.color = PackPremultiplied(color);
+    prim.x0 = rect.x;
+    prim.y0 = rect.y;
+    prim.x1 = rect.width;
+    prim.y1 = rect.height;
+    prim.radius = radius;
+    prim.thickness = t;
+    prim.minY = static_cast<int>(std::floor(rect.y));
+    prim.maxY = static_cast<int>(std::ceil(rect.y + rect.height));
+    submit(prim);
+}
+
+void SoftwareCanvas::drawLine(const DFPoint& from, const DFPoint& to, const DFColor& color, float thickness)
+{
+    DFPoint a = from;
+    DFPoint b = to;
+    if (!cullLine(a, b, thickness)) {
+        return;
+    }
+    const float dx = b.x - a.x;
+    const float dy = b.y - a.y;
+    if (std::sqrt(dx * dx + dy * dy) < 0.0001f) {
+        const float t = std::max(1.0f, thickness);
+        drawRectangle({a.x - t * 0.5f, a.y - t * 0.5f, t, t}, color);
+        return;
+    }
+    Primitive prim;
+    prim.kind = Primitive::Kind::Line;
+    prim.color = PackPremultiplied(color);
+    prim.x0 = a.x;
+    prim.y0 = a.y;
+    prim.x1 = b.x;
+    prim.y1 = b.y;
+    prim.thickness = std::max(0.5f, thickness * 0.5f);
+    const float pad = prim.thickness + 1.0f;
+    prim.minY = static_cast<int>(std::floor(std::min(a.y, b.y) - pad));
+    prim.maxY = static_cast<int>(std::ceil(std::max(a.y, b.y) + pad));
+    submit(prim);
+}
+
+void SoftwareCanvas::drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul, bool /*smooth*/)
+{
+    if (text.empty() || isClippedOut({x, y, DFGlyphAdvancePx(scaleMul) * static_cast<float>(text.size()), DFGlyphHeightPx(scaleMul)})) {
+        return;
+    }
+    Primitive prim;
+    prim.kind = Primitive::Kind::GlyphRun;
+    prim.color = PackPremultiplied(color);
+    prim.x0 = x;
+    prim.y0 = y;
+    prim.x1 = DFGlyphAdvancePx(scaleMul);
+    prim.y1 = DFTextPixelScale() * std::clamp(scaleMul, 0.2f, 4.0f);
+    prim.textOffset = static_cast<uint32_t>(text_.size());
+    prim.textLength = static_cast<uint32_t>(text.size());
+    prim.minY = static_cast<int>(std::floor(y));
+    prim.maxY = static_cast<int>(std::ceil(y + prim.y1 * DFGlyphAtlas::kGlyphHeight));
+    text_.insert(text_.end(), text.begin(), text.end());
+    submit(prim);
+}
+
+void SoftwareCanvas::drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color)
+{
+    const DFRect bounds = DFPointsBounds(points, count);
+    if (count < 3 || bounds.width <= 0.0f || bounds.height <= 0.0f || isClippedOut(bounds)) {
+        return;
+    }
+    float area = 0.0f;
+    float cx = 0.0f;
+    float cy = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        const DFPoint& a = points[i];
+        const DFPoint& b = points[(i + 1) % count];
+        area += a.x * b.y - b.x * a.y;
+        cx += a.x;
+        cy += a.y;
+    }
+    if (std::fabs(area) < 1e-4f) {
+        return;
+    }
+    cx /= static_cast<float>(count);
+    cy /= static_cast<float>(count);
+
+    // Normals are flipped to point away from the vertex centroid, which is
+    // inside a convex polygon, so either winding works.
+    const size_t first = edges_.size();
+    for (size_t i = 0; i < count; ++i) {
+        const DFPoint& a = points[i];
+        const DFPoint& b = points[(i + 1) % count];
+        const float dx = b.x - a.x;
+        const float dy = b.y - a.y;
+        const float len = std::sqrt(dx * dx + dy * dy);
+        if (len < 0.0001f) {
+            continue;
+        }
+        Edge edge{dy / len, -dx / len, 0.0f};
+        edge.c = -(edge.nx * a.x + edge.ny * a.y);
+        if (edge.nx * cx + edge.ny * cy + edge.c > 0.0f) {
+            edge = {-edge.nx, -edge.ny, -edge.c};
+        }
+        edges_.push_back(edge);
+    }
+
+    Primitive prim;
+    prim.kind = Primitive::Kind::ConvexPolygon;
+    prim.color = PackPremultiplied(color);
+    prim.x0 = bounds.x;
+    prim.y0 = bounds.y;
+    prim.x1 = bounds.x + bounds.width;
+    prim.y1 = bounds.y + bounds.height;
+    prim.textOffset = static_cast<uint32_t>(first);
+    prim.textLength = static_cast<uint32_t>(edges_.size() - first);
+    prim.minY = static_cast<int>(std::floor(prim.y0));
+    prim.maxY = static_cast<int>(std::ceil(prim.y1));
+    submit(prim);
+}
+
+void SoftwareCanvas::submit(const Primitive& source)
+{
+    Primitive prim = source;
+    prim.minY = std::max(prim.minY, clipMinY_);
+    prim.maxY = std::min(prim.maxY, clipMaxY_);
+    prim.clipMinX = clipMinX_;
+    prim.clipMaxX = clipMaxX_;
+    if ((prim.color >> 24) != 0u && prim.maxY > prim.minY && prim.clipMaxX > prim.clipMinX) {
+        ++primitiveCount_;
+        if (tileThreads_ > 1) {
+            queue_.push_back(prim);
+            return;
+        }
+        pixelsShaded_ += rasterize(prim, 0, height_);
+    }
+    if (queue_.empty()) {
+        text_.clear();
+        edges_.clear();
+    }
+}
+
+void SoftwareCanvas::flush()
+{
+    if (queue_.empty()) {
+        return;
+    }
+    const int bands = (height_ + bandHeight_ - 1) / bandHeight_;
+    const int workers = std::max(1, std::min(tileThreads_, bands));
+    std::atomic<int> nextBand{0};
+    std::vector<uint64_t> shaded(static_cast<size_t>(workers), 0);
+
+    // Bands are disjoint row ranges, so workers never touch the same pixels and
+    // each band still sees primitives in submission order.
+    auto work = [&](int worker) {
+        for (;;) {
+            const int band = nextBand.fetch_add(1, std::memory_order_relaxed);
+            if (band >= bands) {
+                return;
+            }
+            const int y0 = band * bandHeight_;
+            const int y1 = std::min(height_, y0 + bandHeight_);
+            for (const Primitive& prim : queue_) {
+                if (prim.maxY > y0 && prim.minY < y1) {
+                    shaded[static_cast<size_t>(worker)] += rasterize(prim, y0, y1);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(workers - 1));
+    for (int i = 1; i < workers; ++i) {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (uint64_t count : shaded) {
+        pixelsShaded_ += count;
+    }
+    queue_.clear();
+    text_.clear();
+    edges_.clear();
+}
+
+uint64_t SoftwareCanvas::rasterize(const Primitive& prim, int bandMinY, int bandMaxY)
+{
+    const int rowBegin = std::max({0, bandMinY, prim.minY});
+    const int rowEnd = std::min({height_, bandMaxY, prim.maxY});
+    if (rowBegin >= rowEnd || width_ <= 0) {
+        return 0;
+    }
+    switch (prim.kind) {
+    case Primitive::Kind::RoundRect:
+        return rasterizeRoundRect(prim, rowBegin, rowEnd);
+    case Primitive::Kind::RoundRectOutline:
+        return rasterizeOutline(prim, rowBegin, rowEnd);
+    case Primitive::Kind::Line:
+        return rasterizeLine(prim, rowBegin, rowEnd);
+    case Primitive::Kind::GlyphRun:
+        return rasterizeGlyphRun(prim, rowBegin, rowEnd);
+    case Primitive::Kind::ConvexPolygon:
+        return rasterizePolygon(prim, rowBegin, rowEnd);
+    }
+    return 0;
+}
+
+uint64_t SoftwareCanvas::rasterizeRoundRect(const Primitive& prim, int rowBegin, int rowEnd)
+{
+    const RoundBox box = RoundBox::fromRect(prim.x0, prim.y0, prim.x1, prim.y1, prim.radius);
+    const int colBegin = std::max(prim.clipMinX, static_cast<int>(std::floor(prim.x0)));
+    const int colEnd = std::min(prim.clipMaxX, static_cast<int>(std::ceil(prim.x0 + prim.x1)));
+    if (colBegin >= colEnd) {
+        return 0;
+    }
+
+    uint64_t shaded = 0;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        uint32_t* dst = row(y);
+        const float qy = box.rowQ(static_cast<float>(y) + 0.5f);
+        int fullFirst = colEnd;
+        int fullLast = colEnd - 1;
+        if (box.fullColumns(qy, fullFirst, fullLast)) {
+            fullFirst = std::clamp(fullFirst, colBegin, colEnd);
+            fullLast = std::clamp(fullLast, colBegin - 1, colEnd - 1);
+        } else {
+            fullFirst = colEnd;
+            fullLast = colEnd - 1;
+        }
+        for (int x = colBegin; x < colEnd; ++x) {
+            if (x == fullFirst && fullLast >= fullFirst) {
+                FillSpan(dst + x, fullLast - fullFirst + 1, prim.color);
+                shaded += static_cast<uint64_t>(fullLast - fullFirst + 1);
+                x = fullLast;
+                continue;
+            }
+            const uint32_t coverage = CoverageByte(box.distance(static_cast<float>(x) + 0.5f, qy));
+            if (coverage != 0u) {
+                StorePixel(dst[x], prim.color, coverage);
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
+
+uint64_t SoftwareCanvas::rasterizeOutline(const Primitive& prim, int rowBegin, int rowEnd)
+{
+    const float t = prim.thickness;
+    const RoundBox outer = RoundBox::fromRect(prim.x0, prim.y0, prim.x1, prim.y1, prim.radius);
+    const RoundBox inner = RoundBox::fromRect(
+        prim.x0 + t, prim.y0 + t, prim.x1 - t * 2.0f, prim.y1 - t * 2.0f, std::max(0.0f, outer.r - t));
+    const int colBegin = std::max(prim.clipMinX, static_cast<int>(std::floor(prim.x0)));
+    const int colEnd = std::min(prim.clipMaxX, static_cast<int>(std::ceil(prim.x0 + prim.x1)));
+    if (colBegin >= colEnd) {
+        return 0;
+    }
+
+    uint64_t shaded = 0;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        uint32_t* dst = row(y);
+        const float py = static_cast<float>(y) + 0.5f;
+        const float qyOuter = outer.rowQ(py);
+        const float qyInner = inner.rowQ(py);
+        // The inner fully covered run has zero ring coverage; skip it wholesale.
+        int holeFirst = colEnd;
+        int holeLast = colEnd - 1;
+        if (!inner.fullColumns(qyInner, holeFirst, holeLast)) {
+            holeFirst = colEnd;
+            holeLast = colEnd - 1;
+        }
+        for (int x = colBegin; x < colEnd; ++x) {
+            if (x >= holeFirst && x <= holeLast) {
+                x = holeLast;
+                continue;
+            }
+            const float px = static_cast<float>(x) + 0.5f;
+            const float covOuter = std::clamp(0.5f - outer.distance(px, qyOuter), 0.0f, 1.0f);
+            const float covInner = std::clamp(0.5f - inner.distance(px, qyInner), 0.0f, 1.0f);
+            const uint32_t coverage = ToByte(covOuter - covInner);
+            if (coverage != 0u) {
+                StorePixel(dst[x], prim.color, coverage);
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
+
+uint64_t SoftwareCanvas::rasterizeLine(const Primitive& prim, int rowBegin, int rowEnd)
+{
+    // Butt-capped thick segment as an oriented box: u runs along the segment,
+    // v across it. Per row both are linear in x, so candidate and fully covered
+    // runs come from solving interval constraints instead of testing each pixel.
+    const float ax = prim.x0;
+    const float ay = prim.y0;
+    const float dx = prim.x1 - ax;
+    const float dy = prim.y1 - ay;
+    const float len = std::sqrt(dx * dx + dy * dy);
+    const float ux = dx / len;
+    const float uy = dy / len;
+    const float half = prim.thickness;
+    const float halfLen = len * 0.5f;
+
+    uint64_t shaded = 0;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const float py = static_cast<float>(y) + 0.5f;
+        // u(x) = ux * x + uc, v(x) = -uy * x + vc
+        const float uc = -ax * ux + (py - ay) * uy;
+        const float vc = ax * uy + (py - ay) * ux;
+
+        float uMin = 0.0f, uMax = 0.0f, vMin = 0.0f, vMax = 0.0f;
+        if (!SolveLinear(ux, uc, -0.5f, len + 0.5f, uMin, uMax)
+            || !SolveLinear(-uy, vc, -half - 0.5f, half + 0.5f, vMin, vMax)) {
+            continue;
+        }
+        const float spanMin = std::max(uMin, vMin);
+        const float spanMax = std::min(uMax, vMax);
+        const int colBegin = std::max(prim.clipMinX, static_cast<int>(std::ceil(spanMin - 0.5f)));
+        const int colEnd = std::min(prim.clipMaxX, static_cast<int>(std::floor(spanMax - 0.5f)) + 1);
+        if (colBegin >= colEnd) {
+            continue;
+        }
+
+        int fullFirst = colEnd;
+        int fullLast = colEnd - 1;
+        if (SolveLinear(ux, uc, 0.5f, len - 0.5f, uMin, uMax)
+            && SolveLinear(-uy, vc, -half + 0.5f, half - 0.5f, vMin, vMax)) {
+            fullFirst = std::max(colBegin, static_cast<int>(std::ceil(std::max(uMin, vMin) - 0.5f)));
+            fullLast = std::min(colEnd - 1, static_cast<int>(std::floor(std::min(uMax, vMax) - 0.5f)));
+        }
+
+        uint32_t* dst = row(y);
+        for (int x = colBegin; x < colEnd; ++x) {
+            if (x == fullFirst && fullLast >= fullFirst) {
+                FillSpan(dst + x, fullLast - fullFirst + 1, prim.color);
+                shaded += static_cast<uint64_t>(fullLast - fullFirst + 1);
+                x = fullLast;
+                continue;
+            }
+            const float px = static_cast<float>(x) + 0.5f;
+            const float u = ux * px + uc;
+            const float v = -uy * px + vc;
+            const float d = std::max(std::fabs(u - halfLen) - halfLen, std::fabs(v) - half);
+            const uint32_t coverage = CoverageByte(d);
+            if (coverage != 0u) {
+                StorePixel(dst[x], prim.color, coverage);
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
+
+uint64_t SoftwareCanvas::rasterizeGlyphRun(const Primitive& prim, int rowBegin, int rowEnd)
+{
+    // Each destination pixel takes the exact area it shares with lit glyph
+    // cells, which box-filters the non-integer cell size (1.8px by default).
+    constexpr int kCols = DFGlyphAtlas::kGlyphWidth;
+    constexpr int kRows = DFGlyphAtlas::kGlyphHeight;
+    const DFGlyphAtlas& atlas = DFGlyphAtlas::instance();
+    const float cell = prim.y1;
+    const float advance = prim.x1;
+    const char* text = text_.data() + prim.textOffset;
+
+    auto overlap = [](float a0, float a1, float b0, float b1) {
+        return std::max(0.0f, std::min(a1, b1) - std::max(a0, b0));
+    };
+
+    uint64_t shaded = 0;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        float rowWeight[kRows];
+        bool rowHit = false;
+        for (int r = 0; r < kRows; ++r) {
+            const float top = prim.y0 + static_cast<float>(r) * cell;
+            rowWeight[r] = overlap(top, top + cell, static_cast<float>(y), static_cast<float>(y + 1));
+            rowHit = rowHit || rowWeight[r] > 0.0f;
+        }
+        if (!rowHit) {
+            continue;
+        }
+        uint32_t* dst = row(y);
+        for (uint32_t i = 0; i < prim.textLength; ++i) {
+            const int glyph = DFGlyphAtlas::glyphIndex(text[i]);
+            if (atlas.rectCount(glyph) == 0) {
+                continue;
+            }
+            const uint8_t* mask = atlas.mask(glyph);
+            const float gx = prim.x0 + static_cast<float>(i) * advance;
+            const int colBegin = std::max(prim.clipMinX, static_cast<int>(std::floor(gx)));
+            const int colEnd = std::min(prim.clipMaxX, static_cast<int>(std::ceil(gx + cell * kCols)));
+            for (int x = colBegin; x < colEnd; ++x) {
+                float coverage = 0.0f;
+                for (int c = 0; c < kCols; ++c) {
+                    const float left = gx + static_cast<float>(c) * cell;
+                    const float colWeight = overlap(left, left + cell, static_cast<float>(x), static_cast<float>(x + 1));
+                    if (colWeight <= 0.0f) {
+                        continue;
+                    }
+                    for (int r = 0; r < kRows; ++r) {
+                        if (mask[r * kCols + c] != 0u) {
+                            coverage += colWeight * rowWeight[r];
+                        }
+                    }
+                }
+                const uint32_t coverageByte = ToByte(coverage);
+                if (coverageByte != 0u) {
+                    StorePixel(dst[x], prim.color, coverageByte);
+                    ++shaded;
+                }
+            }
+        }
+    }
+    return shaded;
+}
+
+uint64_t SoftwareCanvas::rasterizePolygon(const Primitive& prim, int rowBegin, int rowEnd)
+{
+    // Coverage uses the largest edge distance, which is exact along edges and
+    // slightly generous at sharp corners. Every edge distance is linear in x
+    // on a row, so the touched and fully covered runs are interval solves.
+    const Edge* edges = edges_.data() + prim.textOffset;
+    const uint32_t edgeCount = prim.textLength;
+    const int boundBegin = std::max(prim.clipMinX, static_cast<int>(std::floor(prim.x0)));
+    const int boundEnd = std::min(prim.clipMaxX, static_cast<int>(std::ceil(prim.x1)));
+
+    uint64_t shaded = 0;
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        const float py = static_cast<float>(y) + 0.5f;
+        float spanMin = -1e30f;
+        float spanMax = 1e30f;
+        float fullMin = -1e30f;
+        float fullMax = 1e30f;
+        bool touched = true;
+        bool full = true;
+        for (uint32_t i = 0; i < edgeCount && touched; ++i) {
+            const float c = edges[i].ny * py + edges[i].c;
+            float lo = 0.0f, hi = 0.0f;
+            touched = SolveLinear(edges[i].nx, c, -1e30f, 0.5f, lo, hi);
+            spanMin = std::max(spanMin, lo);
+            spanMax = std::min(spanMax, hi);
+            if (full && SolveLinear(edges[i].nx, c, -1e30f, -0.5f, lo, hi)) {
+                fullMin = std::max(fullMin, lo);
+                fullMax = std::min(fullMax, hi);
+            } else {
+                full = false;
+            }
+        }
+        if (!touched) {
+            continue;
+        }
+        const int colBegin = std::max(boundBegin, static_cast<int>(std::ceil(std::max(spanMin, -1e9f) - 0.5f)));
+        const int colEnd = std::min(boundEnd, static_cast<int>(std::floor(std::min(spanMax, 1e9f) - 0.5f)) + 1);
+        if (colBegin >= colEnd) {
+            continue;
+        }
+
+        int fullFirst = colEnd;
+        int fullLast = colEnd - 1;
+        if (full) {
+            fullFirst = std::max(colBegin, static_cast<int>(std::ceil(std::max(fullMin, -1e9f) - 0.5f)));
+            fullLast = std::min(colEnd - 1, static_cast<int>(std::floor(std::min(fullMax, 1e9f) - 0.5f)));
+        }
+
+        uint32_t* dst = row(y);
+        for (int x = colBegin; x < colEnd; ++x) {
+            if (x == fullFirst && fullLast >= fullFirst) {
+                FillSpan(dst + x, fullLast - fullFirst + 1, prim.color);
+                shaded += static_cast<uint64_t>(fullLast - fullFirst + 1);
+                x = fullLast;
+                continue;
+            }
+            const float px = static_cast<float>(x) + 0.5f;
+            float d = -1e30f;
+            for (uint32_t i = 0; i < edgeCount; ++i) {
+                d = std::max(d, edges[i].nx * px + edges[i].ny * py + edges[i].c);
+            }
+            const uint32_t coverage = CoverageByte(d);
+            if (coverage != 0u) {
+                StorePixel(dst[x], prim.color, coverage);
+                ++shaded;
+            }
+        }
+    }
+    return shaded;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "core_types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU rasterizer backend. Renders into an RGBA8 framebuffer (R in the low byte,
+// matching DXGI_FORMAT_R8G8B8A8_UNORM) with premultiplied-alpha "over" blending.
+// Edges use analytic signed-distance coverage, so rounded corners and thick lines
+// are antialiased without supersampling. In tile-parallel mode primitives are
+// queued and rasterized per horizontal band on worker threads at flush().
+class SoftwareCanvas : public Canvas {
+public:
+    SoftwareCanvas(int width, int height);
+    ~SoftwareCanvas() override = default;
+
+    void drawRectangle(const DFRect& rect, const DFColor& color) override;
+    void drawRoundedRectangle(const DFRect& rect, float radius, const DFColor& color) override;
+    void drawRoundedRectangleOutline(const DFRect& rect, float radius, const DFColor& color, float thickness = 1.0f) override;
+    void drawLine(const DFPoint& a, const DFPoint& b, const DFColor& color, float thickness = 1.0f) override;
+    // Antialiased like the other edges; one primitive however tall it is.
+    void drawConvexPolygon(const DFPoint* points, size_t count, const DFColor& color) override;
+    void drawText(float x, float y, const std::string& text, const DFColor& color) override
+    {
+        Canvas::drawText(x, y, text, color);
+    }
+    // Area-coverage blit of the glyph atlas masks; smooth is implied.
+    void drawGlyphRun(float x, float y, std::string_view text, const DFColor& color, float scaleMul = 1.0f, bool smooth = false) override;
+    // Pixel-exact scissor: a pixel is written only if its column and row lie in
+    // the clip rect snapped outward to whole pixels.
+    void setClipRect(const DFRect& rect) override;
+    void clearClipRect() override;
+
+    void resize(int width, int height);
+    // Fills the clip rect when one is set, otherwise the whole framebuffer.
+    void clear(const DFColor& color = {0.0f, 0.0f, 0.0f, 1.0f});
+    void flush();
+
+    // threads <= 1 rasterizes immediately on the calling thread.
+    void setTileParallel(int threads, int bandHeight = 64);
+    int tileThreads() const { return tileThreads_; }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    const uint32_t* pixels() const { return pixels_.data(); }
+    uint32_t pixel(int x, int y) const;
+
+    // Pixels written by primitives since the last resetStats() (clears excluded).
+    uint64_t pixelsShaded() const { return pixelsShaded_; }
+    uint64_t primitiveCount() const { return primitiveCount_; }
+    void resetStats() { pixelsShaded_ = 0; primitiveCount_ = 0; }
+
+private:
+    struct Primitive {
+        enum class Kind : uint8_t { RoundRect, RoundRectOutline, Line, GlyphRun, ConvexPolygon };
+        Kind kind = Kind::RoundRect;
+        uint32_t color = 0;   // premultiplied RGBA8
+        float x0 = 0.0f;      // rect: x, y, w, h   line: ax, ay, bx, by   glyphs: x, y, advance, cell
+                              // polygon: bounds left, top, right, bottom; edges at textOffset/textLength
+        float y0 = 0.0f;
+        float x1 = 0.0f;
+        float y1 = 0.0f;
+        float radius = 0.0f;
+        float thickness = 0.0f;
+        uint32_t textOffset = 0;
+        uint32_t textLength = 0;
+        int minY = 0;         // conservative pixel row bounds, clipped
+        int maxY = 0;
+        int clipMinX = 0;     // writable columns [clipMinX, clipMaxX)
+        int clipMaxX = 0;
+    };
+
+    // Polygon edges as outward unit normals: distance = nx * x + ny * y + c.
+    struct Edge {
+        float nx = 0.0f;
+        float ny = 0.0f;
+        float c = 0.0f;
+    };
+
+    void submit(const Primitive& prim);
+    uint64_t rasterize(const Primitive& prim, int bandMinY, int bandMaxY);
+    uint64_t rasterizeRoundRect(const Primitive& prim, int rowBegin, int rowEnd);
+    uint64_t rasterizeOutline(const Primitive& prim, int rowBegin, int rowEnd);
+    uint64_t rasterizeLine(const Primitive& prim, int rowBegin, int rowEnd);
+    uint64_t rasterizeGlyphRun(const Primitive& prim, int rowBegin, int rowEnd);
+    uint64_t rasterizePolygon(const Primitive& prim, int rowBegin, int rowEnd);
+    uint32_t* row(int y) { return pixels_.data() + static_cast<size_t>(y) * static_cast<size_t>(width_); }
+
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<uint32_t> pixels_;
+    std::vector<Primitive> queue_;
+    std::vector<char> text_;
+    std::vector<Edge> edges_;
+    int clipMinX_ = 0;
+    int clipMinY_ = 0;
+    int clipMaxX_ = 0;
+    int clipMaxY_ = 0;
+    int tileThreads_ = 1;
+    int bandHeight_ = 64;
+    uint64_t pixelsShaded_ = 0;
+    uint64_t primitiveCount_ = 0;
+};
@@ -0,0 +1,735 @@
+#include "software_canvas.h"
+#include "corner_tessellation.h"
+#include "counting_canvas.h"
+#include "damage_region.h"
+#include "display_list_canvas.h"
+#include "dock_framework.h"
+#include "dock_layout.h"
+#include "dock_renderer.h"
+#include "dock_splitter.h"
+#include "dock_widget_impl.h"
+#include "test_support.h"
+#include "window_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class LabelContent final : public Widget {
+public:
+    explicit LabelContent(std::string label) : label_(std::move(label)) {}
+
+    void paint(Canvas& canvas) override
+    {
+        const DFRect b = bounds();
+        canvas.drawRoundedRectangle({b.x + 8.0f, b.y + 8.0f, std::max(0.0f, b.width - 16.0f), 40.0f}, 6.0f, {0.22f, 0.24f, 0.28f, 1.0f});
+        canvas.drawText(b.x + 14.0f, b.y + 20.0f, label_, {0.9f, 0.9f, 0.9f, 1.0f});
+        canvas.drawLine({b.x, b.y + b.height}, {b.x + b.width, b.y}, {0.4f, 0.7f, 1.0f, 0.5f}, 2.0f);
+    }
+
+private:
+    std::string label_;
+};
+
+// Draws well past its bounds, like a scrolled list that does not clip itself.
+class OverflowContent final : public Widget {
+public:
+    void paint(Canvas& canvas) override
+    {
+        const DFRect b = bounds();
+        canvas.drawRectangle({b.x - 40.0f, b.y - 40.0f, b.width + 80.0f, b.height + 80.0f}, {1.0f, 0.0f, 0.0f, 1.0f});
+        for (int i = 0; i < 50; ++i) {
+            const float y = b.y + 12.0f * static_cast<float>(i);
+            canvas.drawText(b.x + 4.0f, y, "row", {1.0f, 1.0f, 1.0f, 1.0f});
+            canvas.drawLine({b.x, y}, {b.x + b.width, y}, {0.5f, 0.5f, 0.5f, 1.0f}, 1.0f);
+        }
+    }
+};
+
+class RectCountingCanvas final : public Canvas {
+public:
+    void drawRectangle(const DFRect& rect, const DFColor&) override
+    {
+        ++rects;
+        area += rect.width * rect.height;
+    }
+
+    int rects = 0;
+    float area = 0.0f;
+};
+
+float Channel(uint32_t pixel, int index)
+{
+    return static_cast<float>((pixel >> (index * 8)) & 0xFFu);
+}
+
+// The shared workspace with labelled content, painted and damage-tracked.
+struct Scene : Workspace {
+    df::DockRenderer renderer;
+    DFDamageRegion damage;
+
+    void build()
+    {
+        Workspace::build([](const char* name) { return std::make_unique<LabelContent>(name); });
+    }
+
+    void trackDamage()
+    {
+        layout.setDamageRegion(&damage);
+        splitter.setDamageRegion(&damage);
+        renderer.setDamageRegion(&damage);
+        df::WindowManager::instance().setDamageRegion(&damage);
+    }
+
+    void paint(SoftwareCanvas& canvas)
+    {
+        canvas.clear(df::CurrentTheme().dockBackground);
+        renderer.render(canvas, layout.root());
+        splitter.render(canvas);
+        df::WindowManager::instance().renderAllWindows(canvas);
+    }
+
+    void render(SoftwareCanvas& canvas)
+    {
+        paint(canvas);
+        canvas.flush();
+    }
+
+    // Repaints the accumulated damage only; anything damaged while painting
+    // is left for the next frame.
+    DFDamageRegion renderDamage(SoftwareCanvas& canvas)
+    {
+        const DFDamageRegion frame = damage;
+        damage.clear();
+        for (const DFRect& rect : frame) {
+            canvas.setClipRect(rect);
+            paint(canvas);
+        }
+        canvas.clearClipRect();
+        canvas.flush();
+        return frame;
+    }
+};
+
+bool SamePixels(const SoftwareCanvas& a, const SoftwareCanvas& b)
+{
+    return a.width() == b.width() && a.height() == b.height() &&
+        std::equal(a.pixels(), a.pixels() + a.width() * a.height(), b.pixels());
+}
+
+double MeasureMegapixelsPerSecond(Scene& scene, SoftwareCanvas& canvas, int frames)
+{
+    canvas.resetStats();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i) {
+        scene.render(canvas);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? static_cast<double>(canvas.pixelsShaded()) / seconds / 1.0e6 : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+    CheckSuite checks;
+    const DFColor black{0.0f, 0.0f, 0.0f, 1.0f};
+
+    {
+        SoftwareCanvas canvas(64, 64);
+        canvas.clear(black);
+        canvas.drawRectangle({8.0f, 8.0f, 16.0f, 16.0f}, {1.0f, 0.0f, 0.0f, 1.0f});
+        checks.expect(canvas.pixel(8, 8) == 0xFF0000FFu, "opaque rect fills its first pixel");
+        checks.expect(canvas.pixel(23, 23) == 0xFF0000FFu, "opaque rect fills its last pixel");
+        checks.expect(canvas.pixel(24, 23) == 0xFF000000u, "opaque rect leaves right neighbour untouched");
+        checks.expect(canvas.pixel(7, 8) == 0xFF000000u, "opaque rect leaves left neighbour untouched");
+
+        canvas.drawRectangle({40.5f, 8.0f, 10.0f, 4.0f}, {0.0f, 1.0f, 0.0f, 1.0f});
+        checks.expectNear(Channel(canvas.pixel(40, 9), 1), 128.0f, 2.0f, "half-covered edge pixel gets half coverage");
+
+        canvas.drawRectangle({8.0f, 40.0f, 16.0f, 16.0f}, {1.0f, 1.0f, 1.0f, 0.5f});
+        checks.expectNear(Channel(canvas.pixel(12, 44), 0), 128.0f, 1.0f, "translucent white over black blends to mid grey");
+        checks.expectNear(Channel(canvas.pixel(12, 44), 3), 255.0f, 0.0f, "blend over opaque keeps alpha opaque");
+    }
+
+    {
+        SoftwareCanvas canvas(64, 64);
+        canvas.clear(black);
+        canvas.drawRoundedRectangle({10.0f, 10.0f, 40.0f, 40.0f}, 12.0f, {1.0f, 1.0f, 1.0f, 1.0f});
+        checks.expect(canvas.pixel(10, 10) == 0xFF000000u, "rounded rect corner pixel is outside the arc");
+        checks.expect(canvas.pixel(30, 30) == 0xFFFFFFFFu, "rounded rect center is filled");
+        checks.expect(canvas.pixel(30, 10) == 0xFFFFFFFFu, "rounded rect straight edge is filled");
+        const float arc = Channel(canvas.pixel(13, 13), 0);
+        checks.expect(arc > 0.0f && arc < 255.0f, "rounded rect arc pixel is antialiased");
+
+        canvas.clear(black);
+        canvas.drawRoundedRectangleOutline({10.0f, 10.0f, 40.0f, 40.0f}, 6.0f, {1.0f, 1.0f, 1.0f, 1.0f}, 2.0f);
+        checks.expect(canvas.pixel(30, 30) == 0xFF000000u, "outline leaves interior untouched");
+        checks.expect(canvas.pixel(30, 10) == 0xFFFFFFFFu && canvas.pixel(30, 11) == 0xFFFFFFFFu, "outline stroke is two pixels thick");
+        checks.expect(canvas.pixel(30, 12) == 0xFF000000u, "outline stroke stays inside the rect");
+    }
+
+    {
+        SoftwareCanvas canvas(64, 64);
+        canvas.clear(black);
+        canvas.drawLine({4.0f, 20.0f}, {60.0f, 20.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, 4.0f);
+        checks.expect(canvas.pixel(30, 18) == 0xFFFFFFFFu && canvas.pixel(30, 21) == 0xFFFFFFFFu, "thick horizontal line covers its width");
+        checks.expect(canvas.pixel(30, 17) == 0xFF000000u && canvas.pixel(30, 22) == 0xFF000000u, "thick horizontal line has exact edges");
+
+        canvas.clear(black);
+        canvas.drawLine({4.0f, 4.0f}, {60.0f, 60.0f}, {1.0f, 1.0f, 1.0f, 1.0f}, 3.0f);
+        checks.expect(Channel(canvas.pixel(30, 30), 0) > 200.0f, "diagonal line covers pixels on the segment");
+        checks.expect(canvas.pixel(40, 20) == 0xFF000000u, "diagonal line leaves distant pixels untouched");
+    }
+
+    {
+        const std::string text = "Hello Dock 42";
+        int litCells = 0;
+        for (char ch : text) {
+            const uint8_t* bits = DFGlyph5x7(ch);
+            for (int row = 0; row < 7; ++row) {
+                for (int col = 0; col < 5; ++col) {
+                    litCells += (bits[row] >> (4 - col)) & 1;
+                }
+            }
+        }
+        const float cell = DFTextPixelScale();
+        RectCountingCanvas counter;
+        counter.drawGlyphRun(0.0f, 0.0f, text, {1.0f, 1.0f, 1.0f, 1.0f});
+        checks.expect(counter.rects > 0 && counter.rects * 3 < litCells, "glyph run emits far fewer rects than lit pixels");
+        checks.expectNear(counter.area, static_cast<float>(litCells) * cell * cell, 0.01f * litCells, "glyph run rects exactly tile the lit cells");
+
+        DFSetTextPixelScale(2.0f);
+        SoftwareCanvas canvas(64, 32);
+        canvas.clear(black);
+        canvas.drawGlyphRun(10.0f, 10.0f, "I", {1.0f, 1.0f, 1.0f, 1.0f});
+        checks.expect(canvas.pixel(10, 10) == 0xFFFFFFFFu && canvas.pixel(19, 11) == 0xFFFFFFFFu, "glyph blit fills the top bar of I");
+        checks.expect(canvas.pixel(10, 12) == 0xFF000000u && canvas.pixel(14, 12) == 0xFFFFFFFFu, "glyph blit keeps the stem of I narrow");
+        canvas.clear(black);
+        canvas.drawGlyphRun(10.5f, 10.0f, "I", {1.0f, 1.0f, 1.0f, 1.0f});
+        checks.expectNear(Channel(canvas.pixel(10, 10), 0), 128.0f, 2.0f, "glyph blit box-filters fractional positions");
+        DFSetTextPixelScale(1.8f);
+    }
+
+    Scene scene;
+    scene.build();
+
+    SoftwareCanvas serial(static_cast<int>(scene.bounds.width), static_cast<int>(scene.bounds.height));
+    SoftwareCanvas tiled(serial.width(), serial.height());
+    tiled.setTileParallel(4, 32);
+    scene.render(serial);
+    scene.render(tiled);
+    checks.expect(serial.primitiveCount() > 50, "dock scene submits primitives");
+    checks.expect(serial.pixels()[0] != 0u, "dock scene writes the framebuffer");
+    bool identical = true;
+    for (int i = 0; i < serial.width() * serial.height(); ++i) {
+        if (serial.pixels()[i] != tiled.pixels()[i]) {
+            identical = false;
+            break;
+        }
+    }
+    checks.expect(identical, "tile-parallel output matches serial output");
+
+    DisplayListCanvas recorded;
+    scene.renderer.render(recorded, scene.layout.root());
+    scene.splitter.render(recorded);
+    df::WindowManager::instance().renderAllWindows(recorded);
+    const uint64_t firstHash = recorded.hash();
+    const size_t firstCount = recorded.commandCount();
+    checks.expect(firstCount > 50, "display list records the dock scene");
+    checks.expect(recorded.count(DisplayListCanvas::Op::Text) + recorded.count(DisplayListCanvas::Op::GlyphRun) > 0,
+                  "display list keeps text as single commands");
+
+    SoftwareCanvas replayed(serial.width(), serial.height());
+    replayed.clear(df::CurrentTheme().dockBackground);
+    recorded.replay(replayed);
+    checks.expect(std::equal(serial.pixels(), serial.pixels() + serial.width() * serial.height(), replayed.pixels()),
+                  "display list replay matches direct rendering");
+
+    recorded.reset();
+    scene.renderer.render(recorded, scene.layout.root());
+    scene.splitter.render(recorded);
+    df::WindowManager::instance().renderAllWindows(recorded);
+    checks.expect(recorded.hash() == firstHash && recorded.commandCount() == firstCount, "unchanged frame hashes identically");
+
+    df::WindowFrame* floating = df::WindowManager::instance().findWindowByContent(scene.widgets.back().get());
+    const DFRect floatingBounds = floating->bounds();
+    floating->setBounds({floatingBounds.x + 1.0f, floatingBounds.y, floatingBounds.width, floatingBounds.height});
+    recorded.reset();
+    scene.renderer.render(recorded, scene.layout.root());
+    scene.splitter.render(recorded);
+    df::WindowManager::instance().renderAllWindows(recorded);
+    checks.expect(recorded.hash() != firstHash, "moved window produces a different hash");
+    floating->setBounds(floatingBounds);
+
+    {
+        DFDamageRegion region;
+        region.add({10.2f, 10.0f, 20.0f, 5.5f});
+        checks.expect(region.size() == 1 && region[0].x == 9.0f && region[0].width == 23.0f, "damage rects snap outward with a 1px margin");
+        region.add({25.0f, 12.0f, 20.0f, 4.0f});
+        checks.expect(region.size() == 1 && region[0].width == 37.0f, "overlapping damage rects merge");
+        for (int i = 0; i < 20; ++i) {
+            region.add({100.0f + 40.0f * static_cast<float>(i), 100.0f, 8.0f, 8.0f});
+        }
+        checks.expect(region.size() == DFDamageRegion::kMaxRects, "damage region caps its rect count");
+        checks.expect(region.intersects({30.0f, 12.0f, 1.0f, 1.0f}) && region.intersects({864.0f, 104.0f, 1.0f, 1.0f}),
+                      "capped damage region still covers every added rect");
+    }
+
+    {
+        SoftwareCanvas canvas(32, 32);
+        canvas.clear(black);
+        canvas.setClipRect({4.0f, 4.0f, 8.0f, 8.0f});
+        canvas.drawRectangle({0.0f, 0.0f, 32.0f, 32.0f}, {1.0f, 1.0f, 1.0f, 1.0f});
+        canvas.drawLine({0.0f, 8.0f}, {32.0f, 8.0f}, {1.0f, 0.0f, 0.0f, 1.0f}, 2.0f);
+        canvas.clearClipRect();
+        checks.expect(canvas.pixel(4, 4) == 0xFFFFFFFFu && canvas.pixel(11, 11) == 0xFFFFFFFFu, "clip admits pixels inside it");
+        checks.expect(canvas.pixel(3, 4) == 0xFF000000u && canvas.pixel(12, 11) == 0xFF000000u, "clip rejects pixels outside it");
+        checks.expect(canvas.pixel(4, 8) == 0xFF0000FFu && canvas.pixel(20, 8) == 0xFF000000u, "clip applies to lines");
+    }
+
+    {
+        SoftwareCanvas canvas(32, 32);
+        canvas.clear(black);
+        canvas.pushClip({4.0f, 4.0f, 16.0f, 16.0f});
+        canvas.pushClip({10.0f, 0.0f, 32.0f, 32.0f});
+        const DFRect nested = canvas.clipRect();
+        canvas.drawRectangle({0.0f, 0.0f, 32.0f, 32.0f}, {1.0f, 1.0f, 1.0f, 1.0f});
+        canvas.popClip();
+        checks.expect(nested.x == 10.0f && nested.y == 4.0f && nested.width == 10.0f && nested.height == 16.0f,
+                      "pushed clip intersects the enclosing clip");
+        checks.expect(canvas.clipDepth() == 1 && canvas.clipRect().x == 4.0f, "popClip restores the enclosing clip");
+        canvas.popClip();
+        checks.expect(canvas.clipDepth() == 0 && !canvas.hasClipRect(), "popping the last clip removes clipping");
+        checks.expect(canvas.pixel(10, 4) == 0xFFFFFFFFu && canvas.pixel(19, 19) == 0xFFFFFFFFu, "nested clip admits its pixels");
+        checks.expect(canvas.pixel(9, 10) == 0xFF000000u && canvas.pixel(20, 10) == 0xFF000000u, "nested clip rejects the outer clip's margin");
+    }
+
+    {
+        DisplayListCanvas list;
+        list.pushClip({0.0f, 0.0f, 100.0f, 100.0f});
+        list.drawRectangle({200.0f, 0.0f, 10.0f, 10.0f}, black);
+        list.drawRoundedRectangle({0.0f, 300.0f, 10.0f, 10.0f}, 3.0f, black);
+        list.drawLine({150.0f, 0.0f}, {150.0f, 100.0f}, black, 1.0f);
+        list.drawText(0.0f, 400.0f, "hidden", black);
+        checks.expect(list.commandCount() == 1, "draws outside the clip are culled before recording");
+        list.drawRectangle({50.0f, 50.0f, 100.0f, 100.0f}, black);
+        list.drawLine({50.0f, 50.0f}, {500.0f, 50.0f}, black, 2.0f);
+        list.popClip();
+        const auto& commands = list.commands();
+        checks.expect(commands.size() == 4 && commands[1].w == 50.0f && commands[1].h == 50.0f, "straddling rects are trimmed to the clip");
+        checks.expect(commands[2].w > 100.0f && commands[2].w < 110.0f, "straddling lines are trimmed near the clip");
+        checks.expect(commands[3].op == DisplayListCanvas::Op::ClearClip, "popping the only clip records a clear");
+    }
+
+    {
+        df::BasicDockWidget panel("Overflow");
+        panel.setContent(std::make_unique<OverflowContent>());
+        panel.setBounds({40.0f, 40.0f, 120.0f, 100.0f});
+        SoftwareCanvas canvas(240, 240);
+        canvas.clear(black);
+        panel.paint(canvas);
+        canvas.flush();
+        checks.expect(canvas.pixel(20, 90) == 0xFF000000u && canvas.pixel(100, 200) == 0xFF000000u,
+                      "dock widget content cannot paint outside the widget");
+        checks.expect(canvas.pixel(100, 90) != 0xFF000000u, "dock widget content still paints its client area");
+        checks.expect(canvas.clipDepth() == 0 && !canvas.hasClipRect(), "dock widget paint leaves no clip behind");
+
+        DisplayListCanvas unclipped;
+        OverflowContent raw;
+        raw.setBounds(panel.content()->bounds());
+        raw.paint(unclipped);
+        DisplayListCanvas clipped;
+        panel.paint(clipped);
+        checks.expect(clipped.count(DisplayListCanvas::Op::Text) * 4 < unclipped.count(DisplayListCanvas::Op::Text),
+                      "rows scrolled out of the client area are not submitted");
+    }
+
+    {
+        // Each change repaints its damage only and must match a full repaint.
+        scene.trackDamage();
+        SoftwareCanvas full(serial.width(), serial.height());
+        SoftwareCanvas partial(serial.width(), serial.height());
+        scene.render(full);
+        scene.render(partial);
+        scene.damage.clear();
+
+        auto repaint = [&](const std::string& label) {
+            partial.resetStats();
+            full.resetStats();
+            const DFDamageRegion frame = scene.renderDamage(partial);
+            scene.render(full);
+            checks.expect(!frame.empty(), label + " reports damage");
+            checks.expect(SamePixels(partial, full), label + " partial repaint matches full repaint");
+            return full.pixelsShaded() > 0
+                ? static_cast<double>(partial.pixelsShaded()) / static_cast<double>(full.pixelsShaded())
+                : 1.0;
+        };
+
+        df::DockLayout::Node* tabs = scene.layout.root()->second->first.get();
+        const DFRect inactiveTab = df::DockLayout::TabRectForIndex(*tabs, tabs->bounds, 1, tabs->children.size());
+        scene.renderer.setMousePosition({inactiveTab.x + inactiveTab.width * 0.5f, inactiveTab.y + inactiveTab.height * 0.5f});
+        const double hoverCost = repaint("tab hover");
+        checks.expect(hoverCost < 0.05, "tab hover repaints under 5% of a full frame");
+
+        tabs->activeTab = 1;
+        df::DockLayout::MarkDirty(tabs);
+        scene.layout.update(scene.bounds);
+        repaint("tab activation");
+
+        const DFPoint lane{tabs->bounds.x + tabs->bounds.width * 0.5f, tabs->bounds.y + tabs->bounds.height + 1.0f};
+        Event down(Event::Type::MouseDown);
+        down.x = lane.x;
+        down.y = lane.y;
+        Event move(Event::Type::MouseMove);
+        move.x = lane.x;
+        move.y = lane.y - 40.0f;
+        Event up(Event::Type::MouseUp);
+        checks.expect(scene.splitter.handleEvent(down), "splitter grabs its lane");
+        scene.splitter.handleEvent(move);
+        scene.splitter.handleEvent(up);
+        scene.layout.update(scene.bounds);
+        scene.splitter.updateSplitters(scene.layout.root(), scene.bounds);
+        repaint("splitter drag");
+
+        Event hover(Event::Type::MouseMove);
+        hover.x = lane.x;
+        hover.y = tabs->bounds.y + tabs->bounds.height + 1.0f;
+        scene.splitter.handleEvent(hover);
+        const double splitterHoverCost = repaint("splitter hover");
+        checks.expect(splitterHoverCost < 0.05, "splitter hover repaints under 5% of a full frame");
+
+        floating->setBounds({floatingBounds.x + 30.0f, floatingBounds.y + 20.0f, floatingBounds.width, floatingBounds.height});
+        repaint("floating window move");
+
+        const DFRect moved = floating->bounds();
+        Event closeHover(Event::Type::MouseMove);
+        closeHover.x = moved.x + moved.width - 12.0f;
+        closeHover.y = moved.y + 12.0f;
+        floating->handleEvent(closeHover);
+        const double closeHoverCost = repaint("close button hover");
+        checks.expect(closeHoverCost < 0.05, "close button hover repaints under 5% of a full frame");
+
+        scene.renderer.render(full, scene.layout.root());
+        checks.expect(scene.damage.empty(), "repainting without changes adds no damage");
+
+        scene.layout.setDamageRegion(nullptr);
+        scene.splitter.setDamageRegion(nullptr);
+        scene.renderer.setDamageRegion(nullptr);
+        df::WindowManager::instance().setDamageRegion(nullptr);
+        floating->setBounds(floatingBounds);
+    }
+
+    // Tab strips are recorded once per Tab node and replayed while unchanged,
+    // producing the same commands as drawing them.
+    {
+        df::DockLayout::Node* root = scene.layout.root();
+        df::DockRenderer uncached;
+        uncached.setStripCacheEnabled(false);
+        df::DockRenderer cached;
+        DisplayListCanvas direct;
+        DisplayListCanvas first;
+        DisplayListCanvas second;
+        uncached.render(direct, root);
+        cached.render(first, root);
+        const uint64_t strips = cached.stats().stripMisses;
+        cached.resetStats();
+        cached.render(second, root);
+        checks.expect(strips > 0 && first.hash() == direct.hash() && second.hash() == direct.hash() &&
+                          second.commandCount() == direct.commandCount(),
+                      "cached tab strips record the same commands as drawing them");
+        checks.expect(cached.stats().stripHits == strips && cached.stats().stripMisses == 0,
+                      "unchanged tab strips are replayed");
+
+        const df::DockLayout::Node* tabs = root->second->first.get();
+        const DFRect hoverTab = df::DockLayout::TabRectForIndex(*tabs, tabs->bounds, 1, tabs->children.size());
+        const DFPoint hoverPoint{hoverTab.x + hoverTab.width * 0.5f, hoverTab.y + hoverTab.height * 0.5f};
+        cached.setMousePosition(hoverPoint);
+        uncached.setMousePosition(hoverPoint);
+        cached.resetStats();
+        direct.reset();
+        second.reset();
+        uncached.render(direct, root);
+        cached.render(second, root);
+        checks.expect(cached.stats().stripMisses == 1 && second.hash() == direct.hash(),
+                      "hovering a tab re-records only its strip");
+
+        SoftwareCanvas clippedDirect(serial.width(), serial.height());
+        SoftwareCanvas clippedCached(serial.width(), serial.height());
+        for (SoftwareCanvas* target : {&clippedDirect, &clippedCached}) {
+            target->clear(df::CurrentTheme().dockBackground);
+            target->setClipRect({hoverTab.x + 4.0f, hoverTab.y, 40.0f, hoverTab.height});
+            (target == &clippedDirect ? uncached : cached).render(*target, root);
+            target->clearClipRect();
+            target->flush();
+        }
+        checks.expect(SamePixels(clippedDirect, clippedCached), "cached strips honour the target clip");
+
+        df::SetTheme(df::CurrentTheme());
+        cached.resetStats();
+        second.reset();
+        cached.render(second, root);
+        checks.expect(cached.stats().stripMisses == strips, "theme change re-records every strip");
+    }
+
+    // Convex polygons rasterize natively: pixel-exact on integer edges, in
+    // either winding, and with antialiased slanted edges. Canvases without a
+    // native path get one rectangle per pixel row.
+    {
+        const DFColor white{1.0f, 1.0f, 1.0f, 1.0f};
+        const DFColor black{0.0f, 0.0f, 0.0f, 1.0f};
+        SoftwareCanvas rect(40, 40);
+        SoftwareCanvas polygon(40, 40);
+        rect.clear(black);
+        polygon.clear(black);
+        rect.drawRectangle({5.0f, 6.0f, 20.0f, 10.0f}, white);
+        const DFPoint box[] = {{5.0f, 6.0f}, {25.0f, 6.0f}, {25.0f, 16.0f}, {5.0f, 16.0f}};
+        polygon.drawConvexPolygon(box, 4, white);
+        checks.expect(SamePixels(rect, polygon) && polygon.primitiveCount() == 1,
+                      "axis-aligned polygon matches the rectangle in one primitive");
+
+        SoftwareCanvas clockwise(40, 40);
+        SoftwareCanvas counter(40, 40);
+        const DFPoint triangle[] = {{4.0f, 4.0f}, {36.0f, 4.0f}, {4.0f, 36.0f}};
+        const DFPoint reversed[] = {{4.0f, 36.0f}, {36.0f, 4.0f}, {4.0f, 4.0f}};
+        clockwise.clear(black);
+        counter.clear(black);
+        clockwise.drawConvexPolygon(triangle, 3, white);
+        counter.drawConvexPolygon(reversed, 3, white);
+        checks.expect(SamePixels(clockwise, counter), "polygon winding does not change coverage");
+        checks.expect(clockwise.pixel(10, 10) == 0xFFFFFFFFu && clockwise.pixel(30, 30) == 0xFF000000u,
+                      "triangle covers its inside only");
+        // The hypotenuse x + y = 40 passes through the centre of pixel (19, 20).
+        checks.expectNear(Channel(clockwise.pixel(19, 20), 0), 128.0f, 2.0f, "slanted polygon edge is antialiased");
+
+        RectCountingCanvas rows;
+        const DFPoint tab[] = {{10.0f, 2.0f}, {90.0f, 2.0f}, {98.0f, 22.0f}, {98.0f, 23.0f}, {2.0f, 23.0f}, {2.0f, 22.0f}};
+        rows.drawConvexPolygon(tab, 6, white);
+        checks.expect(rows.rects == 21, "fallback fills one rectangle per pixel row");
+        checks.expectNear(rows.area, 96.0f + 88.0f * 20.0f, 40.0f, "fallback rows cover the polygon area");
+
+        DisplayListCanvas recorded;
+        recorded.drawConvexPolygon(tab, 6, white);
+        const uint64_t tabHash = recorded.hash();
+        SoftwareCanvas direct(100, 30);
+        SoftwareCanvas replayed(100, 30);
+        direct.clear(black);
+        replayed.clear(black);
+        direct.drawConvexPolygon(tab, 6, white);
+        recorded.replay(replayed);
+        checks.expect(recorded.count(DisplayListCanvas::Op::ConvexPolygon) == 1 && SamePixels(direct, replayed),
+                      "display list replays a polygon as one command");
+        DFPoint moved[6];
+        std::copy(std::begin(tab), std::end(tab), moved);
+        moved[1].x += 1.0f;
+        recorded.reset();
+        recorded.drawConvexPolygon(moved, 6, white);
+        checks.expect(recorded.hash() != tabHash, "display list hash covers polygon points");
+    }
+
+    // Stepped tabs fill with one polygon each instead of one rectangle per row.
+    {
+        size_t tabCount = 0;
+        std::vector<const df::DockLayout::Node*> pending{scene.layout.root()};
+        while (!pending.empty()) {
+            const df::DockLayout::Node* node = pending.back();
+            pending.pop_back();
+            if (!node) {
+                continue;
+            }
+            if (node->type == df::DockLayout::Node::Type::Tab) {
+                tabCount += node->children.size();
+            }
+            pending.push_back(node->first.get());
+            pending.push_back(node->second.get());
+        }
+        df::DockRenderer renderer;
+        renderer.setStripCacheEnabled(false);
+        DisplayListCanvas strip;
+        renderer.render(strip, scene.layout.root());
+        checks.expect(!df::CurrentTheme().drawSteppedTabShape ||
+                          strip.count(DisplayListCanvas::Op::ConvexPolygon) == tabCount,
+                      "stepped tab shapes are single polygons");
+        // Drawn through the fallback, each fill becomes the per-row rectangles
+        // the renderer used to emit.
+        RectCountingCanvas rows;
+        for (const DisplayListCanvas::Command& command : strip.commands()) {
+            if (command.op == DisplayListCanvas::Op::ConvexPolygon) {
+                rows.drawConvexPolygon(strip.pointsOf(command), command.textLength, DFUnpackColor(command.color));
+            }
+        }
+        const size_t polygons = strip.count(DisplayListCanvas::Op::ConvexPolygon);
+        checks.expect(polygons == 0 || static_cast<size_t>(rows.rects) >= polygons * 10,
+                      "polygon tab fills replace ten or more row rectangles each");
+    }
+
+    // Corner tables are shared per quarter-pixel radius and trace outlines
+    // whose edges meet the rect exactly.
+    {
+        DFCornerTessellation& tessellation = DFCornerTessellation::instance();
+        const DFCornerTable& fill = tessellation.fill(6.1f);
+        const size_t tables = tessellation.tableCount();
+        checks.expect(&tessellation.fill(6.2f) == &fill && tessellation.tableCount() == tables,
+                      "corner radii within a quarter pixel share a table");
+        checks.expect(&tessellation.fill(6.3f) != &fill && &tessellation.ring(6.0f, 1.0f) != &fill,
+                      "corner tables are keyed by radius and stroke");
+
+        bool onRadius = fill.pointCount() == static_cast<size_t>(fill.segments + 1) * 4;
+        for (const DFPoint& offset : fill.outer) {
+            onRadius = onRadius && std::fabs(std::sqrt(offset.x * offset.x + offset.y * offset.y) - 6.0f) < 1e-4f;
+        }
+        checks.expect(onRadius, "corner offsets lie on the quantized radius");
+
+        const DFRect rect{10.0f, 12.0f, 40.0f, 20.0f};
+        std::vector<DFPoint> outline(fill.pointCount());
+        fill.trace(rect, false, outline.data());
+        const DFRect traced = DFPointsBounds(outline.data(), outline.size());
+        checks.expect(traced.x == rect.x && traced.y == rect.y && traced.width == rect.width && traced.height == rect.height,
+                      "traced corners span the rect exactly");
+
+        const DFCornerTable& ring = tessellation.ring(6.0f, 2.0f);
+        std::vector<DFPoint> outer(ring.pointCount());
+        std::vector<DFPoint> inner(ring.pointCount());
+        ring.trace(rect, false, outer.data());
+        ring.trace(rect, true, inner.data());
+        const DFRect outerBounds = DFPointsBounds(outer.data(), outer.size());
+        const DFRect innerBounds = DFPointsBounds(inner.data(), inner.size());
+        checks.expect(outerBounds.x == rect.x - 1.0f && outerBounds.width == rect.width + 2.0f &&
+                          innerBounds.y == rect.y + 1.0f && innerBounds.height == rect.height - 2.0f,
+                      "ring corners straddle the rect edge by half the stroke");
+
+        // Filled through the polygon rasterizer, the traced shape matches the
+        // analytic rounded rect closely.
+        SoftwareCanvas analytic(64, 48);
+        SoftwareCanvas tessellated(64, 48);
+        analytic.clear({0.0f, 0.0f, 0.0f, 1.0f});
+        tessellated.clear({0.0f, 0.0f, 0.0f, 1.0f});
+        analytic.drawRoundedRectangle(rect, 6.0f, {1.0f, 1.0f, 1.0f, 1.0f});
+        tessellated.drawConvexPolygon(outline.data(), outline.size(), {1.0f, 1.0f, 1.0f, 1.0f});
+        float worst = 0.0f;
+        for (int y = 0; y < analytic.height(); ++y) {
+            for (int x = 0; x < analytic.width(); ++x) {
+                worst = std::max(worst, std::fabs(Channel(analytic.pixel(x, y), 0) - Channel(tessellated.pixel(x, y), 0)));
+            }
+        }
+        checks.expect(worst <= 24.0f, "tessellated corners match analytic corners");
+    }
+
+    // Packed colors round to the nearest byte, clamp out-of-range channels and
+    // survive an unpack/pack round trip unchanged.
+    {
+        bool rounds = true;
+        for (int i = -40; i <= 1060; ++i) {
+            const float v = static_cast<float>(i) / 1000.0f;
+            const uint32_t expected = static_cast<uint32_t>(std::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f);
+            const uint32_t packed = DFPackColor({v, 1.0f - v, v * 0.5f, v}).rgba;
+            const uint32_t green = static_cast<uint32_t>(std::clamp(1.0f - v, 0.0f, 1.0f) * 255.0f + 0.5f);
+            const uint32_t blue = static_cast<uint32_t>(std::clamp(v * 0.5f, 0.0f, 1.0f) * 255.0f + 0.5f);
+            rounds = rounds && packed == (expected | (green << 8) | (blue << 16) | (expected << 24));
+        }
+        checks.expect(rounds, "packed colors round and clamp each channel");
+        checks.expect(DFPackColor({std::nanf(""), 0.0f, 1.0f, 1.0f}).rgba == 0xFFFF0000u,
+                      "NaN channels pack to zero");
+
+        bool roundTrips = true;
+        for (uint32_t k = 0; k < 256; ++k) {
+            const DFPackedColor packed{k | ((255u - k) << 8) | ((k * 7u & 0xFFu) << 16) | ((k ^ 0x5Au) << 24)};
+            roundTrips = roundTrips && DFPackColor(DFUnpackColor(packed)) == packed;
+        }
+        checks.expect(roundTrips, "packed colors survive an unpack/pack round trip");
+        checks.expect(sizeof(DisplayListCanvas::Command) == 40 && sizeof(DFVertex) == 12,
+                      "commands and vertices carry 4-byte colors");
+
+        // Translucent draws replay to the same bytes as drawing them directly.
+        SoftwareCanvas direct(64, 32);
+        SoftwareCanvas replayed(64, 32);
+        DisplayListCanvas list;
+        for (Canvas* canvas : {static_cast<Canvas*>(&direct), static_cast<Canvas*>(&list)}) {
+            canvas->drawRectangle({2.0f, 2.0f, 40.0f, 20.0f}, {0.123f, 0.456f, 0.789f, 0.333f});
+            canvas->drawRoundedRectangle({10.0f, 6.0f, 50.0f, 22.0f}, 5.0f, {0.91f, 0.27f, 0.05f, 0.61f});
+            canvas->drawLine({0.0f, 30.0f}, {63.0f, 1.0f}, {0.5f, 0.5f, 0.25f, 0.77f}, 1.5f);
+        }
+        list.replay(replayed);
+        direct.flush();
+        replayed.flush();
+        checks.expect(SamePixels(direct, replayed), "packed display list colors replay exactly");
+    }
+
+    // CountingCanvas forwards unchanged and attributes its tallies to the
+    // innermost subsystem scope.
+    {
+        SoftwareCanvas direct(serial.width(), serial.height());
+        SoftwareCanvas forwarded(serial.width(), serial.height());
+        CountingCanvas counting(forwarded);
+        scene.render(direct);
+        forwarded.clear(df::CurrentTheme().dockBackground);
+        counting.beginFrame();
+        scene.renderer.render(counting, scene.layout.root());
+        scene.splitter.render(counting);
+        df::WindowManager::instance().renderAllWindows(counting);
+        forwarded.flush();
+        checks.expect(SamePixels(direct, forwarded), "counting canvas forwards every draw");
+
+        const CountingCanvas::Counts total = counting.total();
+        checks.expect(counting.counts(DFCanvasScope::DockRenderer).primitives > 0 &&
+                          counting.counts(DFCanvasScope::DockSplitter).primitives > 0 &&
+                          counting.counts(DFCanvasScope::WindowManager).primitives > 0 &&
+                          counting.counts(DFCanvasScope::WidgetContent).textChars > 0 &&
+                          counting.counts(DFCanvasScope::Other).primitives == 0,
+                      "draws are attributed to the subsystem that issued them");
+        checks.expect(total.vertices >= total.primitives * 6 && total.pixelArea > 0.0,
+                      "counts include vertex and pixel estimates");
+
+        // A display list target takes cached strips whole; the counts match
+        // those of replaying them draw by draw.
+        DisplayListCanvas list;
+        CountingCanvas listCounting(list);
+        scene.renderer.render(listCounting, scene.layout.root());
+        scene.splitter.render(listCounting);
+        df::WindowManager::instance().renderAllWindows(listCounting);
+        const CountingCanvas::Counts listTotal = listCounting.total();
+        checks.expect(listTotal.primitives == total.primitives && listTotal.vertices == total.vertices &&
+                          listTotal.textChars == total.textChars,
+                      "appended strips are counted like replayed ones");
+
+        SoftwareCanvas small(64, 64);
+        CountingCanvas unit(small);
+        unit.drawRectangle({4.0f, 4.0f, 10.0f, 10.0f}, {1.0f, 1.0f, 1.0f, 1.0f});
+        unit.setClipRect({0.0f, 0.0f, 32.0f, 32.0f});
+        unit.drawRectangle({40.0f, 40.0f, 10.0f, 10.0f}, {1.0f, 1.0f, 1.0f, 1.0f});
+        unit.clearClipRect();
+        {
+            DFCanvasScopeGuard scope(unit, DFCanvasScope::DebugOverlay);
+            unit.drawGlyphRun(0.0f, 40.0f, "ab", {1.0f, 1.0f, 1.0f, 1.0f});
+        }
+        const CountingCanvas::Counts& other = unit.counts(DFCanvasScope::Other);
+        checks.expect(other.primitives == 1 && other.vertices == 6 && other.pixelArea == 100.0,
+                      "a rectangle costs one quad and its area; clipped draws are not counted");
+        checks.expect(unit.counts(DFCanvasScope::DebugOverlay).textChars == 2 &&
+                          unit.currentScope() == DFCanvasScope::Other,
+                      "scope guards restore the enclosing scope");
+        checks.expect(unit.json().find("\"debug_overlay\": {\"primitives\": 1,") != std::string::npos,
+                      "counts are reported as JSON");
+    }
+
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const double serialMps = MeasureMegapixelsPerSecond(scene, serial, frames);
+    const double tiledMps = MeasureMegapixelsPerSecond(scene, tiled, frames);
+    std::cout << "dock scene " << serial.width() << "x" << serial.height() << " frames=" << frames
+              << " serial=" << serialMps << " MP/s tiled(" << tiled.tileThreads() << ")=" << tiledMps << " MP/s\n";
+
+    df::WindowManager::instance().destroyAllWindows();
+
+    if (checks.failed() > 0) {
+        std::cout << "CHECKS FAILED passed=" << checks.passed() << " failed=" << checks.failed() << "\n";
+        return 1;
+    }
+
+    std::cout << "ALL CHECKS PASSED passed=" << checks.passed() << " failed=0\n";
+    return 0;
+}
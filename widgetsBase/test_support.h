@@ -0,0 +1,110 @@
+#pragma once
+
+#include "dock_framework.h"
+#include "dock_layout.h"
+#include "dock_splitter.h"
+#include "dock_widget_impl.h"
+#include "window_manager.h"
+
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Helpers shared by the check executables (dock_layout_constraints_demo,
+// software_canvas_demo, input_pipeline_demo). Each prints one line per check
+// and ends with "ALL CHECKS PASSED" or "CHECKS FAILED", which ctest matches.
+
+class CheckSuite {
+public:
+    void expect(bool condition, const std::string& label)
+    {
+        if (condition) {
+            ++passed_;
+            std::cout << "[PASS] " << label << "\n";
+            return;
+        }
+        ++failed_;
+        std::cout << "[FAIL] " << label << "\n";
+    }
+
+    void expectNear(float actual, float expected, float epsilon, const std::string& label)
+    {
+        std::ostringstream oss;
+        oss << label << " actual=" << actual << " expected=" << expected << " eps=" << epsilon;
+        expect(std::fabs(actual - expected) <= epsilon, oss.str());
+    }
+
+    int failed() const { return failed_; }
+    int passed() const { return passed_; }
+
+private:
+    int passed_ = 0;
+    int failed_ = 0;
+};
+
+inline std::unique_ptr<df::DockLayout::Node> makeLeaf(df::DockWidget* widget)
+{
+    auto node = std::make_unique<df::DockLayout::Node>();
+    node->type = df::DockLayout::Node::Type::Widget;
+    node->widget = widget;
+    return node;
+}
+
+// Hierarchy | (Viewport/Scene tabs over Inspector | Console), plus a floating
+// window over the right half. Widgets are registered with the DockManager in
+// that order; makeContent, when given, supplies each one's content by title.
+struct Workspace {
+    std::vector<std::unique_ptr<df::BasicDockWidget>> widgets;
+    df::DockLayout layout;
+    df::DockSplitter splitter;
+    DFRect bounds{0.0f, 0.0f, 1280.0f, 720.0f};
+
+    void build(const std::function<std::unique_ptr<Widget>(const char*)>& makeContent = nullptr)
+    {
+        const char* names[] = {"Hierarchy", "Viewport", "Inspector", "Console", "Scene", "Floating"};
+        for (const char* name : names) {
+            auto widget = std::make_unique<df::BasicDockWidget>(name);
+            if (makeContent) {
+                widget->setContent(makeContent(name));
+            }
+            df::DockManager::instance().registerWidget(widget.get());
+            widgets.push_back(std::move(widget));
+        }
+
+        auto root = std::make_unique<df::DockLayout::Node>();
+        root->type = df::DockLayout::Node::Type::Split;
+        root->vertical = true;
+        root->ratio = 0.2f;
+        root->first = makeLeaf(widgets[0].get());
+
+        auto right = std::make_unique<df::DockLayout::Node>();
+        right->type = df::DockLayout::Node::Type::Split;
+        right->vertical = false;
+        right->ratio = 0.65f;
+
+        auto tabs = std::make_unique<df::DockLayout::Node>();
+        tabs->type = df::DockLayout::Node::Type::Tab;
+        tabs->tabBarHeight = df::DockLayout::ThemeTabBarHeight();
+        tabs->children.push_back(makeLeaf(widgets[1].get()));
+        tabs->children.push_back(makeLeaf(widgets[4].get()));
+        right->first = std::move(tabs);
+
+        auto bottom = std::make_unique<df::DockLayout::Node>();
+        bottom->type = df::DockLayout::Node::Type::Split;
+        bottom->vertical = true;
+        bottom->ratio = 0.5f;
+        bottom->first = makeLeaf(widgets[2].get());
+        bottom->second = makeLeaf(widgets[3].get());
+        right->second = std::move(bottom);
+        root->second = std::move(right);
+
+        layout.setRoot(std::move(root));
+        layout.update(bounds);
+        splitter.updateSplitters(layout.root(), bounds);
+        df::WindowManager::instance().createFloatingWindow(widgets[5].get(), {700.0f, 140.0f, 420.0f, 300.0f});
+    }
+};
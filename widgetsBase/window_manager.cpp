@@ -25,20 +25,19 @@ WindowFrame::WindowFrame(DockWidget* content, const DFRect& initialBounds)
         };
         content_->setBounds(contentBounds);
     }
+    WindowManager::instance().addDamage(bounds_);
 }
 
 WindowFrame::~WindowFrame() = default;
 
-void WindowFrame::setBounds(const DFRect& bounds)
+void WindowFrame::moveTo(const DFRect& bounds)
 {
+    if (bounds.x != bounds_.x || bounds.y != bounds_.y ||
+        bounds.width != bounds_.width || bounds.height != bounds_.height) {
+        WindowManager::instance().addDamage(bounds_);
+        WindowManager::instance().addDamage(bounds);
+    }
     bounds_ = bounds;
-    const DFPoint origin = WindowManager::instance().clientOriginScreen();
-    globalBounds_ = {
-        bounds_.x + origin.x,
-        bounds_.y + origin.y,
-        bounds_.width,
-        bounds_.height
-    };
     if (content_) {
         DFRect contentBounds = {
             bounds_.x,
@@ -50,21 +49,26 @@ void WindowFrame::setBounds(const DFRect& bounds)
     }
 }
 
+void WindowFrame::setBounds(const DFRect& bounds)
+{
+    moveTo(bounds);
+    const DFPoint origin = WindowManager::instance().clientOriginScreen();
+    globalBounds_ = {
+        bounds_.x + origin.x,
+        bounds_.y + origin.y,
+        bounds_.width,
+        bounds_.height
+    };
+}
+
 void WindowFrame::syncLocalFromClientOrigin(const DFPoint& clientOriginScreen)
 {
-    bounds_.x = globalBounds_.x - clientOriginScreen.x;
-    bounds_.y = globalBounds_.y - clientOriginScreen.y;
-    bounds_.width = globalBounds_.width;
-    bounds_.height = globalBounds_.height;
-    if (content_) {
-        DFRect contentBounds = {
-            bounds_.x,
-            bounds_.y + TITLE_BAR_HEIGHT,
-            bounds_.width,
-            bounds_.height - TITLE_BAR_HEIGHT
-        };
-        content_->setBounds(contentBounds);
-    }
+    moveTo({
+        globalBounds_.x - clientOriginScreen.x,
+        globalBounds_.y - clientOriginScreen.y,
+        globalBounds_.width,
+        globalBounds_.height
+    });
 }
 
 bool WindowFrame::isInFrameArea(const DFPoint& p) const
@@ -72,6 +76,20 @@ bool WindowFrame::isInFrameArea(const DFPoint& p) const
     return isInTitleBar(p) || isInCloseButton(p) || getResizeMode(p) != DragMode::None;
 }
 
+WindowFrame::Part WindowFrame::partAt(const DFPoint& p) const
+{
+    if (!bounds_.contains(p)) {
+        return Part::None;
+    }
+    if (closeButtonEnabled() && isInCloseButton(p)) {
+        return Part::CloseButton;
+    }
+    if (getResizeMode(p) != DragMode::None) {
+        return Part::ResizeEdge;
+    }
+    return isInTitleBar(p) ? Part::TitleBar : Part::Client;
+}
+
 bool WindowFrame::consumeCloseRequest()
 {
     if (!closeRequested_) {
@@ -95,10 +113,17 @@ bool WindowFrame::isInTitleBar(const DFPoint& p) const
 
 bool WindowFrame::isInCloseButton(const DFPoint& p) const
 {
-    float closeX = bounds_.x + bounds_.width - CLOSE_BUTTON_SIZE - CLOSE_BUTTON_PADDING;
-    float closeY = bounds_.y + CLOSE_BUTTON_PADDING;
-    return p.x >= closeX && p.x <= closeX + CLOSE_BUTTON_SIZE &&
-           p.y >= closeY && p.y <= closeY + CLOSE_BUTTON_SIZE;
+    return closeButtonRect().contains(p);
+}
+
+DFRect WindowFrame::closeButtonRect() const
+{
+    return {
+        bounds_.x + bounds_.width - CLOSE_BUTTON_SIZE - CLOSE_BUTTON_PADDING,
+        bounds_.y + CLOSE_BUTTON_PADDING,
+        CLOSE_BUTTON_SIZE,
+        CLOSE_BUTTON_SIZE
+    };
 }
 
 bool WindowFrame::closeButtonEnabled() const
@@ -138,13 +163,20 @@ WindowFrame::DragMode WindowFrame::getResizeMode(const DFPoint& p) const
 bool WindowFrame::handleEvent(Event& event)
 {
     if (event.type == Event::Type::MouseMove) {
-        closeHovered_ = closeButtonEnabled() && isInCloseButton({event.x, event.y});
+        const bool hovered = closeButtonEnabled() && isInCloseButton({event.x, event.y});
+        if (hovered != closeHovered_) {
+            WindowManager::instance().addDamage(closeButtonRect());
+        }
+        closeHovered_ = hovered;
     }
 
     if (event.type == Event::Type::MouseDown) {
         DFPoint mousePos{event.x, event.y};
 
         if (closeButtonEnabled() && isInCloseButton(mousePos)) {
+            if (!closeHovered_) {
+                WindowManager::instance().addDamage(closeButtonRect());
+            }
             closeHovered_ = true;
             closeRequested_ = true;
             event.handled = true;
@@ -242,16 +274,7 @@ bool WindowFrame::handleEvent(Event& event)
             newBounds.y = std::clamp(newBounds.y, minY, maxY);
         }
 
-        bounds_ = newBounds;
-        if (content_) {
-            DFRect contentBounds = {
-                bounds_.x,
-                bounds_.y + TITLE_BAR_HEIGHT,
-                bounds_.width,
-                bounds_.height - TITLE_BAR_HEIGHT
-            };
-            content_->setBounds(contentBounds);
-        }
+        moveTo(newBounds);
         event.handled = true;
         return true;
     }
@@ -272,6 +295,9 @@ bool WindowFrame::handleEvent(Event& event)
 
 void WindowFrame::render(Canvas& canvas)
 {
+    if (canvas.isClippedOut(bounds_)) {
+        return;
+    }
     const auto& theme = CurrentTheme();
     canvas.drawRectangle(bounds_, theme.floatingFrame);
     DFRect titleBar{bounds_.x, bounds_.y, bounds_.width, TITLE_BAR_HEIGHT};
@@ -281,20 +307,18 @@ void WindowFrame::render(Canvas& canvas)
         const float textLeft = titleBar.x + 8.0f;
         const float textRight = titleBar.x + titleBar.width - CLOSE_BUTTON_SIZE - CLOSE_BUTTON_PADDING - 8.0f;
         const float maxWidth = std::max(0.0f, textRight - textLeft);
-        const std::string caption = DFClipTextToWidth(content_->title(), maxWidth, true);
-        if (!caption.empty()) {
+        const DFTextFit fit = DFFitTextToWidth(content_->title(), maxWidth, true);
+        if (fit.visibleChars > 0) {
             const float luminance = theme.titleBar.r * 0.2126f + theme.titleBar.g * 0.7152f + theme.titleBar.b * 0.0722f;
             const DFColor textColor = (luminance > 0.50f)
                 ? DFColor{0.08f, 0.09f, 0.10f, 1.0f}
                 : DFColor{0.90f, 0.91f, 0.94f, 1.0f};
-            canvas.drawText(textLeft, DFTextBaselineYForRect(titleBar), caption, textColor);
+            DFDrawTextFit(canvas, textLeft, DFTextBaselineYForRect(titleBar), content_->title(), fit, textColor, 1.0f, DFTextSmooth());
         }
     }
 
     if (closeButtonEnabled()) {
-        float closeX = bounds_.x + bounds_.width - CLOSE_BUTTON_SIZE - CLOSE_BUTTON_PADDING;
-        float closeY = bounds_.y + CLOSE_BUTTON_PADDING;
-        DFRect closeButton{closeX, closeY, CLOSE_BUTTON_SIZE, CLOSE_BUTTON_SIZE};
+        const DFRect closeButton = closeButtonRect();
         DockIconButtonStyle style{};
         style.roundHoverBackground = true;
         style.hoverCornerRadius = 4.0f;
@@ -330,6 +354,9 @@ WindowFrame* WindowManager::createFloatingWindow(DockWidget* widget, const DFRec
 
 void WindowManager::destroyWindow(WindowFrame* window)
 {
+    if (hasWindow(window)) {
+        addDamage(window->bounds());
+    }
     if (window && window->content()) {
         window->content()->floating_ = false;
         window->content()->hostWindow_ = nullptr;
@@ -344,6 +371,9 @@ void WindowManager::destroyWindow(WindowFrame* window)
 
 void WindowManager::destroyAllWindows()
 {
+    for (const auto& window : windows_) {
+        addDamage(window->bounds());
+    }
     windows_.clear();
 }
 
@@ -413,6 +443,7 @@ void WindowManager::bringToFront(WindowFrame* window)
     auto it = std::find_if(windows_.begin(), windows_.end(),
                            [window](const std::unique_ptr<WindowFrame>& w) { return w.get() == window; });
     if (it != windows_.end() && it != windows_.end() - 1) {
+        addDamage((*it)->bounds());
         std::rotate(it, it + 1, windows_.end());
     }
 }
@@ -424,6 +455,7 @@ void WindowManager::updateAllWindows()
 
 void WindowManager::renderAllWindows(Canvas& canvas)
 {
+    DFCanvasScopeGuard scope(canvas, DFCanvasScope::WindowManager);
     for (auto& w : windows_) w->render(canvas);
 }
 
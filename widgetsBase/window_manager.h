@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core_types.h"
+#include "damage_region.h"
 #include <memory>
 #include <vector>
 
@@ -24,6 +25,9 @@ public:
     void syncLocalFromClientOrigin(const DFPoint& clientOriginScreen);
     bool isDragging() const { return dragging_; }
     bool isInFrameArea(const DFPoint& p) const;
+    // Part of the frame under p, tested in the order handleEvent uses.
+    enum class Part { None, CloseButton, ResizeEdge, TitleBar, Client };
+    Part partAt(const DFPoint& p) const;
     bool consumeCloseRequest();
     void cancelDrag();
 
@@ -34,6 +38,8 @@ private:
 
     bool isInTitleBar(const DFPoint& p) const;
     bool isInCloseButton(const DFPoint& p) const;
+    DFRect closeButtonRect() const;
+    void moveTo(const DFRect& bounds);
     bool closeButtonEnabled() const;
     DragMode getResizeMode(const DFPoint& p) const;
 
@@ -65,6 +71,9 @@ public:
     WindowFrame* findWindowByContent(const DockWidget* widget);
     bool hasWindow(const WindowFrame* window) const;
     std::vector<WindowFrame*> windowsSnapshot() const;
+    // Back-to-front access without copying the list.
+    size_t windowCount() const { return windows_.size(); }
+    WindowFrame* windowAt(size_t index) const { return windows_[index].get(); }
     void bringToFront(WindowFrame* window);
     bool hasDraggingWindow() const;
     void cancelAllDrags();
@@ -74,13 +83,25 @@ public:
     const DFPoint& clientOriginScreen() const { return clientOriginScreen_; }
 
     void updateAllWindows();
+    // Skips windows outside canvas.clipRect() when a clip is set.
     void renderAllWindows(Canvas& canvas);
 
+    // Receives old and new bounds of frames that move, resize, open, close or
+    // change stacking, and the close button when its hover state flips.
+    void setDamageRegion(DFDamageRegion* damage) { damage_ = damage; }
+    void addDamage(const DFRect& rect)
+    {
+        if (damage_) {
+            damage_->add(rect);
+        }
+    }
+
 private:
     WindowManager() = default;
     std::vector<std::unique_ptr<WindowFrame>> windows_;
     DFRect workArea_{0.0f, 0.0f, 1280.0f, 720.0f};
     DFPoint clientOriginScreen_{0.0f, 0.0f};
+    DFDamageRegion* damage_ = nullptr;
 };
 
 } // namespace df